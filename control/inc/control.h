@@ -17,12 +17,17 @@
 #ifndef __CONTROL_H
 #define __CONTROL_H
 
+#include "link.h"
+#include "thread.h"
 #include "logger.h"
 
 typedef struct {
 
-    // TCP Socket file descriptors
-    int guidance_sock, navigation_sock;
+    // Guards fields shared between the subsystem's threads
+    THREAD_MUTEX lock;
+
+    // Supervised TCP links to other subsystems
+    LINK guidance_link, navigation_link;
 
     // Serial device file descriptors
     int kangaroo_fd, encoder_fd;
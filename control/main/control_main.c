@@ -12,6 +12,14 @@
  * Revision 0.1
  *      Last edited 04/10/2020
  *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Runs until SIGINT or SIGTERM instead of for a fixed time
+ *
+ * Revision 0.3
+ *      Last edited 10/18/2026
+ *      Thread stack freed even when the thread fails to start
+ *
  ***************************************************************************/
 
 // Standard headers
@@ -20,6 +28,7 @@
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
+#include <signal.h>
 
 // Thread management
 #include <sched.h>
@@ -27,8 +36,9 @@
 // Custom library headers
 #include "config.h"
 #include "debuglog.h"
-#include "tcp.h"
+#include "link.h"
 #include "thread.h"
+#include "watchdog.h"
 
 // Subsystem library headers
 #include "control.h"
@@ -36,6 +46,23 @@
 #include "kangaroo_run.h"
 #include "encoder_run.h"
 
+// Cleared by SIGINT or SIGTERM to shut the subsystem down
+static volatile sig_atomic_t running = 1;
+
+static void stopHandler(int signum) {
+
+    (void) signum;
+    running = 0;
+
+}
+
+// Periodic task routine, runs one pass of the control loop
+static int controlTask(void *params) {
+
+    return control_run((CONTROL_PARAMS *) params);
+
+}
+
 int main(int argc, char** argv) {
 
     int rc;
@@ -46,6 +73,29 @@ int main(int argc, char** argv) {
 
     logDebug(L_DEBUG, "Control: Starting control process...\n\n");
 
+    // Shut down cleanly on SIGINT or SIGTERM
+    struct sigaction stopAction;
+    sigset_t stopSignals, oldMask;
+    memset(&stopAction, 0, sizeof(stopAction));
+    stopAction.sa_handler = &stopHandler;
+    sigemptyset(&stopAction.sa_mask);
+    sigaction(SIGINT, &stopAction, NULL);
+    sigaction(SIGTERM, &stopAction, NULL);
+
+    // Shared between the subsystem threads, which run at different realtime
+    // priorities, so it inherits priority and tracks hold times
+    rc = ThreadMutexInit(&(control.lock), "Control params", THREAD_MUTEX_INSTRUMENT);
+    if (rc != 0) {
+        logDebug(L_INFO, "Control: Failed to initialize params lock: %s\n", strerror(errno));
+    }
+
+    // Lock memory before anything large is allocated so the realtime loop
+    // never waits on a page fault
+    rc = ThreadLockMemory();
+    if (rc != 0) {
+        logDebug(L_INFO, "Control: Continuing without locked memory\n");
+    }
+
     /**** Serial device loggers ****/
 
     logDebug(L_DEBUG, "Control: Initializing serial interfaces...\n");
@@ -77,59 +127,32 @@ int main(int argc, char** argv) {
 
     logDebug(L_DEBUG, "Control: Initializing network interfaces...\n");
 
-    // Initialize socket file descriptors
-    control.guidance_sock = -1;
-    control.navigation_sock = -1;
-    int gSock = TCPClientInit();
-    int nSock = TCPClientInit();
-
-    if (gSock == -1 || nSock == -1) {
-        logDebug(L_INFO, "Control: Failed to initialize control sockets: %s\n", strerror(errno));
+    // Initialize supervised links to guidance and navigation. The
+    // run function services them every period, so a link reconnects if its
+    // peer restarts.
+    rc = LinkInit(&(control.guidance_link), "guidance",
+            LINK_ROLE_CLIENT, GUIDANCE_IP_ADDR, CONTROL_TCP_PORT);
+    rc |= LinkInit(&(control.navigation_link), "navigation",
+            LINK_ROLE_CLIENT, NAVIGATION_IP_ADDR, CONTROL_TCP_PORT);
+    if (rc != 0) {
+        logDebug(L_INFO, "Control: Failed to initialize control links: %s\n", strerror(errno));
     }
 
-    // Loop until both sockets are connected
+    // Loop until both links are connected
     const int MAX_CONNECT_ATTEMPTS = 10000;
-    int gConnected = 0, nConnected = 0, numTries = 0; 
-    while (!(gConnected && nConnected) && numTries < MAX_CONNECT_ATTEMPTS) {
+    int numTries = 0;
+    while (running &&
+            !(LinkIsUp(&(control.guidance_link)) && LinkIsUp(&(control.navigation_link))) &&
+            numTries < MAX_CONNECT_ATTEMPTS) {
 
         // Count attempt number
         numTries++;
 
-        // Attempt to connect to guidance (if not already connected)
-        if (!gConnected) {
-
-            logDebug(L_DEBUG, "Control: Attempting to connect to guidance at %s:%d\n", GUIDANCE_IP_ADDR, CONTROL_TCP_PORT);
-            rc = TCPClientTryConnect(gSock, GUIDANCE_IP_ADDR, CONTROL_TCP_PORT);
-            if (rc != -1) {
-                logDebug(L_INFO, "Control: Successful TCP connection to guidance\n");
-                gConnected = 1;
-                control.guidance_sock = gSock;
-            } else if (errno == ECONNREFUSED) {
-                logDebug(L_DEBUG, "Control: Unsuccessful connection to guidance, will try again\n");
-                // Delay to give other end a chance to start
-                usleep(10000);
-            } else {
-                logDebug(L_INFO, "Control: Could not connect to guidance: %s\n", strerror(errno));
-            }
-        }
-
-        // Attempt to connect to navigation (if not already connected)
-        if (!nConnected) {
-
-            logDebug(L_DEBUG, "Control: Attempting to connect to navigation at %s:%d\n", NAVIGATION_IP_ADDR, CONTROL_TCP_PORT);
-            rc = TCPClientTryConnect(nSock, NAVIGATION_IP_ADDR, CONTROL_TCP_PORT);
-            if (rc != -1) {
-                logDebug(L_INFO, "Control: Successful TCP connection to navigation\n");
-                nConnected = 1;
-                control.navigation_sock = nSock;
-            } else if (errno == ECONNREFUSED) {
-                logDebug(L_DEBUG, "Control: Unsuccessful connection to navigation, will try again\n");
-                // Delay to give other end a chance to start
-                usleep(10000);
-            } else {
-                logDebug(L_INFO, "Control: Could not connect to navigation: %s\n", strerror(errno));
-            }
-        }
+        LinkService(&(control.guidance_link));
+        LinkService(&(control.navigation_link));
+
+        // Delay to give other ends a chance to start
+        usleep(10000);
 
     } // while (!connected)
 
@@ -140,6 +163,11 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!running) {
+        logDebug(L_INFO, "Control: Stopped before links connected, exiting\n");
+        return 0;
+    }
+
 
     /**** Threads ****/
 
@@ -148,8 +176,8 @@ int main(int argc, char** argv) {
     // For now, only dispatch control thread. Will dispatch hardware interface
     // threads when they are ready
     pthread_attr_t controlThreadAttr /*, kangarooThreadAttr, encoderThreadAttr*/;
-    pthread_t controlThread /*, kangarooThread, encoderThread*/;
-    int controlReturn /*, kangarooReturn, encoderReturn*/;
+    // pthread_t kangarooThread, encoderThread;
+    // int kangarooReturn, encoderReturn;
 
     // Initialize thread attributes
     // ThreadAttrInit(&encoderThreadAttr, 0);
@@ -159,26 +187,69 @@ int main(int argc, char** argv) {
         logDebug(L_INFO, "Control: Failed to initialize control thread attributes: %s\n", strerror(errno));
     }
 
+    // Pin the loop to its own core and give it a pre-faulted stack
+    if (ThreadAttrSetAffinity(&controlThreadAttr, SUBSYSTEM_RT_CPU_MASK) != 0) {
+        logDebug(L_INFO, "Control: Running control thread without CPU affinity\n");
+    }
+    if (ThreadAttrSetStack(&controlThreadAttr, SUBSYSTEM_RT_STACK_SIZE) != 0) {
+        logDebug(L_INFO, "Control: Running control thread on default stack\n");
+    }
+
+    // Report anything that will cost the loop its timing
+    ThreadCheckRealtime(SUBSYSTEM_RT_CPU_MASK);
+
     // Dispatch threads, give configuration object as argument
     // ThreadCreate(&encoderThreadAttr, &encoderThreadAttr, &encoder_run, (void *)&control);
     // ThreadCreate(&kangarooThreadAttr, &kangarooThreadAttr, &kangaroo_run, (void *)&control);
-    rc = ThreadCreate(&controlThread, &controlThreadAttr,
-            (void *(*)(void *)) &control_run, (void *)&control);
+
+    // Only the main thread takes the stop signals. Threads started from here
+    // on inherit the blocked mask.
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &oldMask);
+
+    // The control loop runs as a periodic task at a fixed rate
+    PERIODIC_TASK controlLoop;
+    ThreadPeriodicInit(&controlLoop, "Control", CONTROL_PERIOD_US,
+            &controlTask, (void *)&control);
+
+    // Watchdog logs when the loop goes several periods without running
+    WATCHDOG watchdog;
+    WatchdogInit(&watchdog, WATCHDOG_CHECK_PERIOD_US);
+    int watchdogHandle = WatchdogRegister(&watchdog, "Control",
+            WATCHDOG_BUDGET_PERIODS * CONTROL_PERIOD_US, WATCHDOG_ACTION_LOG, NULL, NULL);
+    if (watchdogHandle >= 0) {
+        ThreadPeriodicSetWatchdog(&controlLoop, &watchdog, watchdogHandle);
+    }
+    WatchdogStart(&watchdog);
+
+    rc = ThreadPeriodicStart(&controlLoop, &controlThreadAttr);
     if (rc == -1) {
         logDebug(L_INFO, "Control: Failed to dispatch control thread: %s\n", strerror(errno));
     }
 
     logDebug(L_DEBUG, "Control: Threads initialized\n");
 
-    // Join threads
-    int i = 0;
-    do {
-        usleep(100000);
-        rc = ThreadTryJoin(controlThread, &controlReturn);
-        i++;
-    } while (i < 10 && rc != 0 && errno == EBUSY);
+    // Run until told to stop. The stop signals are unblocked only while
+    // waiting, so one that arrives just before the wait is not missed.
+    while (running) {
+        sigsuspend(&oldMask);
+    }
+    if (rc == 0) {
+        ThreadPeriodicStop(&controlLoop);
+        ThreadPeriodicReportStats(&controlLoop);
+    }
+    ThreadAttrFreeStack(&controlThreadAttr);
+    WatchdogStop(&watchdog);
+    WatchdogReportStats(&watchdog);
 
     logDebug(L_DEBUG, "Control: Successfully joined threads.\n");
+
+    // Report how each link behaved over the run
+    LinkReportStats(&(control.guidance_link));
+    LinkReportStats(&(control.navigation_link));
+    ThreadMutexReportStats(&(control.lock));
     logDebug(L_INFO, "\nControl: Closing application.\n");
 
     // Safely shutdown the application
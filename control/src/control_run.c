@@ -12,12 +12,29 @@
  * Revision 0.1
  *      Last edited 03/05/2020
  *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Links serviced every period so they recover from peer restarts
+ *
+ * Revision 0.3
+ *      Last edited 10/18/2026
+ *      Shared params locked while the links are serviced
+ *
  ***************************************************************************/
 
 #include "control.h"
 
 int control_run(CONTROL_PARAMS *control) {
 
+    // The links are shared with the subsystem's other threads
+    ThreadMutexLock(&(control->lock));
+
+    // Keep the links connected, a peer that restarted is reconnected here
+    LinkService(&(control->guidance_link));
+    LinkService(&(control->navigation_link));
+
+    ThreadMutexUnlock(&(control->lock));
+
 	// First function call will initialize interface with hardware
 
 	// Second function call will read data into controller
@@ -28,4 +45,3 @@ int control_run(CONTROL_PARAMS *control) {
 
 	return 0;
 }
-
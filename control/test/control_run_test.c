@@ -0,0 +1,83 @@
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "timing.h"
+
+#include "control.h"
+#include "control_run.h"
+
+#define IP_ADDR "127.0.0.1"
+#define GUIDANCE_PORT   GUIDANCE_TCP_PORT
+#define NAVIGATION_PORT NAVIGATION_TCP_PORT
+
+// Stand-ins for the guidance and navigation processes
+LINK guidancePeer, navigationPeer;
+CONTROL_PARAMS control;
+
+Describe(ControlRun);
+
+BeforeEach(ControlRun) {
+
+    memset(&control, 0, sizeof(control));
+    ThreadMutexInit(&(control.lock), "Control params", THREAD_MUTEX_INSTRUMENT);
+    LinkInit(&(control.guidance_link), "guidance", LINK_ROLE_CLIENT, IP_ADDR, GUIDANCE_PORT);
+    LinkInit(&(control.navigation_link), "navigation", LINK_ROLE_CLIENT, IP_ADDR, NAVIGATION_PORT);
+    LinkInit(&guidancePeer, "guidance peer", LINK_ROLE_SERVER, IP_ADDR, GUIDANCE_PORT);
+    LinkInit(&navigationPeer, "navigation peer", LINK_ROLE_SERVER, IP_ADDR, NAVIGATION_PORT);
+
+}
+
+AfterEach(ControlRun) {
+
+    LinkClose(&(control.guidance_link));
+    LinkClose(&(control.navigation_link));
+    ThreadMutexDestroy(&(control.lock));
+    LinkClose(&guidancePeer);
+    LinkClose(&navigationPeer);
+
+}
+
+// Runs the control loop (and the peers) until the links are in the wanted
+// state. Returns the time taken in milliseconds, or -1 on timeout.
+static int run_until(int wantUp, int timeoutMs) {
+
+    int64_t start = TimeMonotonicNs();
+
+    do {
+        control_run(&control);
+        LinkService(&guidancePeer);
+        LinkService(&navigationPeer);
+        if ((LinkIsUp(&(control.guidance_link)) && LinkIsUp(&(control.navigation_link))) == wantUp) {
+            return (int) ((TimeMonotonicNs() - start) / NSEC_PER_MSEC);
+        }
+        usleep(1000);
+    } while (TimeMonotonicNs() - start < timeoutMs * NSEC_PER_MSEC);
+
+    return -1;
+
+}
+
+Ensure(ControlRun, reconnects_after_peer_restart) {
+
+    assert_that(run_until(1, 1000), is_not_equal_to(-1));
+
+    // Navigation goes away after startup, and comes back
+    LinkClose(&navigationPeer);
+    assert_that(run_until(0, 1000), is_not_equal_to(-1));
+    assert_that(LinkIsUp(&(control.guidance_link)), is_true);
+
+    LinkInit(&navigationPeer, "navigation peer", LINK_ROLE_SERVER, IP_ADDR, NAVIGATION_PORT);
+    assert_that(run_until(1, 2000), is_not_equal_to(-1));
+
+    assert_that(control.navigation_link.numDrops, is_equal_to(1));
+    assert_that(control.navigation_link.numRecoveries, is_equal_to(1));
+
+    // Every pass took the params lock
+    assert_that(control.lock.numLocks, is_greater_than(0));
+    assert_that(control.lock.depth, is_equal_to(0));
+    assert_that(control.guidance_link.numDrops, is_equal_to(0));
+
+}
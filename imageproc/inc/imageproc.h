@@ -17,10 +17,16 @@
 #ifndef __IMAGEPROC_H
 #define __IMAGEPROC_H
 
+#include "link.h"
+#include "thread.h"
+
 typedef struct {
 
-    // TCP Socket file descriptors
-    int guidance_sock, navigation_sock;
+    // Guards fields shared between the subsystem's threads
+    THREAD_MUTEX lock;
+
+    // Supervised TCP links to other subsystems
+    LINK guidance_link, navigation_link;
 
 } IMAGEPROC_PARAMS;
 
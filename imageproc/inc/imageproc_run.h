@@ -3,7 +3,8 @@
 #ifndef IMAGEPROC_RUN_H
 #define IMAGEPROC_RUN_H
 
-int imageproc_run(int arg);
+#include "imageproc.h"
 
-#endif // IMAGEPROC_RUN_H
+int imageproc_run(IMAGEPROC_PARAMS *imageproc);
 
+#endif // IMAGEPROC_RUN_H
@@ -12,6 +12,18 @@
  * Revision 0.1
  *      Last edited 04/23/2020
  *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Runs until SIGINT or SIGTERM instead of for a fixed time
+ *
+ * Revision 0.3
+ *      Last edited 10/18/2026
+ *      Realtime setup to match the other subsystems
+ *
+ * Revision 0.4
+ *      Last edited 10/18/2026
+ *      Thread stack freed even when the thread fails to start
+ *
  ***************************************************************************/
 
 // Standard headers
@@ -20,6 +32,7 @@
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
+#include <signal.h>
 
 // Thread management
 #include <sched.h>
@@ -27,13 +40,30 @@
 // Custom library headers
 #include "config.h"
 #include "debuglog.h"
-#include "tcp.h"
+#include "link.h"
 #include "thread.h"
 
 // Subsystem library headers
 #include "imageproc.h"
 #include "imageproc_run.h"
 
+// Cleared by SIGINT or SIGTERM to shut the subsystem down
+static volatile sig_atomic_t running = 1;
+
+static void stopHandler(int signum) {
+
+    (void) signum;
+    running = 0;
+
+}
+
+// Periodic task routine, runs one pass of the imageproc loop
+static int imageprocTask(void *params) {
+
+    return imageproc_run((IMAGEPROC_PARAMS *) params);
+
+}
+
 int main(int argc, char** argv) {
 
     int rc;
@@ -44,6 +74,29 @@ int main(int argc, char** argv) {
 
     logDebug(L_DEBUG, "ImageProc: Starting imageproc process...\n\n");
 
+    // Shut down cleanly on SIGINT or SIGTERM
+    struct sigaction stopAction;
+    sigset_t stopSignals, oldMask;
+    memset(&stopAction, 0, sizeof(stopAction));
+    stopAction.sa_handler = &stopHandler;
+    sigemptyset(&stopAction.sa_mask);
+    sigaction(SIGINT, &stopAction, NULL);
+    sigaction(SIGTERM, &stopAction, NULL);
+
+    // Shared between the subsystem threads, which run at different realtime
+    // priorities, so it inherits priority and tracks hold times
+    rc = ThreadMutexInit(&(imageproc.lock), "ImageProc params", THREAD_MUTEX_INSTRUMENT);
+    if (rc != 0) {
+        logDebug(L_INFO, "ImageProc: Failed to initialize params lock: %s\n", strerror(errno));
+    }
+
+    // Lock memory before anything large is allocated so the realtime loop
+    // never waits on a page fault
+    rc = ThreadLockMemory();
+    if (rc != 0) {
+        logDebug(L_INFO, "ImageProc: Continuing without locked memory\n");
+    }
+
 
     /**** Serial interfaces ****/
 
@@ -56,59 +109,32 @@ int main(int argc, char** argv) {
 
     logDebug(L_DEBUG, "ImageProc: Initializing network interfaces...\n");
 
-    // Initialize socket file descriptors
-    imageproc.guidance_sock = -1;
-    imageproc.navigation_sock = -1;
-    int gSock = TCPClientInit();
-    int nSock = TCPClientInit();
-
-    if (gSock == -1 || nSock == -1) {
-        logDebug(L_INFO, "ImageProc: Failed to initialize imageproc sockets: %s\n", strerror(errno));
+    // Initialize supervised links to guidance and navigation. The
+    // run function services them every period, so a link reconnects if its
+    // peer restarts.
+    rc = LinkInit(&(imageproc.guidance_link), "guidance",
+            LINK_ROLE_CLIENT, GUIDANCE_IP_ADDR, IMAGEPROC_TCP_PORT);
+    rc |= LinkInit(&(imageproc.navigation_link), "navigation",
+            LINK_ROLE_CLIENT, NAVIGATION_IP_ADDR, IMAGEPROC_TCP_PORT);
+    if (rc != 0) {
+        logDebug(L_INFO, "ImageProc: Failed to initialize imageproc links: %s\n", strerror(errno));
     }
 
-    // Loop until both sockets are connected
+    // Loop until both links are connected
     const int MAX_CONNECT_ATTEMPTS = 10000;
-    int gConnected = 0, nConnected = 0, numTries = 0; 
-    while (!(gConnected && nConnected) && numTries < MAX_CONNECT_ATTEMPTS) {
+    int numTries = 0;
+    while (running &&
+            !(LinkIsUp(&(imageproc.guidance_link)) && LinkIsUp(&(imageproc.navigation_link))) &&
+            numTries < MAX_CONNECT_ATTEMPTS) {
 
         // Count attempt number
         numTries++;
 
-        // Attempt to connect to guidance (if not already connected)
-        if (!gConnected) {
-
-            logDebug(L_DEBUG, "ImageProc: Attempting to connect to guidance at %s:%d\n", GUIDANCE_IP_ADDR, IMAGEPROC_TCP_PORT);
-            rc = TCPClientTryConnect(gSock, GUIDANCE_IP_ADDR, IMAGEPROC_TCP_PORT);
-            if (rc != -1) {
-                logDebug(L_INFO, "ImageProc: Successful TCP connection to guidance\n");
-                gConnected = 1;
-                imageproc.guidance_sock = gSock;
-            } else if (errno == ECONNREFUSED) {
-                logDebug(L_DEBUG, "ImageProc: Unsuccessful connection to guidance, will try again\n");
-                // Delay to give other end a chance to start
-                usleep(10000);
-            } else {
-                logDebug(L_INFO, "ImageProc: Could not connect to guidance: %s\n", strerror(errno));
-            }
-        }
-
-        // Attempt to connect to navigation (if not already connected)
-        if (!nConnected) {
-
-            logDebug(L_DEBUG, "ImageProc: Attempting to connect to navigation at %s:%d\n", NAVIGATION_IP_ADDR, IMAGEPROC_TCP_PORT);
-            rc = TCPClientTryConnect(nSock, NAVIGATION_IP_ADDR, IMAGEPROC_TCP_PORT);
-            if (rc != -1) {
-                logDebug(L_INFO, "ImageProc: Successful TCP connection to navigation\n");
-                nConnected = 1;
-                imageproc.navigation_sock = nSock;
-            } else if (errno == ECONNREFUSED) {
-                logDebug(L_DEBUG, "ImageProc: Unsuccessful connection to navigation, will try again\n");
-                // Delay to give other end a chance to start
-                usleep(10000);
-            } else {
-                logDebug(L_INFO, "ImageProc: Could not connect to navigation: %s\n", strerror(errno));
-            }
-        }
+        LinkService(&(imageproc.guidance_link));
+        LinkService(&(imageproc.navigation_link));
+
+        // Delay to give other ends a chance to start
+        usleep(10000);
 
     } // while (!connected)
 
@@ -119,6 +145,11 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!running) {
+        logDebug(L_INFO, "ImageProc: Stopped before links connected, exiting\n");
+        return 0;
+    }
+
 
     /**** Threads ****/
 
@@ -127,8 +158,6 @@ int main(int argc, char** argv) {
     // For now, only dispatch imageproc thread. Will dispatch hardware interface
     // threads when they are ready
     pthread_attr_t imageprocThreadAttr;
-    pthread_t imageprocThread;
-    int imageprocReturn;
 
     // Initialize thread attributes
     rc = ThreadAttrInit(&imageprocThreadAttr, 2);
@@ -136,24 +165,54 @@ int main(int argc, char** argv) {
         logDebug(L_INFO, "ImageProc: Failed to initialize imageproc thread attributes: %s\n", strerror(errno));
     }
 
-    // Dispatch threads, give configuration object as argument
-    rc = ThreadCreate(&imageprocThread, &imageprocThreadAttr,
-            (void *(*)(void *)) &imageproc_run, (void *)&imageproc);
+    // Pin the loop to its own core and give it a pre-faulted stack
+    if (ThreadAttrSetAffinity(&imageprocThreadAttr, SUBSYSTEM_RT_CPU_MASK) != 0) {
+        logDebug(L_INFO, "ImageProc: Running imageproc thread without CPU affinity\n");
+    }
+    if (ThreadAttrSetStack(&imageprocThreadAttr, SUBSYSTEM_RT_STACK_SIZE) != 0) {
+        logDebug(L_INFO, "ImageProc: Running imageproc thread on default stack\n");
+    }
+
+    // Report anything that will cost the loop its timing
+    ThreadCheckRealtime(SUBSYSTEM_RT_CPU_MASK);
+
+    // Only the main thread takes the stop signals. Threads started from here
+    // on inherit the blocked mask.
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &oldMask);
+
+    // The imageproc loop runs as a periodic task, which also keeps the links
+    // serviced
+    PERIODIC_TASK imageprocLoop;
+    ThreadPeriodicInit(&imageprocLoop, "ImageProc", IMAGEPROC_PERIOD_US,
+            &imageprocTask, (void *)&imageproc);
+
+    rc = ThreadPeriodicStart(&imageprocLoop, &imageprocThreadAttr);
     if (rc == -1) {
         logDebug(L_INFO, "ImageProc: Failed to dispatch imageproc thread: %s\n", strerror(errno));
     }
 
     logDebug(L_DEBUG, "ImageProc: Threads initialized\n");
 
-    // Join threads
-    int i = 0;
-    do {
-        usleep(100000);
-        rc = ThreadTryJoin(imageprocThread, &imageprocReturn);
-        i++;
-    } while (i < 10 && rc != 0 && errno == EBUSY);
+    // Run until told to stop. The stop signals are unblocked only while
+    // waiting, so one that arrives just before the wait is not missed.
+    while (running) {
+        sigsuspend(&oldMask);
+    }
+    if (rc == 0) {
+        ThreadPeriodicStop(&imageprocLoop);
+        ThreadPeriodicReportStats(&imageprocLoop);
+    }
+    ThreadAttrFreeStack(&imageprocThreadAttr);
 
     logDebug(L_DEBUG, "ImageProc: Successfully joined threads.\n");
+
+    // Report how each link behaved over the run
+    LinkReportStats(&(imageproc.guidance_link));
+    LinkReportStats(&(imageproc.navigation_link));
+    ThreadMutexReportStats(&(imageproc.lock));
     logDebug(L_INFO, "\nImageProc: Closing application.\n");
 
     // Safely shutdown the application
@@ -1,6 +1,17 @@
 /* imageproc_run.c */
 
-int imageproc_run(int arg) {
+#include "imageproc.h"
+
+int imageproc_run(IMAGEPROC_PARAMS *imageproc) {
+
+    // The links are shared with the subsystem's other threads
+    ThreadMutexLock(&(imageproc->lock));
+
+    // Keep the links connected, a peer that restarted is reconnected here
+    LinkService(&(imageproc->guidance_link));
+    LinkService(&(imageproc->navigation_link));
+
+    ThreadMutexUnlock(&(imageproc->lock));
 
 	// Add image processing operation here
 
@@ -2,6 +2,15 @@
 #include <cgreen/cgreen.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "timing.h"
+
+#include "imageproc.h"
+#include "imageproc_run.h"
+
+#define IP_ADDR "127.0.0.1"
 
 Describe(ImageProcessing);
 BeforeEach(ImageProcessing) {}
@@ -14,3 +23,53 @@ Ensure(ImageProcessing, dummy_test) {
 
 }
 
+
+// Runs the imageproc loop and a navigation stand-in until the navigation
+// link is in the wanted state. Returns -1 on timeout.
+static int run_until(IMAGEPROC_PARAMS *imageproc, LINK *peer, int wantUp, int timeoutMs) {
+
+    int64_t start = TimeMonotonicNs();
+
+    do {
+        imageproc_run(imageproc);
+        LinkService(peer);
+        if (LinkIsUp(&(imageproc->navigation_link)) == wantUp) {
+            return (int) ((TimeMonotonicNs() - start) / NSEC_PER_MSEC);
+        }
+        usleep(1000);
+    } while (TimeMonotonicNs() - start < timeoutMs * NSEC_PER_MSEC);
+
+    return -1;
+
+}
+
+Ensure(ImageProcessing, reconnects_after_navigation_restart) {
+
+    IMAGEPROC_PARAMS imageproc;
+    LINK navigationPeer;
+
+    memset(&imageproc, 0, sizeof(imageproc));
+    ThreadMutexInit(&(imageproc.lock), "ImageProc params", THREAD_MUTEX_INSTRUMENT);
+    LinkInit(&(imageproc.guidance_link), "guidance", LINK_ROLE_CLIENT, IP_ADDR, GUIDANCE_TCP_PORT);
+    LinkInit(&(imageproc.navigation_link), "navigation", LINK_ROLE_CLIENT, IP_ADDR, IMAGEPROC_TCP_PORT);
+    LinkInit(&navigationPeer, "navigation peer", LINK_ROLE_SERVER, IP_ADDR, IMAGEPROC_TCP_PORT);
+
+    assert_that(run_until(&imageproc, &navigationPeer, 1, 1000), is_not_equal_to(-1));
+
+    LinkClose(&navigationPeer);
+    assert_that(run_until(&imageproc, &navigationPeer, 0, 1000), is_not_equal_to(-1));
+    LinkInit(&navigationPeer, "navigation peer", LINK_ROLE_SERVER, IP_ADDR, IMAGEPROC_TCP_PORT);
+    assert_that(run_until(&imageproc, &navigationPeer, 1, 2000), is_not_equal_to(-1));
+
+    assert_that(imageproc.navigation_link.numRecoveries, is_equal_to(1));
+
+    // Every pass took the params lock
+    assert_that(imageproc.lock.numLocks, is_greater_than(0));
+    assert_that(imageproc.lock.depth, is_equal_to(0));
+
+    LinkClose(&(imageproc.guidance_link));
+    LinkClose(&(imageproc.navigation_link));
+    ThreadMutexDestroy(&(imageproc.lock));
+    LinkClose(&navigationPeer);
+
+}
@@ -0,0 +1,474 @@
+/****************************************************************************
+ *
+ * File:
+ *      vn200_bench.c
+ *
+ * Description:
+ *      CGreen benchmarks for the VN200 driver against the code it replaced.
+ *      Run with make bench, apart from the unit tests, since the numbers
+ *      depend on the machine. Each check is loose, it fails only on a
+ *      regression well outside run to run noise.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "timing.h"
+#include "vn200.h"
+#include "vn200_struct.h"
+#include "vn200_imu.h"
+#include "vn200_gps.h"
+#include "vn200_crc.h"
+#include "vn200_binary.h"
+#include "vn200_framer.h"
+#include "vn200_scan.h"
+#include "vn200_packet.h"
+#include "vn200_decim.h"
+
+Describe(VN200Bench);
+BeforeEach(VN200Bench) {}
+AfterEach(VN200Bench) {}
+
+static const char imuSentence[] =
+    "$VNIMU,+01.0854,-02.0143,+02.1980,-01.157,+00.271,-09.847,"
+    "+00.001114,+00.000727,+00.002568,+21.4,+084.334*6D\r\n";
+
+// One body of every supported type, in VN200_PACKET_TYPE order
+static const char *packetBodies[VN200_PACKET_NUM_TYPES] = {
+    "VNIMU,+01.0854,-02.0143,+02.1980,-01.157,+00.271,-09.847,"
+        "+00.001114,+00.000727,+00.002568,+21.4,+084.334",
+    "VNGPS,342123.600000,1851,3,09,+40.11402320,-088.24282640,+00227.483,"
+        "+000.030,-000.070,+000.070,+004.290,+004.010,+009.560,+000.250,2.80E-08",
+    "VNGPE,570937.199558,2075,3,07,-2006902.850,-4857470.210,+3604176.410,"
+        "+000.110,-000.680,+000.170,+019.320,+016.935,+016.758,+001.312,9.00E-09",
+    "VNINS,342123.600000,1851,0C2A,+010.365,-000.736,+000.215,+40.11402320,"
+        "-088.24282640,+00227.483,+000.030,-000.070,+000.070,00.9,02.7,0.14",
+    "VNYMR,+006.380,+000.023,-001.953,+1.0640,-0.2531,+3.0614,+00.005,+00.344,"
+        "-09.758,-0.001222,-0.000450,-0.001218",
+    "VNQMR,-0.017386,-0.000303,+0.055490,+0.998308,+1.0661,-0.2520,+3.0581,"
+        "+00.046,+00.376,-09.798,-0.001056,-0.000547,-0.000908",
+    "VNWRG,75,2,16,01,0129",
+    "VNRRG,07,40",
+    "VNERR,12"
+};
+
+// Rate the decimator is benchmarked down to
+#define DECIM_OUTPUT_RATE 50
+
+// Adds received bytes to the device as a read would
+static void feed(VN200_DEV *dev, const void *data, int len) {
+
+    BufferAddArray(&(dev->inbuf), (unsigned char *) data, len);
+    dev->rxOffset += len;
+
+}
+
+// Little endian float, as the sensor sends it
+static int putFloat(unsigned char *p, float value) {
+
+    uint32_t bits;
+    int i;
+
+    memcpy(&bits, &value, sizeof(bits));
+    for (i = 0; i < 4; i++) {
+        p[i] = (bits >> (8 * i)) & 0xFF;
+    }
+
+    return 4;
+
+}
+
+static int buildImuPacket(unsigned char *p) {
+
+    const float values[] = {
+        21.4, 84.334,                 // Temp, Pres
+        1.0854, -2.0143, 2.1980,      // Mag
+        -1.157, 0.271, -9.847,        // Accel
+        0.001114, 0.000727, 0.002568  // AngularRate
+    };
+    unsigned short crc;
+    int i, len = 0;
+
+    p[len++] = VN200_BINARY_SYNC;
+    p[len++] = VN200_BINARY_GROUP_IMU;
+    p[len++] = VN200_BINARY_IMU_FIELDS & 0xFF;
+    p[len++] = VN200_BINARY_IMU_FIELDS >> 8;
+    for (i = 0; i < 11; i++) {
+        len += putFloat(&p[len], values[i]);
+    }
+
+    crc = VN200CalculateCRC(&p[1], len - 1);
+    p[len++] = crc >> 8;
+    p[len++] = crc & 0xFF;
+
+    return len;
+
+}
+
+/**** Start benchmark suite ****/
+
+// The framing loop vn200_main.c used before the framer: rescans from the
+// front for '$' and '*' on every poll
+static int legacyFrame(VN200_DEV *dev) {
+
+    unsigned char data[VN200_FRAME_MAX_LEN], chk[3] = {0};
+    unsigned int expected;
+    int numFound = 0, start, end, length;
+
+    while (1) {
+
+        length = BufferLength(&(dev->inbuf));
+        for (start = 0; start < length && BufferIndex(&(dev->inbuf), start) != '$'; start++);
+        for (end = start; end < length - 3 && BufferIndex(&(dev->inbuf), end) != '*'; end++);
+
+        if (end >= length || BufferIndex(&(dev->inbuf), end) != '*') {
+            return numFound;
+        }
+
+        if (end - start - 1 < VN200_FRAME_MAX_LEN) {
+            BufferCopy(&(dev->inbuf), chk, end + 1, 2);
+            BufferCopy(&(dev->inbuf), data, start + 1, end - start - 1);
+            if (sscanf((char *) chk, "%2X", &expected) == 1 &&
+                    VN200CalculateChecksum(data, end - start - 1) == expected) {
+                numFound++;
+            }
+        }
+
+        VN200Consume(dev, end + 3);
+    }
+
+}
+
+Ensure(VN200Bench, bench_framer_at_one_megabyte_per_second) {
+
+    // One second of input at 1 MB/s, delivered in event-driven reads
+    const int numBytes = 1000000;
+    const int readLen = VN200_READ_VMIN;
+    static unsigned char stream[1000000 + VN200_FRAME_MAX_LEN];
+    VN200_DEV dev;
+    VN200_PACKET_VIEW view;
+    int len = sizeof(imuSentence) - 1, total = 0, numSentences = 0;
+    int i, numFramed = 0, numLegacy = 0;
+    int64_t start, framerNs, legacyNs;
+
+    // Sentences with a little line noise between some of them
+    while (total < numBytes) {
+        memcpy(&stream[total], imuSentence, len);
+        total += len;
+        numSentences++;
+        if (numSentences % 50 == 0) {
+            memcpy(&stream[total], "\x13\xFA*$", 4);
+            total += 4;
+        }
+    }
+
+    memset(&dev, 0, sizeof(dev));
+    start = TimeMonotonicNs();
+    for (i = 0; i < total; i += readLen) {
+        feed(&dev, &stream[i], (total - i < readLen) ? total - i : readLen);
+        while (VN200FrameNext(&dev, &view) > 0) {
+            numFramed++;
+        }
+    }
+    framerNs = TimeMonotonicNs() - start;
+
+    memset(&dev, 0, sizeof(dev));
+    start = TimeMonotonicNs();
+    for (i = 0; i < total; i += readLen) {
+        feed(&dev, &stream[i], (total - i < readLen) ? total - i : readLen);
+        numLegacy += legacyFrame(&dev);
+    }
+    legacyNs = TimeMonotonicNs() - start;
+
+    printf("BENCH VN200 framer: %d sentences from %.1f MB in %.1f ms, %.1f%% of a core at 1 MB/s\n",
+            numFramed, (double) total / 1e6, (double) framerNs / NSEC_PER_MSEC,
+            100.0 * framerNs / NSEC_PER_SEC);
+    printf("BENCH VN200 rescanning loop: %d sentences in %.1f ms, %.1f%% of a core at 1 MB/s\n",
+            numLegacy, (double) legacyNs / NSEC_PER_MSEC, 100.0 * legacyNs / NSEC_PER_SEC);
+
+    // The rescanning loop takes the '$' in the line noise as a sentence
+    // start and loses the real sentence after it
+    assert_that(numFramed, is_equal_to(numSentences));
+    assert_that(numLegacy, is_less_than(numFramed));
+    assert_that(framerNs, is_less_than(2 * legacyNs));
+
+}
+
+// The parsers as they were: copy into a stack buffer, then sscanf
+static int sscanfImu(unsigned char *buf, int len, IMU_DATA *data) {
+
+    char currentPacket[1024];
+
+    memcpy(currentPacket, buf, len);
+    currentPacket[len] = '\0';
+
+    return sscanf(currentPacket, "%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf",
+            &(data->compass[0]), &(data->compass[1]), &(data->compass[2]),
+            &(data->accel[0]), &(data->accel[1]), &(data->accel[2]),
+            &(data->gyro[0]), &(data->gyro[1]), &(data->gyro[2]),
+            &(data->temp), &(data->baro));
+
+}
+
+static int sscanfGps(unsigned char *buf, int len, GPS_DATA *data) {
+
+    char currentPacket[1024];
+
+    memcpy(currentPacket, buf, len);
+    currentPacket[len] = '\0';
+
+    return sscanf(currentPacket, "%lf,%hd,%hhd,%hhd,%lf,%lf,%lf,%f,%f,%f,%f,%f,%f,%f,%f",
+            &(data->time), &(data->week), &(data->GpsFix), &(data->NumSats),
+            &(data->PosX), &(data->PosY), &(data->PosZ),
+            &(data->VelX), &(data->VelY), &(data->VelZ),
+            &(data->PosAccX), &(data->PosAccY), &(data->PosAccZ),
+            &(data->SpeedAcc), &(data->TimeAcc));
+
+}
+
+Ensure(VN200Bench, bench_field_parser_packets_per_second) {
+
+    const int numIterations = 50000;
+    unsigned char *imuBody = (unsigned char *)
+        "+01.0854,-02.0143,+02.1980,-01.157,+00.271,-09.847,"
+        "+00.001114,+00.000727,+00.002568,+21.4,+084.334";
+    unsigned char *gpsBody = (unsigned char *)
+        "570937.199558,2075,3,07,-2006902.850,-4857470.210,+3604176.410,"
+        "+000.110,-000.680,+000.170,+019.320,+016.935,+016.758,+001.312,9.00E-09";
+    int imuLen = strlen((char *) imuBody), gpsLen = strlen((char *) gpsBody);
+    IMU_DATA imu, imuOld;
+    GPS_DATA gps, gpsOld;
+    int64_t start, oldNs, newNs;
+    int i;
+
+    memset(&gps, 0, sizeof(gps));
+    memset(&gpsOld, 0, sizeof(gpsOld));
+
+    start = TimeMonotonicNs();
+    for (i = 0; i < numIterations; i++) {
+        sscanfImu(imuBody, imuLen, &imuOld);
+        sscanfGps(gpsBody, gpsLen, &gpsOld);
+    }
+    oldNs = TimeMonotonicNs() - start;
+
+    start = TimeMonotonicNs();
+    for (i = 0; i < numIterations; i++) {
+        VN200IMUPacketParse(imuBody, imuLen, &imu);
+        VN200GPSPacketParse(gpsBody, gpsLen, &gps);
+    }
+    newNs = TimeMonotonicNs() - start;
+
+    printf("BENCH VN200 sscanf parse: %.0f packets/s\n", 2.0 * numIterations * NSEC_PER_SEC / oldNs);
+    printf("BENCH VN200 field parser: %.0f packets/s\n", 2.0 * numIterations * NSEC_PER_SEC / newNs);
+
+    // Same values either way
+    assert_that(memcmp(imu.accel, imuOld.accel, sizeof(imu.accel)), is_equal_to(0));
+    assert_that(memcmp(imu.gyro, imuOld.gyro, sizeof(imu.gyro)), is_equal_to(0));
+    assert_that(imu.baro == imuOld.baro, is_true);
+    assert_that(gps.time == gpsOld.time, is_true);
+    assert_that(gps.PosX == gpsOld.PosX, is_true);
+    assert_that(gps.VelY == gpsOld.VelY, is_true);
+    assert_that(gps.TimeAcc == gpsOld.TimeAcc, is_true);
+    assert_that(gps.week, is_equal_to(gpsOld.week));
+    assert_that(gps.NumSats, is_equal_to(gpsOld.NumSats));
+    assert_that(newNs, is_less_than(2 * oldNs));
+
+}
+
+Ensure(VN200Bench, bench_binary_decode_versus_ascii_parse) {
+
+    const int numIterations = 100000;
+    const char *body = imuSentence + 7;
+    unsigned char packet[VN200_BINARY_MAX_LEN];
+    IMU_DATA imu;
+    int i, len, bodyLen = strchr(body, '*') - body;
+    int64_t start, asciiNs, binaryNs;
+
+    len = buildImuPacket(packet);
+
+    // Against the sscanf parser the binary protocol replaces
+    start = TimeMonotonicNs();
+    for (i = 0; i < numIterations; i++) {
+        sscanfImu((unsigned char *) body, bodyLen, &imu);
+    }
+    asciiNs = TimeMonotonicNs() - start;
+
+    start = TimeMonotonicNs();
+    for (i = 0; i < numIterations; i++) {
+        VN200BinaryDecode(packet, len, &imu, NULL);
+    }
+    binaryNs = TimeMonotonicNs() - start;
+
+    printf("BENCH VN200 IMU sscanf parse: %.1f ns per sample, %d bytes\n",
+            (double) asciiNs / numIterations, (int) sizeof(imuSentence) - 1);
+    printf("BENCH VN200 IMU binary decode: %.1f ns per sample, %d bytes\n",
+            (double) binaryNs / numIterations, len);
+
+    assert_that(VN200BinaryDecode(packet, len, &imu, NULL), is_equal_to(VN200_BINARY_HAS_IMU));
+    assert_that(binaryNs, is_less_than(2 * asciiNs));
+
+}
+
+Ensure(VN200Bench, bench_scan_kernels_megabytes_per_second) {
+
+    const int numBytes = 1 << 20;
+    const int numIterations = 20;
+    const VN200_SCAN_LEVEL levels[] = {
+        VN200_SCAN_SCALAR, VN200_SCAN_SSE2, VN200_SCAN_AVX2, VN200_SCAN_NEON
+    };
+    VN200_SCAN_LEVEL original = VN200ScanGetLevel();
+    unsigned char *data = malloc(numBytes);
+    volatile unsigned char cksum;
+    volatile int found;
+    int64_t start, checksumNs, findNs, scalarNs = 0, bestNs = 0;
+    int i, j;
+
+    // A sentence body with no framing characters, the common case for both
+    for (i = 0; i < numBytes; i++) {
+        data[i] = "0123456789.,+-"[i % 14];
+    }
+
+    for (j = 0; j < (int) (sizeof(levels) / sizeof(levels[0])); j++) {
+        if (VN200ScanSetLevel(levels[j]) < 0) {
+            continue;
+        }
+
+        start = TimeMonotonicNs();
+        for (i = 0; i < numIterations; i++) {
+            cksum = VN200ChecksumXor(data, numBytes);
+        }
+        checksumNs = TimeMonotonicNs() - start;
+
+        start = TimeMonotonicNs();
+        for (i = 0; i < numIterations; i++) {
+            found = VN200FindFramingByte(data, numBytes);
+        }
+        findNs = TimeMonotonicNs() - start;
+
+        printf("BENCH VN200 %s checksum: %.0f MB/s, framing search: %.0f MB/s\n",
+                VN200ScanLevelName(levels[j]),
+                1e3 * numIterations * numBytes / checksumNs,
+                1e3 * numIterations * numBytes / findNs);
+
+        if (levels[j] == VN200_SCAN_SCALAR) {
+            scalarNs = checksumNs + findNs;
+        } else if (bestNs == 0 || checksumNs + findNs < bestNs) {
+            bestNs = checksumNs + findNs;
+        }
+    }
+
+    VN200ScanSetLevel(original);
+    free(data);
+
+    // Only the scalar kernels on a machine without vector units
+    if (bestNs > 0) {
+        printf("BENCH VN200 best vector kernels: %.1f times scalar\n", (double) scalarNs / bestNs);
+        assert_that(bestNs, is_less_than(2 * scalarNs));
+    }
+
+    assert_that(found, is_equal_to(numBytes));
+    (void) cksum;
+
+}
+
+// The dispatch as it was: compare against each id in turn
+static int chainedLookup(const unsigned char *body) {
+
+    int type;
+
+    for (type = 0; type < VN200_PACKET_NUM_TYPES; type++) {
+        if (strncmp((const char *) body, packetBodies[type], VN200_PACKET_HEADER_LEN) == 0) {
+            return type;
+        }
+    }
+
+    return -1;
+
+}
+
+Ensure(VN200Bench, bench_packet_lookup_versus_string_compares) {
+
+    const int numIterations = 1000000;
+    volatile int sink = 0;
+    int64_t start, chainNs, tableNs;
+    int i, j;
+
+    start = TimeMonotonicNs();
+    for (i = 0; i < numIterations; i++) {
+        sink += chainedLookup((const unsigned char *) packetBodies[i % VN200_PACKET_NUM_TYPES]);
+    }
+    chainNs = TimeMonotonicNs() - start;
+
+    start = TimeMonotonicNs();
+    for (i = 0; i < numIterations; i++) {
+        sink += VN200PacketLookup((const unsigned char *) packetBodies[i % VN200_PACKET_NUM_TYPES],
+                VN200_PACKET_HEADER_LEN);
+    }
+    tableNs = TimeMonotonicNs() - start;
+
+    printf("BENCH VN200 chained strncmp lookup: %.1f ns per packet\n", (double) chainNs / numIterations);
+    printf("BENCH VN200 hashed table lookup: %.1f ns per packet\n", (double) tableNs / numIterations);
+
+    (void) sink;
+    assert_that(tableNs, is_less_than(2 * chainNs));
+
+    // Every header hashes to a slot of its own, so each lookup is one compare
+    for (i = 0; i < VN200_PACKET_NUM_TYPES; i++) {
+        for (j = 0; j < i; j++) {
+            assert_that(VN200_PACKET_HASH(packetBodies[i]),
+                    is_not_equal_to(VN200_PACKET_HASH(packetBodies[j])));
+        }
+        assert_that(VN200PacketLookup((const unsigned char *) packetBodies[i],
+                    VN200_PACKET_HEADER_LEN), is_equal_to(i));
+    }
+
+}
+
+Ensure(VN200Bench, bench_decimator_cost_per_sample) {
+
+    VN200_DECIM decim;
+    VN200_DELTA delta;
+    IMU_DATA imu;
+    const int numSamples = 4000000;
+    double check = 0;
+    int64_t start, elapsedNs;
+    int i;
+
+    VN200DecimInit(&decim, VN200_DECIM_MAX_RATE, DECIM_OUTPUT_RATE);
+    memset(&imu, 0, sizeof(imu));
+    imu.accel[2] = -9.8;
+
+    start = TimeMonotonicNs();
+    for (i = 0; i < numSamples; i++) {
+        imu.gyro[0] = (i & 7) * 0.01;
+        imu.gyro[1] = (i & 3) * -0.02;
+        imu.accel[0] = (i & 15) * 0.1;
+        if (VN200DecimAdd(&decim, &imu, &delta) == 1) {
+            check += delta.dVel[0];
+        }
+    }
+    elapsedNs = TimeMonotonicNs() - start;
+
+    printf("BENCH VN200 decimation, %d Hz to %d Hz: %.1f ns per sample (%.3f%% of a core at %d Hz)\n",
+            VN200_DECIM_MAX_RATE, DECIM_OUTPUT_RATE, (double) elapsedNs / numSamples,
+            (double) elapsedNs / numSamples * VN200_DECIM_MAX_RATE / NSEC_PER_SEC * 100,
+            VN200_DECIM_MAX_RATE);
+
+    assert_that(decim.numOutput, is_equal_to(numSamples / (VN200_DECIM_MAX_RATE / DECIM_OUTPUT_RATE)));
+    assert_that_double(check, is_greater_than_double(0));
+
+    // Well inside a percent of a core at the fastest input rate
+    assert_that(elapsedNs / numSamples, is_less_than(NSEC_PER_SEC / VN200_DECIM_MAX_RATE / 100));
+
+}
@@ -17,12 +17,17 @@
 #ifndef __NAVIGATION_H
 #define __NAVIGATION_H
 
+#include "link.h"
+#include "thread.h"
 #include "vn200_struct.h"
 
 typedef struct {
 
-    // TCP Socket file descriptors
-    int guidance_sock, control_sock, imageproc_sock;
+    // Guards fields shared between the subsystem's threads
+    THREAD_MUTEX lock;
+
+    // Supervised TCP links to other subsystems
+    LINK guidance_link, control_link, imageproc_link;
 
     // Serial device file descriptors
     VN200_DEV vn200;
@@ -16,6 +16,22 @@
  * 	Last edited 5/30/2019
  * 	Major overhaul unifying GPS and IMU functionality
  *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Automatic baud rate detection and negotiation
+ *
+ * Revision 0.4
+ * 	Last edited 10/18/2026
+ * 	Event-driven reading and byte arrival times
+ *
+ * Revision 0.5
+ * 	Last edited 10/18/2026
+ * 	Binary output mode
+ *
+ * Revision 0.6
+ * 	Last edited 10/18/2026
+ * 	Configuration saved to the sensor on request, first sample recorded
+ *
  ***************************************************************************/
 
 #ifndef __VN200_H
@@ -34,21 +50,46 @@
 #include "vn200_struct.h"
 
 #define VN200_DEVNAME "/dev/ttyUSB0"
-#define VN200_BAUD 57600
-//#define VN200_BAUD 115200
+// Rate the sensor is switched to after detecting its current rate. Full-rate
+// binary IMU output needs 460800 or more.
+#define VN200_BAUD 115200
+
+// Time to wait for a reply while probing each candidate rate
+#define VN200_PROBE_TIMEOUT_MS 100
+
+// Bytes waiting before an event-driven read wakes, about one ASCII packet
+#define VN200_READ_VMIN 64
 
 // Device initialization modes
 #define VN200_INIT_MODE_GPS 1
 #define VN200_INIT_MODE_IMU 2
 #define VN200_INIT_MODE_BOTH (VN200_INIT_MODE_GPS|VN200_INIT_MODE_IMU)
+// Combined with the modes above to stream binary packets instead of ASCII
+// sentences (see vn200_binary.h)
+#define VN200_INIT_MODE_BINARY 4
+// Combined with the modes above to save the configuration in the sensor when
+// anything had to change, so later starts find nothing to write
+#define VN200_INIT_MODE_PERSIST 8
 
 
 int getTimestamp(struct timespec *ts, double *td);
 
+int VN200DetectBaud(VN200_DEV *dev, int timeoutMs);
+
+int VN200SetBaud(VN200_DEV *dev, int baud, int timeoutMs);
+
 int VN200BaseInit(VN200_DEV *dev, char *devname, int baud);
 
+int VN200EnableEvents(VN200_DEV *dev, int vmin);
+
 int VN200Poll(VN200_DEV *dev);
 
+int VN200PollWait(VN200_DEV *dev, int timeoutMs);
+
+int64_t VN200ByteTimeNs(VN200_DEV *dev, int index);
+
+int VN200MarkSample(VN200_DEV *dev, int64_t arrivalNs);
+
 int VN200Consume(VN200_DEV *dev, int num);
 
 int VN200FlushInput(VN200_DEV *dev);
@@ -59,7 +100,7 @@ int VN200FlushOutput(VN200_DEV *dev);
 
 int VN200Destroy(VN200_DEV *dev);
 
-int VN200Init(VN200_DEV *dev, char *devname, int baud, int fs, int mode);
+int VN200Init(VN200_DEV *dev, char *devname, int fs, int baud, int mode);
 
 #endif
 
@@ -0,0 +1,93 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_binary.h
+ *
+ * Description:
+ *	Function and type declarations and constants for vn200_binary.c
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Output register values formatted separately
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_BINARY_H
+#define __VN200_BINARY_H
+
+#include <stdint.h>
+
+#include "vn200_struct.h"
+
+// First byte of every binary packet
+#define VN200_BINARY_SYNC 0xFA
+
+// Rate the sensor samples its IMU at. Binary output rates are set as a
+// divisor of this.
+#define VN200_BINARY_BASE_RATE 800
+
+// Binary output registers (1 through 3)
+#define VN200_BINARY_REG_BASE 74
+#define VN200_BINARY_NUM_OUTPUTS 3
+
+// Output groups that can be decoded
+#define VN200_BINARY_GROUP_COMMON 0x01
+#define VN200_BINARY_GROUP_TIME   0x02
+#define VN200_BINARY_GROUP_IMU    0x04
+#define VN200_BINARY_GROUP_GPS    0x08
+#define VN200_BINARY_NUM_GROUPS   4
+
+// IMU group fields
+#define VN200_BINARY_IMU_TEMP    0x0010
+#define VN200_BINARY_IMU_PRES    0x0020
+#define VN200_BINARY_IMU_MAG     0x0100
+#define VN200_BINARY_IMU_ACCEL   0x0200
+#define VN200_BINARY_IMU_GYRO    0x0400
+
+// GPS group fields
+#define VN200_BINARY_GPS_TOW     0x0002
+#define VN200_BINARY_GPS_WEEK    0x0004
+#define VN200_BINARY_GPS_NUMSATS 0x0008
+#define VN200_BINARY_GPS_FIX     0x0010
+#define VN200_BINARY_GPS_POSECEF 0x0040
+#define VN200_BINARY_GPS_VELECEF 0x0100
+#define VN200_BINARY_GPS_POSU    0x0200
+#define VN200_BINARY_GPS_VELU    0x0400
+#define VN200_BINARY_GPS_TIMEU   0x0800
+
+// Fields requested by VN200Init, the same values the VNIMU and VNGPE
+// sentences carry
+#define VN200_BINARY_IMU_FIELDS (VN200_BINARY_IMU_TEMP | VN200_BINARY_IMU_PRES | \
+        VN200_BINARY_IMU_MAG | VN200_BINARY_IMU_ACCEL | VN200_BINARY_IMU_GYRO)
+#define VN200_BINARY_GPS_FIELDS (VN200_BINARY_GPS_TOW | VN200_BINARY_GPS_WEEK | \
+        VN200_BINARY_GPS_NUMSATS | VN200_BINARY_GPS_FIX | VN200_BINARY_GPS_POSECEF | \
+        VN200_BINARY_GPS_VELECEF | VN200_BINARY_GPS_POSU | VN200_BINARY_GPS_VELU | \
+        VN200_BINARY_GPS_TIMEU)
+
+// GPS solutions are produced at 5 Hz
+#define VN200_BINARY_GPS_RATE 5
+
+// Longest packet accepted, enough for every field of every decoded group
+#define VN200_BINARY_MAX_LEN 512
+
+// Flags returned by VN200BinaryParse for the data a packet filled in
+#define VN200_BINARY_HAS_IMU 0x1
+#define VN200_BINARY_HAS_GPS 0x2
+
+int VN200BinaryPacketSize(int groups, const uint16_t *fields);
+
+int VN200BinaryOutputValue(int rateHz, int group, uint16_t fields, char *value, int valueLen);
+
+int VN200BinaryConfigure(VN200_DEV *dev, int output, int rateHz, int group, uint16_t fields);
+
+int VN200BinaryDecode(const unsigned char *packet, int length, IMU_DATA *imu, GPS_DATA *gps);
+
+int VN200BinaryParse(VN200_DEV *dev, IMU_DATA *imu, GPS_DATA *gps);
+
+#endif
@@ -0,0 +1,72 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_clock.h
+ *
+ * Description:
+ *	Function declarations and constants for vn200_clock.c
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_CLOCK_H
+#define __VN200_CLOCK_H
+
+#include <stdint.h>
+
+#include "timing.h"
+#include "vn200_struct.h"
+#include "vn200_packet.h"
+
+// Seconds in a GPS week
+#define VN200_CLOCK_WEEK_SEC 604800LL
+
+// Loop gains applied to each residual, for the offset and for the drift.
+// The drift gain is a quarter of the square of the offset gain, which
+// critically damps the loop.
+#define VN200_CLOCK_GAIN_OFFSET 0.2
+#define VN200_CLOCK_GAIN_DRIFT  0.01
+
+// Residuals beyond this many times the running spread are clipped, and
+// beyond VN200_CLOCK_OUTLIER_SCALE times it rejected
+#define VN200_CLOCK_CLIP_SCALE    2.0
+#define VN200_CLOCK_OUTLIER_SCALE 8.0
+
+// Floor and starting value for the running spread. Arrival times are
+// stamped when the host reads the UART, so sub-millisecond jitter is normal.
+#define VN200_CLOCK_MIN_SCALE_NS  (200 * NSEC_PER_USEC)
+#define VN200_CLOCK_INIT_SCALE_NS (2 * NSEC_PER_MSEC)
+
+// Share of a late residual applied. Arrival can only be delayed, never
+// early, so late observations say less about the true offset.
+#define VN200_CLOCK_LATE_WEIGHT 0.1
+
+// Largest drift believed, in host seconds per sensor second
+#define VN200_CLOCK_MAX_DRIFT 500e-6
+
+// The model starts over after this many rejected observations in a row, or
+// when sensor time steps back or forward by more than the limit
+#define VN200_CLOCK_MAX_OUTLIERS 10
+#define VN200_CLOCK_MAX_GAP_NS   (10 * NSEC_PER_SEC)
+
+// Observations before the mapping is trusted for timestamps
+#define VN200_CLOCK_MIN_UPDATES 3
+
+void VN200ClockReset(VN200_CLOCK *clock);
+
+int64_t VN200ClockGpsToNs(double timeOfWeek, int week);
+
+int VN200ClockUpdate(VN200_CLOCK *clock, int64_t sensorNs, int64_t arrivalNs);
+
+int VN200ClockIsLocked(const VN200_CLOCK *clock);
+
+int64_t VN200ClockToHostNs(const VN200_CLOCK *clock, int64_t sensorNs);
+
+int VN200ClockStamp(VN200_CLOCK *clock, int64_t arrivalNs, VN200_PACKET *packet);
+
+#endif
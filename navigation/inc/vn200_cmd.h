@@ -0,0 +1,54 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_cmd.h
+ *
+ * Description:
+ *	Function and type declarations and constants for vn200_cmd.c
+ * 
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Write settings (VNWNV) command
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_CMD_H
+#define __VN200_CMD_H
+
+#include "vn200_struct.h"
+
+// Default time to wait for the sensor to answer a command
+#define VN200_CMD_TIMEOUT_MS 250
+
+// Return codes for VN200CmdWait
+#define VN200_CMD_ERR_ARGS      -1
+#define VN200_CMD_ERR_SENSOR    -2
+#define VN200_CMD_ERR_TIMEOUT   -3
+
+// Register id recorded for a write settings (VNWNV) command, which has none
+#define VN200_CMD_REG_SETTINGS -2
+
+// Time the sensor may take to save its settings
+#define VN200_CMD_SETTINGS_TIMEOUT_MS 1000
+
+int VN200CmdSend(VN200_DEV *dev, int isWrite, int reg, const char *value, int timeoutMs);
+
+int VN200CmdRead(VN200_DEV *dev, int reg, int timeoutMs);
+
+int VN200CmdWrite(VN200_DEV *dev, int reg, const char *value, int timeoutMs);
+
+int VN200CmdWriteSettings(VN200_DEV *dev, int timeoutMs);
+
+int VN200CmdService(VN200_DEV *dev, int waitMs);
+
+int VN200CmdWait(VN200_DEV *dev, int handle, char *reply, int replyLen);
+
+int VN200CmdWaitAll(VN200_DEV *dev);
+
+#endif
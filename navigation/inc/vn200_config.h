@@ -0,0 +1,58 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_config.h
+ *
+ * Description:
+ *	Function and type declarations and constants for vn200_config.c
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_CONFIG_H
+#define __VN200_CONFIG_H
+
+#include "vn200_struct.h"
+
+// Registers in one configuration. Their reads go out together, leaving a
+// command slot for anything else in flight.
+#define VN200_CONFIG_MAX_REGS (VN200_CMD_MAX_PENDING - 2)
+
+// Flags for VN200ConfigApply
+#define VN200_CONFIG_PERSIST 0x1 // Save to non-volatile memory after writing
+
+// A register and the value it should hold
+typedef struct {
+	int reg;
+	char value[VN200_CMD_REPLY_LEN];   // Wanted
+	char current[VN200_CMD_REPLY_LEN]; // Read from the sensor
+	int isCurrent;  // Read back and found to match, or written
+} VN200_CONFIG_REG;
+
+// Wanted register values, in the order they are written
+typedef struct {
+	VN200_CONFIG_REG regs[VN200_CONFIG_MAX_REGS];
+	int numRegs;
+
+	// Results of the last VN200ConfigApply
+	int numRead;     // Registers read back
+	int numWritten;  // Registers that differed and were written
+	int numFailed;   // Commands not answered or rejected
+	int saved;       // Settings written to non-volatile memory
+	int64_t elapsedNs;
+} VN200_CONFIG;
+
+void VN200ConfigReset(VN200_CONFIG *config);
+
+int VN200ConfigSet(VN200_CONFIG *config, int reg, const char *value);
+
+int VN200ConfigValuesEqual(const char *a, const char *b);
+
+int VN200ConfigApply(VN200_DEV *dev, VN200_CONFIG *config, int flags);
+
+#endif
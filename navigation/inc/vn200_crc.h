@@ -12,6 +12,10 @@
  * Revision 0.1
  * 	Last edited 4/16/2019
  *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	CRC enabled for binary output
+ *
 \***************************************************************************/
 
 #ifndef __VN200_CRC_H
@@ -25,9 +29,7 @@
 
 unsigned char VN200CalculateChecksum(unsigned char data[], unsigned int length);
 
-/* From VN200 documentation. Used for binary messages, so keeping around in case
 unsigned short VN200CalculateCRC(unsigned char data[], unsigned int length);
-*/
 
 #endif
 
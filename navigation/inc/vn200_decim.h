@@ -0,0 +1,69 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_decim.h
+ *
+ * Description:
+ *	Function and type declarations and constants for vn200_decim.c
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_DECIM_H
+#define __VN200_DECIM_H
+
+#include <stdint.h>
+
+#include "vn200_struct.h"
+
+// Fastest IMU rate the sensor outputs, Hz
+#define VN200_DECIM_MAX_RATE 800
+
+// Motion over one navigation interval, from every IMU sample in it
+typedef struct {
+	double dTheta[3];  // Rotation vector, body frame at the start to the end, rad
+	double dVel[3];    // Velocity change from specific force, in the body frame
+	                   // at the start of the interval, m/s
+	double dt;         // Length of the interval, s
+	int numSamples;    // IMU samples in the interval
+
+	// Means over the interval, for logging alongside the increments
+	double compass[3]; // Gauss
+	double temp;       // C
+	double baro;       // kPa
+
+	double timestamp;  // Time of the last sample in the interval
+} VN200_DELTA;
+
+typedef struct {
+	int inputRate;     // IMU samples per second
+	int outputRate;    // Increments per second
+	int ratio;         // Samples per increment
+	double dt;         // Sample period, s
+
+	// Sums over the current interval
+	int numSamples;
+	double alpha[3];     // Sum of the angle increments
+	double upsilon[3];   // Sum of the velocity increments
+	double coning[3];    // Coning correction so far
+	double sculling[3];  // Sculling correction so far
+	double lastAngle[3]; // Previous sample's increments
+	double lastVel[3];
+	double compass[3], temp, baro;
+
+	uint64_t numInput;   // Samples taken in
+	uint64_t numOutput;  // Increments emitted
+} VN200_DECIM;
+
+int VN200DecimInit(VN200_DECIM *decim, int inputRate, int outputRate);
+
+void VN200DecimReset(VN200_DECIM *decim);
+
+int VN200DecimAdd(VN200_DECIM *decim, const IMU_DATA *imu, VN200_DELTA *delta);
+
+#endif
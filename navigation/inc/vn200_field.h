@@ -0,0 +1,27 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_field.h
+ *
+ * Description:
+ *	Function and type declarations and constants for vn200_field.c
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_FIELD_H
+#define __VN200_FIELD_H
+
+// Longest field handed to strtod when the fast path cannot be exact
+#define VN200_FIELD_MAX_LEN 64
+
+int VN200ParseDouble(const unsigned char *buf, int len, double *value);
+
+int VN200ParseFields(const unsigned char *buf, int len, double *values, int numFields);
+
+#endif
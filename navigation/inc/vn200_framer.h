@@ -0,0 +1,51 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_framer.h
+ *
+ * Description:
+ *	Function and type declarations and constants for vn200_framer.c
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_FRAMER_H
+#define __VN200_FRAMER_H
+
+#include <stdint.h>
+
+#include "vn200_struct.h"
+
+// Longest sentence body framed, anything longer is dropped as garbage
+#define VN200_FRAME_MAX_LEN 256
+
+// A complete sentence in the device input buffer. Indices are valid until
+// the next call to VN200FrameNext or until the input buffer is consumed.
+typedef struct {
+	int start;       // Index in inbuf of the '$'
+	int bodyStart;   // Index in inbuf of the first body character
+	int bodyLen;     // Characters between '$' and '*'
+	int end;         // Index in inbuf one past the last checksum character
+	uint64_t offset; // Position of the '$' in the received stream
+} VN200_PACKET_VIEW;
+
+void VN200FramerReset(VN200_FRAMER *framer);
+
+void VN200FramerDiscard(VN200_FRAMER *framer, int num);
+
+int VN200FrameNext(VN200_DEV *dev, VN200_PACKET_VIEW *view);
+
+unsigned char *VN200FrameBody(VN200_DEV *dev, VN200_PACKET_VIEW *view, unsigned char *scratch,
+        int scratchLen);
+
+int VN200FrameCopyBody(VN200_DEV *dev, VN200_PACKET_VIEW *view, unsigned char *dest, int destLen);
+
+#endif
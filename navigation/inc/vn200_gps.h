@@ -12,6 +12,10 @@
  * Revision 0.1
  * 	Last edited 5/06/2019
  *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Field count for the in-place parser
+ *
  ***************************************************************************/
 
 #ifndef __VN200_GPS_H
@@ -21,6 +25,9 @@
 #include "vn200_struct.h"
 #include "vn200.h"
 
+// Number of fields in a VNGPE sentence
+#define VN200_GPS_NUM_FIELDS 15
+
 int VN200GPSInit(VN200_DEV *dev, char *devname, int fs);
 
 int VN200GPSPacketParse(unsigned char *buf, int len, GPS_DATA *data);
@@ -15,6 +15,10 @@
  * Revision 0.2
  * 	Last edited 5/07/2019
  *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Field count for the in-place parser
+ *
  ***************************************************************************/
 
 #ifndef __VN200_IMU_H
@@ -24,6 +28,9 @@
 #include "vn200_struct.h"
 #include "vn200.h"
 
+// Number of fields in a VNIMU sentence
+#define VN200_IMU_NUM_FIELDS 11
+
 int VN200IMUInit(VN200_DEV *dev, char *devname, int fs);
 
 int VN200IMUPacketParse(unsigned char *buf, int len, IMU_DATA *data);
@@ -0,0 +1,97 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_packet.h
+ *
+ * Description:
+ *	Function and type declarations and constants for vn200_packet.c
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_PACKET_H
+#define __VN200_PACKET_H
+
+#include "vn200_struct.h"
+
+// Length of a packet id (VNIMU) and of the id with its comma
+#define VN200_PACKET_ID_LEN 5
+#define VN200_PACKET_HEADER_LEN 6
+
+// Slots in the dispatch table, a power of two
+#define VN200_PACKET_TABLE_LEN 32
+
+// Dispatch table slot for a packet id. Every id starts with "VN", and the
+// other three characters XORed together are different for each supported
+// type. A type that collides needs a new hash (the test suite checks).
+#define VN200_PACKET_SLOT(c2, c3, c4) \
+	(((c2) ^ (c3) ^ (c4)) & (VN200_PACKET_TABLE_LEN - 1))
+#define VN200_PACKET_HASH(id) VN200_PACKET_SLOT((id)[2], (id)[3], (id)[4])
+
+// Fields in each sentence, after the id
+#define VN200_GPS_LLA_NUM_FIELDS 15
+#define VN200_INS_NUM_FIELDS 15
+#define VN200_YMR_NUM_FIELDS 12
+#define VN200_QMR_NUM_FIELDS 13
+
+typedef enum {
+	VN200_PACKET_IMU, // VNIMU
+	VN200_PACKET_GPS, // VNGPS
+	VN200_PACKET_GPE, // VNGPE
+	VN200_PACKET_INS, // VNINS
+	VN200_PACKET_YMR, // VNYMR
+	VN200_PACKET_QMR, // VNQMR
+	VN200_PACKET_WRG, // VNWRG
+	VN200_PACKET_RRG, // VNRRG
+	VN200_PACKET_ERR, // VNERR
+	VN200_PACKET_NUM_TYPES
+} VN200_PACKET_TYPE;
+
+// A parsed sentence, the member of data given by type is filled in
+typedef struct {
+	VN200_PACKET_TYPE type;
+	union {
+		IMU_DATA imu;
+		GPS_LLA_DATA gps;
+		GPS_DATA gpe;
+		INS_DATA ins;
+		ATTITUDE_DATA ymr;
+		QUATERNION_DATA qmr;
+		REGISTER_DATA reg; // VNWRG and VNRRG
+		ERROR_DATA err;
+	} data;
+} VN200_PACKET;
+
+// Dispatch table entry
+typedef struct {
+	char id[VN200_PACKET_ID_LEN + 1];
+	VN200_PACKET_TYPE type;
+	int (*parse)(unsigned char *buf, int len, VN200_PACKET *packet);
+} VN200_PACKET_HANDLER;
+
+int VN200PacketLookup(const unsigned char *body, int len);
+
+int VN200PacketParse(unsigned char *body, int len, VN200_PACKET *packet);
+
+const VN200_PACKET_HANDLER *VN200PacketHandler(int slot);
+
+const char *VN200PacketName(VN200_PACKET_TYPE type);
+
+int VN200GPSLLAPacketParse(unsigned char *buf, int len, GPS_LLA_DATA *data);
+
+int VN200INSPacketParse(unsigned char *buf, int len, INS_DATA *data);
+
+int VN200YMRPacketParse(unsigned char *buf, int len, ATTITUDE_DATA *data);
+
+int VN200QMRPacketParse(unsigned char *buf, int len, QUATERNION_DATA *data);
+
+int VN200RegisterPacketParse(unsigned char *buf, int len, REGISTER_DATA *data);
+
+int VN200ErrorPacketParse(unsigned char *buf, int len, ERROR_DATA *data);
+
+#endif
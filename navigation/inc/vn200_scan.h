@@ -0,0 +1,46 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_scan.h
+ *
+ * Description:
+ *	Function and type declarations and constants for vn200_scan.c
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Delimiter bitmasks removed
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_SCAN_H
+#define __VN200_SCAN_H
+
+#include <stdint.h>
+
+// Kernel sets, in order of preference on their architecture
+typedef enum {
+	VN200_SCAN_SCALAR,
+	VN200_SCAN_SSE2,
+	VN200_SCAN_AVX2,
+	VN200_SCAN_NEON
+} VN200_SCAN_LEVEL;
+
+unsigned char VN200ChecksumXor(const unsigned char *data, int length);
+
+int VN200FindByte(const unsigned char *data, int length, unsigned char c);
+
+int VN200FindFramingByte(const unsigned char *data, int length);
+
+int VN200ScanSetLevel(VN200_SCAN_LEVEL level);
+
+VN200_SCAN_LEVEL VN200ScanGetLevel(void);
+
+const char *VN200ScanLevelName(VN200_SCAN_LEVEL level);
+
+#endif
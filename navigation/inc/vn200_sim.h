@@ -0,0 +1,116 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_sim.h
+ *
+ * Description:
+ *	Function and type declarations and constants for vn200_sim.c
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __VN200_SIM_H
+#define __VN200_SIM_H
+
+#include <stdint.h>
+
+// Most points in a trajectory
+#define VN200_SIM_MAX_WAYPOINTS 2048
+
+// Most bytes VN200SimStep produces for one IMU sample
+#define VN200_SIM_MAX_STEP_LEN 512
+
+// Standard gravity, m/s^2
+#define VN200_SIM_GRAVITY 9.80665
+
+typedef enum {
+	VN200_SIM_ASCII,  // VNIMU and VNGPE sentences
+	VN200_SIM_BINARY  // IMU and GPS group binary packets
+} VN200_SIM_FORMAT;
+
+typedef struct {
+	VN200_SIM_FORMAT format;
+	int imuRate;         // IMU samples per second (with baro and temperature)
+	int gpsRate;         // GPS solutions per second
+	double speed;        // Speed along the trajectory, m/s
+
+	int startWeek;       // GPS time of the first sample
+	double startTow;
+
+	// Standard deviations of white noise added to each measurement
+	double accelNoise;   // m/s^2
+	double gyroNoise;    // rad/s
+	double magNoise;     // Gauss
+	double baroNoise;    // kPa
+	double tempNoise;    // C
+	double gpsPosNoise;  // m, each ECEF axis
+	double gpsVelNoise;  // m/s, each ECEF axis
+
+	// Constant sensor biases, body axes
+	double accelBias[3]; // m/s^2
+	double gyroBias[3];  // rad/s
+
+	double dropRate;     // Probability each packet is left out
+	double corruptRate;  // Probability each packet has a byte changed
+
+	uint64_t seed;       // Random seed, the same seed gives the same output
+} VN200_SIM_CONFIG;
+
+typedef struct {
+	double lat, lon, alt; // Degrees and meters above the ellipsoid
+} VN200_SIM_WAYPOINT;
+
+// True motion at one instant
+typedef struct {
+	double time;        // Seconds since the first sample
+	double lla[3];      // Latitude and longitude in degrees, altitude in m
+	double ecef[3];     // m
+	double velNed[3];   // m/s
+	double velEcef[3];  // m/s
+	double accelNed[3]; // m/s^2
+	double yaw;         // Heading, rad
+	double yawRate;     // rad/s
+} VN200_SIM_STATE;
+
+typedef struct {
+	VN200_SIM_CONFIG config;
+
+	// Trajectory, flown from the first point to the last and back to the
+	// first, over and over. Points are also kept in north, east, down
+	// meters from the first.
+	VN200_SIM_WAYPOINT waypoints[VN200_SIM_MAX_WAYPOINTS];
+	double ned[VN200_SIM_MAX_WAYPOINTS][3];
+	double legStart[VN200_SIM_MAX_WAYPOINTS + 1]; // Time each leg begins, and the lap time
+	int numWaypoints;
+	double lapTime;     // Seconds to go around once
+
+	uint64_t numSteps;  // IMU samples produced
+	uint64_t rng;       // Random generator state
+
+	VN200_SIM_STATE truth; // Motion at the last sample produced
+
+	// Statistics
+	uint64_t numImu, numGps;  // Packets written
+	uint64_t numDropped;      // Packets left out
+	uint64_t numCorrupted;    // Packets written with a changed byte
+	uint64_t numBytes;
+} VN200_SIM;
+
+void VN200SimDefaults(VN200_SIM_CONFIG *config);
+
+int VN200SimInit(VN200_SIM *sim, const VN200_SIM_CONFIG *config);
+
+int VN200SimAddWaypoint(VN200_SIM *sim, double lat, double lon, double alt);
+
+int VN200SimLoadGpx(VN200_SIM *sim, const char *path, int segment);
+
+int VN200SimTruth(VN200_SIM *sim, double time, VN200_SIM_STATE *state);
+
+int VN200SimStep(VN200_SIM *sim, unsigned char *buf, int bufLen);
+
+#endif
@@ -13,6 +13,34 @@
  * Revision 0.1
  * 	Last edited 9/19/2019
  *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Chunk arrival timestamps for received data
+ *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Binary output framing statistics
+ *
+ * Revision 0.4
+ * 	Last edited 10/18/2026
+ * 	Streaming sentence framer state
+ *
+ * Revision 0.5
+ * 	Last edited 10/18/2026
+ * 	Data for the remaining ASCII output types and register replies
+ *
+ * Revision 0.6
+ * 	Last edited 10/18/2026
+ * 	Sensor to host clock model
+ *
+ * Revision 0.7
+ * 	Last edited 10/18/2026
+ * 	Open and first sample times
+ *
+ * Revision 0.8
+ * 	Last edited 10/18/2026
+ * 	Counts of bytes copied out of the input buffer
+ *
  ***************************************************************************/
 
 #ifndef __VN200_STRUCT_H
@@ -24,6 +52,7 @@
 #include "utils.h"
 #include "buffer.h"
 #include "logger.h"
+#include "uart.h"
 
 
 typedef struct {
@@ -59,6 +88,81 @@ typedef struct {
 } IMU_DATA;
 
 
+typedef struct {
+	double time;      // 0: Time of the week in seconds
+	uint16_t week;    // 1: GPS week
+	uint8_t GpsFix;   // 2: GPS fix type. 03 means locked.
+	uint8_t NumSats;  // 3: Number of GPS satellites used in solution.
+	double Latitude;  // 4: Latitude in degrees.
+	double Longitude; // 5: Longitude in degrees.
+	double Altitude;  // 6: Altitude above the ellipsoid in meters.
+	float VelN;       // 7: North velocity in m/s.
+	float VelE;       // 8: East velocity in m/s.
+	float VelD;       // 9: Down velocity in m/s.
+	float PosAccN;    // 10: North position accuracy estimate.
+	float PosAccE;    // 11: East position accuracy estimate.
+	float PosAccD;    // 12: Down position accuracy estimate.
+	float SpeedAcc;   // 13: Speed accuracy estimate.
+	float TimeAcc;    // 14: Time accuracy estimate.
+
+	double timestamp; // System time data was collected
+
+} GPS_LLA_DATA;
+
+typedef struct {
+	double time;          // 0: Time of the week in seconds
+	uint16_t week;        // 1: GPS week
+	uint16_t status;      // 2: INS status flags (sent as hex)
+	double Yaw;           // 3: Heading in degrees.
+	double Pitch;         // 4: Pitch in degrees.
+	double Roll;          // 5: Roll in degrees.
+	double Latitude;      // 6: Latitude in degrees.
+	double Longitude;     // 7: Longitude in degrees.
+	double Altitude;      // 8: Altitude above the ellipsoid in meters.
+	float VelN;           // 9: North velocity in m/s.
+	float VelE;           // 10: East velocity in m/s.
+	float VelD;           // 11: Down velocity in m/s.
+	float AttUncertainty; // 12: Attitude uncertainty in degrees.
+	float PosUncertainty; // 13: Position uncertainty in meters.
+	float VelUncertainty; // 14: Velocity uncertainty in m/s.
+
+	double timestamp; // System time data was collected
+
+} INS_DATA;
+
+typedef struct {
+	double ypr[3]; // yaw, pitch, roll degrees
+	double compass[3]; // compass (x,y,z) Gauss
+	double accel[3]; // accel (x,y,z) m/s^2
+	double gyro[3]; // gyro (x, y, z) rad/s
+
+	double timestamp; // System time data was collected
+
+} ATTITUDE_DATA;
+
+typedef struct {
+	double quat[4]; // quaternion (x,y,z,w), w is the scalar part
+	double compass[3]; // compass (x,y,z) Gauss
+	double accel[3]; // accel (x,y,z) m/s^2
+	double gyro[3]; // gyro (x, y, z) rad/s
+
+	double timestamp; // System time data was collected
+
+} QUATERNION_DATA;
+
+// Longest register value kept from a reply
+#define VN200_REGISTER_VALUE_LEN 128
+
+typedef struct {
+	int reg;       // Register id
+	int valueLen;  // Length of value, not counting the terminator
+	char value[VN200_REGISTER_VALUE_LEN]; // Field(s) after the register id
+} REGISTER_DATA;
+
+typedef struct {
+	int code; // Error code from $VNERR
+} ERROR_DATA;
+
 // For indicating the type of data in a packet structure
 typedef enum {
 	VN200_PACKET_CONTENTS_TYPE_GPS,
@@ -66,6 +170,86 @@ typedef enum {
 	VN200_PACKET_CONTENTS_TYPE_OTHER
 } VN200_PACKET_CONTENTS_TYPE;
 
+// Number of received chunks whose arrival times are remembered
+#define VN200_CHUNK_RING_LEN 256
+
+// Arrival record for one chunk of bytes read from the UART
+typedef struct {
+	uint64_t endOffset; // Stream offset one past the chunk's last byte
+	int64_t timeNs;     // CLOCK_MONOTONIC time the chunk was read
+} VN200_CHUNK;
+
+// Commands that may be awaiting a reply at once
+#define VN200_CMD_MAX_PENDING 8
+
+// Longest reply value kept for a command
+#define VN200_CMD_REPLY_LEN 128
+
+typedef enum {
+	VN200_CMD_FREE,
+	VN200_CMD_PENDING,
+	VN200_CMD_DONE,
+	VN200_CMD_ERROR,
+	VN200_CMD_TIMEOUT
+} VN200_CMD_STATUS;
+
+// A register read or write sent to the sensor and its reply
+typedef struct {
+	VN200_CMD_STATUS status;
+	int isWrite;    // VNWRG if set, VNRRG otherwise
+	int reg;        // Register id
+	uint32_t order; // Order sent, the sensor answers in this order
+	int64_t sentNs, deadlineNs, doneNs;
+	int errorCode;  // From $VNERR
+	char reply[VN200_CMD_REPLY_LEN]; // Register value(s) from the reply
+} VN200_CMD;
+
+// Framing statistics for binary output
+typedef struct {
+	uint64_t numPackets;   // Packets that passed the CRC
+	uint64_t numCrcErrors; // Candidate packets that failed the CRC
+	uint64_t numSkipped;   // Bytes discarded while looking for a packet
+	uint64_t numCopied;    // Packet bytes copied because they wrapped
+} VN200_BINARY_STATS;
+
+// Where the sentence framer is within a sentence
+typedef enum {
+	VN200_FRAME_HUNT,    // Looking for '$'
+	VN200_FRAME_BODY,    // Between '$' and '*'
+	VN200_FRAME_CHECKSUM // Reading the two checksum characters
+} VN200_FRAME_STATE;
+
+// Sentence framer, kept between polls so each byte is examined once
+typedef struct {
+	VN200_FRAME_STATE state;
+	int scanned;            // Bytes at the front of inbuf already examined
+	int start;              // Index in inbuf of the current sentence's '$'
+	unsigned char checksum; // Running checksum of the body so far
+	unsigned char received; // Checksum characters decoded so far
+	int numChecksumChars;
+
+	uint64_t numPackets;        // Sentences that passed the checksum
+	uint64_t numChecksumErrors; // Sentences that failed it
+	uint64_t numBroken;         // Sentences cut off or too long
+	uint64_t numSkipped;        // Bytes discarded outside good sentences
+	uint64_t numCopied;         // Body bytes copied out of the input buffer
+} VN200_FRAMER;
+
+// Mapping from sensor GPS time to host CLOCK_MONOTONIC time, estimated from
+// when samples carrying GPS time arrive
+typedef struct {
+	int numUpdates;       // Observations accepted since the last reset
+	int64_t refSensorNs;  // GPS time of the reference point
+	int64_t refHostNs;    // Host time estimated for the reference point
+	double drift;         // Host clock rate relative to the sensor's, minus 1
+	double scaleNs;       // Running spread of the residuals
+
+	int numOutliersInRow; // Rejected observations since the last accepted
+	uint64_t numOutliers; // Observations rejected as delayed or bad
+	uint64_t numResets;   // Times the model was started over
+	double lastResidualNs; // Observed minus predicted host time
+} VN200_CLOCK;
+
 typedef struct {
 
 	int fd; // UART file descriptor
@@ -80,6 +264,26 @@ typedef struct {
 	int baud; // Baud rate
 	int fs; // Sampling Frequency
 
+	UART_READER reader; // Event-driven reader, used if eventDriven is set
+	int eventDriven;
+
+	uint64_t rxOffset; // Total bytes ever added to inbuf
+	VN200_CHUNK chunks[VN200_CHUNK_RING_LEN]; // Most recent chunks
+	int chunkHead; // Index of the next chunk record
+	int numChunks; // Number of valid chunk records
+
+	VN200_CMD commands[VN200_CMD_MAX_PENDING]; // Commands awaiting collection
+	uint32_t cmdOrder; // Order number for the next command
+
+	VN200_BINARY_STATS binary; // Binary output framing
+
+	VN200_FRAMER framer; // ASCII sentence framing
+
+	VN200_CLOCK clock; // Sensor to host time mapping
+
+	int64_t openNs;        // CLOCK_MONOTONIC time the UART was opened
+	int64_t firstSampleNs; // Arrival of the first valid sample, 0 until then
+
 } VN200_DEV;
 
 #endif
@@ -12,6 +12,14 @@
  * Revision 0.1
  *      Last edited 04/23/2020
  *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Runs until SIGINT or SIGTERM instead of for a fixed time
+ *
+ * Revision 0.3
+ *      Last edited 10/18/2026
+ *      Thread stack freed even when the thread fails to start
+ *
  ***************************************************************************/
 
 // Standard headers
@@ -20,6 +28,7 @@
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
+#include <signal.h>
 
 // Socket constants
 #include <netinet/in.h>
@@ -30,14 +39,32 @@
 // Custom library headers
 #include "config.h"
 #include "debuglog.h"
-#include "tcp.h"
+#include "link.h"
 #include "thread.h"
+#include "watchdog.h"
 
 // Subsystem library headers
 #include "navigation.h"
 #include "navigation_run.h"
 #include "vn200_run.h"
 
+// Cleared by SIGINT or SIGTERM to shut the subsystem down
+static volatile sig_atomic_t running = 1;
+
+static void stopHandler(int signum) {
+
+    (void) signum;
+    running = 0;
+
+}
+
+// Periodic task routine, runs one pass of the navigation loop
+static int navigationTask(void *params) {
+
+    return navigation_run((NAVIGATION_PARAMS *) params);
+
+}
+
 int main(int argc, char** argv) {
 
     int rc;
@@ -48,6 +75,29 @@ int main(int argc, char** argv) {
 
     logDebug(L_DEBUG, "Navigation: Starting navigation process...\n\n");
 
+    // Shut down cleanly on SIGINT or SIGTERM
+    struct sigaction stopAction;
+    sigset_t stopSignals, oldMask;
+    memset(&stopAction, 0, sizeof(stopAction));
+    stopAction.sa_handler = &stopHandler;
+    sigemptyset(&stopAction.sa_mask);
+    sigaction(SIGINT, &stopAction, NULL);
+    sigaction(SIGTERM, &stopAction, NULL);
+
+    // Shared between the subsystem threads, which run at different realtime
+    // priorities, so it inherits priority and tracks hold times
+    rc = ThreadMutexInit(&(navigation.lock), "Navigation params", THREAD_MUTEX_INSTRUMENT);
+    if (rc != 0) {
+        logDebug(L_INFO, "Navigation: Failed to initialize params lock: %s\n", strerror(errno));
+    }
+
+    // Lock memory before anything large is allocated so the realtime loop
+    // never waits on a page fault
+    rc = ThreadLockMemory();
+    if (rc != 0) {
+        logDebug(L_INFO, "Navigation: Continuing without locked memory\n");
+    }
+
 
     /**** Serial interfaces ****/
 
@@ -66,81 +116,37 @@ int main(int argc, char** argv) {
 
     logDebug(L_DEBUG, "Navigation: Initializing network interfaces...\n");
 
-    // Initialize socket file descriptors
-    navigation.guidance_sock = -1;
-    navigation.control_sock = -1;
-    navigation.imageproc_sock = -1;
-    int gSock = TCPClientInit();
-    int cSock = TCPServerInit(NAVIGATION_IP_ADDR, CONTROL_TCP_PORT);
-    TCPSetNonBlocking(cSock);
-    int ipSock = TCPServerInit(NAVIGATION_IP_ADDR, IMAGEPROC_TCP_PORT);
-    TCPSetNonBlocking(ipSock);
-
-    if (gSock == -1 || cSock == -1 || ipSock == -1) {
-        logDebug(L_INFO, "Navigation: Failed to initialize navigation sockets: %s\n", strerror(errno));
+    // Initialize supervised links to the other subsystems. Guidance is a
+    // server, control and image processing connect to navigation. The
+    // run function services them every period, so a link reconnects if its
+    // peer restarts.
+    rc = LinkInit(&(navigation.guidance_link), "guidance",
+            LINK_ROLE_CLIENT, GUIDANCE_IP_ADDR, NAVIGATION_TCP_PORT);
+    rc |= LinkInit(&(navigation.control_link), "control",
+            LINK_ROLE_SERVER, NAVIGATION_IP_ADDR, CONTROL_TCP_PORT);
+    rc |= LinkInit(&(navigation.imageproc_link), "imageproc",
+            LINK_ROLE_SERVER, NAVIGATION_IP_ADDR, IMAGEPROC_TCP_PORT);
+    if (rc != 0) {
+        logDebug(L_INFO, "Navigation: Failed to initialize navigation links: %s\n", strerror(errno));
     }
 
-    // Loop until both sockets are connected
+    // Loop until all links are connected
     const int MAX_CONNECT_ATTEMPTS = 10000;
-    int gConnected = 0, cConnected = 0, ipConnected = 0, numTries = 0; 
-    while (!(gConnected && cConnected && ipConnected) && numTries < MAX_CONNECT_ATTEMPTS) {
+    int numTries = 0;
+    while (running && !(LinkIsUp(&(navigation.guidance_link)) &&
+                LinkIsUp(&(navigation.control_link)) &&
+                LinkIsUp(&(navigation.imageproc_link))) &&
+            numTries < MAX_CONNECT_ATTEMPTS) {
 
         // Count attempt number
         numTries++;
 
-        // Attempt to connect to guidance (if not already connected)
-        if (!gConnected) {
-
-            logDebug(L_DEBUG, "Navigation: Attempting to connect to guidance at %s:%d\n", GUIDANCE_IP_ADDR, NAVIGATION_TCP_PORT);
-            rc = TCPClientTryConnect(gSock, GUIDANCE_IP_ADDR, NAVIGATION_TCP_PORT);
-            if (rc != -1) {
-                logDebug(L_INFO, "Navigation: Successful TCP connection to guidance\n");
-                gConnected = 1;
-                navigation.guidance_sock = gSock;
-            } else if (errno == ECONNREFUSED) {
-                logDebug(L_DEBUG, "Navigation: Unsuccessful connection to guidance, will try again\n");
-                // Delay to give other end a chance to start
-                usleep(10000);
-            } else {
-                logDebug(L_INFO, "Navigation: Could not connect to guidance: %s\n", strerror(errno));
-            }
-        }
-
-        // Attempt to connect to control (if not already connected)
-        if (!cConnected) {
-
-            logDebug(L_DEBUG, "Navigation: Attempting to accept connection from control at port %d\n", CONTROL_TCP_PORT);
-            rc = TCPServerTryAccept(cSock);
-            if (rc != -1) {
-                logDebug(L_INFO, "Navigation: Successful TCP connection to control\n");
-                cConnected = 1;
-                navigation.control_sock = rc;
-            } else if (errno == EAGAIN) {
-                logDebug(L_DEBUG, "Navigation: Unsuccessful connection to control, will try again\n");
-                // Delay to give other end a chance to start
-                usleep(10000);
-            } else {
-                logDebug(L_INFO, "Navigation: Could not connect to control: %s\n", strerror(errno));
-            }
-        }
-
-        // Attempt to connect to image processing (if not already connected)
-        if (!ipConnected) {
-
-            logDebug(L_DEBUG, "Navigation: Attempting to accept connection from image processing at port %d\n", IMAGEPROC_TCP_PORT);
-            rc = TCPServerTryAccept(ipSock);
-            if (rc != -1) {
-                logDebug(L_INFO, "Navigation: Successful TCP connection to image processing\n");
-                ipConnected = 1;
-                navigation.imageproc_sock = rc;
-            } else if (errno == EAGAIN) {
-                logDebug(L_DEBUG, "Navigation: Unsuccessful connection to image processing, will try again\n");
-                // Delay to give other end a chance to start
-                usleep(10000);
-            } else {
-                logDebug(L_INFO, "Navigation: Could not connect to image processing: %s\n", strerror(errno));
-            }
-        }
+        LinkService(&(navigation.guidance_link));
+        LinkService(&(navigation.control_link));
+        LinkService(&(navigation.imageproc_link));
+
+        // Delay to give other ends a chance to start
+        usleep(10000);
 
     } // while (!connected && tries remaining)
 
@@ -151,6 +157,11 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!running) {
+        logDebug(L_INFO, "Navigation: Stopped before links connected, exiting\n");
+        return 0;
+    }
+
 
     /**** Threads ****/
 
@@ -159,8 +170,8 @@ int main(int argc, char** argv) {
     // For now, only dispatch navigation thread. Will dispatch hardware interface
     // threads when they are ready
     pthread_attr_t navigationThreadAttr /*, vn200ThreadAttr*/;
-    pthread_t navigationThread /*, vn200Thread*/;
-    int navigationReturn /*, vn200Return*/;
+    // pthread_t vn200Thread;
+    // int vn200Return;
 
     // Initialize thread attributes
     // ThreadAttrInit(&vn200ThreadAttr, 0);
@@ -169,25 +180,69 @@ int main(int argc, char** argv) {
         logDebug(L_INFO, "Navigation: Failed to initialize navigation thread attributes: %s\n", strerror(errno));
     }
 
+    // Pin the loop to its own core and give it a pre-faulted stack
+    if (ThreadAttrSetAffinity(&navigationThreadAttr, SUBSYSTEM_RT_CPU_MASK) != 0) {
+        logDebug(L_INFO, "Navigation: Running navigation thread without CPU affinity\n");
+    }
+    if (ThreadAttrSetStack(&navigationThreadAttr, SUBSYSTEM_RT_STACK_SIZE) != 0) {
+        logDebug(L_INFO, "Navigation: Running navigation thread on default stack\n");
+    }
+
+    // Report anything that will cost the loop its timing
+    ThreadCheckRealtime(SUBSYSTEM_RT_CPU_MASK);
+
     // Dispatch threads, give configuration object as argument
     // ThreadCreate(&vn200ThreadAttr, &vn200ThreadAttr, &vn200_run, (void *)&navigation);
-    rc = ThreadCreate(&navigationThread, &navigationThreadAttr,
-            (void *(*)(void *)) &navigation_run, (void *)&navigation);
+
+    // Only the main thread takes the stop signals. Threads started from here
+    // on inherit the blocked mask.
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &oldMask);
+
+    // The navigation loop runs as a periodic task at a fixed rate
+    PERIODIC_TASK navigationLoop;
+    ThreadPeriodicInit(&navigationLoop, "Navigation", NAVIGATION_PERIOD_US,
+            &navigationTask, (void *)&navigation);
+
+    // Watchdog logs when the loop goes several periods without running
+    WATCHDOG watchdog;
+    WatchdogInit(&watchdog, WATCHDOG_CHECK_PERIOD_US);
+    int watchdogHandle = WatchdogRegister(&watchdog, "Navigation",
+            WATCHDOG_BUDGET_PERIODS * NAVIGATION_PERIOD_US, WATCHDOG_ACTION_LOG, NULL, NULL);
+    if (watchdogHandle >= 0) {
+        ThreadPeriodicSetWatchdog(&navigationLoop, &watchdog, watchdogHandle);
+    }
+    WatchdogStart(&watchdog);
+
+    rc = ThreadPeriodicStart(&navigationLoop, &navigationThreadAttr);
     if (rc == -1) {
         logDebug(L_INFO, "Navigation: Failed to dispatch navigation thread: %s\n", strerror(errno));
     }
 
     logDebug(L_DEBUG, "Navigation: Threads initialized\n");
 
-    // Join threads
-    int i = 0;
-    do {
-        usleep(100000);
-        rc = ThreadTryJoin(navigationThread, &navigationReturn);
-        i++;
-    } while (i < 10 && rc != 0 && errno == EBUSY);
+    // Run until told to stop. The stop signals are unblocked only while
+    // waiting, so one that arrives just before the wait is not missed.
+    while (running) {
+        sigsuspend(&oldMask);
+    }
+    if (rc == 0) {
+        ThreadPeriodicStop(&navigationLoop);
+        ThreadPeriodicReportStats(&navigationLoop);
+    }
+    ThreadAttrFreeStack(&navigationThreadAttr);
+    WatchdogStop(&watchdog);
+    WatchdogReportStats(&watchdog);
 
     logDebug(L_DEBUG, "Navigation: Successfully joined threads.\n");
+
+    // Report how each link behaved over the run
+    LinkReportStats(&(navigation.guidance_link));
+    LinkReportStats(&(navigation.control_link));
+    LinkReportStats(&(navigation.imageproc_link));
+    ThreadMutexReportStats(&(navigation.lock));
     logDebug(L_INFO, "\nNavigation: Closing application.\n");
 
     // Safely shutdown the application
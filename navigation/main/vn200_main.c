@@ -12,6 +12,30 @@
  * Revision 0.1
  * 	Last edited 2/15/2020
  *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Streaming framer in place of rescanning the buffer on every poll
+ *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Packets parsed through the dispatch table for every output type
+ *
+ * Revision 0.4
+ * 	Last edited 10/18/2026
+ * 	Samples stamped with host time from the clock model
+ *
+ * Revision 0.5
+ * 	Last edited 10/18/2026
+ * 	Time from opening to the first sample logged
+ *
+ * Revision 0.6
+ * 	Last edited 10/18/2026
+ * 	Sentences parsed in place in the input buffer
+ *
+ * Revision 0.7
+ * 	Last edited 10/18/2026
+ * 	IMU samples decimated into angle and velocity increments
+ *
  ***************************************************************************/
 
 #include <stdio.h>
@@ -28,22 +52,38 @@
 #include "debuglog.h"
 #include "uart.h"
 
-#include "VN200.h"
-#include "VN200_CRC.h"
-#include "VN200_GPS.h"
-#include "VN200_IMU.h"
+#include "vn200.h"
+#include "vn200_clock.h"
+#include "vn200_decim.h"
+#include "vn200_framer.h"
+#include "vn200_gps.h"
+#include "vn200_imu.h"
+#include "vn200_packet.h"
+
+// IMU output rate, and the rate increments are logged at
+#define VN200_MAIN_IMU_RATE   50
+#define VN200_MAIN_DELTA_RATE 10
 
 
 int main(int argc, char **argv) {
 
-    int i, rc;
+    int rc;
 
     // Instances of structure variables
     VN200_DEV dev;
+    VN200_PACKET_VIEW view;
 
     // Stores received packet data temporarily, immediately after parsing
-    GPS_DATA gps_packet;
-    IMU_DATA imu_packet;
+    VN200_PACKET packet;
+
+    // IMU samples summed into increments at the lower rate
+    VN200_DECIM decim;
+    VN200_DELTA delta;
+    uint64_t numLost, lastLost = 0;
+
+    // Body of the current sentence, between '$' and '*'. It is parsed where
+    // it lies in the input buffer, scratch only holds one that wraps.
+    unsigned char scratch[VN200_FRAME_MAX_LEN], *body;
 
     // Use logDebug(L_DEBUG, ...) just like printf
     // Debug levels are L_INFO, L_DEBUG, L_VDEBUG
@@ -56,215 +96,152 @@ int main(int argc, char **argv) {
         devname = VN200_DEVNAME;
     }
 
-    // Initialize VN200 device at 50Hz sample frequency, baud rate, for both IMU and GPS packets
-    VN200Init(&dev, devname, 50, VN200_BAUD, VN200_INIT_MODE_BOTH);
-
-    // Force into both IMU and GPE concurrent output mode
-    char *command = "VNWRG,06,248";
-    VN200Command(&dev, command, strlen(command), 0);
-
-    // Clear any received data from input buffer
-    // (could instead verify confirmation message was received)
-    VN200FlushOutput(&dev);
+    // Initialize VN200 device at 50Hz sample frequency, baud rate, for both
+    // IMU and GPS packets (VNIMU and VNGPE output)
+    VN200Init(&dev, devname, VN200_MAIN_IMU_RATE, VN200_BAUD, VN200_INIT_MODE_BOTH);
+    VN200DecimInit(&decim, VN200_MAIN_IMU_RATE, VN200_MAIN_DELTA_RATE);
 
     // Loop forever (for test)
     while (1) {
 
         int numRead;
 
-        // Number of bytes actually found
-        int numParsed = 0, numConsumed = 0;
-
-        // Poll the device for any input data (distinct from linux service call poll (2))
-        numRead = VN200Poll(&dev);
+        // Wait for input data
+        numRead = VN200PollWait(&dev, 100);
         logDebug(L_DEBUG, "Read %d bytes from UART\n", numRead);
 
-        // Loop until all input data has been parsed
-        do { // while data left to parse
+        // The framer resumes where it left off, so only the new bytes are
+        // examined and a partial sentence waits for the next read
+        while (VN200FrameNext(&dev, &view) > 0) {
 
-            // Store checksums
-            unsigned char chkOld, chkNew;
+            body = VN200FrameBody(&dev, &view, scratch, sizeof(scratch));
 
-            // Determine start of first packet in buffer (starts on '$' character)
-            int packetStart;
-            for (packetStart = 0;
-                    packetStart < BufferLength(&(dev.inbuf)) && BufferIndex(&(dev.inbuf), packetStart) != '$'; packetStart++) {
-                // Loop until $ found
-            }
+            /**** Determine type of packet and parse accordingly ****/
+
+            rc = (body != NULL) ? VN200PacketParse(body, view.bodyLen, &packet) : -2;
 
-            // Determine end of first packet (data ends on '*' character, then has 2 character checksum)
-            int chkStartIndex;
-            for (chkStartIndex = packetStart; chkStartIndex < BufferLength(&(dev.inbuf)) - 3 && BufferIndex(&(dev.inbuf), chkStartIndex) != '*'; chkStartIndex++) {
-                // Loop until * found
+            // Host time of the sample, from when its '$' arrived
+            if (rc >= 0 && VN200ClockStamp(&(dev.clock), VN200ByteTimeNs(&dev, view.start), &packet) == 0) {
+                VN200MarkSample(&dev, VN200ByteTimeNs(&dev, view.start));
             }
 
-            // Only parse the packet if there was a complete packet
-            if (BufferIndex(&(dev.inbuf), chkStartIndex) == '*') {
-
-                // Read received checksum from input buffer
-                unsigned char chkReadData[2];
-                BufferCopy(&(dev.inbuf), chkReadData, chkStartIndex + 1, 2);
-                int chkLength = sscanf(chkReadData, "%hhX", &chkOld);
-
-                // Compute checksum of data (everything between $ and *, both excluded)
-                int chkComputeLength = chkStartIndex - packetStart - 1;
-                {
-                    unsigned char chkComputeData[chkComputeLength + 1];
-                    BufferCopy(&(dev.inbuf), chkComputeData, packetStart + 1, chkComputeLength);
-                    chkNew = VN200CalculateChecksum(chkComputeData, chkComputeLength);
-
-                    // Useful to keep around for debugging checksum, disable when not using
-                    logDebug(L_VVDEBUG, "Read checksum from index %d (%c) to %d (%c)\n",
-                            chkStartIndex + 1, BufferIndex(&(dev.inbuf), chkStartIndex + 1),
-                            chkStartIndex + chkLength + 1, BufferIndex(&(dev.inbuf), chkStartIndex + chkLength + 1));
-                    logDebug(L_VVDEBUG, "Computed checksum from index %d (%c) to %d (%c)\n",
-                            packetStart + 1, BufferIndex(&(dev.inbuf), packetStart + 1),
-                            chkStartIndex,
-                            BufferIndex(&(dev.inbuf), chkStartIndex));
-                    logDebug(L_VVDEBUG, "  Full packet data:\n    ");
-                    int i;
-                    for (i = 0; i < chkComputeLength; i++) {
-                        logDebug(L_VVDEBUG, "%c", (char) chkComputeData[i]);
+            switch (rc) {
+
+                case VN200_PACKET_GPE:
+                    logDebug(L_DEBUG, "GPS packet data at %.6f:\n"
+                            "\tPos: %f, %f, %f\n"
+                            "\tVel: %f, %f, %f\n",
+                            packet.data.gpe.timestamp,
+                            packet.data.gpe.PosX,
+                            packet.data.gpe.PosY,
+                            packet.data.gpe.PosZ,
+                            packet.data.gpe.VelX,
+                            packet.data.gpe.VelY,
+                            packet.data.gpe.VelZ);
+                    break;
+
+                case VN200_PACKET_GPS:
+                    logDebug(L_DEBUG, "GPS packet data:\n"
+                            "\tLat/Lon/Alt: %f, %f, %f\n"
+                            "\tVel NED: %f, %f, %f\n",
+                            packet.data.gps.Latitude,
+                            packet.data.gps.Longitude,
+                            packet.data.gps.Altitude,
+                            packet.data.gps.VelN,
+                            packet.data.gps.VelE,
+                            packet.data.gps.VelD);
+                    break;
+
+                case VN200_PACKET_IMU:
+                    logDebug(L_DEBUG, "IMU packet data at %.6f:\n"
+                            "\tAccel: %f, %f, %f\n"
+                            "\tGyro: %f, %f, %f\n"
+                            "\tCompass: %f, %f, %f\n",
+                            packet.data.imu.timestamp,
+                            packet.data.imu.accel[0],
+                            packet.data.imu.accel[1],
+                            packet.data.imu.accel[2],
+                            packet.data.imu.gyro[0],
+                            packet.data.imu.gyro[1],
+                            packet.data.imu.gyro[2],
+                            packet.data.imu.compass[0],
+                            packet.data.imu.compass[1],
+                            packet.data.imu.compass[2]);
+
+                    // A sentence lost since the last sample may have been
+                    // a sample, which the increments would leave out, so the
+                    // interval starts over
+                    numLost = dev.framer.numChecksumErrors + dev.framer.numBroken;
+                    if (numLost != lastLost) {
+                        logDebug(L_INFO, "Sentences lost, restarting IMU increment\n");
+                        VN200DecimReset(&decim);
+                        lastLost = numLost;
                     }
-                    logDebug(L_VVDEBUG, "\n\n");
-
-                } // Temporary block for computing checksum on stack
-
-
-                // Verify checksums match
-                if (chkNew != chkOld) {
-                    // Checksum failed, don't parse but skip to next packet
-                    logDebug(L_INFO, "Checksum failed: Read %02X but computed %02X\n", chkOld, chkNew);
-
-                    // Signal to consume the packet anyway, it's garbage data
-                    numParsed = chkStartIndex + 2;
 
-                } else {
-
-                    // Search for end of packet ID (ex. VNIMU), starts after first comma
-                    const int packetIDMaxLength = 16;
-                    unsigned char packetIDString[packetIDMaxLength];
-                    for (i = packetStart;
-                            i < chkStartIndex
-                            && i - packetStart < packetIDMaxLength
-                            && BufferIndex(&(dev.inbuf), i) != ',';
-                            i++) {
-                        // Loop until comma is reached, copy ID string into buffer
-                        packetIDString[i - packetStart] = BufferIndex(&(dev.inbuf), i);
+                    if (VN200DecimAdd(&decim, &(packet.data.imu), &delta) == 1) {
+                        logDebug(L_DEBUG, "IMU increment over %.3f s at %.6f:\n"
+                                "\tdTheta: %f, %f, %f\n"
+                                "\tdVel: %f, %f, %f\n",
+                                delta.dt,
+                                delta.timestamp,
+                                delta.dTheta[0],
+                                delta.dTheta[1],
+                                delta.dTheta[2],
+                                delta.dVel[0],
+                                delta.dVel[1],
+                                delta.dVel[2]);
                     }
-
-                    // Length of packet ID string is the number travelled
-                    int packetIDLength = i - packetStart;
-
-                    // Ignore intro $VN*** ID, data starts after the comma
-                    int packetDataStart = i + 1;
-                    int packetLen = chkStartIndex - packetDataStart;
-
-                    /**** Determine type of packet and parse accordingly ****/
-
-                    // Packet is a GPS packet
-                    if (packetIDLength == 6 && !strncmp(packetIDString, "$VNGPE", packetIDLength)) {
-
-                        /****************************** Note: This needs to be updated to parse VNGPE packets instead of VNGPS
-                         ******************************/
-
-                        unsigned char packetDataBuf[packetLen + 1];
-                        BufferCopy(&(dev.inbuf), packetDataBuf, packetDataStart, packetLen);
-
-                        // Print ID for debugging
-                        logDebug(L_DEBUG, "Found a GPS Packet at index %d: %c%c%c%c%c%c\n",
-                                packetStart,
-                                BufferIndex(&(dev.inbuf), packetStart),
-                                BufferIndex(&(dev.inbuf), packetStart+1),
-                                BufferIndex(&(dev.inbuf), packetStart+2),
-                                BufferIndex(&(dev.inbuf), packetStart+3),
-                                BufferIndex(&(dev.inbuf), packetStart+4),
-                                BufferIndex(&(dev.inbuf), packetStart+5));
-
-                        // Parse as GPS packet
-                        rc = VN200GPSPacketParse(packetDataBuf, packetLen, &gps_packet);
-
-                        // Eventually do something with timestamps
-                        // gps_packet.timestamp = packet->timestamp;
-
-                        // Check return code to ensure parsing succeeded, else remove packet anyway
-                        if (rc > 0) {
-                            numParsed = rc;
-
-                            // Print data
-                            logDebug(L_DEBUG, "GPS packet data:\n"
-                                    "\tLat: %f\n"
-                                    "\tLon: %f\n"
-                                    "\tAlt: %f\n",
-                                    gps_packet.Latitude,
-                                    gps_packet.Longitude,
-                                    gps_packet.Altitude);
-                        } else {
-                            numParsed = chkStartIndex + 2;
-                        }
-
-                        // Packet is an IMU packet
-                    } else if (packetIDLength == 6 && !strncmp(packetIDString, "$VNIMU", packetIDLength)) {
-
-                        unsigned char packetDataBuf[packetLen + 1];
-                        BufferCopy(&(dev.inbuf), packetDataBuf, packetDataStart, packetLen);
-
-                        logDebug(L_DEBUG, "Found an IMU Packet at index %d: %c%c%c%c%c%c\n",
-                                packetStart,
-                                BufferIndex(&(dev.inbuf), packetStart),
-                                BufferIndex(&(dev.inbuf), packetStart+1),
-                                BufferIndex(&(dev.inbuf), packetStart+2),
-                                BufferIndex(&(dev.inbuf), packetStart+3),
-                                BufferIndex(&(dev.inbuf), packetStart+4),
-                                BufferIndex(&(dev.inbuf), packetStart+5));
-
-                        // Parse as IMU packet
-                        rc = VN200IMUPacketParse(packetDataBuf, packetLen, &imu_packet);
-
-                        if (rc > 0) {
-                            numParsed = rc;
-
-                            // Print parsed data
-                            logDebug(L_DEBUG, "IMU packet data:\n"
-                                    "\tAccel: %f, %f, %f\n"
-                                    "\tGyro: %f, %f, %f\n"
-                                    "\tCompass: %f, %f, %f\n",
-                                    imu_packet.accel[0],
-                                    imu_packet.accel[1],
-                                    imu_packet.accel[2],
-                                    imu_packet.gyro[0],
-                                    imu_packet.gyro[1],
-                                    imu_packet.gyro[2],
-                                    imu_packet.compass[0],
-                                    imu_packet.compass[1],
-                                    imu_packet.compass[2]);
-                        } else {
-                            numParsed = chkStartIndex + 2;
-                        }
-
-                    } else {
-
-                        // Packet is unknown type or improperly formatted
-                        logDebug(L_INFO, "Packet type unknown\n");
-
-                    } // Parsed packet type
-
-                } // Checksum pass
-
-                // If errors uncaught, remove some bytes anyway to move on to next packet
-                if (numParsed <= 0) {
-                    numParsed = 3;
-                }
-
-                // Remove bytes from buffer
-                numConsumed = VN200Consume(&dev, numParsed);
-                logDebug(L_DEBUG, "Consumed %d bytes (%d req) from buffer\n", numConsumed, numParsed);
-
-            } else {
-                numConsumed = 0;
-            }
-
-        } while (numConsumed > 0);
+                    break;
+
+                case VN200_PACKET_INS:
+                    logDebug(L_DEBUG, "INS packet data:\n"
+                            "\tStatus: %04X\n"
+                            "\tYaw/Pitch/Roll: %f, %f, %f\n"
+                            "\tLat/Lon/Alt: %f, %f, %f\n",
+                            packet.data.ins.status,
+                            packet.data.ins.Yaw,
+                            packet.data.ins.Pitch,
+                            packet.data.ins.Roll,
+                            packet.data.ins.Latitude,
+                            packet.data.ins.Longitude,
+                            packet.data.ins.Altitude);
+                    break;
+
+                case VN200_PACKET_YMR:
+                    logDebug(L_DEBUG, "Attitude packet data:\n"
+                            "\tYaw/Pitch/Roll: %f, %f, %f\n",
+                            packet.data.ymr.ypr[0],
+                            packet.data.ymr.ypr[1],
+                            packet.data.ymr.ypr[2]);
+                    break;
+
+                case VN200_PACKET_QMR:
+                    logDebug(L_DEBUG, "Attitude packet data:\n"
+                            "\tQuaternion: %f, %f, %f, %f\n",
+                            packet.data.qmr.quat[0],
+                            packet.data.qmr.quat[1],
+                            packet.data.qmr.quat[2],
+                            packet.data.qmr.quat[3]);
+                    break;
+
+                case VN200_PACKET_WRG:
+                case VN200_PACKET_RRG:
+                    logDebug(L_DEBUG, "Register %d: %s\n",
+                            packet.data.reg.reg, packet.data.reg.value);
+                    break;
+
+                case VN200_PACKET_ERR:
+                    logDebug(L_INFO, "Sensor error %d\n", packet.data.err.code);
+                    break;
+
+                default:
+                    // Packet is unknown type or improperly formatted
+                    logDebug(L_INFO, "Packet type unknown\n");
+                    break;
+
+            } // Parsed packet type
+
+        } // while (VN200FrameNext(...))
 
     } // while (1)
 
@@ -274,4 +251,3 @@ int main(int argc, char **argv) {
     return 0;
 
 }
-
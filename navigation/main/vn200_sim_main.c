@@ -0,0 +1,247 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_sim_main.c
+ *
+ * Description:
+ *	Streams simulated VN200 output to a file, a pseudo-terminal, or a
+ *	serial port, in real time or faster
+ *
+ *	    vn200_sim_main [-g map.gpx [-s segment]] [-b] [-r imuHz] [-G gpsHz]
+ *	        [-v speed] [-t seconds] [-x speedup] [-n noiseScale]
+ *	        [-D dropRate] [-C corruptRate] [-S seed]
+ *	        [-o file | -p | -d device] [-B baud]
+ *
+ *	With no GPX file the vehicle drives a 40 m square. A speedup of 0 writes
+ *	as fast as the output takes it. With -p the pseudo-terminal path to
+ *	open is printed, and the output is paced at the baud rate if one is
+ *	given.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Sample pacing retries only an interrupted sleep
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+#include "debuglog.h"
+#include "ptydev.h"
+#include "timing.h"
+#include "uart.h"
+
+#include "vn200.h"
+#include "vn200_sim.h"
+
+// Square driven when no GPX file is given
+#define SIM_SQUARE_LAT 34.6162565
+#define SIM_SQUARE_LON -112.4494117
+#define SIM_SQUARE_ALT 1573.8
+#define SIM_SQUARE_DLAT (40 / 110922.0)
+#define SIM_SQUARE_DLON (40 / 91694.0)
+
+typedef enum {
+    SIM_OUT_FILE,
+    SIM_OUT_PTY,
+    SIM_OUT_UART
+} SIM_OUT;
+
+// Commands sent to the simulated sensor are ignored
+static int simIgnore(PTY_DEV *pty, const unsigned char *data, int length, void *context) {
+
+    (void) pty;
+    (void) data;
+    (void) length;
+    (void) context;
+
+    return 0;
+
+}
+
+static void usage(const char *name) {
+
+    fprintf(stderr, "Usage: %s [-g map.gpx [-s segment]] [-b] [-r imuHz] [-G gpsHz] [-v speed]\n"
+            "\t[-t seconds] [-x speedup] [-n noiseScale] [-D dropRate] [-C corruptRate]\n"
+            "\t[-S seed] [-o file | -p | -d device] [-B baud]\n", name);
+
+}
+
+
+int main(int argc, char **argv) {
+
+    static VN200_SIM sim;
+    static PTY_DEV pty;
+    VN200_SIM_CONFIG config;
+    SIM_OUT outType = SIM_OUT_FILE;
+    FILE *outFile = stdout;
+    unsigned char buf[VN200_SIM_MAX_STEP_LEN];
+    char *gpxPath = NULL, *outPath = NULL, *devName = NULL;
+    double seconds = 60, speedup = 1, noiseScale = 1;
+    int64_t startNs, dueNs;
+    struct timespec due;
+    int opt, segment = 0, baud = 0, fd = -1, len, rc;
+    uint64_t step, numSteps;
+
+    VN200SimDefaults(&config);
+
+    while ((opt = getopt(argc, argv, "g:s:br:G:v:t:x:n:D:C:S:o:pd:B:h")) != -1) {
+        switch (opt) {
+            case 'g': gpxPath = optarg; break;
+            case 's': segment = atoi(optarg); break;
+            case 'b': config.format = VN200_SIM_BINARY; break;
+            case 'r': config.imuRate = atoi(optarg); break;
+            case 'G': config.gpsRate = atoi(optarg); break;
+            case 'v': config.speed = atof(optarg); break;
+            case 't': seconds = atof(optarg); break;
+            case 'x': speedup = atof(optarg); break;
+            case 'n': noiseScale = atof(optarg); break;
+            case 'D': config.dropRate = atof(optarg); break;
+            case 'C': config.corruptRate = atof(optarg); break;
+            case 'S': config.seed = strtoull(optarg, NULL, 0); break;
+            case 'o': outType = SIM_OUT_FILE; outPath = optarg; break;
+            case 'p': outType = SIM_OUT_PTY; break;
+            case 'd': outType = SIM_OUT_UART; devName = optarg; break;
+            case 'B': baud = atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    config.accelNoise *= noiseScale;
+    config.gyroNoise *= noiseScale;
+    config.magNoise *= noiseScale;
+    config.baroNoise *= noiseScale;
+    config.tempNoise *= noiseScale;
+    config.gpsPosNoise *= noiseScale;
+    config.gpsVelNoise *= noiseScale;
+
+    if (VN200SimInit(&sim, &config) != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (gpxPath != NULL) {
+        rc = VN200SimLoadGpx(&sim, gpxPath, segment);
+        if (rc < 0) {
+            fprintf(stderr, "Could not read a trajectory from %s\n", gpxPath);
+            return 1;
+        }
+    } else {
+        VN200SimAddWaypoint(&sim, SIM_SQUARE_LAT, SIM_SQUARE_LON, SIM_SQUARE_ALT);
+        VN200SimAddWaypoint(&sim, SIM_SQUARE_LAT + SIM_SQUARE_DLAT, SIM_SQUARE_LON, SIM_SQUARE_ALT);
+        VN200SimAddWaypoint(&sim, SIM_SQUARE_LAT + SIM_SQUARE_DLAT, SIM_SQUARE_LON + SIM_SQUARE_DLON,
+                SIM_SQUARE_ALT);
+        VN200SimAddWaypoint(&sim, SIM_SQUARE_LAT, SIM_SQUARE_LON + SIM_SQUARE_DLON, SIM_SQUARE_ALT);
+    }
+    logDebug(L_INFO, "Trajectory of %d points, %.1f s per lap\n", sim.numWaypoints, sim.lapTime);
+
+    switch (outType) {
+        case SIM_OUT_FILE:
+            if (outPath != NULL && strcmp(outPath, "-") != 0) {
+                outFile = fopen(outPath, "wb");
+                if (outFile == NULL) {
+                    fprintf(stderr, "Could not open %s\n", outPath);
+                    return 1;
+                }
+            }
+            break;
+        case SIM_OUT_PTY:
+            if (PtyDevInit(&pty, simIgnore, NULL) != 0) {
+                fprintf(stderr, "Could not open a pseudo-terminal\n");
+                return 1;
+            }
+            if (baud > 0) {
+                PtyDevSetPacing(&pty, baud);
+            }
+            PtyDevStart(&pty);
+            printf("%s\n", pty.slavePath);
+            fflush(stdout);
+            break;
+        case SIM_OUT_UART:
+            fd = UARTInit(devName, baud > 0 ? baud : VN200_BAUD);
+            if (fd < 0) {
+                fprintf(stderr, "Could not open %s\n", devName);
+                return 1;
+            }
+            break;
+    }
+
+    numSteps = (uint64_t) (seconds * config.imuRate);
+    startNs = TimeMonotonicNs();
+
+    for (step = 0; step < numSteps; step++) {
+
+        // Each sample goes out when it would have been sampled
+        if (speedup > 0) {
+            dueNs = startNs + (int64_t) (step * NSEC_PER_SEC / (config.imuRate * speedup));
+            due.tv_sec = dueNs / NSEC_PER_SEC;
+            due.tv_nsec = dueNs % NSEC_PER_SEC;
+            // Only a signal cuts the sleep short. Any other error would
+            // fail again on every try.
+            while ((rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL)) == EINTR);
+            if (rc != 0) {
+                logDebug(L_INFO, "Could not wait for the next sample: %s\n", strerror(rc));
+                break;
+            }
+        }
+
+        len = VN200SimStep(&sim, buf, sizeof(buf));
+        if (len < 0) {
+            logDebug(L_INFO, "Simulator step failed (%d)\n", len);
+            break;
+        }
+
+        switch (outType) {
+            case SIM_OUT_FILE:
+                rc = (fwrite(buf, 1, len, outFile) == (size_t) len) ? len : -1;
+                break;
+            case SIM_OUT_PTY:
+                rc = PtyDevWrite(&pty, buf, len);
+                break;
+            default:
+                rc = UARTWrite(fd, buf, len);
+                break;
+        }
+        if (rc < 0) {
+            logDebug(L_INFO, "Output write failed\n");
+            break;
+        }
+    }
+
+    logDebug(L_INFO, "%llu IMU and %llu GPS packets, %llu dropped, %llu corrupted, %llu bytes in %.2f s\n",
+            (unsigned long long) sim.numImu, (unsigned long long) sim.numGps,
+            (unsigned long long) sim.numDropped, (unsigned long long) sim.numCorrupted,
+            (unsigned long long) sim.numBytes, (double) (TimeMonotonicNs() - startNs) / NSEC_PER_SEC);
+
+    switch (outType) {
+        case SIM_OUT_FILE:
+            if (outFile != stdout) {
+                fclose(outFile);
+            } else {
+                fflush(stdout);
+            }
+            break;
+        case SIM_OUT_PTY:
+            PtyDevStop(&pty);
+            PtyDevClose(&pty);
+            break;
+        case SIM_OUT_UART:
+            UARTClose(fd);
+            break;
+    }
+
+    return 0;
+
+} // main(int, char **)
@@ -12,14 +12,31 @@
  * Revision 0.1
  *      Last edited 04/23/2020
  *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Links serviced every period so they recover from peer restarts
+ *
+ * Revision 0.3
+ *      Last edited 10/18/2026
+ *      Shared params locked while the links are serviced
+ *
  ***************************************************************************/
 
 #include "navigation.h"
 
 int navigation_run(NAVIGATION_PARAMS *navigation) {
 
+    // The links are shared with the subsystem's other threads
+    ThreadMutexLock(&(navigation->lock));
+
+    // Keep the links connected, a peer that restarted is reconnected here
+    LinkService(&(navigation->guidance_link));
+    LinkService(&(navigation->control_link));
+    LinkService(&(navigation->imageproc_link));
+
+    ThreadMutexUnlock(&(navigation->lock));
+
     // Navigation control flow operations
 
 	return 0;
 }
-
@@ -16,6 +16,31 @@
  * 	Last edited 5/30/2019
  * 	Major overhaul unifying GPS and IMU functionality
  *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Automatic baud rate detection and negotiation
+ *
+ * Revision 0.4
+ * 	Last edited 10/18/2026
+ * 	Event-driven reading and byte arrival times
+ *
+ * Revision 0.5
+ * 	Last edited 10/18/2026
+ * 	Binary output mode
+ *
+ * Revision 0.6
+ * 	Last edited 10/18/2026
+ * 	Streaming sentence framer kept in step with consumed input
+ *
+ * Revision 0.7
+ * 	Last edited 10/18/2026
+ * 	Timestamps from CLOCK_MONOTONIC, clock model reset on init
+ *
+ * Revision 0.8
+ * 	Last edited 10/18/2026
+ * 	Configuration read back and only differences written, time to first
+ * 	sample logged
+ *
  ***************************************************************************/
 
 #include <stdio.h>
@@ -31,8 +56,14 @@
 #include "buffer.h"
 #include "logger.h"
 #include "debuglog.h"
+#include "timing.h"
 #include "uart.h"
+#include "vn200_binary.h"
+#include "vn200_clock.h"
+#include "vn200_cmd.h"
+#include "vn200_config.h"
 #include "vn200_crc.h"
+#include "vn200_framer.h"
 #include "vn200_gps.h"
 #include "vn200_imu.h"
 
@@ -41,7 +72,9 @@
 
 /**** Function getTimestamp ****
  *
- * Gets a system timestamp as a double and struct timespec
+ * Gets a system timestamp as a double and struct timespec. The time is from
+ * CLOCK_MONOTONIC, which does not jump when the wall clock is set, so it is
+ * the same time base as the byte arrival times.
  * Only one of the arguments need not be null
  *
  * Arguments: 
@@ -69,7 +102,7 @@ int getTimestamp(struct timespec *ts, double *td) {
     }
 
     // Get system time
-    rc = clock_gettime(CLOCK_REALTIME, ts);
+    rc = clock_gettime(CLOCK_MONOTONIC, ts);
     if (rc) {
         return rc;
     }
@@ -84,6 +117,128 @@ int getTimestamp(struct timespec *ts, double *td) {
 } // getTimestamp(struct timespec *, double *)
 
 
+// Rates the VN200 supports, most likely first. Probed after the rate in
+// VN200_DEV (if any) when detecting the sensor's current setting.
+static const int vn200BaudCandidates[] = {
+    115200, 57600, 230400, 460800, 921600, 128000, 38400, 19200, 9600
+};
+
+#define VN200_NUM_BAUD_CANDIDATES \
+    ((int) (sizeof(vn200BaudCandidates) / sizeof(vn200BaudCandidates[0])))
+
+
+/**** Function VN200DetectBaud ****
+ *
+ * Finds the baud rate the sensor is currently using by reading its serial
+ * baud rate register (05) at each candidate rate until a reply with a valid
+ * checksum reports that same rate. The UART is left at the detected rate.
+ *
+ * Arguments: 
+ * 	dev       - Pointer to VN200_DEV instance with an open UART
+ * 	timeoutMs - Milliseconds to wait for a reply at each candidate rate
+ *
+ * Return value:
+ *	On success, returns the detected baud rate (also stored in dev->baud)
+ *	On failure, returns a negative number
+ */
+int VN200DetectBaud(VN200_DEV *dev, int timeoutMs) {
+
+    char reply[VN200_CMD_REPLY_LEN];
+    int i, candidate, reported, handle;
+
+    if (dev == NULL) {
+        return -1;
+    }
+
+    // Try the configured rate first, then every supported rate
+    for (i = -1; i < VN200_NUM_BAUD_CANDIDATES; i++) {
+
+        if (i < 0) {
+            candidate = dev->baud;
+            if (candidate <= 0) {
+                continue;
+            }
+        } else {
+            candidate = vn200BaudCandidates[i];
+            if (candidate == dev->baud) {
+                continue;
+            }
+        }
+
+        if (UARTSetBaud(dev->fd, candidate) != 0) {
+            continue;
+        }
+
+        // Anything received at the previous rate is noise
+        VN200Consume(dev, BufferLength(&(dev->inbuf)));
+
+        // At the wrong rate the reply arrives as noise and fails its checksum
+        logDebug(L_DEBUG, "Probing VN200 at %d baud\n", candidate);
+        handle = VN200CmdRead(dev, 5, timeoutMs);
+        if (VN200CmdWait(dev, handle, reply, sizeof(reply)) != 0) {
+            continue;
+        }
+
+        if (sscanf(reply, "%d", &reported) == 1 && reported == candidate) {
+            logDebug(L_INFO, "Detected VN200 at %d baud\n", candidate);
+            dev->baud = candidate;
+            return candidate;
+        }
+    }
+
+    logDebug(L_INFO, "Could not detect VN200 baud rate\n");
+
+    return -2;
+
+} // VN200DetectBaud(VN200_DEV *, int)
+
+
+/**** Function VN200SetBaud ****
+ *
+ * Switches the sensor and the UART to a new baud rate. The sensor
+ * acknowledges at the old rate before switching, so the UART is only changed
+ * once the acknowledgement arrives.
+ *
+ * Arguments: 
+ * 	dev       - Pointer to VN200_DEV instance at the sensor's current rate
+ * 	baud      - New baud rate (must be one the VN200 supports)
+ * 	timeoutMs - Milliseconds to wait for the acknowledgement
+ *
+ * Return value:
+ *	On success, returns 0
+ *	On failure, returns a negative number and leaves the rate unchanged
+ */
+int VN200SetBaud(VN200_DEV *dev, int baud, int timeoutMs) {
+
+    char value[16];
+    int handle, rc;
+
+    if (dev == NULL) {
+        return -1;
+    }
+
+    snprintf(value, sizeof(value), "%d", baud);
+    handle = VN200CmdWrite(dev, 5, value, timeoutMs);
+
+    rc = VN200CmdWait(dev, handle, NULL, 0);
+    if (rc != 0) {
+        logDebug(L_INFO, "VN200 did not accept baud rate %d\n", baud);
+        return -2;
+    }
+
+    rc = UARTSetBaud(dev->fd, baud);
+    if (rc != 0) {
+        return -3;
+    }
+
+    dev->baud = baud;
+    logDebug(L_INFO, "Switched VN200 to %d baud\n", baud);
+
+    return 0;
+
+} // VN200SetBaud(VN200_DEV *, int, int)
+
+
 /**** Function VN200BaseInit ****
  *
  * Initializes a VN200 IMU/GPS before it is setup for either functionality.
@@ -113,11 +268,27 @@ int VN200BaseInit(VN200_DEV *dev, char *devname, int baud) {
         logDebug(L_INFO, "Couldn't initialize VN200 sensor\n");
         return -2;
     }
+    dev->openNs = TimeMonotonicNs();
+    dev->firstSampleNs = 0;
 
     // Initialize the input and output buffers
     BufferEmpty(&(dev->inbuf));
     BufferEmpty(&(dev->outbuf));
 
+    dev->eventDriven = 0;
+    dev->rxOffset = 0;
+    dev->chunkHead = 0;
+    dev->numChunks = 0;
+
+    memset(dev->commands, 0, sizeof(dev->commands));
+    dev->cmdOrder = 0;
+
+    memset(&(dev->binary), 0, sizeof(dev->binary));
+    memset(&(dev->framer), 0, sizeof(dev->framer));
+    VN200FramerReset(&(dev->framer));
+    memset(&(dev->clock), 0, sizeof(dev->clock));
+    VN200ClockReset(&(dev->clock));
+
 #if 0 // TODO REMOVE
     // Initialize packet ring buffer
     dev->ringbuf.start = 0;
@@ -130,23 +301,84 @@ int VN200BaseInit(VN200_DEV *dev, char *devname, int baud) {
 } // VN200BaseInit(VN200_DEV *)
 
 
-/**** Function VN200Poll ****
+/**** Function VN200EnableEvents ****
  *
- * Polls the UART file for an initialized VN200 device and populates inbuf with
- * read data. If it detects the start of a packet with '$' it will also move
- * the data into the next available VN200_PACKET in the ring buffer
+ * Switches the device to event-driven reading (see UARTReaderInit). Should be
+ * called after the baud rate is final, since changing it resets VMIN.
  *
  * Arguments: 
- * 	dev - Pointer to VN200_DEV instance to poll
+ * 	dev  - Pointer to initialized VN200_DEV instance
+ * 	vmin - Bytes waiting before a read wakes
+ *
+ * Return value:
+ *	On success, returns 0
+ *	On failure, returns a negative number
+ */
+int VN200EnableEvents(VN200_DEV *dev, int vmin) {
+
+    int rc;
+
+    if (dev == NULL) {
+        return -1;
+    }
+
+    rc = UARTReaderInit(&(dev->reader), dev->fd, dev->baud, vmin);
+    if (rc != 0) {
+        logDebug(L_INFO, "VN200EnableEvents: Could not start event-driven reader\n");
+        return rc;
+    }
+
+    dev->eventDriven = 1;
+
+    return 0;
+
+} // VN200EnableEvents(VN200_DEV *, int)
+
+
+/**** Function vn200RecordChunk ****
+ *
+ * Remembers the arrival time of a chunk just added to the input buffer
+ *
+ * Arguments: 
+ * 	dev    - Pointer to VN200_DEV instance
+ * 	length - Number of bytes added
+ * 	timeNs - CLOCK_MONOTONIC time the chunk was read
+ */
+static void vn200RecordChunk(VN200_DEV *dev, int length, int64_t timeNs) {
+
+    dev->rxOffset += length;
+
+    dev->chunks[dev->chunkHead].endOffset = dev->rxOffset;
+    dev->chunks[dev->chunkHead].timeNs = timeNs;
+    dev->chunkHead = (dev->chunkHead + 1) % VN200_CHUNK_RING_LEN;
+
+    if (dev->numChunks < VN200_CHUNK_RING_LEN) {
+        dev->numChunks++;
+    }
+
+} // vn200RecordChunk(VN200_DEV *, int, int64_t)
+
+
+/**** Function VN200PollWait ****
+ *
+ * Reads from the UART for an initialized VN200 device and appends the data to
+ * inbuf, recording when the chunk arrived. In event-driven mode this sleeps
+ * until data arrives or the timeout expires; otherwise the read is bounded by
+ * VTIME and the timeout is ignored.
+ *
+ * Arguments: 
+ * 	dev       - Pointer to VN200_DEV instance to poll
+ * 	timeoutMs - Milliseconds to wait for data in event-driven mode
  *
  * Return value:
  *	On success, returns the number of bytes received (may be 0)
  *	On failure, returns a negative number
  */
-int VN200Poll(VN200_DEV *dev) {
+int VN200PollWait(VN200_DEV *dev, int timeoutMs) {
 
     int numToRead, numRead, rc;
     unsigned char uartData[BYTE_BUFFER_LEN];
+    int64_t timeNs;
 
     // Exit on error if invalid pointer
     if (dev == NULL) {
@@ -160,11 +392,66 @@ int VN200Poll(VN200_DEV *dev) {
         return -2;
     }
 
+    // Calculate length and pointer to proper position in array
+    numToRead = BYTE_BUFFER_MAX_LEN - BufferLength(&(dev->inbuf));
+
+    logDebug(L_VDEBUG, "Attempting to read %d bytes from uart device...\n", numToRead);
+
+    if (dev->eventDriven) {
+        numRead = UARTReaderRead(&(dev->reader), uartData, numToRead, timeoutMs, &timeNs);
+    } else {
+        numRead = UARTRead(dev->fd, uartData, numToRead);
+        timeNs = TimeMonotonicNs();
+    }
+    logDebug(L_VDEBUG, "\tRead %d\n", numRead);
+
+    if (numRead <= 0) {
+        return numRead;
+    }
+
+    rc = BufferAddArray(&(dev->inbuf), uartData, numRead);
+
+    if (rc != numRead) {
+        logDebug(L_INFO, "WARNING: Couldn't add all bytes read from uart to input buffer\n");
+    }
+
+    vn200RecordChunk(dev, rc, timeNs);
+
+    // Log newly read data to file
+    LogUpdate(&(dev->logFile), (char *) uartData, numRead);
+
+    // Return number successfully and saved to buffer (may be 0)
+    return rc;
+
+} // VN200PollWait(VN200_DEV *, int)
+
+
+/**** Function VN200Poll ****
+ *
+ * Polls the UART file for an initialized VN200 device and populates inbuf with
+ * read data. Does not wait in event-driven mode.
+ *
+ * Arguments: 
+ * 	dev - Pointer to VN200_DEV instance to poll
+ *
+ * Return value:
+ *	On success, returns the number of bytes received (may be 0)
+ *	On failure, returns a negative number
+ */
+int VN200Poll(VN200_DEV *dev) {
+
+    int rc;
+
+    // Exit on error if invalid pointer
+    if (dev == NULL) {
+        return -1;
+    }
+
     // Some systems don't have this ioctl parameter. Since this isn't a
     // completely necessary check, it can be skipped if not found.
 #ifdef FIONREAD
     // Check if how many bytes of UART data available
-    int ioctl_status;
+    int ioctl_status = 0;
     rc = ioctl(dev->fd, FIONREAD, &ioctl_status);
     if (rc) {
         logDebug(L_INFO, "%s: VN200Poll: ioctl() failed to fetch FIONREAD\n", strerror(errno));
@@ -175,28 +462,102 @@ int VN200Poll(VN200_DEV *dev) {
     logDebug(L_DEBUG, "%d bytes available from UART device...\n", ioctl_status);
 #endif
 
-    // Calculate length and pointer to proper position in array
-    numToRead = BYTE_BUFFER_LEN - BufferLength(&(dev->inbuf));
+    return VN200PollWait(dev, 0);
 
-    logDebug(L_DEBUG, "Attempting to read %d bytes from uart device...\n", numToRead);
+} // VN200Poll(VN200_DEV *)
 
-    // Read without blocking from UART device
-    numRead = UARTRead(dev->fd, uartData, numToRead);
-    logDebug(L_DEBUG, "\tRead %d\n", numRead);
 
-    rc = BufferAddArray(&(dev->inbuf), uartData, numRead);
+/**** Function VN200ByteTimeNs ****
+ *
+ * Estimates when a byte in the input buffer arrived at the UART. The chunk it
+ * came in was stamped when read, and each byte before the chunk's last one
+ * arrived one character time earlier, so the estimate depends on the baud
+ * rate rather than on when the data is parsed.
+ *
+ * Arguments: 
+ * 	dev   - Pointer to VN200_DEV instance
+ * 	index - Index of the byte in inbuf (0 is the oldest unconsumed byte)
+ *
+ * Return value:
+ *	On success, returns the CLOCK_MONOTONIC arrival time in nanoseconds
+ *	If the byte's chunk is no longer remembered, returns a negative number
+ */
+int64_t VN200ByteTimeNs(VN200_DEV *dev, int index) {
 
-    if (rc != numRead) {
-        logDebug(L_INFO, "WARNING: Couldn't add all bytes read from uart to input buffer\n");
+    uint64_t offset, startOffset;
+    VN200_CHUNK *chunk;
+    int i, slot;
+
+    if (dev == NULL || index < 0 || index >= BufferLength(&(dev->inbuf))) {
+        return -1;
     }
 
-    // Log newly read data to file
-    LogUpdate(&(dev->logFile), (char *) uartData, numRead);
+    // Absolute position of the byte in the received stream
+    offset = dev->rxOffset - BufferLength(&(dev->inbuf)) + index;
 
-    // Return number successfully and saved to buffer (may be 0)
-    return rc;
+    // Search from the newest chunk back, since parsing happens near the end
+    for (i = 0; i < dev->numChunks; i++) {
 
-} // VN200Poll(VN200_DEV *)
+        slot = (dev->chunkHead - 1 - i + VN200_CHUNK_RING_LEN) % VN200_CHUNK_RING_LEN;
+        chunk = &(dev->chunks[slot]);
+
+        // Where the oldest record started is only known if nothing was evicted
+        if (i + 1 < dev->numChunks) {
+            startOffset = dev->chunks[(slot - 1 + VN200_CHUNK_RING_LEN) % VN200_CHUNK_RING_LEN].endOffset;
+        } else if (dev->numChunks < VN200_CHUNK_RING_LEN) {
+            startOffset = 0;
+        } else {
+            break;
+        }
+
+        if (offset >= startOffset && offset < chunk->endOffset) {
+            return chunk->timeNs - (int64_t) (chunk->endOffset - 1 - offset) * UARTByteTimeNs(dev->baud);
+        }
+
+        if (offset >= chunk->endOffset) {
+            break;
+        }
+    }
+
+    return -2;
+
+} // VN200ByteTimeNs(VN200_DEV *, int)
+
+
+/**** Function VN200MarkSample ****
+ *
+ * Records that a valid sample arrived. The first one since the UART was
+ * opened is logged with the time it took to get there, which is what
+ * configuration costs at startup.
+ *
+ * Arguments: 
+ * 	dev       - Pointer to VN200_DEV instance
+ * 	arrivalNs - CLOCK_MONOTONIC time the sample's first byte arrived, or a
+ * 	            negative number if not known
+ *
+ * Return value:
+ *	If this was the first sample, returns 1
+ *	Otherwise returns 0, or a negative number on failure
+ */
+int VN200MarkSample(VN200_DEV *dev, int64_t arrivalNs) {
+
+    if (dev == NULL) {
+        return -1;
+    }
+
+    if (dev->firstSampleNs != 0) {
+        return 0;
+    }
+
+    dev->firstSampleNs = (arrivalNs > 0) ? arrivalNs : TimeMonotonicNs();
+    if (dev->openNs > 0) {
+        logDebug(L_INFO, "First VN200 sample %.1f ms after opening the UART\n",
+                (double) (dev->firstSampleNs - dev->openNs) / NSEC_PER_MSEC);
+    }
+
+    return 1;
+
+} // VN200MarkSample(VN200_DEV *, int64_t)
 
 
 /**** Function VN200Consume ****
@@ -220,6 +581,7 @@ int VN200Consume(VN200_DEV *dev, int num) {
 
     logDebug(L_VDEBUG, "Attempting to consume %d bytes\n", num);
     num = BufferRemove(&(dev->inbuf), num);
+    VN200FramerDiscard(&(dev->framer), num);
     logDebug(L_VDEBUG, "Consumed %d bytes, %d remaining.\n", num, BufferLength(&(dev->inbuf)));
 
     return num;
@@ -340,26 +702,39 @@ int VN200Command(VN200_DEV *dev, char *cmd, int num, int sendChk) {
  */
 int VN200FlushOutput(VN200_DEV *dev) {
 
-    int numWritten, i;
+    int numWritten, numContiguous, total = 0, i;
 
     // Ensure valid pointers
     if (dev == NULL) {
         return -1;
     }
 
-    // Write output buffer to UART
-    numWritten = UARTWrite(dev->fd, dev->outbuf.buffer, dev->outbuf.length);
-
     logDebug(L_VDEBUG, "Output: \n");
-    for (i = 0; i < dev->outbuf.length; i++) {
-        logDebug(L_VDEBUG, "%c", dev->outbuf.buffer[i]);
+    for (i = 0; i < BufferLength(&(dev->outbuf)); i++) {
+        logDebug(L_VDEBUG, "%c", BufferIndex(&(dev->outbuf), i));
     }
     logDebug(L_VDEBUG, "\n");
 
-    // Remove the data from the output buffer
-    BufferRemove(&(dev->outbuf), numWritten);
+    // Write output buffer to UART from its start index, in at most two
+    // pieces if the data wraps around the end of the ring
+    while (BufferLength(&(dev->outbuf)) > 0) {
 
-    return numWritten;
+        numContiguous = BYTE_BUFFER_LEN - dev->outbuf.start;
+        if (numContiguous > BufferLength(&(dev->outbuf))) {
+            numContiguous = BufferLength(&(dev->outbuf));
+        }
+
+        numWritten = UARTWrite(dev->fd, &(dev->outbuf.buffer[dev->outbuf.start]), numContiguous);
+        if (numWritten <= 0) {
+            break;
+        }
+
+        // Remove the data from the output buffer
+        BufferRemove(&(dev->outbuf), numWritten);
+        total += numWritten;
+    }
+
+    return total;
 
 } // VN200FlushOutput(VN200_DEV &)
 
@@ -381,6 +756,10 @@ int VN200Destroy(VN200_DEV *dev) {
         return -1;
     }
 
+    if (dev->eventDriven) {
+        UARTReaderClose(&(dev->reader));
+    }
+
     // Close UART file
     UARTClose(dev->fd);
 
@@ -394,7 +773,9 @@ int VN200Destroy(VN200_DEV *dev) {
 
 /**** Function VN200Init ****
  *
- * Initializes a VN200 UART device for both GPS and IMU functionality
+ * Initializes a VN200 UART device for both GPS and IMU functionality. The
+ * sensor's registers are read back first and only those that differ from
+ * the wanted configuration are written (see vn200_config.c).
  *
  * Arguments: 
  * 	dev     - Pointer to VN200_DEV instance to initialize
@@ -409,9 +790,13 @@ int VN200Destroy(VN200_DEV *dev) {
  */
 int VN200Init(VN200_DEV *dev, char *devname, int fs, int baud, int mode) {
 
-#define CMD_BUFFER_SIZE 64
-    char commandBuf[CMD_BUFFER_SIZE], logBuf[256];
-    int commandBufLen, logBufLen;
+    char logBuf[256], fsValue[16], serialNumber[VN200_CMD_REPLY_LEN];
+    char value[VN200_CMD_REPLY_LEN];
+    char *asyncType;
+    int logBufLen, serialHandle, numFailed = 0, dataMode, packetBits, baudChanged = 0;
+    uint16_t fields;
+    int64_t startNs;
+    VN200_CONFIG config;
 
     char logFileDirName[512];
 
@@ -421,9 +806,10 @@ int VN200Init(VN200_DEV *dev, char *devname, int fs, int baud, int mode) {
     }
 
     // Ensure valid init mode
-    if (!(mode == VN200_INIT_MODE_GPS ||
-                mode == VN200_INIT_MODE_IMU ||
-                mode == VN200_INIT_MODE_BOTH)) {
+    dataMode = mode & ~(VN200_INIT_MODE_BINARY | VN200_INIT_MODE_PERSIST);
+    if (!(dataMode == VN200_INIT_MODE_GPS ||
+                dataMode == VN200_INIT_MODE_IMU ||
+                dataMode == VN200_INIT_MODE_BOTH)) {
 
         logDebug(L_INFO, "VN200Init: Initialization mode 0x%02x not recognized.\n", mode);
         return -2;
@@ -471,79 +857,115 @@ int VN200Init(VN200_DEV *dev, char *devname, int fs, int baud, int mode) {
 
     /**** Initialize VN200 through UART commands ****/
 
-    // Ensure Baud rate is expected rate
-    UARTSetBaud(dev->fd, 57600);
-    char *baudCommandString = "VNWRG,05,115200";
-    VN200Command(dev, baudCommandString, strlen(baudCommandString), 0);
-    VN200FlushOutput(dev);
-    usleep(100000);
-    UARTSetBaud(dev->fd, 115200);
-    VN200FlushInput(dev);
-    usleep(100000);
-
-    // Request VN200 serial number
-    commandBufLen = snprintf(commandBuf, CMD_BUFFER_SIZE, "%s", "VNRRG,03");
-    VN200Command(dev, commandBuf, commandBufLen, 0);
-    VN200FlushOutput(dev);
-    usleep(100000);
-    VN200FlushInput(dev);
-    usleep(100000);
-
-    // Disable asynchronous output
-    commandBufLen = snprintf(commandBuf, CMD_BUFFER_SIZE, "%s", "VNWRG,06,0");
-    VN200Command(dev, commandBuf, commandBufLen, 0);
-    VN200FlushOutput(dev);
-    usleep(100000);
-    VN200FlushInput(dev);
-    usleep(100000);
-
-    if (mode == VN200_INIT_MODE_GPS) {
+    startNs = TimeMonotonicNs();
+
+    // Find the rate the sensor is at (it persists across power cycles), then
+    // move it to the requested rate
+    if (VN200DetectBaud(dev, VN200_PROBE_TIMEOUT_MS) < 0) {
+        logDebug(L_INFO, "VN200Init: Sensor not responding, assuming %d baud\n", baud);
+        UARTSetBaud(dev->fd, baud);
+        dev->baud = baud;
+    } else if (dev->baud != baud) {
+        baudChanged = (VN200SetBaud(dev, baud, VN200_CMD_TIMEOUT_MS) == 0);
+    }
+
+    if (dataMode == VN200_INIT_MODE_GPS) {
 
         // Enable asynchronous GPS data output
-        commandBufLen = snprintf(commandBuf, CMD_BUFFER_SIZE, "%s", "VNWRG,06,20");
+        asyncType = "20";
 
-    } else if (mode == VN200_INIT_MODE_IMU) {
+    } else if (dataMode == VN200_INIT_MODE_IMU) {
 
         // Enable asynchronous IMU data output
-        commandBufLen = snprintf(commandBuf, CMD_BUFFER_SIZE, "%s", "VNWRG,06,19");
+        asyncType = "19";
 
     } else { // BOTH
 
-        /*
-        // IMU/GPS Sample frequency are not the same, so use default frequencies
-        // already set for both
-        dev->fs = 0;
-        */
-
         // Enable both GPS and IMU output
-        commandBufLen = snprintf(commandBuf, CMD_BUFFER_SIZE, "%s", "VNWRG,06,248");
+        asyncType = "248";
     }
 
+    dev->fs = fs;
+    snprintf(fsValue, sizeof(fsValue), "%02d", dev->fs);
+
+    // The serial number read goes out with the configuration reads
+    serialHandle = VN200CmdRead(dev, 3, VN200_CMD_TIMEOUT_MS);
+
+    VN200ConfigReset(&config);
+
+    if (mode & VN200_INIT_MODE_BINARY) {
+
+        // ASCII output off. IMU on binary output 1 at the sampling
+        // frequency, GPS on output 2 at its solution rate. Outputs not used
+        // are turned off.
+        VN200ConfigSet(&config, 6, "0");
+        if (VN200BinaryOutputValue((mode & VN200_INIT_MODE_IMU) ? dev->fs : 0,
+                    VN200_BINARY_GROUP_IMU, VN200_BINARY_IMU_FIELDS, value, sizeof(value)) == 0) {
+            VN200ConfigSet(&config, VN200_BINARY_REG_BASE + 1, value);
+        } else {
+            numFailed++;
+        }
+        if (VN200BinaryOutputValue((mode & VN200_INIT_MODE_GPS) ? VN200_BINARY_GPS_RATE : 0,
+                    VN200_BINARY_GROUP_GPS, VN200_BINARY_GPS_FIELDS, value, sizeof(value)) == 0) {
+            VN200ConfigSet(&config, VN200_BINARY_REG_BASE + 2, value);
+        } else {
+            numFailed++;
+        }
+
+        // Warn if the link cannot carry it (10 bits per byte on the wire)
+        packetBits = 0;
+        if (mode & VN200_INIT_MODE_IMU) {
+            fields = VN200_BINARY_IMU_FIELDS;
+            packetBits += 10 * dev->fs * VN200BinaryPacketSize(VN200_BINARY_GROUP_IMU, &fields);
+        }
+        if (mode & VN200_INIT_MODE_GPS) {
+            fields = VN200_BINARY_GPS_FIELDS;
+            packetBits += 10 * VN200_BINARY_GPS_RATE * VN200BinaryPacketSize(VN200_BINARY_GROUP_GPS, &fields);
+        }
+        if (packetBits > dev->baud) {
+            logDebug(L_INFO, "VN200Init: Binary output needs %d bits/s, more than %d baud\n",
+                    packetBits, dev->baud);
+        }
+
+    } else {
+        VN200ConfigSet(&config, 6, asyncType);  // Asynchronous output type
+        VN200ConfigSet(&config, 7, fsValue);    // Sampling frequency
+    }
 
-    // Send mode command to UART
-    VN200Command(dev, commandBuf, commandBufLen, 0);
-    VN200FlushOutput(dev);
-    usleep(100000);
-    VN200FlushInput(dev);
-    usleep(100000);
+    // Registers already holding the wanted values are left alone, so a
+    // sensor configured and saved before keeps streaming untouched
+    if (VN200ConfigApply(dev, &config, (mode & VN200_INIT_MODE_PERSIST) ? VN200_CONFIG_PERSIST : 0) < 0) {
+        numFailed += config.numFailed;
+    }
 
-    // Set sampling frequency (register 07)
-    dev->fs = fs;
-    commandBufLen = snprintf(commandBuf, CMD_BUFFER_SIZE, "%s%02d", "VNWRG,07,", dev->fs);
-    VN200Command(dev, commandBuf, commandBufLen, 1);
-    VN200FlushOutput(dev);
-    usleep(100000);
-    VN200FlushInput(dev);
-    usleep(100000);
+    // A new baud rate is only kept through a power cycle if it is saved
+    if ((mode & VN200_INIT_MODE_PERSIST) && baudChanged && !config.saved) {
+        if (VN200CmdWait(dev, VN200CmdWriteSettings(dev, VN200_CMD_SETTINGS_TIMEOUT_MS), NULL, 0) != 0) {
+            numFailed++;
+        }
+    }
+
+    if (VN200CmdWait(dev, serialHandle, serialNumber, sizeof(serialNumber)) == 0) {
+        logDebug(L_INFO, "VN200 serial number %s\n", serialNumber);
+    } else {
+        numFailed++;
+    }
 
     if (devname != NULL) {
-        logDebug(L_INFO, "Finished configuring UART for device %s\n", devname);
+        logDebug(L_INFO, "Finished configuring UART for device %s in %.1f ms\n", devname,
+                (double) (TimeMonotonicNs() - startNs) / NSEC_PER_MSEC);
     } else {
-        logDebug(L_INFO, "Finished configuring UART for default device\n");
+        logDebug(L_INFO, "Finished configuring UART for default device in %.1f ms\n",
+                (double) (TimeMonotonicNs() - startNs) / NSEC_PER_MSEC);
+    }
+
+    if (numFailed > 0) {
+        logDebug(L_INFO, "VN200Init: %d configuration commands failed\n", numFailed);
+        return -3;
     }
 
-    // Clear input buffer to prevent parsing "latent" data (temporary)
-    VN200FlushInput(dev);
+    // Wake on arriving packets instead of the VTIME timer from now on
+    VN200EnableEvents(dev, VN200_READ_VMIN);
 
     return 0;
 
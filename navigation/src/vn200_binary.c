@@ -0,0 +1,582 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_binary.c
+ *
+ * Description:
+ *	Binary output protocol for the VN200. The sensor is told which fields
+ *	to send through its binary output registers, then sends packets of
+ *	little-endian values:
+ *
+ *	    0xFA | groups | fields (u16) per group | payload | CRC16 (big-endian)
+ *
+ *	The CRC covers everything after the sync byte. Packets are framed on
+ *	the sync byte, checked against the CRC, and decoded field by field
+ *	straight into IMU_DATA and GPS_DATA, so no text is formatted or scanned
+ *	on either end. The IMU fields take 50 bytes per sample against about 120
+ *	for a VNIMU sentence.
+ *
+ *	Only the common, time, IMU, and GPS groups are understood. A packet
+ *	carrying any other group cannot be sized, so it is treated as noise.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Samples stamped from byte arrival times and the clock model
+ *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Output register values formatted separately, first sample recorded
+ *
+ * Revision 0.4
+ * 	Last edited 10/18/2026
+ * 	Packets checked and decoded in place in the input buffer
+ *
+ * Revision 0.5
+ * 	Last edited 10/18/2026
+ * 	Field walks visit only the bits that are set
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "debuglog.h"
+#include "timing.h"
+#include "vn200_clock.h"
+#include "vn200_cmd.h"
+#include "vn200_crc.h"
+#include "vn200.h"
+
+#include "vn200_binary.h"
+
+// Most fields in any group
+#define VN200_BINARY_MAX_FIELDS 16
+
+// Size in bytes of each field, by group and field bit. Zero marks a bit with
+// no known field.
+static const uint8_t vn200FieldSize[VN200_BINARY_NUM_GROUPS][VN200_BINARY_MAX_FIELDS] = {
+    // Common: TimeStartup, TimeGps, TimeSyncIn, YawPitchRoll, Quaternion,
+    // AngularRate, Position, Velocity, Accel, Imu, MagPres, DeltaTheta,
+    // InsStatus, SyncInCnt, TimeGpsPps
+    {8, 8, 8, 12, 16, 12, 24, 12, 12, 24, 20, 28, 2, 4, 8, 0},
+    // Time: TimeStartup, TimeGps, GpsTow, GpsWeek, TimeSyncIn, TimeGpsPps,
+    // TimeUtc, SyncInCnt, SyncOutCnt, TimeStatus
+    {8, 8, 8, 2, 8, 8, 8, 4, 4, 1, 0, 0, 0, 0, 0, 0},
+    // IMU: ImuStatus, UncompMag, UncompAccel, UncompGyro, Temp, Pres,
+    // DeltaTheta, DeltaVel, Mag, Accel, AngularRate, SensSat
+    {2, 12, 12, 12, 4, 4, 16, 12, 12, 12, 12, 2, 0, 0, 0, 0},
+    // GPS: Utc, Tow, Week, NumSats, Fix, PosLla, PosEcef, VelNed, VelEcef,
+    // PosU, VelU, TimeU, TimeInfo, Dop
+    {8, 8, 2, 1, 1, 24, 24, 12, 12, 12, 4, 4, 2, 28, 0, 0}
+};
+
+
+/**** Function vn200GroupSize ****
+ *
+ * Payload bytes for the given fields of one group
+ *
+ * Arguments:
+ * 	group  - Group index (bit number in the group byte)
+ * 	fields - Field mask for the group
+ *
+ * Return value:
+ *	On success, returns the number of bytes
+ *	If a field is not known, returns a negative number
+ */
+static int vn200GroupSize(int group, uint16_t fields) {
+
+    int bit, size = 0;
+    unsigned int remaining = fields;
+
+    // Visit only the bits that are set
+    while (remaining != 0) {
+        bit = __builtin_ctz(remaining);
+        remaining &= remaining - 1;
+        if (vn200FieldSize[group][bit] == 0) {
+            return -1;
+        }
+        size += vn200FieldSize[group][bit];
+    }
+
+    return size;
+
+} // vn200GroupSize(int, uint16_t)
+
+
+/**** Function VN200BinaryPacketSize ****
+ *
+ * Computes the length of a binary packet, sync byte and CRC included
+ *
+ * Arguments:
+ * 	groups - Group byte of the packet
+ * 	fields - Field mask for each group set in groups, in order
+ *
+ * Return value:
+ *	On success, returns the packet length in bytes
+ *	If the packet holds a group or field that is not known, returns a
+ *	negative number
+ */
+int VN200BinaryPacketSize(int groups, const uint16_t *fields) {
+
+    int group, size, length = 2, numGroups = 0;
+
+    if (fields == NULL || groups <= 0 || groups >= (1 << VN200_BINARY_NUM_GROUPS)) {
+        return -1;
+    }
+
+    for (group = 0; group < VN200_BINARY_NUM_GROUPS; group++) {
+        if (groups & (1 << group)) {
+            size = vn200GroupSize(group, fields[numGroups++]);
+            if (size < 0) {
+                return -1;
+            }
+            length += 2 + size;
+        }
+    }
+
+    // CRC
+    return length + 2;
+
+} // VN200BinaryPacketSize(int, const uint16_t *)
+
+
+/**** Function VN200BinaryOutputValue ****
+ *
+ * Formats the value of a binary output register that sends a single group
+ *
+ * Arguments:
+ * 	rateHz   - Packets per second, must divide VN200_BINARY_BASE_RATE. Zero
+ * 	           turns the output off.
+ * 	group    - One VN200_BINARY_GROUP_* value
+ * 	fields   - Mask of fields to send from the group
+ * 	value    - Buffer for the register value
+ * 	valueLen - Size of value
+ *
+ * Return value:
+ *	On success, returns 0
+ *	If the sensor could not send the output, returns a negative number
+ */
+int VN200BinaryOutputValue(int rateHz, int group, uint16_t fields, char *value, int valueLen) {
+
+    int asyncMode = 1, divisor = 1;
+
+    if (value == NULL || valueLen <= 0 || (group & (group - 1)) != 0 || rateHz < 0 ||
+            rateHz > VN200_BINARY_BASE_RATE || VN200BinaryPacketSize(group, &fields) < 0) {
+        return -1;
+    }
+
+    if (rateHz == 0) {
+        asyncMode = 0;
+    } else {
+        divisor = VN200_BINARY_BASE_RATE / rateHz;
+        if (divisor * rateHz != VN200_BINARY_BASE_RATE) {
+            logDebug(L_INFO, "VN200 binary output: %d Hz is not a divisor of %d Hz, using %d Hz\n",
+                    rateHz, VN200_BINARY_BASE_RATE, VN200_BINARY_BASE_RATE / divisor);
+        }
+    }
+
+    snprintf(value, valueLen, "%d,%d,%02X,%04X", asyncMode, divisor, group, fields);
+
+    return 0;
+
+} // VN200BinaryOutputValue(int, int, uint16_t, char *, int)
+
+
+/**** Function VN200BinaryConfigure ****
+ *
+ * Sets up one of the sensor's binary outputs to send a single group. Sends
+ * the register write without waiting, collect it with VN200CmdWait or
+ * VN200CmdWaitAll.
+ *
+ * Arguments:
+ * 	dev    - Pointer to initialized VN200_DEV instance
+ * 	output - Binary output number, 1 through VN200_BINARY_NUM_OUTPUTS
+ * 	rateHz - Packets per second (see VN200BinaryOutputValue)
+ * 	group  - One VN200_BINARY_GROUP_* value
+ * 	fields - Mask of fields to send from the group
+ *
+ * Return value:
+ *	On success, returns a handle for VN200CmdWait
+ *	On failure, returns a negative number
+ */
+int VN200BinaryConfigure(VN200_DEV *dev, int output, int rateHz, int group, uint16_t fields) {
+
+    char value[VN200_CMD_REPLY_LEN];
+
+    if (dev == NULL || output < 1 || output > VN200_BINARY_NUM_OUTPUTS ||
+            VN200BinaryOutputValue(rateHz, group, fields, value, sizeof(value)) != 0) {
+        return -1;
+    }
+
+    return VN200CmdWrite(dev, VN200_BINARY_REG_BASE + output, value, VN200_CMD_TIMEOUT_MS);
+
+} // VN200BinaryConfigure(VN200_DEV *, int, int, int, uint16_t)
+
+
+// Little-endian field readers. Byte by byte, so neither alignment nor host
+// byte order matter.
+static inline uint16_t vn200U16(const unsigned char *p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static inline uint32_t vn200U32(const unsigned char *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+        ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline uint64_t vn200U64(const unsigned char *p) {
+    return (uint64_t) vn200U32(p) | ((uint64_t) vn200U32(p + 4) << 32);
+}
+
+static inline float vn200Float(const unsigned char *p) {
+    uint32_t bits = vn200U32(p);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static inline double vn200Double(const unsigned char *p) {
+    uint64_t bits = vn200U64(p);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static inline void vn200Vec3(const unsigned char *p, double *dest) {
+    dest[0] = vn200Float(p);
+    dest[1] = vn200Float(p + 4);
+    dest[2] = vn200Float(p + 8);
+}
+
+
+/**** Function vn200DecodeField ****
+ *
+ * Stores one field in IMU_DATA or GPS_DATA if it has a place there
+ *
+ * Arguments:
+ * 	group - Group index
+ * 	bit   - Field bit within the group
+ * 	p     - Pointer to the field's payload
+ * 	imu   - IMU data to fill in (may be NULL)
+ * 	gps   - GPS data to fill in (may be NULL)
+ *
+ * Return value:
+ *	Returns VN200_BINARY_HAS_IMU or VN200_BINARY_HAS_GPS for the data the
+ *	field went into, or 0 if it was skipped
+ */
+static int vn200DecodeField(int group, int bit, const unsigned char *p,
+        IMU_DATA *imu, GPS_DATA *gps) {
+
+    double vec[3];
+
+    if (group == 0 && imu != NULL) {
+
+        // Common group
+        switch (bit) {
+            case 5: // AngularRate
+                vn200Vec3(p, imu->gyro);
+                return VN200_BINARY_HAS_IMU;
+            case 8: // Accel
+                vn200Vec3(p, imu->accel);
+                return VN200_BINARY_HAS_IMU;
+            case 10: // MagPres
+                vn200Vec3(p, imu->compass);
+                imu->temp = vn200Float(p + 12);
+                imu->baro = vn200Float(p + 16);
+                return VN200_BINARY_HAS_IMU;
+        }
+
+    } else if (group == 2 && imu != NULL) {
+
+        // IMU group
+        switch (bit) {
+            case 4: // Temp
+                imu->temp = vn200Float(p);
+                return VN200_BINARY_HAS_IMU;
+            case 5: // Pres
+                imu->baro = vn200Float(p);
+                return VN200_BINARY_HAS_IMU;
+            case 8: // Mag
+                vn200Vec3(p, imu->compass);
+                return VN200_BINARY_HAS_IMU;
+            case 9: // Accel
+                vn200Vec3(p, imu->accel);
+                return VN200_BINARY_HAS_IMU;
+            case 10: // AngularRate
+                vn200Vec3(p, imu->gyro);
+                return VN200_BINARY_HAS_IMU;
+        }
+
+    } else if (group == 3 && gps != NULL) {
+
+        // GPS group
+        switch (bit) {
+            case 1: // Tow, nanoseconds
+                gps->time = (double) vn200U64(p) * 1e-9;
+                return VN200_BINARY_HAS_GPS;
+            case 2: // Week
+                gps->week = vn200U16(p);
+                return VN200_BINARY_HAS_GPS;
+            case 3: // NumSats
+                gps->NumSats = p[0];
+                return VN200_BINARY_HAS_GPS;
+            case 4: // Fix
+                gps->GpsFix = p[0];
+                return VN200_BINARY_HAS_GPS;
+            case 6: // PosEcef
+                gps->PosX = vn200Double(p);
+                gps->PosY = vn200Double(p + 8);
+                gps->PosZ = vn200Double(p + 16);
+                return VN200_BINARY_HAS_GPS;
+            case 8: // VelEcef
+                vn200Vec3(p, vec);
+                gps->VelX = vec[0];
+                gps->VelY = vec[1];
+                gps->VelZ = vec[2];
+                return VN200_BINARY_HAS_GPS;
+            case 9: // PosU
+                vn200Vec3(p, vec);
+                gps->PosAccX = vec[0];
+                gps->PosAccY = vec[1];
+                gps->PosAccZ = vec[2];
+                return VN200_BINARY_HAS_GPS;
+            case 10: // VelU
+                gps->SpeedAcc = vn200Float(p);
+                return VN200_BINARY_HAS_GPS;
+            case 11: // TimeU
+                gps->TimeAcc = vn200Float(p);
+                return VN200_BINARY_HAS_GPS;
+        }
+    }
+
+    return 0;
+
+} // vn200DecodeField(int, int, const unsigned char *, IMU_DATA *, GPS_DATA *)
+
+
+/**** Function VN200BinaryDecode ****
+ *
+ * Checks the CRC of one complete binary packet and decodes its fields.
+ * Fields with no place in IMU_DATA or GPS_DATA are skipped.
+ *
+ * Arguments:
+ * 	packet - Pointer to the packet, starting with the sync byte
+ * 	length - Length of the packet, CRC included
+ * 	imu    - IMU data to fill in (may be NULL)
+ * 	gps    - GPS data to fill in (may be NULL)
+ *
+ * Return value:
+ *	On success, returns VN200_BINARY_HAS_* flags for the data filled in
+ *	If the packet is malformed, returns -1
+ *	If the CRC does not match, returns -2
+ */
+int VN200BinaryDecode(const unsigned char *packet, int length, IMU_DATA *imu, GPS_DATA *gps) {
+
+    uint16_t fields[VN200_BINARY_NUM_GROUPS];
+    unsigned int remaining;
+    int groups, group, bit, numGroups = 0, offset, found = 0;
+
+    if (packet == NULL || length < 6 || packet[0] != VN200_BINARY_SYNC) {
+        return -1;
+    }
+
+    groups = packet[1];
+    offset = 2;
+    for (group = 0; group < VN200_BINARY_NUM_GROUPS; group++) {
+        if ((groups & (1 << group)) && offset + 2 <= length) {
+            fields[numGroups++] = vn200U16(&packet[offset]);
+            offset += 2;
+        }
+    }
+
+    if (VN200BinaryPacketSize(groups, fields) != length) {
+        return -1;
+    }
+
+    if (VN200CalculateCRC((unsigned char *) &packet[1], length - 1) != 0) {
+        return -2;
+    }
+
+    numGroups = 0;
+    for (group = 0; group < VN200_BINARY_NUM_GROUPS; group++) {
+
+        if (!(groups & (1 << group))) {
+            continue;
+        }
+
+        remaining = fields[numGroups++];
+        while (remaining != 0) {
+            bit = __builtin_ctz(remaining);
+            remaining &= remaining - 1;
+            found |= vn200DecodeField(group, bit, &packet[offset], imu, gps);
+            offset += vn200FieldSize[group][bit];
+        }
+    }
+
+    return found;
+
+} // VN200BinaryDecode(const unsigned char *, int, IMU_DATA *, GPS_DATA *)
+
+
+/**** Function vn200BinaryLength ****
+ *
+ * Reads a packet header from the input buffer to find its length
+ *
+ * Arguments:
+ * 	dev   - Pointer to VN200_DEV instance
+ * 	start - Index of the sync byte in inbuf
+ *
+ * Return value:
+ *	On success, returns the packet length
+ *	If more bytes are needed to tell, returns 0
+ *	If the header is not a valid packet, returns a negative number
+ */
+static int vn200BinaryLength(VN200_DEV *dev, int start) {
+
+    BYTE_BUFFER *inbuf = &(dev->inbuf);
+    uint16_t fields[VN200_BINARY_NUM_GROUPS];
+    int available = BufferLength(inbuf) - start;
+    int groups, group, numGroups = 0, offset = 2;
+
+    if (available < 2) {
+        return 0;
+    }
+
+    groups = BufferIndex(inbuf, start + 1);
+    if (groups == 0 || groups >= (1 << VN200_BINARY_NUM_GROUPS)) {
+        return -1;
+    }
+
+    for (group = 0; group < VN200_BINARY_NUM_GROUPS; group++) {
+        if (groups & (1 << group)) {
+            if (offset + 2 > available) {
+                return 0;
+            }
+            fields[numGroups++] = BufferIndex(inbuf, start + offset) |
+                (BufferIndex(inbuf, start + offset + 1) << 8);
+            offset += 2;
+        }
+    }
+
+    return VN200BinaryPacketSize(groups, fields);
+
+} // vn200BinaryLength(VN200_DEV *, int)
+
+
+/**** Function VN200BinaryParse ****
+ *
+ * Finds the next valid binary packet in the input buffer, decodes it, and
+ * consumes it along with anything before it. Bytes that cannot start a
+ * packet, and sync bytes whose packet fails the CRC, are skipped one at a
+ * time so a corrupted packet costs only itself. A packet that is still
+ * arriving is left in the buffer for the next call.
+ *
+ * ASCII replies in the buffer are skipped, so commands should be collected
+ * with VN200CmdWait before streaming resumes.
+ *
+ * Arguments:
+ * 	dev - Pointer to VN200_DEV instance to parse from
+ * 	imu - IMU data to fill in (may be NULL)
+ * 	gps - GPS data to fill in (may be NULL)
+ *
+ * Return value:
+ *	If a packet was decoded, returns VN200_BINARY_HAS_* flags for the data
+ *	filled in (0 if none of its fields had a place)
+ *	If no complete packet is waiting, returns -1
+ *	On failure, returns -2
+ */
+int VN200BinaryParse(VN200_DEV *dev, IMU_DATA *imu, GPS_DATA *gps) {
+
+    unsigned char scratch[VN200_BINARY_MAX_LEN], *packet;
+    int length, packetLen = 0, i = 0, rc = -1;
+    int64_t arrivalNs, sensorNs, hostNs;
+    double timestamp;
+
+    if (dev == NULL) {
+        return -2;
+    }
+
+    length = BufferLength(&(dev->inbuf));
+
+    while (i < length) {
+
+        if (BufferIndex(&(dev->inbuf), i) != VN200_BINARY_SYNC) {
+            i++;
+            continue;
+        }
+
+        packetLen = vn200BinaryLength(dev, i);
+        if (packetLen == 0 || (packetLen > 0 && i + packetLen > length)) {
+            // Wait for the rest
+            break;
+        }
+        if (packetLen < 0 || packetLen > VN200_BINARY_MAX_LEN) {
+            i++;
+            continue;
+        }
+
+        // Checked and decoded where it lies, unless it wraps
+        if (BufferSegment(&(dev->inbuf), i, packetLen, &packet) != packetLen) {
+            BufferCopy(&(dev->inbuf), scratch, i, packetLen);
+            dev->binary.numCopied += packetLen;
+            packet = scratch;
+        }
+        rc = VN200BinaryDecode(packet, packetLen, imu, gps);
+        if (rc < 0) {
+            dev->binary.numCrcErrors++;
+            logDebug(L_DEBUG, "VN200 binary packet failed CRC\n");
+            rc = -1;
+            i++;
+            continue;
+        }
+
+        // Stamped with when the packet started arriving, or for GPS from
+        // the clock model it updates
+        arrivalNs = VN200ByteTimeNs(dev, i);
+        hostNs = arrivalNs;
+        if ((rc & VN200_BINARY_HAS_GPS) && gps != NULL) {
+            sensorNs = VN200ClockGpsToNs(gps->time, gps->week);
+            if (sensorNs >= 0 && arrivalNs >= 0) {
+                VN200ClockUpdate(&(dev->clock), sensorNs, arrivalNs);
+            }
+            if (sensorNs >= 0 && VN200ClockIsLocked(&(dev->clock))) {
+                hostNs = VN200ClockToHostNs(&(dev->clock), sensorNs);
+            }
+        }
+        if (hostNs >= 0) {
+            timestamp = (double) hostNs / NSEC_PER_SEC;
+        } else {
+            getTimestamp(NULL, &timestamp);
+        }
+        if ((rc & VN200_BINARY_HAS_IMU) && imu != NULL) {
+            imu->timestamp = (arrivalNs >= 0) ? (double) arrivalNs / NSEC_PER_SEC : timestamp;
+        }
+        if ((rc & VN200_BINARY_HAS_GPS) && gps != NULL) {
+            gps->timestamp = timestamp;
+        }
+
+        dev->binary.numPackets++;
+        if (rc != 0) {
+            VN200MarkSample(dev, arrivalNs);
+        }
+        break;
+    }
+
+    dev->binary.numSkipped += i;
+    if (rc >= 0) {
+        i += packetLen;
+    }
+    VN200Consume(dev, i);
+
+    return rc;
+
+} // VN200BinaryParse(VN200_DEV *, IMU_DATA *, GPS_DATA *)
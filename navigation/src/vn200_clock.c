@@ -0,0 +1,317 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_clock.c
+ *
+ * Description:
+ *	Maps VN200 GPS time (week and time of week) to host CLOCK_MONOTONIC
+ *	time so samples can be fused with data timestamped on the host.
+ *
+ *	Each sample that carries GPS time is an observation: the time it
+ *	carries, and when its first byte reached the host. The arrival time
+ *	comes from when the UART chunk was read, less a character time for
+ *	each byte after it (VN200ByteTimeNs), so it does not depend on when
+ *	the sample is parsed. The model is a line, host time = reference +
+ *	(1 + drift) * sensor time since the reference, and a second order
+ *	loop pulls the offset and drift toward each observation.
+ *
+ *	Arrival is only ever delayed (scheduling, reads that wait for more
+ *	bytes, a GPS solution going out with a later output), so residuals are
+ *	clipped to a few times their running spread, late ones count for less
+ *	than early ones, and far off ones are rejected. The mapping follows the
+ *	earliest arrivals, which is the host time a sample with that GPS time
+ *	would reach the host with no delay. A constant output latency in the
+ *	sensor is part of the offset, the same as for samples stamped by their
+ *	arrival time alone.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "debuglog.h"
+#include "timing.h"
+
+#include "vn200_clock.h"
+
+
+/**** Function VN200ClockReset ****
+ *
+ * Discards the model so the next observation starts it over. Statistics are
+ * kept.
+ *
+ * Arguments:
+ * 	clock - Pointer to VN200_CLOCK instance
+ */
+void VN200ClockReset(VN200_CLOCK *clock) {
+
+    if (clock == NULL) {
+        return;
+    }
+
+    clock->numUpdates = 0;
+    clock->refSensorNs = 0;
+    clock->refHostNs = 0;
+    clock->drift = 0;
+    clock->scaleNs = VN200_CLOCK_INIT_SCALE_NS;
+    clock->numOutliersInRow = 0;
+    clock->lastResidualNs = 0;
+
+} // VN200ClockReset(VN200_CLOCK *)
+
+
+/**** Function VN200ClockGpsToNs ****
+ *
+ * Arguments:
+ * 	timeOfWeek - GPS time of week in seconds
+ * 	week       - GPS week
+ *
+ * Return value:
+ *	Returns nanoseconds since the start of GPS time, or a negative number
+ *	if the time is not valid
+ */
+int64_t VN200ClockGpsToNs(double timeOfWeek, int week) {
+
+    if (week <= 0 || timeOfWeek < 0 || timeOfWeek >= VN200_CLOCK_WEEK_SEC) {
+        return -1;
+    }
+
+    return (int64_t) week * VN200_CLOCK_WEEK_SEC * NSEC_PER_SEC + (int64_t) (timeOfWeek * NSEC_PER_SEC + 0.5);
+
+} // VN200ClockGpsToNs(double, int)
+
+
+// Limits value to [-limit, limit]
+static inline double vn200Clamp(double value, double limit) {
+
+    if (value > limit) {
+        return limit;
+    } else if (value < -limit) {
+        return -limit;
+    }
+
+    return value;
+
+}
+
+
+// Makes an observation the reference point of a new model
+static void vn200ClockStart(VN200_CLOCK *clock, int64_t sensorNs, int64_t arrivalNs) {
+
+    VN200ClockReset(clock);
+    clock->refSensorNs = sensorNs;
+    clock->refHostNs = arrivalNs;
+    clock->numUpdates = 1;
+
+}
+
+
+/**** Function VN200ClockUpdate ****
+ *
+ * Adds an observation of a sample's GPS time and the host time its first
+ * byte arrived
+ *
+ * Arguments:
+ * 	clock     - Pointer to VN200_CLOCK instance
+ * 	sensorNs  - GPS time of the sample from VN200ClockGpsToNs
+ * 	arrivalNs - CLOCK_MONOTONIC time the sample's first byte arrived
+ *
+ * Return value:
+ *	If the observation was used, returns 0
+ *	If it repeats the last GPS time or was rejected, returns 1
+ *	On failure, returns a negative number
+ */
+int VN200ClockUpdate(VN200_CLOCK *clock, int64_t sensorNs, int64_t arrivalNs) {
+
+    int64_t elapsedNs, predictedNs;
+    double residual, applied, limit;
+
+    if (clock == NULL || sensorNs < 0 || arrivalNs < 0) {
+        return -1;
+    }
+
+    if (clock->numUpdates == 0) {
+        vn200ClockStart(clock, sensorNs, arrivalNs);
+        return 0;
+    }
+
+    elapsedNs = sensorNs - clock->refSensorNs;
+
+    // Outputs faster than the GPS rate repeat the last solution, and only
+    // its first arrival says anything about when it was computed
+    if (elapsedNs == 0) {
+        return 1;
+    }
+
+    // A step in GPS time (restart, new fix) or a long silence
+    if (elapsedNs < 0 || elapsedNs > VN200_CLOCK_MAX_GAP_NS) {
+        logDebug(L_DEBUG, "VN200 clock: GPS time stepped %.3f s, starting over\n",
+                (double) elapsedNs / NSEC_PER_SEC);
+        clock->numResets++;
+        vn200ClockStart(clock, sensorNs, arrivalNs);
+        return 0;
+    }
+
+    predictedNs = clock->refHostNs + elapsedNs + (int64_t) (clock->drift * elapsedNs);
+    residual = (double) (arrivalNs - predictedNs);
+    clock->lastResidualNs = residual;
+
+    limit = VN200_CLOCK_OUTLIER_SCALE * clock->scaleNs;
+
+    // Once the model has settled, far off observations are delays (or a
+    // host clock step, if they keep coming)
+    if (clock->numUpdates >= VN200_CLOCK_MIN_UPDATES &&
+            (residual > limit || residual < -limit)) {
+
+        clock->numOutliers++;
+        if (++(clock->numOutliersInRow) >= VN200_CLOCK_MAX_OUTLIERS) {
+            logDebug(L_INFO, "VN200 clock: %d observations off by %.3f ms, starting over\n",
+                    clock->numOutliersInRow, residual / NSEC_PER_MSEC);
+            clock->numResets++;
+            vn200ClockStart(clock, sensorNs, arrivalNs);
+            return 0;
+        }
+        return 1;
+    }
+    clock->numOutliersInRow = 0;
+
+    limit = VN200_CLOCK_CLIP_SCALE * clock->scaleNs;
+    applied = vn200Clamp(residual, limit);
+
+    clock->scaleNs += 0.05 * ((applied < 0 ? -applied : applied) - clock->scaleNs);
+    if (clock->scaleNs < VN200_CLOCK_MIN_SCALE_NS) {
+        clock->scaleNs = VN200_CLOCK_MIN_SCALE_NS;
+    }
+
+    if (applied > 0) {
+        applied *= VN200_CLOCK_LATE_WEIGHT;
+    }
+
+    clock->refSensorNs = sensorNs;
+    clock->refHostNs = predictedNs + (int64_t) (VN200_CLOCK_GAIN_OFFSET * applied);
+    clock->drift += VN200_CLOCK_GAIN_DRIFT * applied / elapsedNs;
+    clock->drift = vn200Clamp(clock->drift, VN200_CLOCK_MAX_DRIFT);
+    clock->numUpdates++;
+
+    return 0;
+
+} // VN200ClockUpdate(VN200_CLOCK *, int64_t, int64_t)
+
+
+/**** Function VN200ClockIsLocked ****
+ *
+ * Return value:
+ *	Returns true if enough observations have been used for the mapping to
+ *	be trusted
+ */
+int VN200ClockIsLocked(const VN200_CLOCK *clock) {
+
+    return clock != NULL && clock->numUpdates >= VN200_CLOCK_MIN_UPDATES;
+
+} // VN200ClockIsLocked(const VN200_CLOCK *)
+
+
+/**** Function VN200ClockToHostNs ****
+ *
+ * Arguments:
+ * 	clock    - Pointer to VN200_CLOCK instance
+ * 	sensorNs - GPS time from VN200ClockGpsToNs
+ *
+ * Return value:
+ *	Returns the CLOCK_MONOTONIC time for a GPS time
+ *	If there have been no observations, returns a negative number
+ */
+int64_t VN200ClockToHostNs(const VN200_CLOCK *clock, int64_t sensorNs) {
+
+    int64_t elapsedNs;
+
+    if (clock == NULL || clock->numUpdates == 0 || sensorNs < 0) {
+        return -1;
+    }
+
+    elapsedNs = sensorNs - clock->refSensorNs;
+
+    return clock->refHostNs + elapsedNs + (int64_t) (clock->drift * elapsedNs);
+
+} // VN200ClockToHostNs(const VN200_CLOCK *, int64_t)
+
+
+/**** Function VN200ClockStamp ****
+ *
+ * Sets the timestamp of a parsed sample, in CLOCK_MONOTONIC seconds. Samples
+ * with GPS time update the model and, once it is locked, are stamped from
+ * it. Samples without are stamped with the arrival of their first byte.
+ *
+ * Arguments:
+ * 	clock     - Pointer to VN200_CLOCK instance
+ * 	arrivalNs - CLOCK_MONOTONIC time the packet's first byte arrived, or a
+ * 	            negative number if not known
+ * 	packet    - Packet from VN200PacketParse
+ *
+ * Return value:
+ *	If the sample was stamped, returns 0
+ *	If the packet is not a sample or no time is known, returns a negative
+ *	number
+ */
+int VN200ClockStamp(VN200_CLOCK *clock, int64_t arrivalNs, VN200_PACKET *packet) {
+
+    double *timestamp;
+    int64_t sensorNs = -1, hostNs = arrivalNs;
+
+    if (clock == NULL || packet == NULL) {
+        return -1;
+    }
+
+    switch (packet->type) {
+        case VN200_PACKET_IMU:
+            timestamp = &(packet->data.imu.timestamp);
+            break;
+        case VN200_PACKET_YMR:
+            timestamp = &(packet->data.ymr.timestamp);
+            break;
+        case VN200_PACKET_QMR:
+            timestamp = &(packet->data.qmr.timestamp);
+            break;
+        case VN200_PACKET_GPS:
+            timestamp = &(packet->data.gps.timestamp);
+            sensorNs = VN200ClockGpsToNs(packet->data.gps.time, packet->data.gps.week);
+            break;
+        case VN200_PACKET_GPE:
+            timestamp = &(packet->data.gpe.timestamp);
+            sensorNs = VN200ClockGpsToNs(packet->data.gpe.time, packet->data.gpe.week);
+            break;
+        case VN200_PACKET_INS:
+            timestamp = &(packet->data.ins.timestamp);
+            sensorNs = VN200ClockGpsToNs(packet->data.ins.time, packet->data.ins.week);
+            break;
+        default:
+            return -1;
+    }
+
+    // Before the first fix the GPS time is not valid
+    if (sensorNs >= 0) {
+        if (arrivalNs >= 0) {
+            VN200ClockUpdate(clock, sensorNs, arrivalNs);
+        }
+        if (VN200ClockIsLocked(clock)) {
+            hostNs = VN200ClockToHostNs(clock, sensorNs);
+        }
+    }
+
+    if (hostNs < 0) {
+        return -1;
+    }
+
+    *timestamp = (double) hostNs / NSEC_PER_SEC;
+
+    return 0;
+
+} // VN200ClockStamp(VN200_CLOCK *, int64_t, VN200_PACKET *)
@@ -0,0 +1,477 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_cmd.c
+ *
+ * Description:
+ *	Command/response engine for VN200 register reads and writes. Commands
+ *	are sent without waiting, so independent ones can be pipelined, and
+ *	each is completed by the matching $VNRRG/$VNWRG reply (by register id)
+ *	or $VNERR as soon as it arrives, or by its own timeout.
+ *
+ *	The sensor answers commands in the order they were received, so a
+ *	reply completes the oldest pending command with the same type and
+ *	register, and an error completes the oldest pending command.
+ *
+ *	Replies are taken from the device input buffer. Anything else in the
+ *	buffer while commands are serviced (asynchronous output) is discarded.
+ * 
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Replies recognized through the packet dispatch table
+ *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Write settings (VNWNV) command
+ *
+ * Revision 0.4
+ * 	Last edited 10/18/2026
+ * 	Replies framed by the shared sentence framer
+ *
+ * Revision 0.5
+ * 	Last edited 10/18/2026
+ * 	Replies parsed in place in the input buffer
+ *
+ * Revision 0.6
+ * 	Last edited 10/18/2026
+ * 	No blocking wait once a deadline has passed
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "debuglog.h"
+#include "timing.h"
+#include "vn200.h"
+#include "vn200_packet.h"
+#include "vn200_framer.h"
+
+#include "vn200_cmd.h"
+
+// Longest sentence body examined for a reply
+#define VN200_SENTENCE_LEN 256
+
+
+/**** Function vn200CmdStart ****
+ *
+ * Takes a free command slot and sends a command
+ *
+ * Arguments: 
+ * 	dev        - Pointer to initialized VN200_DEV instance
+ * 	isWrite    - Kind of reply expected
+ * 	reg        - Register id the reply carries
+ * 	command    - Sentence body, without the '$' or checksum
+ * 	commandLen - Length of command
+ * 	timeoutMs  - Milliseconds to wait for the reply
+ *
+ * Return value:
+ *	On success, returns a handle for VN200CmdWait
+ *	On failure, returns a negative number
+ */
+static int vn200CmdStart(VN200_DEV *dev, int isWrite, int reg, const char *command,
+        int commandLen, int timeoutMs) {
+
+    int handle;
+    VN200_CMD *cmd;
+
+    for (handle = 0; handle < VN200_CMD_MAX_PENDING; handle++) {
+        if (dev->commands[handle].status == VN200_CMD_FREE) {
+            break;
+        }
+    }
+
+    if (handle == VN200_CMD_MAX_PENDING) {
+        logDebug(L_INFO, "VN200CmdSend: Too many commands outstanding\n");
+        return -2;
+    }
+
+    cmd = &(dev->commands[handle]);
+    memset(cmd, 0, sizeof(VN200_CMD));
+    cmd->status = VN200_CMD_PENDING;
+    cmd->isWrite = isWrite;
+    cmd->reg = reg;
+    cmd->order = dev->cmdOrder++;
+    cmd->sentNs = TimeMonotonicNs();
+    cmd->deadlineNs = cmd->sentNs + (int64_t) timeoutMs * NSEC_PER_MSEC;
+
+    if (VN200Command(dev, (char *) command, commandLen, 1) <= 0) {
+        cmd->status = VN200_CMD_FREE;
+        return -3;
+    }
+
+    return handle;
+
+} // vn200CmdStart(VN200_DEV *, int, int, const char *, int, int)
+
+
+/**** Function VN200CmdSend ****
+ *
+ * Sends a register read or write without waiting for the reply
+ *
+ * Arguments: 
+ * 	dev       - Pointer to initialized VN200_DEV instance
+ * 	isWrite   - True for VNWRG, false for VNRRG
+ * 	reg       - Register id
+ * 	value     - Value fields to write (ignored for reads)
+ * 	timeoutMs - Milliseconds to wait for the reply
+ *
+ * Return value:
+ *	On success, returns a handle for VN200CmdWait
+ *	On failure, returns a negative number
+ */
+int VN200CmdSend(VN200_DEV *dev, int isWrite, int reg, const char *value, int timeoutMs) {
+
+    char command[VN200_CMD_REPLY_LEN];
+    int commandLen;
+
+    if (dev == NULL || reg < 0 || (isWrite && value == NULL)) {
+        return VN200_CMD_ERR_ARGS;
+    }
+
+    if (isWrite) {
+        commandLen = snprintf(command, sizeof(command), "VNWRG,%02d,%s", reg, value);
+    } else {
+        commandLen = snprintf(command, sizeof(command), "VNRRG,%02d", reg);
+    }
+
+    return vn200CmdStart(dev, isWrite, reg, command, commandLen, timeoutMs);
+
+} // VN200CmdSend(VN200_DEV *, int, int, const char *, int)
+
+
+/**** Function VN200CmdWriteSettings ****
+ *
+ * Sends a write settings command (VNWNV) without waiting for the reply. The
+ * sensor saves its current configuration to non-volatile memory, so it
+ * starts up with it after a power cycle. Saving takes much longer than a
+ * register write (see VN200_CMD_SETTINGS_TIMEOUT_MS).
+ *
+ * Arguments: 
+ * 	dev       - Pointer to initialized VN200_DEV instance
+ * 	timeoutMs - Milliseconds to wait for the reply
+ *
+ * Return value:
+ *	On success, returns a handle for VN200CmdWait
+ *	On failure, returns a negative number
+ */
+int VN200CmdWriteSettings(VN200_DEV *dev, int timeoutMs) {
+
+    if (dev == NULL) {
+        return VN200_CMD_ERR_ARGS;
+    }
+
+    return vn200CmdStart(dev, 1, VN200_CMD_REG_SETTINGS, "VNWNV", VN200_PACKET_ID_LEN, timeoutMs);
+
+} // VN200CmdWriteSettings(VN200_DEV *, int)
+
+
+/**** Function VN200CmdRead ****
+ *
+ * Sends a register read (see VN200CmdSend)
+ */
+int VN200CmdRead(VN200_DEV *dev, int reg, int timeoutMs) {
+
+    return VN200CmdSend(dev, 0, reg, NULL, timeoutMs);
+
+} // VN200CmdRead(VN200_DEV *, int, int)
+
+
+/**** Function VN200CmdWrite ****
+ *
+ * Sends a register write (see VN200CmdSend)
+ */
+int VN200CmdWrite(VN200_DEV *dev, int reg, const char *value, int timeoutMs) {
+
+    return VN200CmdSend(dev, 1, reg, value, timeoutMs);
+
+} // VN200CmdWrite(VN200_DEV *, int, const char *, int)
+
+
+/**** Function vn200CmdOldest ****
+ *
+ * Finds the oldest pending command, optionally with a given type and register
+ *
+ * Arguments: 
+ * 	dev     - Pointer to VN200_DEV instance
+ * 	isWrite - Command type to match (-1 for any)
+ * 	reg     - Register to match (-1 for any)
+ *
+ * Return value:
+ *	Returns pointer to the command, or NULL if none match
+ */
+static VN200_CMD *vn200CmdOldest(VN200_DEV *dev, int isWrite, int reg) {
+
+    VN200_CMD *cmd, *oldest = NULL;
+    int i;
+
+    for (i = 0; i < VN200_CMD_MAX_PENDING; i++) {
+
+        cmd = &(dev->commands[i]);
+        if (cmd->status != VN200_CMD_PENDING ||
+                (isWrite >= 0 && cmd->isWrite != isWrite) ||
+                (reg != -1 && cmd->reg != reg)) {
+            continue;
+        }
+
+        // Order numbers wrap, so compare by difference
+        if (oldest == NULL || (int32_t) (cmd->order - oldest->order) < 0) {
+            oldest = cmd;
+        }
+    }
+
+    return oldest;
+
+} // vn200CmdOldest(VN200_DEV *, int, int)
+
+
+/**** Function vn200CmdDispatch ****
+ *
+ * Completes the command a checksummed sentence answers, if any
+ *
+ * Arguments: 
+ * 	dev     - Pointer to VN200_DEV instance
+ * 	body    - Sentence between '$' and '*', not terminated
+ * 	bodyLen - Length of body
+ */
+static void vn200CmdDispatch(VN200_DEV *dev, unsigned char *body, int bodyLen) {
+
+    VN200_CMD *cmd;
+    VN200_PACKET packet;
+    int type, isWrite;
+
+    // The write settings reply is the bare id, which the table does not hold
+    if (bodyLen == VN200_PACKET_ID_LEN && memcmp(body, "VNWNV", VN200_PACKET_ID_LEN) == 0) {
+        cmd = vn200CmdOldest(dev, 1, VN200_CMD_REG_SETTINGS);
+        if (cmd != NULL) {
+            cmd->status = VN200_CMD_DONE;
+            cmd->doneNs = TimeMonotonicNs();
+            logDebug(L_DEBUG, "VN200 settings saved in %.1f ms\n",
+                    (double) (cmd->doneNs - cmd->sentNs) / NSEC_PER_MSEC);
+        }
+        return;
+    }
+
+    // Asynchronous output is told apart by its id alone, without parsing
+    type = VN200PacketLookup(body, bodyLen);
+    if (type != VN200_PACKET_WRG && type != VN200_PACKET_RRG && type != VN200_PACKET_ERR) {
+        return;
+    }
+
+    if (VN200PacketParse(body, bodyLen, &packet) < 0) {
+        return;
+    }
+
+    if (type == VN200_PACKET_ERR) {
+
+        cmd = vn200CmdOldest(dev, -1, -1);
+        if (cmd != NULL) {
+            cmd->status = VN200_CMD_ERROR;
+            cmd->errorCode = packet.data.err.code;
+            cmd->doneNs = TimeMonotonicNs();
+            logDebug(L_INFO, "VN200 rejected %s of register %d: error %d\n",
+                    cmd->isWrite ? "write" : "read", cmd->reg, packet.data.err.code);
+        }
+        return;
+    }
+
+    isWrite = (type == VN200_PACKET_WRG);
+    cmd = vn200CmdOldest(dev, isWrite, packet.data.reg.reg);
+    if (cmd == NULL) {
+        logDebug(L_DEBUG, "VN200 reply with no command waiting: %.*s\n", bodyLen, body);
+        return;
+    }
+
+    // Keep only the value fields after the register id
+    snprintf(cmd->reply, VN200_CMD_REPLY_LEN, "%s", packet.data.reg.value);
+
+    cmd->status = VN200_CMD_DONE;
+    cmd->doneNs = TimeMonotonicNs();
+    logDebug(L_DEBUG, "VN200 register %d %s in %.1f ms\n", cmd->reg, isWrite ? "written" : "read",
+            (double) (cmd->doneNs - cmd->sentNs) / NSEC_PER_MSEC);
+
+} // vn200CmdDispatch(VN200_DEV *, unsigned char *, int)
+
+
+/**** Function vn200CmdScan ****
+ *
+ * Frames every complete sentence in the input buffer and dispatches each
+ * one. The framer checks the checksums and consumes what it has examined,
+ * keeping a partial sentence at the end for the next call.
+ *
+ * Arguments: 
+ * 	dev - Pointer to VN200_DEV instance
+ */
+static void vn200CmdScan(VN200_DEV *dev) {
+
+    VN200_PACKET_VIEW view;
+    unsigned char scratch[VN200_FRAME_MAX_LEN], *body;
+
+    while (VN200FrameNext(dev, &view) > 0) {
+
+        // Parsed where it lies in the ring, copied only if it wraps
+        body = VN200FrameBody(dev, &view, scratch, sizeof(scratch));
+        if (body != NULL) {
+            vn200CmdDispatch(dev, body, view.bodyLen);
+        }
+    }
+
+} // vn200CmdScan(VN200_DEV *)
+
+
+/**** Function VN200CmdService ****
+ *
+ * Reads any replies that have arrived, completes the matching commands, and
+ * expires commands past their timeout
+ *
+ * Arguments: 
+ * 	dev    - Pointer to initialized VN200_DEV instance
+ * 	waitMs - Longest time to wait for data (limited by the nearest timeout)
+ *
+ * Return value:
+ *	On success, returns number of commands still pending
+ *	On failure, returns a negative number
+ */
+int VN200CmdService(VN200_DEV *dev, int waitMs) {
+
+    VN200_CMD *cmd;
+    int64_t now, nearest = -1;
+    int i, numPending = 0;
+
+    if (dev == NULL) {
+        return VN200_CMD_ERR_ARGS;
+    }
+
+    // Never sleep past the next deadline
+    now = TimeMonotonicNs();
+    for (i = 0; i < VN200_CMD_MAX_PENDING; i++) {
+        cmd = &(dev->commands[i]);
+        if (cmd->status == VN200_CMD_PENDING && (nearest < 0 || cmd->deadlineNs < nearest)) {
+            nearest = cmd->deadlineNs;
+        }
+    }
+    if (nearest >= 0 && (nearest - now) / NSEC_PER_MSEC + 1 < waitMs) {
+        waitMs = (nearest - now) / NSEC_PER_MSEC + 1;
+    }
+
+    // A deadline already past only needs what has arrived. A negative wait
+    // would block the reader until data came.
+    if (waitMs < 0) {
+        waitMs = 0;
+    }
+
+    VN200PollWait(dev, waitMs);
+    vn200CmdScan(dev);
+
+    now = TimeMonotonicNs();
+    for (i = 0; i < VN200_CMD_MAX_PENDING; i++) {
+
+        cmd = &(dev->commands[i]);
+        if (cmd->status != VN200_CMD_PENDING) {
+            continue;
+        }
+
+        if (now > cmd->deadlineNs) {
+            cmd->status = VN200_CMD_TIMEOUT;
+            cmd->doneNs = now;
+            logDebug(L_INFO, "VN200 did not answer %s of register %d\n",
+                    cmd->isWrite ? "write" : "read", cmd->reg);
+            continue;
+        }
+
+        numPending++;
+    }
+
+    return numPending;
+
+} // VN200CmdService(VN200_DEV *, int)
+
+
+/**** Function VN200CmdWait ****
+ *
+ * Services the device until a command completes, then releases it
+ *
+ * Arguments: 
+ * 	dev      - Pointer to initialized VN200_DEV instance
+ * 	handle   - Handle returned by VN200CmdSend
+ * 	reply    - Buffer for the register value(s) in the reply (may be NULL)
+ * 	replyLen - Size of reply buffer
+ *
+ * Return value:
+ *	On success, returns 0
+ *	If the sensor rejected the command, returns VN200_CMD_ERR_SENSOR
+ *	If the sensor did not answer in time, returns VN200_CMD_ERR_TIMEOUT
+ *	On other failure, returns VN200_CMD_ERR_ARGS
+ */
+int VN200CmdWait(VN200_DEV *dev, int handle, char *reply, int replyLen) {
+
+    VN200_CMD *cmd;
+    int rc;
+
+    if (dev == NULL || handle < 0 || handle >= VN200_CMD_MAX_PENDING ||
+            dev->commands[handle].status == VN200_CMD_FREE) {
+        return VN200_CMD_ERR_ARGS;
+    }
+
+    cmd = &(dev->commands[handle]);
+    while (cmd->status == VN200_CMD_PENDING) {
+        VN200CmdService(dev, VN200_CMD_TIMEOUT_MS);
+    }
+
+    if (cmd->status == VN200_CMD_DONE) {
+        if (reply != NULL && replyLen > 0) {
+            snprintf(reply, replyLen, "%s", cmd->reply);
+        }
+        rc = 0;
+    } else if (cmd->status == VN200_CMD_ERROR) {
+        rc = VN200_CMD_ERR_SENSOR;
+    } else {
+        rc = VN200_CMD_ERR_TIMEOUT;
+    }
+
+    cmd->status = VN200_CMD_FREE;
+
+    return rc;
+
+} // VN200CmdWait(VN200_DEV *, int, char *, int)
+
+
+/**** Function VN200CmdWaitAll ****
+ *
+ * Services the device until every outstanding command completes, then
+ * releases them all
+ *
+ * Arguments: 
+ * 	dev - Pointer to initialized VN200_DEV instance
+ *
+ * Return value:
+ *	On success, returns number of commands that failed (0 if all succeeded)
+ *	On failure, returns a negative number
+ */
+int VN200CmdWaitAll(VN200_DEV *dev) {
+
+    int i, numFailed = 0;
+
+    if (dev == NULL) {
+        return VN200_CMD_ERR_ARGS;
+    }
+
+    for (i = 0; i < VN200_CMD_MAX_PENDING; i++) {
+        if (dev->commands[i].status != VN200_CMD_FREE &&
+                VN200CmdWait(dev, i, NULL, 0) != 0) {
+            numFailed++;
+        }
+    }
+
+    return numFailed;
+
+} // VN200CmdWaitAll(VN200_DEV *)
@@ -0,0 +1,280 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_config.c
+ *
+ * Description:
+ *	Brings the sensor's registers to a wanted configuration with as few
+ *	writes as possible. The registers are read back together (the reads
+ *	are pipelined, so the batch costs about one round trip), compared field
+ *	by field with the wanted values, and only those that differ are
+ *	written. The sensor keeps its registers across power cycles once they
+ *	are saved, so a sensor that was configured and saved before needs no
+ *	writes at all, and its output never stops.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "debuglog.h"
+#include "timing.h"
+#include "vn200_cmd.h"
+
+#include "vn200_config.h"
+
+
+/**** Function VN200ConfigReset ****
+ *
+ * Empties a configuration
+ *
+ * Arguments:
+ * 	config - Pointer to VN200_CONFIG instance
+ */
+void VN200ConfigReset(VN200_CONFIG *config) {
+
+    if (config == NULL) {
+        return;
+    }
+
+    memset(config, 0, sizeof(VN200_CONFIG));
+
+} // VN200ConfigReset(VN200_CONFIG *)
+
+
+/**** Function VN200ConfigSet ****
+ *
+ * Sets the value a register should hold. Registers are written in the order
+ * they are first set.
+ *
+ * Arguments:
+ * 	config - Pointer to VN200_CONFIG instance
+ * 	reg    - Register id
+ * 	value  - Value fields, as sent in a VNWRG command
+ *
+ * Return value:
+ *	On success, returns 0
+ *	On failure, returns a negative number
+ */
+int VN200ConfigSet(VN200_CONFIG *config, int reg, const char *value) {
+
+    VN200_CONFIG_REG *entry = NULL;
+    int i;
+
+    if (config == NULL || reg < 0 || value == NULL || strlen(value) >= VN200_CMD_REPLY_LEN) {
+        return -1;
+    }
+
+    for (i = 0; i < config->numRegs; i++) {
+        if (config->regs[i].reg == reg) {
+            entry = &(config->regs[i]);
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        if (config->numRegs >= VN200_CONFIG_MAX_REGS) {
+            logDebug(L_INFO, "VN200ConfigSet: More than %d registers\n", VN200_CONFIG_MAX_REGS);
+            return -2;
+        }
+        entry = &(config->regs[config->numRegs++]);
+    }
+
+    memset(entry, 0, sizeof(VN200_CONFIG_REG));
+    entry->reg = reg;
+    snprintf(entry->value, sizeof(entry->value), "%s", value);
+
+    return 0;
+
+} // VN200ConfigSet(VN200_CONFIG *, int, const char *)
+
+
+// Compares one field of each value, up to the next comma or the end
+static int vn200ConfigFieldEqual(const char *a, int aLen, const char *b, int bLen) {
+
+    char aBuf[VN200_CMD_REPLY_LEN], bBuf[VN200_CMD_REPLY_LEN], *aEnd, *bEnd;
+    double aValue, bValue;
+
+    if (aLen == bLen && memcmp(a, b, aLen) == 0) {
+        return 1;
+    }
+
+    if (aLen == 0 || bLen == 0 || aLen >= VN200_CMD_REPLY_LEN || bLen >= VN200_CMD_REPLY_LEN) {
+        return 0;
+    }
+
+    memcpy(aBuf, a, aLen);
+    aBuf[aLen] = '\0';
+    memcpy(bBuf, b, bLen);
+    bBuf[bLen] = '\0';
+
+    // Integers are written with or without leading zeros, and in hex for
+    // masks. Read as hex, "050" and "50" match and "0730" and "730" match,
+    // and no two different decimal strings do.
+    if (strtoul(aBuf, &aEnd, 16) == strtoul(bBuf, &bEnd, 16) && *aEnd == '\0' && *bEnd == '\0') {
+        return 1;
+    }
+
+    // Reals may come back with a different number of digits
+    aValue = strtod(aBuf, &aEnd);
+    bValue = strtod(bBuf, &bEnd);
+    if (*aEnd != '\0' || *bEnd != '\0') {
+        return 0;
+    }
+
+    return fabs(aValue - bValue) <= 1e-6 * fabs(aValue) + 1e-9;
+
+}
+
+
+/**** Function VN200ConfigValuesEqual ****
+ *
+ * Compares two register values field by field, so a value read back in
+ * the sensor's formatting matches the same value as written
+ *
+ * Arguments:
+ * 	a, b - Register values, comma separated fields
+ *
+ * Return value:
+ *	Returns true if every field holds the same number (or text)
+ */
+int VN200ConfigValuesEqual(const char *a, const char *b) {
+
+    const char *aEnd, *bEnd;
+
+    if (a == NULL || b == NULL) {
+        return 0;
+    }
+
+    while (1) {
+
+        aEnd = strchr(a, ',');
+        bEnd = strchr(b, ',');
+        if (aEnd == NULL) {
+            aEnd = a + strlen(a);
+        }
+        if (bEnd == NULL) {
+            bEnd = b + strlen(b);
+        }
+
+        if (!vn200ConfigFieldEqual(a, aEnd - a, b, bEnd - b)) {
+            return 0;
+        }
+
+        // Both must run out of fields together
+        if (*aEnd == '\0' || *bEnd == '\0') {
+            return *aEnd == *bEnd;
+        }
+
+        a = aEnd + 1;
+        b = bEnd + 1;
+    }
+
+} // VN200ConfigValuesEqual(const char *, const char *)
+
+
+/**** Function VN200ConfigApply ****
+ *
+ * Reads every register in the configuration, then writes those that differ
+ * from the wanted value. Registers that could not be read are written.
+ * Other commands may be in flight, their handles stay valid.
+ *
+ * Arguments:
+ * 	dev    - Pointer to initialized VN200_DEV instance at the sensor's rate
+ * 	config - Wanted register values, updated with what was found
+ * 	flags  - VN200_CONFIG_PERSIST to save the settings when any were
+ * 	         written
+ *
+ * Return value:
+ *	On success, returns the number of registers written
+ *	If any command failed, returns a negative number (the others still take
+ *	effect, see config->numFailed)
+ */
+int VN200ConfigApply(VN200_DEV *dev, VN200_CONFIG *config, int flags) {
+
+    int handles[VN200_CONFIG_MAX_REGS], saveHandle, i;
+    VN200_CONFIG_REG *entry;
+    int64_t startNs;
+
+    if (dev == NULL || config == NULL) {
+        return -1;
+    }
+
+    startNs = TimeMonotonicNs();
+    config->numRead = 0;
+    config->numWritten = 0;
+    config->numFailed = 0;
+    config->saved = 0;
+
+    // One batch of reads, collected together
+    for (i = 0; i < config->numRegs; i++) {
+        handles[i] = VN200CmdRead(dev, config->regs[i].reg, VN200_CMD_TIMEOUT_MS);
+    }
+    for (i = 0; i < config->numRegs; i++) {
+        entry = &(config->regs[i]);
+        entry->isCurrent = 0;
+        entry->current[0] = '\0';
+        if (handles[i] >= 0 &&
+                VN200CmdWait(dev, handles[i], entry->current, sizeof(entry->current)) == 0) {
+            config->numRead++;
+            entry->isCurrent = VN200ConfigValuesEqual(entry->current, entry->value);
+        }
+    }
+
+    // Then one batch of writes, for what differs. The sensor applies them in
+    // the order sent.
+    for (i = 0; i < config->numRegs; i++) {
+        entry = &(config->regs[i]);
+        handles[i] = -1;
+        if (!entry->isCurrent) {
+            logDebug(L_DEBUG, "VN200 register %d is %s, writing %s\n", entry->reg,
+                    entry->current[0] != '\0' ? entry->current : "unknown", entry->value);
+            handles[i] = VN200CmdWrite(dev, entry->reg, entry->value, VN200_CMD_TIMEOUT_MS);
+            if (handles[i] < 0) {
+                config->numFailed++;
+            }
+        }
+    }
+    for (i = 0; i < config->numRegs; i++) {
+        if (handles[i] < 0) {
+            continue;
+        }
+        if (VN200CmdWait(dev, handles[i], NULL, 0) == 0) {
+            config->regs[i].isCurrent = 1;
+            config->numWritten++;
+        } else {
+            config->numFailed++;
+        }
+    }
+
+    if ((flags & VN200_CONFIG_PERSIST) && config->numWritten > 0 && config->numFailed == 0) {
+        saveHandle = VN200CmdWriteSettings(dev, VN200_CMD_SETTINGS_TIMEOUT_MS);
+        if (VN200CmdWait(dev, saveHandle, NULL, 0) == 0) {
+            config->saved = 1;
+        } else {
+            config->numFailed++;
+        }
+    }
+
+    config->elapsedNs = TimeMonotonicNs() - startNs;
+    logDebug(L_INFO, "VN200 configuration: %d of %d registers written%s in %.1f ms\n",
+            config->numWritten, config->numRegs, config->saved ? " and saved" : "",
+            (double) config->elapsedNs / NSEC_PER_MSEC);
+
+    if (config->numFailed > 0) {
+        logDebug(L_INFO, "VN200 configuration: %d commands failed\n", config->numFailed);
+        return -2;
+    }
+
+    return config->numWritten;
+
+} // VN200ConfigApply(VN200_DEV *, VN200_CONFIG *, int)
@@ -0,0 +1,197 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_decim.c
+ *
+ * Description:
+ *	Reduces full-rate IMU output to angle and velocity increments at the
+ *	navigation rate, so the cost of everything after it does not grow with
+ *	the sensor's rate.
+ *
+ *	Keeping every Nth sample, or averaging the rates, loses motion: a body
+ *	that rotates about an axis that itself rotates (coning) or that
+ *	rotates while accelerating (sculling) turns and gains velocity in
+ *	ways the mean rates do not show. Each sample is taken as the mean rate
+ *	over its period, and its angle and velocity increments are summed with
+ *	the recursive coning and sculling corrections (Savage, Strapdown
+ *	Analytics, 7.1.1.1 and 7.2.2.2), which assume the rates change
+ *	linearly from one sample to the next. The rotation vector and velocity
+ *	change emitted for each interval are then what an attitude and
+ *	velocity update at the navigation rate needs.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "debuglog.h"
+
+#include "vn200_decim.h"
+
+
+/**** Function VN200DecimInit ****
+ *
+ * Sets up a decimator for an IMU rate and a navigation rate
+ *
+ * Arguments:
+ * 	decim      - Pointer to VN200_DECIM instance
+ * 	inputRate  - IMU samples per second
+ * 	outputRate - Increments per second, must divide inputRate
+ *
+ * Return value:
+ *	On success, returns 0
+ *	On failure, returns a negative number
+ */
+int VN200DecimInit(VN200_DECIM *decim, int inputRate, int outputRate) {
+
+    if (decim == NULL) {
+        return -1;
+    }
+
+    if (inputRate <= 0 || inputRate > VN200_DECIM_MAX_RATE || outputRate <= 0 ||
+            outputRate > inputRate || inputRate % outputRate != 0) {
+        logDebug(L_INFO, "VN200DecimInit: Cannot decimate %d Hz to %d Hz\n", inputRate, outputRate);
+        return -2;
+    }
+
+    memset(decim, 0, sizeof(VN200_DECIM));
+    decim->inputRate = inputRate;
+    decim->outputRate = outputRate;
+    decim->ratio = inputRate / outputRate;
+    decim->dt = 1.0 / inputRate;
+
+    return 0;
+
+} // VN200DecimInit(VN200_DECIM *, int, int)
+
+
+/**** Function VN200DecimReset ****
+ *
+ * Discards the interval in progress, after a gap in the samples. Statistics
+ * are kept.
+ *
+ * Arguments:
+ * 	decim - Pointer to VN200_DECIM instance
+ */
+void VN200DecimReset(VN200_DECIM *decim) {
+
+    int i;
+
+    if (decim == NULL) {
+        return;
+    }
+
+    decim->numSamples = 0;
+    for (i = 0; i < 3; i++) {
+        decim->alpha[i] = 0;
+        decim->upsilon[i] = 0;
+        decim->coning[i] = 0;
+        decim->sculling[i] = 0;
+        decim->lastAngle[i] = 0;
+        decim->lastVel[i] = 0;
+        decim->compass[i] = 0;
+    }
+    decim->temp = 0;
+    decim->baro = 0;
+
+} // VN200DecimReset(VN200_DECIM *)
+
+
+// Adds half of a x b to out
+static inline void vn200DecimHalfCross(const double *a, const double *b, double *out) {
+
+    out[0] += 0.5 * (a[1] * b[2] - a[2] * b[1]);
+    out[1] += 0.5 * (a[2] * b[0] - a[0] * b[2]);
+    out[2] += 0.5 * (a[0] * b[1] - a[1] * b[0]);
+
+}
+
+
+/**** Function VN200DecimAdd ****
+ *
+ * Takes in one IMU sample, and emits the increments for the interval when
+ * it is the last sample of one
+ *
+ * Arguments:
+ * 	decim - Pointer to initialized VN200_DECIM instance
+ * 	imu   - Sample at the IMU rate
+ * 	delta - Filled in when an interval is complete
+ *
+ * Return value:
+ *	Returns 1 if delta was filled in, 0 if the interval goes on
+ *	On failure, returns a negative number
+ */
+int VN200DecimAdd(VN200_DECIM *decim, const IMU_DATA *imu, VN200_DELTA *delta) {
+
+    double angle[3], vel[3], angleTerm[3], velTerm[3], rotation[3] = {0, 0, 0}, scale;
+    int i;
+
+    if (decim == NULL || imu == NULL || delta == NULL || decim->ratio <= 0) {
+        return -1;
+    }
+
+    for (i = 0; i < 3; i++) {
+        angle[i] = imu->gyro[i] * decim->dt;
+        vel[i] = imu->accel[i] * decim->dt;
+        angleTerm[i] = decim->alpha[i] + decim->lastAngle[i] * (1.0 / 6);
+        velTerm[i] = decim->upsilon[i] + decim->lastVel[i] * (1.0 / 6);
+    }
+
+    // Corrections use the sums before this sample
+    vn200DecimHalfCross(angleTerm, angle, decim->coning);
+    vn200DecimHalfCross(angleTerm, vel, decim->sculling);
+    vn200DecimHalfCross(velTerm, angle, decim->sculling);
+
+    for (i = 0; i < 3; i++) {
+        decim->alpha[i] += angle[i];
+        decim->upsilon[i] += vel[i];
+        decim->lastAngle[i] = angle[i];
+        decim->lastVel[i] = vel[i];
+        decim->compass[i] += imu->compass[i];
+    }
+    decim->temp += imu->temp;
+    decim->baro += imu->baro;
+    decim->numSamples++;
+    decim->numInput++;
+
+    if (decim->numSamples < decim->ratio) {
+        return 0;
+    }
+
+    // Velocity change in the frame at the start, with the rotation over the
+    // interval taken out
+    vn200DecimHalfCross(decim->alpha, decim->upsilon, rotation);
+    scale = 1.0 / decim->numSamples;
+    for (i = 0; i < 3; i++) {
+        delta->dTheta[i] = decim->alpha[i] + decim->coning[i];
+        delta->dVel[i] = decim->upsilon[i] + rotation[i] + decim->sculling[i];
+        delta->compass[i] = decim->compass[i] * scale;
+
+        decim->alpha[i] = 0;
+        decim->upsilon[i] = 0;
+        decim->coning[i] = 0;
+        decim->sculling[i] = 0;
+        decim->compass[i] = 0;
+    }
+    delta->temp = decim->temp * scale;
+    delta->baro = decim->baro * scale;
+    delta->dt = decim->numSamples * decim->dt;
+    delta->numSamples = decim->numSamples;
+    delta->timestamp = imu->timestamp;
+
+    decim->temp = 0;
+    decim->baro = 0;
+    decim->numSamples = 0;
+    decim->numOutput++;
+
+    return 1;
+
+} // VN200DecimAdd(VN200_DECIM *, const IMU_DATA *, VN200_DELTA *)
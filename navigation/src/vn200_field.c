@@ -0,0 +1,228 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_field.c
+ *
+ * Description:
+ *	Numeric field parser for VN200 ASCII sentences. Fields are signed
+ *	decimals with an optional exponent (+01.0854, -000.680, 2.10E-08),
+ *	separated by commas. They are parsed in place from the sentence
+ *	bytes within an explicit length, so nothing is copied or needs a
+ *	terminator, and the result does not depend on the locale.
+ *
+ *	Digits are collected into an integer and scaled by an exact power of
+ *	ten. While the digits fit in 53 bits and the power is at most 10^22,
+ *	both are exact doubles and the one multiply or divide rounds
+ *	correctly, so the value is the same as strtod gives. Every field the
+ *	sensor sends takes that path, anything else falls back to strtod.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "vn200_field.h"
+
+// Most digits collected before the integer could overflow
+#define VN200_FIELD_MAX_DIGITS 19
+
+// Powers of ten that are exact as doubles
+static const double vn200Pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define VN200_MAX_EXACT_POW10 22
+
+
+/**** Function vn200ParseSlow ****
+ *
+ * Parses a field the fast path could not convert exactly
+ *
+ * Arguments:
+ * 	buf   - Pointer to the field
+ * 	len   - Length of the field
+ * 	value - Set to the parsed value
+ *
+ * Return value:
+ *	On success, returns 0
+ *	On failure, returns a negative number
+ */
+static int vn200ParseSlow(const unsigned char *buf, int len, double *value) {
+
+    char field[VN200_FIELD_MAX_LEN];
+
+    if (len >= VN200_FIELD_MAX_LEN) {
+        return -1;
+    }
+
+    memcpy(field, buf, len);
+    field[len] = '\0';
+    *value = strtod(field, NULL);
+
+    return 0;
+
+} // vn200ParseSlow(const unsigned char *, int, double *)
+
+
+/**** Function VN200ParseDouble ****
+ *
+ * Parses one number at the start of buf. Stops at the first character that
+ * cannot continue it (normally a comma or the end).
+ *
+ * Arguments:
+ * 	buf   - Pointer to the first character of the field
+ * 	len   - Characters available
+ * 	value - Set to the parsed value
+ *
+ * Return value:
+ *	On success, returns the number of characters parsed
+ *	If there is no number, returns a negative number
+ */
+int VN200ParseDouble(const unsigned char *buf, int len, double *value) {
+
+    const unsigned char *p = buf, *end = buf + len;
+    uint64_t mantissa = 0;
+    int negative = 0, numDigits = 0, numSignificant = 0, truncated = 0;
+    int scale = 0, exponent = 0, exponentNegative = 0, power;
+    const unsigned char *exponentStart;
+
+    if (buf == NULL || value == NULL || len <= 0) {
+        return -1;
+    }
+
+    if (*p == '+' || *p == '-') {
+        negative = (*p == '-');
+        p++;
+    }
+
+    // Integer part
+    for (; p < end && *p >= '0' && *p <= '9'; p++, numDigits++) {
+        if (numSignificant < VN200_FIELD_MAX_DIGITS) {
+            mantissa = mantissa * 10 + (*p - '0');
+            numSignificant += (mantissa != 0);
+        } else {
+            scale++;
+            truncated |= (*p != '0');
+        }
+    }
+
+    // Fraction
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, numDigits++) {
+            if (numSignificant < VN200_FIELD_MAX_DIGITS) {
+                mantissa = mantissa * 10 + (*p - '0');
+                numSignificant += (mantissa != 0);
+                scale--;
+            } else {
+                truncated |= (*p != '0');
+            }
+        }
+    }
+
+    if (numDigits == 0) {
+        return -1;
+    }
+
+    // Exponent, only taken if digits follow
+    if (p < end && (*p == 'E' || *p == 'e')) {
+        exponentStart = p++;
+        if (p < end && (*p == '+' || *p == '-')) {
+            exponentNegative = (*p == '-');
+            p++;
+        }
+        if (p < end && *p >= '0' && *p <= '9') {
+            for (; p < end && *p >= '0' && *p <= '9'; p++) {
+                if (exponent < 10000) {
+                    exponent = exponent * 10 + (*p - '0');
+                }
+            }
+        } else {
+            p = exponentStart;
+        }
+    }
+
+    power = scale + (exponentNegative ? -exponent : exponent);
+
+    if (mantissa == 0) {
+        *value = 0.0;
+    } else if (!truncated && mantissa <= (1ULL << 53) &&
+            power >= -VN200_MAX_EXACT_POW10 && power <= VN200_MAX_EXACT_POW10) {
+        if (power < 0) {
+            *value = (double) mantissa / vn200Pow10[-power];
+        } else {
+            *value = (double) mantissa * vn200Pow10[power];
+        }
+    } else {
+        if (vn200ParseSlow(buf, p - buf, value) < 0) {
+            return -1;
+        }
+        return p - buf;
+    }
+
+    if (negative) {
+        *value = -*value;
+    }
+
+    return p - buf;
+
+} // VN200ParseDouble(const unsigned char *, int, double *)
+
+
+/**** Function VN200ParseFields ****
+ *
+ * Parses a comma separated list of exactly numFields numbers that fills the
+ * whole buffer
+ *
+ * Arguments:
+ * 	buf       - Pointer to the first field
+ * 	len       - Length of the list, up to but not including '*'
+ * 	values    - Set to the parsed values
+ * 	numFields - Number of fields expected
+ *
+ * Return value:
+ *	On success, returns numFields
+ *	If a field is malformed or the count is wrong, returns a negative
+ *	number
+ */
+int VN200ParseFields(const unsigned char *buf, int len, double *values, int numFields) {
+
+    const unsigned char *p = buf, *end = buf + len;
+    int i, rc;
+
+    if (buf == NULL || values == NULL || len <= 0) {
+        return -1;
+    }
+
+    for (i = 0; i < numFields; i++) {
+
+        rc = VN200ParseDouble(p, end - p, &values[i]);
+        if (rc < 0) {
+            return -2;
+        }
+        p += rc;
+
+        if (i < numFields - 1) {
+            if (p >= end || *p != ',') {
+                return -2;
+            }
+            p++;
+        }
+    }
+
+    // Anything left over means the sentence had a different layout
+    if (p != end) {
+        return -3;
+    }
+
+    return numFields;
+
+} // VN200ParseFields(const unsigned char *, int, double *, int)
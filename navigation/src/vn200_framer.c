@@ -0,0 +1,354 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_framer.c
+ *
+ * Description:
+ *	Streaming framer for VN200 ASCII sentences ($...*XX). The framer is a
+ *	state machine (hunting for '$', in the body, in the checksum) whose
+ *	state is kept in the device between polls, so every received byte is
+ *	examined exactly once and the checksum is accumulated as the body
+ *	arrives. A sentence that is still arriving is resumed where it left
+ *	off on the next call instead of being scanned again from its start.
+ *
+ *	Complete sentences are returned as views into the input buffer rather
+ *	than copies. Garbage, cut off sentences, and sentences with a bad
+ *	checksum are dropped, and framing picks up again at the next '$'.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Garbage and sentence bodies are skipped with the vector scan kernels
+ *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Bodies handed out in place in the input buffer
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "debuglog.h"
+#include "vn200.h"
+
+#include "vn200_framer.h"
+#include "vn200_scan.h"
+
+
+/**** Function VN200FramerReset ****
+ *
+ * Starts the framer hunting for a sentence from the front of the buffer.
+ * Statistics are kept.
+ *
+ * Arguments:
+ * 	framer - Pointer to VN200_FRAMER instance
+ */
+void VN200FramerReset(VN200_FRAMER *framer) {
+
+    if (framer == NULL) {
+        return;
+    }
+
+    framer->state = VN200_FRAME_HUNT;
+    framer->scanned = 0;
+    framer->start = 0;
+    framer->checksum = 0;
+    framer->received = 0;
+    framer->numChecksumChars = 0;
+
+} // VN200FramerReset(VN200_FRAMER *)
+
+
+/**** Function VN200FramerDiscard ****
+ *
+ * Keeps the framer's positions in step with the input buffer when bytes are
+ * removed from its front. Called by VN200Consume.
+ *
+ * Arguments:
+ * 	framer - Pointer to VN200_FRAMER instance
+ * 	num    - Number of bytes removed
+ */
+void VN200FramerDiscard(VN200_FRAMER *framer, int num) {
+
+    if (framer == NULL || num <= 0) {
+        return;
+    }
+
+    framer->scanned -= num;
+    framer->start -= num;
+
+    // The sentence in progress went with the consumed bytes
+    if (framer->state != VN200_FRAME_HUNT && framer->start < 0) {
+        framer->state = VN200_FRAME_HUNT;
+    }
+    if (framer->scanned < 0) {
+        framer->scanned = 0;
+    }
+
+} // VN200FramerDiscard(VN200_FRAMER *, int)
+
+
+// Value of a hex digit, or -1
+static inline int vn200HexValue(unsigned char c) {
+
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+
+    return -1;
+
+}
+
+
+/**** Function vn200FrameDrop ****
+ *
+ * Abandons the sentence in progress and goes back to hunting
+ *
+ * Arguments:
+ * 	framer - Pointer to VN200_FRAMER instance
+ * 	upTo   - Index in inbuf of the first byte not being dropped
+ */
+static inline void vn200FrameDrop(VN200_FRAMER *framer, int upTo) {
+
+    framer->numSkipped += upTo - framer->start;
+    framer->state = VN200_FRAME_HUNT;
+
+}
+
+
+/**** Function VN200FrameNext ****
+ *
+ * Advances the framer through newly received bytes until it completes a
+ * sentence with a valid checksum. Everything in the input buffer before that
+ * sentence, including sentences returned by earlier calls, is consumed.
+ *
+ * Arguments:
+ * 	dev  - Pointer to VN200_DEV instance to frame from
+ * 	view - Filled in with the sentence's position in the input buffer
+ *
+ * Return value:
+ *	If a sentence was framed, returns 1
+ *	If every buffered byte was examined without completing one, returns 0
+ *	On failure, returns a negative number
+ */
+int VN200FrameNext(VN200_DEV *dev, VN200_PACKET_VIEW *view) {
+
+    VN200_FRAMER *framer;
+    BYTE_BUFFER *inbuf;
+    const unsigned char *segment;
+    unsigned char c;
+    int length, segmentStart, segmentLen, i, span, skip, digit, found = 0;
+
+    if (dev == NULL || view == NULL) {
+        return -1;
+    }
+
+    framer = &(dev->framer);
+    inbuf = &(dev->inbuf);
+    length = BufferLength(inbuf);
+
+    while (!found && framer->scanned < length) {
+
+        // Walk the ring in contiguous pieces rather than indexing each byte
+        segmentStart = BYTE_BUFFER_MOD(inbuf->start + framer->scanned);
+        segmentLen = BYTE_BUFFER_LEN - segmentStart;
+        if (segmentLen > length - framer->scanned) {
+            segmentLen = length - framer->scanned;
+        }
+        segment = &(inbuf->buffer[segmentStart]);
+
+        for (i = 0; i < segmentLen && !found; i++) {
+
+            // Runs of bytes that only matter in bulk are scanned a vector at
+            // a time. The byte that ends the run goes through the switch.
+            if (framer->state == VN200_FRAME_HUNT) {
+                skip = VN200FindByte(&segment[i], segmentLen - i, '$');
+                framer->numSkipped += skip;
+                i += skip;
+            } else if (framer->state == VN200_FRAME_BODY) {
+                span = framer->start + VN200_FRAME_MAX_LEN + 1 - (framer->scanned + i);
+                if (span > segmentLen - i) {
+                    span = segmentLen - i;
+                }
+                skip = VN200FindFramingByte(&segment[i], span);
+                framer->checksum ^= VN200ChecksumXor(&segment[i], skip);
+                i += skip;
+            }
+            if (i == segmentLen) {
+                break;
+            }
+
+            c = segment[i];
+
+            switch (framer->state) {
+
+                case VN200_FRAME_HUNT:
+                    if (c == '$') {
+                        framer->state = VN200_FRAME_BODY;
+                        framer->start = framer->scanned + i;
+                        framer->checksum = 0;
+                    } else {
+                        framer->numSkipped++;
+                    }
+                    break;
+
+                case VN200_FRAME_BODY:
+                    if (c == '*') {
+                        framer->state = VN200_FRAME_CHECKSUM;
+                        framer->received = 0;
+                        framer->numChecksumChars = 0;
+                    } else if (c == '$') {
+                        // The previous sentence was cut off, this one starts
+                        // over
+                        framer->numBroken++;
+                        framer->numSkipped += framer->scanned + i - framer->start;
+                        framer->start = framer->scanned + i;
+                        framer->checksum = 0;
+                    } else if (c == '\r' || c == '\n' ||
+                            framer->scanned + i - framer->start > VN200_FRAME_MAX_LEN) {
+                        framer->numBroken++;
+                        vn200FrameDrop(framer, framer->scanned + i + 1);
+                    } else {
+                        framer->checksum ^= c;
+                    }
+                    break;
+
+                case VN200_FRAME_CHECKSUM:
+                    digit = vn200HexValue(c);
+                    if (digit < 0) {
+                        framer->numChecksumErrors++;
+                        // Look at this byte again, it may start a sentence
+                        vn200FrameDrop(framer, framer->scanned + i);
+                        i--;
+                        break;
+                    }
+
+                    framer->received = (framer->received << 4) | digit;
+                    if (++(framer->numChecksumChars) < 2) {
+                        break;
+                    }
+
+                    if (framer->received != framer->checksum) {
+                        framer->numChecksumErrors++;
+                        logDebug(L_DEBUG, "VN200 checksum failed: read %02X but computed %02X\n",
+                                framer->received, framer->checksum);
+                        vn200FrameDrop(framer, framer->scanned + i + 1);
+                        break;
+                    }
+
+                    framer->state = VN200_FRAME_HUNT;
+                    framer->numPackets++;
+                    found = 1;
+                    break;
+            }
+        }
+
+        framer->scanned += i;
+    }
+
+    // Nothing before the sentence in progress (or the one found) is needed
+    if (framer->state == VN200_FRAME_HUNT && !found) {
+        VN200Consume(dev, framer->scanned);
+    } else {
+        VN200Consume(dev, framer->start);
+    }
+
+    if (!found) {
+        return 0;
+    }
+
+    view->start = framer->start;
+    view->bodyStart = framer->start + 1;
+    view->end = framer->scanned;
+    view->bodyLen = view->end - 3 - view->bodyStart;
+    view->offset = dev->rxOffset - BufferLength(inbuf) + view->start;
+
+    return 1;
+
+} // VN200FrameNext(VN200_DEV *, VN200_PACKET_VIEW *)
+
+
+/**** Function VN200FrameBody ****
+ *
+ * Gives the body of a framed sentence (between '$' and '*') where it lies
+ * in the input buffer, so it is parsed without being copied. The checksum
+ * was already checked there by VN200FrameNext. Only a body split by the end
+ * of the ring is copied, into scratch. The body is not terminated.
+ *
+ * Arguments:
+ * 	dev        - Pointer to VN200_DEV instance the sentence was framed from
+ * 	view       - Sentence returned by VN200FrameNext
+ * 	scratch    - Buffer for a body that wraps
+ * 	scratchLen - Size of scratch, at least the body length
+ *
+ * Return value:
+ *	On success, returns a pointer to view->bodyLen bytes of body, valid as
+ *	long as the view is
+ *	On failure, returns NULL
+ */
+unsigned char *VN200FrameBody(VN200_DEV *dev, VN200_PACKET_VIEW *view, unsigned char *scratch,
+        int scratchLen) {
+
+    unsigned char *segment;
+
+    if (dev == NULL || view == NULL) {
+        return NULL;
+    }
+
+    if (BufferSegment(&(dev->inbuf), view->bodyStart, view->bodyLen, &segment) == view->bodyLen) {
+        return segment;
+    }
+
+    if (scratch == NULL || view->bodyLen > scratchLen) {
+        return NULL;
+    }
+
+    BufferCopy(&(dev->inbuf), scratch, view->bodyStart, view->bodyLen);
+    dev->framer.numCopied += view->bodyLen;
+
+    return scratch;
+
+} // VN200FrameBody(VN200_DEV *, VN200_PACKET_VIEW *, unsigned char *, int)
+
+
+/**** Function VN200FrameCopyBody ****
+ *
+ * Copies the body of a framed sentence (between '$' and '*') out of the
+ * input buffer and terminates it
+ *
+ * Arguments:
+ * 	dev     - Pointer to VN200_DEV instance the sentence was framed from
+ * 	view    - Sentence returned by VN200FrameNext
+ * 	dest    - Buffer for the body
+ * 	destLen - Size of dest, at least one more than the body length
+ *
+ * Return value:
+ *	On success, returns the body length
+ *	On failure, returns a negative number
+ */
+int VN200FrameCopyBody(VN200_DEV *dev, VN200_PACKET_VIEW *view, unsigned char *dest, int destLen) {
+
+    if (dev == NULL || view == NULL || dest == NULL || view->bodyLen >= destLen) {
+        return -1;
+    }
+
+    BufferCopy(&(dev->inbuf), dest, view->bodyStart, view->bodyLen);
+    dest[view->bodyLen] = '\0';
+    dev->framer.numCopied += view->bodyLen;
+
+    return view->bodyLen;
+
+} // VN200FrameCopyBody(VN200_DEV *, VN200_PACKET_VIEW *, unsigned char *, int)
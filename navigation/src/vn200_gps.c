@@ -15,6 +15,10 @@
  * Revision 0.2
  * 	Last edited 5/06/2019
  *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Fields parsed in place instead of copied and scanned with sscanf
+ *
  \***************************************************************************/
 
 #include <stdio.h>
@@ -39,6 +43,7 @@
 #include "uart.h"
 #include "vn200_crc.h"
 #include "vn200.h"
+#include "vn200_field.h"
 
 #include "vn200_gps.h"
 
@@ -68,9 +73,9 @@ int VN200GPSInit(VN200_DEV *dev, char *devname, int fs) {
  * Parses data from input buffer, assuming GPS
  *
  * Example packet:
- * 	$VNGPS,342123.000168,1890,3,05,+34.61463270,-112.45087270,+01559.954,+000.450,+000.770,-001.290,+002.940,+005.374,+007.410,+001.672,2.10E-08*23
+ * 	$VNGPE,570937.199558,2075,3,07,-2006902.850,-4857470.210,+3604176.410,+000.110,-000.680,+000.170,+019.320,+016.935,+016.758,+001.312,9.00E-09*07
  *
- * 	The input buffer must start at first character after "$VNGPS," and the
+ * 	The input buffer must start at first character after "$VNGPE," and the
  * 	length is the number of characters until *XX
  *
  * Arguments: 
@@ -84,10 +89,8 @@ int VN200GPSInit(VN200_DEV *dev, char *devname, int fs) {
  */
 int VN200GPSPacketParse(unsigned char *buf, int len, GPS_DATA *data) {
 
-    // 1K Should be enough for a single packet
-    const int PACKET_BUF_SIZE = 1024;
-    char currentPacket[PACKET_BUF_SIZE];
-    int i, rc;
+    double values[VN200_GPS_NUM_FIELDS];
+    int rc;
 
     // Exit on error if invalid pointer
     if(buf == NULL || data == NULL) {
@@ -99,29 +102,33 @@ int VN200GPSPacketParse(unsigned char *buf, int len, GPS_DATA *data) {
         return -2;
     }
 
-    logDebug(L_VDEBUG, "\n\n%s - Data in buffer:\n", __func__);
-    for(i = 0; i < len; i++) {
-        logDebug(L_VDEBUG, "%c", buf[i]);
-    }
-    logDebug(L_VDEBUG, "\n\n");
-
-    // Copy string into local variable
-    strncpy(currentPacket, (char *)&(buf[0]), len);
-
-    // Scan for fields in packet string
-    rc = sscanf(currentPacket, "%lf,%hd,%hhd,%hhd,%lf,%lf,%lf,%f,%f,%f,%f,%f,%f,%f,%f",
-            &(data->time), &(data->week), &(data->GpsFix), &(data->NumSats),
-            &(data->PosX), &(data->PosY), &(data->PosZ),
-            &(data->VelX), &(data->VelY), &(data->VelZ),
-            &(data->PosAccX), &(data->PosAccY), &(data->PosAccZ),
-            &(data->SpeedAcc), &(data->TimeAcc));
-    if(rc < 15) {
+    logDebug(L_VDEBUG, "\n\n%s - Data in buffer:\n%.*s\n\n", __func__, len, buf);
+
+    // Scan for fields straight from the packet
+    rc = VN200ParseFields(buf, len, values, VN200_GPS_NUM_FIELDS);
+    if(rc < 0) {
         logDebug(L_INFO, "%s: Didn't match entire formatted string: %d\n", __func__, rc);
 
         // Malformed packet, return to indicate not fully parsed
         return -3;
     }
 
+    data->time = values[0];
+    data->week = (uint16_t) values[1];
+    data->GpsFix = (uint8_t) values[2];
+    data->NumSats = (uint8_t) values[3];
+    data->PosX = values[4];
+    data->PosY = values[5];
+    data->PosZ = values[6];
+    data->VelX = values[7];
+    data->VelY = values[8];
+    data->VelZ = values[9];
+    data->PosAccX = values[10];
+    data->PosAccY = values[11];
+    data->PosAccZ = values[12];
+    data->SpeedAcc = values[13];
+    data->TimeAcc = values[14];
+
     return len;
 
 } // VN200GPSPacketParse(unsigned char *, int, GPS_DATA *)
@@ -12,6 +12,10 @@
  * Revision 0.1
  * 	Last edited 4/1/2019
  *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Fields parsed in place instead of copied and scanned with sscanf
+ *
  ****************************************************************************/
 
 #include <stdio.h>
@@ -35,6 +39,7 @@
 #include "uart.h"
 #include "vn200_crc.h"
 #include "vn200.h"
+#include "vn200_field.h"
 
 #include "vn200_imu.h"
 
@@ -72,10 +77,8 @@ int VN200IMUInit(VN200_DEV *dev, char *devname, int fs) {
  */
 int VN200IMUPacketParse(unsigned char *buf, int len, IMU_DATA *data) {
 
-    // 1K Should be enough for a single packet
-    const int PACKET_BUF_SIZE = 1024;
-    char currentPacket[PACKET_BUF_SIZE];
-    int i, rc;
+    double values[VN200_IMU_NUM_FIELDS];
+    int rc;
 
     // Exit on error if invalid pointer
     if(buf == NULL || data == NULL) {
@@ -87,28 +90,29 @@ int VN200IMUPacketParse(unsigned char *buf, int len, IMU_DATA *data) {
         return -2;
     }
 
-    logDebug(L_VDEBUG, "\n\n%s - Data in buffer:\n", __func__);
-    for(i = 0; i < len; i++) {
-        logDebug(L_VDEBUG, "%c", buf[i]);
-    }
-    logDebug(L_VDEBUG, "\n\n");
-
-    // Copy string into local variable
-    strncpy(currentPacket, (char *)&(buf[0]), len);
-
-    // Parse out values (all doubles)
-    rc = sscanf(currentPacket, "%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf,%lf",
-            &(data->compass[0]), &(data->compass[1]), &(data->compass[2]),
-            &(data->accel[0]), &(data->accel[1]), &(data->accel[2]),
-            &(data->gyro[0]), &(data->gyro[1]), &(data->gyro[2]),
-            &(data->temp), &(data->baro));
-    if(rc < 11) {
+    logDebug(L_VDEBUG, "\n\n%s - Data in buffer:\n%.*s\n\n", __func__, len, buf);
+
+    // Parse out values (all doubles) straight from the packet
+    rc = VN200ParseFields(buf, len, values, VN200_IMU_NUM_FIELDS);
+    if(rc < 0) {
         logDebug(L_INFO, "%s: Didn't match entire formatted string: %d\n", __func__, rc);
 
         // Malformed packet, return error to indicate not fully parsed
         return -3;
     }
 
+    data->compass[0] = values[0];
+    data->compass[1] = values[1];
+    data->compass[2] = values[2];
+    data->accel[0] = values[3];
+    data->accel[1] = values[4];
+    data->accel[2] = values[5];
+    data->gyro[0] = values[6];
+    data->gyro[1] = values[7];
+    data->gyro[2] = values[8];
+    data->temp = values[9];
+    data->baro = values[10];
+
     return len;
 
 } // VN200IMUPacketParse(unsigned char *, int, IMU_DATA *) {
@@ -0,0 +1,503 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_packet.c
+ *
+ * Description:
+ *	Dispatch of VN200 ASCII sentences to a parser by packet id. The ids
+ *	are looked up in a table indexed by a perfect hash of the id, so
+ *	finding the parser is one table read and one comparison whatever the
+ *	number of types. Also holds the parsers for the output types that do
+ *	not have their own file.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "debuglog.h"
+#include "vn200_field.h"
+#include "vn200_gps.h"
+#include "vn200_imu.h"
+
+#include "vn200_packet.h"
+
+
+/**** Adapters from the dispatch table to the typed parsers ****/
+
+static int parseImu(unsigned char *buf, int len, VN200_PACKET *packet) {
+    return VN200IMUPacketParse(buf, len, &(packet->data.imu));
+}
+
+static int parseGps(unsigned char *buf, int len, VN200_PACKET *packet) {
+    return VN200GPSLLAPacketParse(buf, len, &(packet->data.gps));
+}
+
+static int parseGpe(unsigned char *buf, int len, VN200_PACKET *packet) {
+    return VN200GPSPacketParse(buf, len, &(packet->data.gpe));
+}
+
+static int parseIns(unsigned char *buf, int len, VN200_PACKET *packet) {
+    return VN200INSPacketParse(buf, len, &(packet->data.ins));
+}
+
+static int parseYmr(unsigned char *buf, int len, VN200_PACKET *packet) {
+    return VN200YMRPacketParse(buf, len, &(packet->data.ymr));
+}
+
+static int parseQmr(unsigned char *buf, int len, VN200_PACKET *packet) {
+    return VN200QMRPacketParse(buf, len, &(packet->data.qmr));
+}
+
+static int parseRegister(unsigned char *buf, int len, VN200_PACKET *packet) {
+    return VN200RegisterPacketParse(buf, len, &(packet->data.reg));
+}
+
+static int parseError(unsigned char *buf, int len, VN200_PACKET *packet) {
+    return VN200ErrorPacketParse(buf, len, &(packet->data.err));
+}
+
+// Entry for the id "VN" c2 c3 c4, in the slot the id hashes to
+#define VN200_PACKET_ENTRY(c2, c3, c4, type, parse) \
+    [VN200_PACKET_SLOT(c2, c3, c4)] = { { 'V', 'N', c2, c3, c4, '\0' }, type, parse }
+
+// Empty slots have no parser
+static const VN200_PACKET_HANDLER vn200PacketTable[VN200_PACKET_TABLE_LEN] = {
+    VN200_PACKET_ENTRY('I', 'M', 'U', VN200_PACKET_IMU, parseImu),
+    VN200_PACKET_ENTRY('G', 'P', 'S', VN200_PACKET_GPS, parseGps),
+    VN200_PACKET_ENTRY('G', 'P', 'E', VN200_PACKET_GPE, parseGpe),
+    VN200_PACKET_ENTRY('I', 'N', 'S', VN200_PACKET_INS, parseIns),
+    VN200_PACKET_ENTRY('Y', 'M', 'R', VN200_PACKET_YMR, parseYmr),
+    VN200_PACKET_ENTRY('Q', 'M', 'R', VN200_PACKET_QMR, parseQmr),
+    VN200_PACKET_ENTRY('W', 'R', 'G', VN200_PACKET_WRG, parseRegister),
+    VN200_PACKET_ENTRY('R', 'R', 'G', VN200_PACKET_RRG, parseRegister),
+    VN200_PACKET_ENTRY('E', 'R', 'R', VN200_PACKET_ERR, parseError)
+};
+
+
+/**** Function VN200PacketLookup ****
+ *
+ * Finds the type of a sentence from its id
+ *
+ * Arguments:
+ * 	body - Sentence between '$' and '*'
+ * 	len  - Length of body
+ *
+ * Return value:
+ *	Returns the VN200_PACKET_TYPE of the sentence
+ *	If the id is not a supported type, returns -1
+ */
+int VN200PacketLookup(const unsigned char *body, int len) {
+
+    const VN200_PACKET_HANDLER *handler;
+
+    if (body == NULL || len < VN200_PACKET_HEADER_LEN || body[VN200_PACKET_ID_LEN] != ',') {
+        return -1;
+    }
+
+    handler = &vn200PacketTable[VN200_PACKET_HASH(body)];
+    if (handler->parse == NULL || memcmp(handler->id, body, VN200_PACKET_ID_LEN) != 0) {
+        return -1;
+    }
+
+    return handler->type;
+
+} // VN200PacketLookup(const unsigned char *, int)
+
+
+/**** Function VN200PacketParse ****
+ *
+ * Parses a sentence of any supported type
+ *
+ * Arguments:
+ * 	body   - Sentence between '$' and '*', starting with the packet id
+ * 	len    - Length of body
+ * 	packet - Set to the type and parsed data
+ *
+ * Return value:
+ *	On success, returns the VN200_PACKET_TYPE of the sentence
+ *	If the type is not supported, returns -1
+ *	If the sentence is malformed, returns -2
+ */
+int VN200PacketParse(unsigned char *body, int len, VN200_PACKET *packet) {
+
+    const VN200_PACKET_HANDLER *handler;
+    int type;
+
+    if (packet == NULL) {
+        return -1;
+    }
+
+    type = VN200PacketLookup(body, len);
+    if (type < 0) {
+        return -1;
+    }
+
+    handler = &vn200PacketTable[VN200_PACKET_HASH(body)];
+    if (handler->parse(&body[VN200_PACKET_HEADER_LEN], len - VN200_PACKET_HEADER_LEN, packet) < 0) {
+        return -2;
+    }
+
+    packet->type = type;
+
+    return type;
+
+} // VN200PacketParse(unsigned char *, int, VN200_PACKET *)
+
+
+/**** Function VN200PacketHandler ****
+ *
+ * Arguments:
+ * 	slot - Dispatch table index
+ *
+ * Return value:
+ *	Returns the handler in a slot of the dispatch table, or NULL if the
+ *	slot is empty or out of range
+ */
+const VN200_PACKET_HANDLER *VN200PacketHandler(int slot) {
+
+    if (slot < 0 || slot >= VN200_PACKET_TABLE_LEN || vn200PacketTable[slot].parse == NULL) {
+        return NULL;
+    }
+
+    return &vn200PacketTable[slot];
+
+} // VN200PacketHandler(int)
+
+
+/**** Function VN200PacketName ****
+ *
+ * Return value:
+ *	Returns the packet id of a type for log messages
+ */
+const char *VN200PacketName(VN200_PACKET_TYPE type) {
+
+    static const char *names[VN200_PACKET_NUM_TYPES] = {
+        "VNIMU", "VNGPS", "VNGPE", "VNINS", "VNYMR", "VNQMR", "VNWRG", "VNRRG", "VNERR"
+    };
+
+    if ((int) type < 0 || type >= VN200_PACKET_NUM_TYPES) {
+        return "unknown";
+    }
+
+    return names[type];
+
+} // VN200PacketName(VN200_PACKET_TYPE)
+
+
+/**** Function VN200GPSLLAPacketParse ****
+ *
+ * Parses a VNGPS sentence, the GPS solution in latitude, longitude, and
+ * altitude
+ *
+ * Arguments:
+ * 	buf  - First character after "$VNGPS,"
+ * 	len  - Length up to but not including '*'
+ * 	data - Set to the parsed values
+ *
+ * Return value:
+ *	On success, returns len
+ *	On failure, returns a negative number
+ */
+int VN200GPSLLAPacketParse(unsigned char *buf, int len, GPS_LLA_DATA *data) {
+
+    double values[VN200_GPS_LLA_NUM_FIELDS];
+
+    if (buf == NULL || data == NULL) {
+        return -1;
+    }
+
+    if (VN200ParseFields(buf, len, values, VN200_GPS_LLA_NUM_FIELDS) < 0) {
+        logDebug(L_INFO, "%s: Malformed packet\n", __func__);
+        return -3;
+    }
+
+    data->time = values[0];
+    data->week = (uint16_t) values[1];
+    data->GpsFix = (uint8_t) values[2];
+    data->NumSats = (uint8_t) values[3];
+    data->Latitude = values[4];
+    data->Longitude = values[5];
+    data->Altitude = values[6];
+    data->VelN = values[7];
+    data->VelE = values[8];
+    data->VelD = values[9];
+    data->PosAccN = values[10];
+    data->PosAccE = values[11];
+    data->PosAccD = values[12];
+    data->SpeedAcc = values[13];
+    data->TimeAcc = values[14];
+
+    return len;
+
+} // VN200GPSLLAPacketParse(unsigned char *, int, GPS_LLA_DATA *)
+
+
+/**** Function vn200ParseHexField ****
+ *
+ * Parses a field of up to eight hex digits and the comma after it
+ *
+ * Arguments:
+ * 	buf   - First character of the field
+ * 	len   - Characters available
+ * 	value - Set to the field value
+ *
+ * Return value:
+ *	On success, returns the characters consumed, including the comma
+ *	If the field is malformed, returns -1
+ */
+static int vn200ParseHexField(const unsigned char *buf, int len, uint32_t *value) {
+
+    int i, digit;
+
+    *value = 0;
+    for (i = 0; i < len && buf[i] != ','; i++) {
+        if (buf[i] >= '0' && buf[i] <= '9') {
+            digit = buf[i] - '0';
+        } else if (buf[i] >= 'A' && buf[i] <= 'F') {
+            digit = buf[i] - 'A' + 10;
+        } else if (buf[i] >= 'a' && buf[i] <= 'f') {
+            digit = buf[i] - 'a' + 10;
+        } else {
+            return -1;
+        }
+        *value = (*value << 4) | digit;
+    }
+
+    if (i == 0 || i > 8 || i == len) {
+        return -1;
+    }
+
+    return i + 1;
+
+} // vn200ParseHexField(const unsigned char *, int, uint32_t *)
+
+
+/**** Function VN200INSPacketParse ****
+ *
+ * Parses a VNINS sentence, the INS solution in latitude, longitude, and
+ * altitude
+ *
+ * Arguments:
+ * 	buf  - First character after "$VNINS,"
+ * 	len  - Length up to but not including '*'
+ * 	data - Set to the parsed values
+ *
+ * Return value:
+ *	On success, returns len
+ *	On failure, returns a negative number
+ */
+int VN200INSPacketParse(unsigned char *buf, int len, INS_DATA *data) {
+
+    double values[VN200_INS_NUM_FIELDS];
+    uint32_t status;
+    int i, rc, offset = 0;
+
+    if (buf == NULL || data == NULL) {
+        return -1;
+    }
+
+    // Time and week, then the status in hex, then decimal fields
+    for (i = 0; i < 2; i++) {
+        rc = VN200ParseDouble(&buf[offset], len - offset, &values[i]);
+        if (rc < 0 || offset + rc >= len || buf[offset + rc] != ',') {
+            return -3;
+        }
+        offset += rc + 1;
+    }
+
+    rc = vn200ParseHexField(&buf[offset], len - offset, &status);
+    if (rc < 0) {
+        return -3;
+    }
+    offset += rc;
+
+    if (VN200ParseFields(&buf[offset], len - offset, &values[3], VN200_INS_NUM_FIELDS - 3) < 0) {
+        logDebug(L_INFO, "%s: Malformed packet\n", __func__);
+        return -3;
+    }
+
+    data->time = values[0];
+    data->week = (uint16_t) values[1];
+    data->status = (uint16_t) status;
+    data->Yaw = values[3];
+    data->Pitch = values[4];
+    data->Roll = values[5];
+    data->Latitude = values[6];
+    data->Longitude = values[7];
+    data->Altitude = values[8];
+    data->VelN = values[9];
+    data->VelE = values[10];
+    data->VelD = values[11];
+    data->AttUncertainty = values[12];
+    data->PosUncertainty = values[13];
+    data->VelUncertainty = values[14];
+
+    return len;
+
+} // VN200INSPacketParse(unsigned char *, int, INS_DATA *)
+
+
+/**** Function VN200YMRPacketParse ****
+ *
+ * Parses a VNYMR sentence, attitude as yaw, pitch, and roll with the
+ * compensated IMU measurements
+ *
+ * Arguments:
+ * 	buf  - First character after "$VNYMR,"
+ * 	len  - Length up to but not including '*'
+ * 	data - Set to the parsed values
+ *
+ * Return value:
+ *	On success, returns len
+ *	On failure, returns a negative number
+ */
+int VN200YMRPacketParse(unsigned char *buf, int len, ATTITUDE_DATA *data) {
+
+    double values[VN200_YMR_NUM_FIELDS];
+
+    if (buf == NULL || data == NULL) {
+        return -1;
+    }
+
+    if (VN200ParseFields(buf, len, values, VN200_YMR_NUM_FIELDS) < 0) {
+        logDebug(L_INFO, "%s: Malformed packet\n", __func__);
+        return -3;
+    }
+
+    memcpy(data->ypr, &values[0], sizeof(data->ypr));
+    memcpy(data->compass, &values[3], sizeof(data->compass));
+    memcpy(data->accel, &values[6], sizeof(data->accel));
+    memcpy(data->gyro, &values[9], sizeof(data->gyro));
+
+    return len;
+
+} // VN200YMRPacketParse(unsigned char *, int, ATTITUDE_DATA *)
+
+
+/**** Function VN200QMRPacketParse ****
+ *
+ * Parses a VNQMR sentence, attitude as a quaternion with the compensated
+ * IMU measurements
+ *
+ * Arguments:
+ * 	buf  - First character after "$VNQMR,"
+ * 	len  - Length up to but not including '*'
+ * 	data - Set to the parsed values
+ *
+ * Return value:
+ *	On success, returns len
+ *	On failure, returns a negative number
+ */
+int VN200QMRPacketParse(unsigned char *buf, int len, QUATERNION_DATA *data) {
+
+    double values[VN200_QMR_NUM_FIELDS];
+
+    if (buf == NULL || data == NULL) {
+        return -1;
+    }
+
+    if (VN200ParseFields(buf, len, values, VN200_QMR_NUM_FIELDS) < 0) {
+        logDebug(L_INFO, "%s: Malformed packet\n", __func__);
+        return -3;
+    }
+
+    memcpy(data->quat, &values[0], sizeof(data->quat));
+    memcpy(data->compass, &values[4], sizeof(data->compass));
+    memcpy(data->accel, &values[7], sizeof(data->accel));
+    memcpy(data->gyro, &values[10], sizeof(data->gyro));
+
+    return len;
+
+} // VN200QMRPacketParse(unsigned char *, int, QUATERNION_DATA *)
+
+
+/**** Function VN200RegisterPacketParse ****
+ *
+ * Parses a VNRRG or VNWRG reply into the register id and its value. The
+ * value is kept as text, since its layout depends on the register, and cut
+ * short if it does not fit.
+ *
+ * Arguments:
+ * 	buf  - First character after "$VNRRG," or "$VNWRG,"
+ * 	len  - Length up to but not including '*'
+ * 	data - Set to the register id and value
+ *
+ * Return value:
+ *	On success, returns len
+ *	On failure, returns a negative number
+ */
+int VN200RegisterPacketParse(unsigned char *buf, int len, REGISTER_DATA *data) {
+
+    int i;
+
+    if (buf == NULL || data == NULL) {
+        return -1;
+    }
+
+    data->reg = 0;
+    for (i = 0; i < len && buf[i] >= '0' && buf[i] <= '9'; i++) {
+        data->reg = data->reg * 10 + buf[i] - '0';
+    }
+    if (i == 0 || i > 3 || (i < len && buf[i] != ',')) {
+        return -3;
+    }
+
+    // Skip the comma, if there is a value
+    if (i < len) {
+        i++;
+    }
+
+    // A value too long to keep is cut short
+    data->valueLen = len - i;
+    if (data->valueLen >= VN200_REGISTER_VALUE_LEN) {
+        data->valueLen = VN200_REGISTER_VALUE_LEN - 1;
+    }
+    memcpy(data->value, &buf[i], data->valueLen);
+    data->value[data->valueLen] = '\0';
+
+    return len;
+
+} // VN200RegisterPacketParse(unsigned char *, int, REGISTER_DATA *)
+
+
+/**** Function VN200ErrorPacketParse ****
+ *
+ * Parses a VNERR sentence
+ *
+ * Arguments:
+ * 	buf  - First character after "$VNERR,"
+ * 	len  - Length up to but not including '*'
+ * 	data - Set to the error code
+ *
+ * Return value:
+ *	On success, returns len
+ *	On failure, returns a negative number
+ */
+int VN200ErrorPacketParse(unsigned char *buf, int len, ERROR_DATA *data) {
+
+    int i;
+
+    if (buf == NULL || data == NULL) {
+        return -1;
+    }
+
+    data->code = 0;
+    for (i = 0; i < len && buf[i] >= '0' && buf[i] <= '9'; i++) {
+        data->code = data->code * 10 + buf[i] - '0';
+    }
+    if (i == 0 || i != len) {
+        return -3;
+    }
+
+    return len;
+
+} // VN200ErrorPacketParse(unsigned char *, int, ERROR_DATA *)
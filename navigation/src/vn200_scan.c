@@ -0,0 +1,493 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_scan.c
+ *
+ * Description:
+ *	Vector kernels for ASCII sensor sentences: the XOR checksum and
+ *	searching for framing characters. Each has a scalar version (a word at
+ *	a time where it can), SSE2 and AVX2 versions on x86, and a NEON version
+ *	on ARM.
+ *
+ *	On x86 the vector versions are built for their instruction sets with
+ *	target attributes, so no compiler flags are needed, and the best one
+ *	the processor supports is picked at run time. NEON is picked whenever
+ *	the compiler targets it. The kernels can be switched for testing and
+ *	benchmarking with VN200ScanSetLevel.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Delimiter bitmasks removed, nothing split fields with them
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VN200_SCAN_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define VN200_SCAN_ARM
+#include <arm_neon.h>
+#endif
+
+#include "debuglog.h"
+
+#include "vn200_scan.h"
+
+typedef struct {
+    unsigned char (*checksum)(const unsigned char *data, int length);
+    int (*findAny)(const unsigned char *data, int length,
+            unsigned char c0, unsigned char c1, unsigned char c2, unsigned char c3);
+} VN200_SCAN_KERNELS;
+
+
+/**** Scalar kernels ****/
+
+static unsigned char checksumScalar(const unsigned char *data, int length) {
+
+    uint64_t word, acc = 0;
+    unsigned char cksum;
+    int i;
+
+    // Eight bytes at a time, then fold the lanes together
+    for (i = 0; i + 8 <= length; i += 8) {
+        memcpy(&word, &data[i], sizeof(word));
+        acc ^= word;
+    }
+    acc ^= acc >> 32;
+    acc ^= acc >> 16;
+    acc ^= acc >> 8;
+    cksum = (unsigned char) acc;
+
+    for (; i < length; i++) {
+        cksum ^= data[i];
+    }
+
+    return cksum;
+
+}
+
+static int findAnyScalar(const unsigned char *data, int length,
+        unsigned char c0, unsigned char c1, unsigned char c2, unsigned char c3) {
+
+    int i;
+
+    for (i = 0; i < length; i++) {
+        if (data[i] == c0 || data[i] == c1 || data[i] == c2 || data[i] == c3) {
+            return i;
+        }
+    }
+
+    return length;
+
+}
+
+static const VN200_SCAN_KERNELS vn200ScalarKernels = {
+    checksumScalar, findAnyScalar
+};
+
+
+#ifdef VN200_SCAN_X86
+
+/**** SSE2 kernels ****/
+
+__attribute__((target("sse2")))
+static unsigned char checksumSSE2(const unsigned char *data, int length) {
+
+    __m128i acc = _mm_setzero_si128();
+    unsigned char cksum;
+    int i;
+
+    for (i = 0; i + 16 <= length; i += 16) {
+        acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i *) &data[i]));
+    }
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 4));
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 2));
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 1));
+    cksum = (unsigned char) _mm_cvtsi128_si32(acc);
+
+    for (; i < length; i++) {
+        cksum ^= data[i];
+    }
+
+    return cksum;
+
+}
+
+__attribute__((target("sse2")))
+static int findAnySSE2(const unsigned char *data, int length,
+        unsigned char c0, unsigned char c1, unsigned char c2, unsigned char c3) {
+
+    const __m128i v0 = _mm_set1_epi8(c0), v1 = _mm_set1_epi8(c1);
+    const __m128i v2 = _mm_set1_epi8(c2), v3 = _mm_set1_epi8(c3);
+    __m128i x, hits;
+    int i, mask;
+
+    for (i = 0; i + 16 <= length; i += 16) {
+        x = _mm_loadu_si128((const __m128i *) &data[i]);
+        hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, v0), _mm_cmpeq_epi8(x, v1)),
+                _mm_or_si128(_mm_cmpeq_epi8(x, v2), _mm_cmpeq_epi8(x, v3)));
+        mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return i + findAnyScalar(&data[i], length - i, c0, c1, c2, c3);
+
+}
+
+static const VN200_SCAN_KERNELS vn200SSE2Kernels = {
+    checksumSSE2, findAnySSE2
+};
+
+
+/**** AVX2 kernels ****/
+
+__attribute__((target("avx2")))
+static unsigned char checksumAVX2(const unsigned char *data, int length) {
+
+    __m256i acc = _mm256_setzero_si256();
+    __m128i fold;
+    unsigned char cksum;
+    int i;
+
+    for (i = 0; i + 32 <= length; i += 32) {
+        acc = _mm256_xor_si256(acc, _mm256_loadu_si256((const __m256i *) &data[i]));
+    }
+    fold = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    fold = _mm_xor_si128(fold, _mm_srli_si128(fold, 8));
+    fold = _mm_xor_si128(fold, _mm_srli_si128(fold, 4));
+    fold = _mm_xor_si128(fold, _mm_srli_si128(fold, 2));
+    fold = _mm_xor_si128(fold, _mm_srli_si128(fold, 1));
+    cksum = (unsigned char) _mm_cvtsi128_si32(fold);
+
+    for (; i < length; i++) {
+        cksum ^= data[i];
+    }
+
+    return cksum;
+
+}
+
+__attribute__((target("avx2")))
+static int findAnyAVX2(const unsigned char *data, int length,
+        unsigned char c0, unsigned char c1, unsigned char c2, unsigned char c3) {
+
+    const __m256i v0 = _mm256_set1_epi8(c0), v1 = _mm256_set1_epi8(c1);
+    const __m256i v2 = _mm256_set1_epi8(c2), v3 = _mm256_set1_epi8(c3);
+    __m256i x, hits;
+    uint32_t mask;
+    int i;
+
+    for (i = 0; i + 32 <= length; i += 32) {
+        x = _mm256_loadu_si256((const __m256i *) &data[i]);
+        hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, v0), _mm256_cmpeq_epi8(x, v1)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, v2), _mm256_cmpeq_epi8(x, v3)));
+        mask = (uint32_t) _mm256_movemask_epi8(hits);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return i + findAnySSE2(&data[i], length - i, c0, c1, c2, c3);
+
+}
+
+static const VN200_SCAN_KERNELS vn200AVX2Kernels = {
+    checksumAVX2, findAnyAVX2
+};
+
+#endif // VN200_SCAN_X86
+
+
+#ifdef VN200_SCAN_ARM
+
+/**** NEON kernels ****/
+
+// Bit n of the result is set if byte n of cmp is all ones (NEON has no
+// movemask)
+static inline uint32_t neonMask16(uint8x16_t cmp) {
+
+    static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t masked = vandq_u8(cmp, vld1q_u8(bits));
+    uint8x8_t sum = vpadd_u8(vget_low_u8(masked), vget_high_u8(masked));
+
+    sum = vpadd_u8(sum, sum);
+    sum = vpadd_u8(sum, sum);
+
+    return (uint32_t) vget_lane_u8(sum, 0) | ((uint32_t) vget_lane_u8(sum, 1) << 8);
+
+}
+
+static unsigned char checksumNEON(const unsigned char *data, int length) {
+
+    uint8x16_t acc = vdupq_n_u8(0);
+    uint64_t fold;
+    unsigned char cksum;
+    int i;
+
+    for (i = 0; i + 16 <= length; i += 16) {
+        acc = veorq_u8(acc, vld1q_u8(&data[i]));
+    }
+    fold = vgetq_lane_u64(vreinterpretq_u64_u8(acc), 0) ^ vgetq_lane_u64(vreinterpretq_u64_u8(acc), 1);
+    fold ^= fold >> 32;
+    fold ^= fold >> 16;
+    fold ^= fold >> 8;
+    cksum = (unsigned char) fold;
+
+    for (; i < length; i++) {
+        cksum ^= data[i];
+    }
+
+    return cksum;
+
+}
+
+static int findAnyNEON(const unsigned char *data, int length,
+        unsigned char c0, unsigned char c1, unsigned char c2, unsigned char c3) {
+
+    const uint8x16_t v0 = vdupq_n_u8(c0), v1 = vdupq_n_u8(c1);
+    const uint8x16_t v2 = vdupq_n_u8(c2), v3 = vdupq_n_u8(c3);
+    uint8x16_t x, hits;
+    uint32_t mask;
+    int i;
+
+    for (i = 0; i + 16 <= length; i += 16) {
+        x = vld1q_u8(&data[i]);
+        hits = vorrq_u8(vorrq_u8(vceqq_u8(x, v0), vceqq_u8(x, v1)),
+                vorrq_u8(vceqq_u8(x, v2), vceqq_u8(x, v3)));
+        mask = neonMask16(hits);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+
+    return i + findAnyScalar(&data[i], length - i, c0, c1, c2, c3);
+
+}
+
+static const VN200_SCAN_KERNELS vn200NEONKernels = {
+    checksumNEON, findAnyNEON
+};
+
+#endif // VN200_SCAN_ARM
+
+
+/**** Dispatch ****/
+
+static const VN200_SCAN_KERNELS *vn200Kernels = &vn200ScalarKernels;
+static VN200_SCAN_LEVEL vn200Level = VN200_SCAN_SCALAR;
+static pthread_once_t vn200ScanOnce = PTHREAD_ONCE_INIT;
+
+
+/**** Function vn200ScanKernels ****
+ *
+ * Arguments:
+ * 	level - Kernel set
+ *
+ * Return value:
+ *	Returns the kernels for a set, or NULL if the processor or build does
+ *	not support it
+ */
+static const VN200_SCAN_KERNELS *vn200ScanKernels(VN200_SCAN_LEVEL level) {
+
+    switch (level) {
+        case VN200_SCAN_SCALAR:
+            return &vn200ScalarKernels;
+#ifdef VN200_SCAN_X86
+        case VN200_SCAN_SSE2:
+            return __builtin_cpu_supports("sse2") ? &vn200SSE2Kernels : NULL;
+        case VN200_SCAN_AVX2:
+            return __builtin_cpu_supports("avx2") ? &vn200AVX2Kernels : NULL;
+#endif
+#ifdef VN200_SCAN_ARM
+        case VN200_SCAN_NEON:
+            return &vn200NEONKernels;
+#endif
+        default:
+            return NULL;
+    }
+
+} // vn200ScanKernels(VN200_SCAN_LEVEL)
+
+
+/**** Function vn200ScanSelect ****
+ *
+ * Picks the best kernels the processor supports. Run once, before the first
+ * scan.
+ */
+static void vn200ScanSelect(void) {
+
+    static const VN200_SCAN_LEVEL preferred[] = {
+        VN200_SCAN_AVX2, VN200_SCAN_NEON, VN200_SCAN_SSE2
+    };
+    const VN200_SCAN_KERNELS *kernels;
+    int i;
+
+    for (i = 0; i < (int) (sizeof(preferred) / sizeof(preferred[0])); i++) {
+        kernels = vn200ScanKernels(preferred[i]);
+        if (kernels != NULL) {
+            vn200Kernels = kernels;
+            vn200Level = preferred[i];
+            break;
+        }
+    }
+
+    logDebug(L_DEBUG, "VN200 scan kernels: %s\n", VN200ScanLevelName(vn200Level));
+
+} // vn200ScanSelect(void)
+
+
+/**** Function VN200ScanSetLevel ****
+ *
+ * Chooses which kernels are used. Meant for tests and benchmarks, since the
+ * best supported set is chosen automatically. Not safe to call while other
+ * threads are scanning.
+ *
+ * Arguments:
+ * 	level - Kernel set to use
+ *
+ * Return value:
+ *	On success, returns 0
+ *	If the processor or build does not support the set, returns -1 and
+ *	the kernels are unchanged
+ */
+int VN200ScanSetLevel(VN200_SCAN_LEVEL level) {
+
+    const VN200_SCAN_KERNELS *kernels = vn200ScanKernels(level);
+
+    if (kernels == NULL) {
+        return -1;
+    }
+
+    // Select first so the automatic choice cannot replace this one later
+    pthread_once(&vn200ScanOnce, vn200ScanSelect);
+
+    vn200Kernels = kernels;
+    vn200Level = level;
+
+    return 0;
+
+} // VN200ScanSetLevel(VN200_SCAN_LEVEL)
+
+
+/**** Function VN200ScanGetLevel ****
+ *
+ * Return value:
+ *	Returns the kernel set in use
+ */
+VN200_SCAN_LEVEL VN200ScanGetLevel(void) {
+
+    pthread_once(&vn200ScanOnce, vn200ScanSelect);
+
+    return vn200Level;
+
+} // VN200ScanGetLevel(void)
+
+
+/**** Function VN200ScanLevelName ****
+ *
+ * Return value:
+ *	Returns the name of a kernel set for log messages
+ */
+const char *VN200ScanLevelName(VN200_SCAN_LEVEL level) {
+
+    switch (level) {
+        case VN200_SCAN_SSE2:
+            return "SSE2";
+        case VN200_SCAN_AVX2:
+            return "AVX2";
+        case VN200_SCAN_NEON:
+            return "NEON";
+        case VN200_SCAN_SCALAR:
+        default:
+            return "scalar";
+    }
+
+} // VN200ScanLevelName(VN200_SCAN_LEVEL)
+
+
+/**** Function VN200ChecksumXor ****
+ *
+ * Computes the 8-bit XOR checksum of a sentence body
+ *
+ * Arguments:
+ * 	data   - Pointer to the bytes to check
+ * 	length - Number of bytes
+ *
+ * Return value:
+ *	Returns the checksum (0 for no bytes)
+ */
+unsigned char VN200ChecksumXor(const unsigned char *data, int length) {
+
+    if (data == NULL || length <= 0) {
+        return 0;
+    }
+
+    pthread_once(&vn200ScanOnce, vn200ScanSelect);
+
+    return vn200Kernels->checksum(data, length);
+
+} // VN200ChecksumXor(const unsigned char *, int)
+
+
+/**** Function VN200FindByte ****
+ *
+ * Arguments:
+ * 	data   - Pointer to the bytes to search
+ * 	length - Number of bytes
+ * 	c      - Byte to find
+ *
+ * Return value:
+ *	Returns the index of the first c, or length if there is none
+ */
+int VN200FindByte(const unsigned char *data, int length, unsigned char c) {
+
+    if (data == NULL || length <= 0) {
+        return 0;
+    }
+
+    pthread_once(&vn200ScanOnce, vn200ScanSelect);
+
+    return vn200Kernels->findAny(data, length, c, c, c, c);
+
+} // VN200FindByte(const unsigned char *, int, unsigned char)
+
+
+/**** Function VN200FindFramingByte ****
+ *
+ * Finds the next byte that ends a sentence body: '*', '$', '\r', or '\n'
+ *
+ * Arguments:
+ * 	data   - Pointer to the bytes to search
+ * 	length - Number of bytes
+ *
+ * Return value:
+ *	Returns the index of the first framing byte, or length if there is none
+ */
+int VN200FindFramingByte(const unsigned char *data, int length) {
+
+    if (data == NULL || length <= 0) {
+        return 0;
+    }
+
+    pthread_once(&vn200ScanOnce, vn200ScanSelect);
+
+    return vn200Kernels->findAny(data, length, '*', '$', '\r', '\n');
+
+} // VN200FindFramingByte(const unsigned char *, int)
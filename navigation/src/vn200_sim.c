@@ -0,0 +1,915 @@
+/***************************************************************************\
+ *
+ * File:
+ * 	vn200_sim.c
+ *
+ * Description:
+ *	Produces VN200 output for a vehicle driving a reference trajectory, so
+ *	the parsers and the navigation code can be run without the sensor and
+ *	faster than real time.
+ *
+ *	The trajectory is a list of waypoints (added one at a time or read from
+ *	a GPX file) driven at a constant speed and closed back to the first
+ *	point. Each leg is a cubic in time whose ends match the position and
+ *	velocity of the neighbouring legs, so velocity and acceleration are
+ *	continuous and the IMU output agrees with the GPS output. The vehicle
+ *	stays level and points along its velocity.
+ *
+ *	Every IMU sample carries acceleration, angular rate, magnetic field,
+ *	pressure for the altitude, and temperature. GPS solutions are ECEF
+ *	position and velocity. Both go out as VNIMU and VNGPE sentences or as
+ *	IMU and GPS group binary packets, framed exactly as the sensor frames
+ *	them, with noise, bias, dropped packets, and corrupted bytes as
+ *	configured.
+ *
+ * Author:
+ * 	David Stockhouse
+ *
+ * Revision 0.1
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.2
+ * 	Last edited 10/18/2026
+ * 	Sentence corruption never makes a control byte
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "debuglog.h"
+#include "vn200_binary.h"
+#include "vn200_crc.h"
+
+#include "vn200_sim.h"
+
+// WGS84 ellipsoid
+#define VN200_SIM_WGS84_A  6378137.0
+#define VN200_SIM_WGS84_E2 6.69437999014e-3
+
+// Earth's field near the test site, north, east, down, Gauss
+#define VN200_SIM_MAG_NORTH 0.2370
+#define VN200_SIM_MAG_EAST  0.0440
+#define VN200_SIM_MAG_DOWN  0.4160
+
+// Air temperature, C
+#define VN200_SIM_TEMP 21.0
+
+// GPS solution quality reported
+#define VN200_SIM_GPS_FIX 3
+#define VN200_SIM_GPS_NUMSATS 10
+#define VN200_SIM_GPS_TIMEU 9.0e-9
+
+// Waypoints closer than this to the last one are left out, m
+#define VN200_SIM_MIN_LEG 0.01
+
+#define VN200_SIM_DEG (M_PI / 180.0)
+
+
+/**** Function VN200SimDefaults ****
+ *
+ * Fills in a configuration with the sensor's ASCII defaults and noise near
+ * its datasheet values
+ *
+ * Arguments:
+ * 	config - Configuration to fill in
+ */
+void VN200SimDefaults(VN200_SIM_CONFIG *config) {
+
+    if (config == NULL) {
+        return;
+    }
+
+    memset(config, 0, sizeof(VN200_SIM_CONFIG));
+
+    config->format = VN200_SIM_ASCII;
+    config->imuRate = 100;
+    config->gpsRate = VN200_BINARY_GPS_RATE;
+    config->speed = 2.0;
+
+    config->startWeek = 2075;
+    config->startTow = 345600.0;
+
+    config->accelNoise = 0.01;
+    config->gyroNoise = 0.001;
+    config->magNoise = 0.001;
+    config->baroNoise = 0.01;
+    config->tempNoise = 0.05;
+    config->gpsPosNoise = 2.5;
+    config->gpsVelNoise = 0.05;
+
+    config->seed = 1;
+
+} // VN200SimDefaults(VN200_SIM_CONFIG *)
+
+
+/**** Function VN200SimInit ****
+ *
+ * Arguments:
+ * 	sim    - Pointer to VN200_SIM instance
+ * 	config - Rates, noise, and format, or NULL for VN200SimDefaults
+ *
+ * Return value:
+ *	On success, returns 0
+ *	On failure, returns a negative number
+ */
+int VN200SimInit(VN200_SIM *sim, const VN200_SIM_CONFIG *config) {
+
+    if (sim == NULL) {
+        return -1;
+    }
+
+    memset(sim, 0, sizeof(VN200_SIM));
+
+    if (config == NULL) {
+        VN200SimDefaults(&(sim->config));
+    } else {
+        sim->config = *config;
+    }
+
+    if (sim->config.imuRate <= 0 || sim->config.gpsRate <= 0 ||
+            sim->config.gpsRate > sim->config.imuRate || sim->config.speed <= 0) {
+        logDebug(L_INFO, "VN200 sim: bad rates or speed\n");
+        return -2;
+    }
+
+    // xorshift state must not be zero
+    sim->rng = sim->config.seed ? sim->config.seed : 0x9E3779B97F4A7C15ULL;
+
+    return 0;
+
+} // VN200SimInit(VN200_SIM *, const VN200_SIM_CONFIG *)
+
+
+// Radii of curvature of the ellipsoid along the meridian and the prime
+// vertical at a latitude in radians
+static void vn200SimRadii(double lat, double *meridian, double *normal) {
+
+    double s = sin(lat);
+    double w = 1 - VN200_SIM_WGS84_E2 * s * s;
+
+    *normal = VN200_SIM_WGS84_A / sqrt(w);
+    *meridian = *normal * (1 - VN200_SIM_WGS84_E2) / w;
+
+}
+
+
+// Latitude, longitude (degrees), and altitude to ECEF
+static void vn200SimLlaToEcef(const double *lla, double *ecef) {
+
+    double lat = lla[0] * VN200_SIM_DEG, lon = lla[1] * VN200_SIM_DEG;
+    double meridian, normal;
+
+    vn200SimRadii(lat, &meridian, &normal);
+
+    ecef[0] = (normal + lla[2]) * cos(lat) * cos(lon);
+    ecef[1] = (normal + lla[2]) * cos(lat) * sin(lon);
+    ecef[2] = (normal * (1 - VN200_SIM_WGS84_E2) + lla[2]) * sin(lat);
+
+}
+
+
+// Rotates a north, east, down vector at a latitude and longitude (degrees)
+// into ECEF axes
+static void vn200SimNedToEcef(const double *lla, const double *ned, double *ecef) {
+
+    double sLat = sin(lla[0] * VN200_SIM_DEG), cLat = cos(lla[0] * VN200_SIM_DEG);
+    double sLon = sin(lla[1] * VN200_SIM_DEG), cLon = cos(lla[1] * VN200_SIM_DEG);
+
+    ecef[0] = -sLat * cLon * ned[0] - sLon * ned[1] - cLat * cLon * ned[2];
+    ecef[1] = -sLat * sLon * ned[0] + cLon * ned[1] - cLat * sLon * ned[2];
+    ecef[2] = cLat * ned[0] - sLat * ned[2];
+
+}
+
+
+// Times each leg for the current waypoints. The last leg returns to the
+// first point.
+static void vn200SimTimeLegs(VN200_SIM *sim) {
+
+    const double *p0, *p1;
+    double length;
+    int i, n = sim->numWaypoints;
+
+    sim->legStart[0] = 0;
+    for (i = 0; i < n; i++) {
+        p0 = sim->ned[i];
+        p1 = sim->ned[(i + 1) % n];
+        length = sqrt((p1[0] - p0[0]) * (p1[0] - p0[0]) +
+                (p1[1] - p0[1]) * (p1[1] - p0[1]) +
+                (p1[2] - p0[2]) * (p1[2] - p0[2]));
+        sim->legStart[i + 1] = sim->legStart[i] + length / sim->config.speed;
+    }
+
+    sim->lapTime = sim->legStart[n];
+
+}
+
+
+/**** Function VN200SimAddWaypoint ****
+ *
+ * Adds a point to the end of the trajectory. A point on top of the last one
+ * is left out.
+ *
+ * Arguments:
+ * 	sim - Pointer to VN200_SIM instance
+ * 	lat - Latitude in degrees
+ * 	lon - Longitude in degrees
+ * 	alt - Altitude above the ellipsoid in meters
+ *
+ * Return value:
+ *	On success, returns 0
+ *	On failure, returns a negative number
+ */
+int VN200SimAddWaypoint(VN200_SIM *sim, double lat, double lon, double alt) {
+
+    VN200_SIM_WAYPOINT *origin;
+    double meridian, normal, *ned, *last;
+    int n;
+
+    if (sim == NULL || lat < -90 || lat > 90 || lon < -180 || lon > 180) {
+        return -1;
+    }
+
+    n = sim->numWaypoints;
+    if (n >= VN200_SIM_MAX_WAYPOINTS) {
+        logDebug(L_INFO, "VN200 sim: more than %d waypoints\n", VN200_SIM_MAX_WAYPOINTS);
+        return -2;
+    }
+
+    sim->waypoints[n].lat = lat;
+    sim->waypoints[n].lon = lon;
+    sim->waypoints[n].alt = alt;
+
+    // Flat earth about the first point, which is plenty for a course a few
+    // kilometers across
+    origin = &(sim->waypoints[0]);
+    vn200SimRadii(origin->lat * VN200_SIM_DEG, &meridian, &normal);
+    ned = sim->ned[n];
+    ned[0] = (lat - origin->lat) * VN200_SIM_DEG * (meridian + origin->alt);
+    ned[1] = (lon - origin->lon) * VN200_SIM_DEG * (normal + origin->alt) * cos(origin->lat * VN200_SIM_DEG);
+    ned[2] = origin->alt - alt;
+
+    if (n > 0) {
+        last = sim->ned[n - 1];
+        if (fabs(ned[0] - last[0]) < VN200_SIM_MIN_LEG && fabs(ned[1] - last[1]) < VN200_SIM_MIN_LEG &&
+                fabs(ned[2] - last[2]) < VN200_SIM_MIN_LEG) {
+            return 0;
+        }
+    }
+
+    sim->numWaypoints++;
+    vn200SimTimeLegs(sim);
+
+    return 0;
+
+} // VN200SimAddWaypoint(VN200_SIM *, double, double, double)
+
+
+// Reads the lat and lon attributes of the tag at p, and the ele element
+// before end if there is one
+static int vn200SimGpxPoint(VN200_SIM *sim, const char *p, const char *end) {
+
+    const char *tagEnd, *lat, *lon, *ele;
+    double alt = 0;
+
+    tagEnd = strchr(p, '>');
+    lat = strstr(p, "lat=\"");
+    lon = strstr(p, "lon=\"");
+    if (tagEnd == NULL || lat == NULL || lon == NULL || lat > tagEnd || lon > tagEnd) {
+        return -1;
+    }
+
+    ele = strstr(tagEnd, "<ele>");
+    if (ele != NULL && ele < end) {
+        alt = strtod(ele + 5, NULL);
+    }
+
+    return VN200SimAddWaypoint(sim, strtod(lat + 5, NULL), strtod(lon + 5, NULL), alt);
+
+}
+
+
+// Adds every tag named by open (with its leading '<') between p and end.
+// Each point's elements run to the next point or to end.
+static int vn200SimGpxPoints(VN200_SIM *sim, const char *p, const char *end, const char *open) {
+
+    const char *next;
+    int rc, len = strlen(open), numPoints = 0;
+
+    p = strstr(p, open);
+    while (p != NULL && p < end) {
+        next = strstr(p + len, open);
+        rc = vn200SimGpxPoint(sim, p, (next != NULL && next < end) ? next : end);
+        if (rc < 0) {
+            return rc;
+        }
+        numPoints++;
+        p = next;
+    }
+
+    return numPoints;
+
+}
+
+
+/**** Function VN200SimLoadGpx ****
+ *
+ * Adds the points of a GPX file to the trajectory, such as the course maps
+ * in guidance/rust_code/src/graph
+ *
+ * Arguments:
+ * 	sim     - Pointer to VN200_SIM instance
+ * 	path    - GPX file to read
+ * 	segment - Track segment to follow, counting every <trkseg> in the file
+ * 	          from 0, or a negative number to follow the <wpt> points
+ *
+ * Return value:
+ *	On success, returns the number of points read
+ *	On failure, returns a negative number
+ */
+int VN200SimLoadGpx(VN200_SIM *sim, const char *path, int segment) {
+
+    FILE *file;
+    char *text;
+    const char *start, *end;
+    long size;
+    int i, rc;
+
+    if (sim == NULL || path == NULL) {
+        return -1;
+    }
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        logDebug(L_INFO, "VN200 sim: could not open %s\n", path);
+        return -2;
+    }
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    text = malloc(size + 1);
+    if (text == NULL || size < 0) {
+        free(text);
+        fclose(file);
+        return -3;
+    }
+    size = fread(text, 1, size, file);
+    text[size] = '\0';
+    fclose(file);
+
+    start = text;
+    end = text + size;
+    if (segment >= 0) {
+        for (i = 0; i <= segment && start != NULL; i++) {
+            start = strstr(i == 0 ? start : start + 1, "<trkseg");
+        }
+        end = (start != NULL) ? strstr(start, "</trkseg>") : NULL;
+        if (start == NULL || end == NULL) {
+            logDebug(L_INFO, "VN200 sim: %s has no segment %d\n", path, segment);
+            free(text);
+            return -4;
+        }
+    }
+
+    rc = vn200SimGpxPoints(sim, start, end, (segment >= 0) ? "<trkpt" : "<wpt");
+    free(text);
+
+    if (rc <= 0) {
+        logDebug(L_INFO, "VN200 sim: no points read from %s\n", path);
+        return -5;
+    }
+
+    return rc;
+
+} // VN200SimLoadGpx(VN200_SIM *, const char *, int)
+
+
+// Velocity a leg enters or leaves a waypoint with, along the line between
+// the points on either side. At a point where the path doubles back it is
+// zero, and the vehicle stops to turn around.
+static void vn200SimTangent(const VN200_SIM *sim, int i, double *v) {
+
+    int n = sim->numWaypoints, j;
+    const double *prev = sim->ned[(i + n - 1) % n], *next = sim->ned[(i + 1) % n];
+    double d[3], length;
+
+    for (j = 0; j < 3; j++) {
+        d[j] = next[j] - prev[j];
+    }
+    length = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+
+    for (j = 0; j < 3; j++) {
+        v[j] = (length > VN200_SIM_MIN_LEG) ? sim->config.speed * d[j] / length : 0;
+    }
+
+}
+
+
+/**** Function VN200SimTruth ****
+ *
+ * Arguments:
+ * 	sim   - Pointer to VN200_SIM instance
+ * 	time  - Seconds since the first sample
+ * 	state - Filled in with the motion at that time
+ *
+ * Return value:
+ *	On success, returns 0
+ *	If there is no trajectory, returns a negative number
+ */
+int VN200SimTruth(VN200_SIM *sim, double time, VN200_SIM_STATE *state) {
+
+    const VN200_SIM_WAYPOINT *origin;
+    const double *p0, *p1;
+    double v0[3], v1[3], pos[3], lapTime, legTime, u, u2, u3;
+    double meridian, normal, horizontal;
+    int n, leg, lo, hi, mid, j;
+
+    if (sim == NULL || state == NULL || sim->numWaypoints == 0 || time < 0) {
+        return -1;
+    }
+
+    memset(state, 0, sizeof(VN200_SIM_STATE));
+    state->time = time;
+    n = sim->numWaypoints;
+
+    if (n == 1 || sim->lapTime <= 0) {
+
+        // Parked
+        memcpy(pos, sim->ned[0], sizeof(pos));
+
+    } else {
+
+        // Leg whose time span holds the lap time, by bisection
+        lapTime = fmod(time, sim->lapTime);
+        lo = 0;
+        hi = n;
+        while (hi - lo > 1) {
+            mid = (lo + hi) / 2;
+            if (sim->legStart[mid] <= lapTime) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        leg = lo;
+
+        p0 = sim->ned[leg];
+        p1 = sim->ned[(leg + 1) % n];
+        vn200SimTangent(sim, leg, v0);
+        vn200SimTangent(sim, (leg + 1) % n, v1);
+
+        // Cubic Hermite in u = [0, 1] across the leg, with the tangents
+        // scaled to the leg time
+        legTime = sim->legStart[leg + 1] - sim->legStart[leg];
+        u = (lapTime - sim->legStart[leg]) / legTime;
+        u2 = u * u;
+        u3 = u2 * u;
+        for (j = 0; j < 3; j++) {
+            pos[j] = (2 * u3 - 3 * u2 + 1) * p0[j] + (u3 - 2 * u2 + u) * legTime * v0[j] +
+                (-2 * u3 + 3 * u2) * p1[j] + (u3 - u2) * legTime * v1[j];
+            state->velNed[j] = ((6 * u2 - 6 * u) * (p0[j] - p1[j]) / legTime +
+                    (3 * u2 - 4 * u + 1) * v0[j] + (3 * u2 - 2 * u) * v1[j]);
+            state->accelNed[j] = ((12 * u - 6) * (p0[j] - p1[j]) / legTime +
+                    (6 * u - 4) * v0[j] + (6 * u - 2) * v1[j]) / legTime;
+        }
+    }
+
+    // Heading follows the velocity
+    horizontal = state->velNed[0] * state->velNed[0] + state->velNed[1] * state->velNed[1];
+    if (horizontal > 1e-6) {
+        state->yaw = atan2(state->velNed[1], state->velNed[0]);
+        state->yawRate = (state->velNed[0] * state->accelNed[1] -
+                state->velNed[1] * state->accelNed[0]) / horizontal;
+    }
+
+    origin = &(sim->waypoints[0]);
+    vn200SimRadii(origin->lat * VN200_SIM_DEG, &meridian, &normal);
+    state->lla[0] = origin->lat + pos[0] / (meridian + origin->alt) / VN200_SIM_DEG;
+    state->lla[1] = origin->lon + pos[1] / ((normal + origin->alt) * cos(origin->lat * VN200_SIM_DEG)) / VN200_SIM_DEG;
+    state->lla[2] = origin->alt - pos[2];
+
+    vn200SimLlaToEcef(state->lla, state->ecef);
+    vn200SimNedToEcef(state->lla, state->velNed, state->velEcef);
+
+    return 0;
+
+} // VN200SimTruth(VN200_SIM *, double, VN200_SIM_STATE *)
+
+
+// xorshift64*, fast and good enough for sensor noise
+static inline uint64_t vn200SimRandom(VN200_SIM *sim) {
+
+    sim->rng ^= sim->rng >> 12;
+    sim->rng ^= sim->rng << 25;
+    sim->rng ^= sim->rng >> 27;
+
+    return sim->rng * 0x2545F4914F6CDD1DULL;
+
+}
+
+
+// Uniform in [0, 1)
+static inline double vn200SimUniform(VN200_SIM *sim) {
+
+    return (vn200SimRandom(sim) >> 11) * (1.0 / 9007199254740992.0);
+
+}
+
+
+// Normal with the given standard deviation, by Box-Muller
+static double vn200SimGaussian(VN200_SIM *sim, double sigma) {
+
+    double u1, u2;
+
+    if (sigma <= 0) {
+        return 0;
+    }
+
+    u1 = 1.0 - vn200SimUniform(sim);
+    u2 = vn200SimUniform(sim);
+
+    return sigma * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+
+}
+
+
+// What the IMU measures for a true state. Body axes are forward, right,
+// down, and the vehicle is level.
+static void vn200SimImu(VN200_SIM *sim, const VN200_SIM_STATE *truth, IMU_DATA *imu) {
+
+    const VN200_SIM_CONFIG *config = &(sim->config);
+    const double mag[3] = {VN200_SIM_MAG_NORTH, VN200_SIM_MAG_EAST, VN200_SIM_MAG_DOWN};
+    double c = cos(truth->yaw), s = sin(truth->yaw);
+    double force[3];
+    int j;
+
+    // Specific force is acceleration less gravity, which reads -g on z at
+    // rest
+    force[0] = truth->accelNed[0];
+    force[1] = truth->accelNed[1];
+    force[2] = truth->accelNed[2] - VN200_SIM_GRAVITY;
+
+    imu->accel[0] = c * force[0] + s * force[1];
+    imu->accel[1] = -s * force[0] + c * force[1];
+    imu->accel[2] = force[2];
+
+    imu->gyro[0] = 0;
+    imu->gyro[1] = 0;
+    imu->gyro[2] = truth->yawRate;
+
+    imu->compass[0] = c * mag[0] + s * mag[1];
+    imu->compass[1] = -s * mag[0] + c * mag[1];
+    imu->compass[2] = mag[2];
+
+    for (j = 0; j < 3; j++) {
+        imu->accel[j] += config->accelBias[j] + vn200SimGaussian(sim, config->accelNoise);
+        imu->gyro[j] += config->gyroBias[j] + vn200SimGaussian(sim, config->gyroNoise);
+        imu->compass[j] += vn200SimGaussian(sim, config->magNoise);
+    }
+
+    // Standard atmosphere
+    imu->baro = 101.325 * pow(1 - 2.25577e-5 * truth->lla[2], 5.25588) +
+        vn200SimGaussian(sim, config->baroNoise);
+    imu->temp = VN200_SIM_TEMP + vn200SimGaussian(sim, config->tempNoise);
+
+}
+
+
+// What the GPS reports for a true state at a time since the first sample
+static void vn200SimGps(VN200_SIM *sim, const VN200_SIM_STATE *truth, double time, GPS_DATA *gps) {
+
+    const VN200_SIM_CONFIG *config = &(sim->config);
+    double tow = config->startTow + time;
+    int week = config->startWeek;
+
+    while (tow >= 604800.0) {
+        tow -= 604800.0;
+        week++;
+    }
+
+    gps->time = tow;
+    gps->week = week;
+    gps->GpsFix = VN200_SIM_GPS_FIX;
+    gps->NumSats = VN200_SIM_GPS_NUMSATS;
+
+    gps->PosX = truth->ecef[0] + vn200SimGaussian(sim, config->gpsPosNoise);
+    gps->PosY = truth->ecef[1] + vn200SimGaussian(sim, config->gpsPosNoise);
+    gps->PosZ = truth->ecef[2] + vn200SimGaussian(sim, config->gpsPosNoise);
+    gps->VelX = truth->velEcef[0] + vn200SimGaussian(sim, config->gpsVelNoise);
+    gps->VelY = truth->velEcef[1] + vn200SimGaussian(sim, config->gpsVelNoise);
+    gps->VelZ = truth->velEcef[2] + vn200SimGaussian(sim, config->gpsVelNoise);
+
+    gps->PosAccX = config->gpsPosNoise;
+    gps->PosAccY = config->gpsPosNoise;
+    gps->PosAccZ = config->gpsPosNoise;
+    gps->SpeedAcc = config->gpsVelNoise;
+    gps->TimeAcc = VN200_SIM_GPS_TIMEU;
+
+}
+
+
+// Finishes a sentence body written after the '$' at buf with its checksum
+// and line ending
+static int vn200SimFinishSentence(unsigned char *buf, int len, int bufLen) {
+
+    int n;
+
+    if (len < 0 || len >= bufLen) {
+        return -1;
+    }
+
+    n = snprintf((char *) &buf[len], bufLen - len, "*%02X\r\n",
+            VN200CalculateChecksum(&buf[1], len - 1));
+    if (n < 0 || len + n >= bufLen) {
+        return -1;
+    }
+
+    return len + n;
+
+}
+
+
+static int vn200SimImuSentence(const IMU_DATA *imu, unsigned char *buf, int bufLen) {
+
+    int len = snprintf((char *) buf, bufLen,
+            "$VNIMU,%+08.4f,%+08.4f,%+08.4f,%+07.3f,%+07.3f,%+07.3f,"
+            "%+010.6f,%+010.6f,%+010.6f,%+05.1f,%+08.3f",
+            imu->compass[0], imu->compass[1], imu->compass[2],
+            imu->accel[0], imu->accel[1], imu->accel[2],
+            imu->gyro[0], imu->gyro[1], imu->gyro[2],
+            imu->temp, imu->baro);
+
+    return vn200SimFinishSentence(buf, len, bufLen);
+
+}
+
+
+static int vn200SimGpsSentence(const GPS_DATA *gps, unsigned char *buf, int bufLen) {
+
+    int len = snprintf((char *) buf, bufLen,
+            "$VNGPE,%.6f,%04d,%d,%02d,%+012.3f,%+012.3f,%+012.3f,"
+            "%+08.3f,%+08.3f,%+08.3f,%+08.3f,%+08.3f,%+08.3f,%+08.3f,%.2E",
+            gps->time, gps->week, gps->GpsFix, gps->NumSats,
+            gps->PosX, gps->PosY, gps->PosZ,
+            (double) gps->VelX, (double) gps->VelY, (double) gps->VelZ,
+            (double) gps->PosAccX, (double) gps->PosAccY, (double) gps->PosAccZ,
+            (double) gps->SpeedAcc, (double) gps->TimeAcc);
+
+    return vn200SimFinishSentence(buf, len, bufLen);
+
+}
+
+
+// Little-endian field writers
+static inline int vn200SimPutU16(unsigned char *p, uint16_t value) {
+
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+
+    return 2;
+
+}
+
+static inline int vn200SimPutU64(unsigned char *p, uint64_t value) {
+
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        p[i] = (value >> (8 * i)) & 0xFF;
+    }
+
+    return 8;
+
+}
+
+static inline int vn200SimPutFloat(unsigned char *p, double value) {
+
+    float f = value;
+    uint32_t bits;
+    int i;
+
+    memcpy(&bits, &f, sizeof(bits));
+    for (i = 0; i < 4; i++) {
+        p[i] = (bits >> (8 * i)) & 0xFF;
+    }
+
+    return 4;
+
+}
+
+static inline int vn200SimPutDouble(unsigned char *p, double value) {
+
+    uint64_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    return vn200SimPutU64(p, bits);
+
+}
+
+
+// Starts a one group packet
+static int vn200SimBinaryHeader(unsigned char *p, int group, uint16_t fields) {
+
+    p[0] = VN200_BINARY_SYNC;
+    p[1] = group;
+
+    return 2 + vn200SimPutU16(&p[2], fields);
+
+}
+
+
+// Appends the CRC to a packet, which covers everything after the sync byte
+static int vn200SimBinaryFinish(unsigned char *p, int len) {
+
+    unsigned short crc = VN200CalculateCRC(&p[1], len - 1);
+
+    p[len++] = crc >> 8;
+    p[len++] = crc & 0xFF;
+
+    return len;
+
+}
+
+
+static int vn200SimImuPacket(const IMU_DATA *imu, unsigned char *p, int bufLen) {
+
+    uint16_t fields = VN200_BINARY_IMU_FIELDS;
+    int j, len;
+
+    if (bufLen < VN200BinaryPacketSize(VN200_BINARY_GROUP_IMU, &fields)) {
+        return -1;
+    }
+
+    len = vn200SimBinaryHeader(p, VN200_BINARY_GROUP_IMU, VN200_BINARY_IMU_FIELDS);
+    len += vn200SimPutFloat(&p[len], imu->temp);
+    len += vn200SimPutFloat(&p[len], imu->baro);
+    for (j = 0; j < 3; j++) {
+        len += vn200SimPutFloat(&p[len], imu->compass[j]);
+    }
+    for (j = 0; j < 3; j++) {
+        len += vn200SimPutFloat(&p[len], imu->accel[j]);
+    }
+    for (j = 0; j < 3; j++) {
+        len += vn200SimPutFloat(&p[len], imu->gyro[j]);
+    }
+
+    return vn200SimBinaryFinish(p, len);
+
+}
+
+
+static int vn200SimGpsPacket(const GPS_DATA *gps, unsigned char *p, int bufLen) {
+
+    uint16_t fields = VN200_BINARY_GPS_FIELDS;
+    int len;
+
+    if (bufLen < VN200BinaryPacketSize(VN200_BINARY_GROUP_GPS, &fields)) {
+        return -1;
+    }
+
+    len = vn200SimBinaryHeader(p, VN200_BINARY_GROUP_GPS, VN200_BINARY_GPS_FIELDS);
+    len += vn200SimPutU64(&p[len], (uint64_t) (gps->time * 1e9 + 0.5));
+    len += vn200SimPutU16(&p[len], gps->week);
+    p[len++] = gps->NumSats;
+    p[len++] = gps->GpsFix;
+    len += vn200SimPutDouble(&p[len], gps->PosX);
+    len += vn200SimPutDouble(&p[len], gps->PosY);
+    len += vn200SimPutDouble(&p[len], gps->PosZ);
+    len += vn200SimPutFloat(&p[len], gps->VelX);
+    len += vn200SimPutFloat(&p[len], gps->VelY);
+    len += vn200SimPutFloat(&p[len], gps->VelZ);
+    len += vn200SimPutFloat(&p[len], gps->PosAccX);
+    len += vn200SimPutFloat(&p[len], gps->PosAccY);
+    len += vn200SimPutFloat(&p[len], gps->PosAccZ);
+    len += vn200SimPutFloat(&p[len], gps->SpeedAcc);
+    len += vn200SimPutFloat(&p[len], gps->TimeAcc);
+
+    return vn200SimBinaryFinish(p, len);
+
+}
+
+
+// Drops or corrupts a packet just written at p as configured, and counts
+// it. Only bytes the checksum or CRC covers are changed, never the framing,
+// so each corrupted packet is caught by its check. In a sentence digits and
+// punctuation become lower case letters and letters change case, so the
+// byte stays printable and can never be taken for a '$', '*', or line ending.
+//
+// Returns the length the packet keeps in the output
+static int vn200SimDeliver(VN200_SIM *sim, unsigned char *p, int len, uint64_t *count) {
+
+    int first, last, i;
+
+    if (sim->config.dropRate > 0 && vn200SimUniform(sim) < sim->config.dropRate) {
+        sim->numDropped++;
+        return 0;
+    }
+
+    if (sim->config.corruptRate > 0 && vn200SimUniform(sim) < sim->config.corruptRate) {
+        if (sim->config.format == VN200_SIM_ASCII) {
+            // Body after "$VN", before "*XX\r\n"
+            first = 3;
+            last = len - 6;
+        } else {
+            // Payload after the header, before the CRC
+            first = 4;
+            last = len - 3;
+        }
+        i = first + vn200SimRandom(sim) % (last - first + 1);
+        if (sim->config.format == VN200_SIM_ASCII) {
+            p[i] ^= (p[i] & 0x40) ? 0x20 : 0x40;
+        } else {
+            p[i] ^= 0x01;
+        }
+        sim->numCorrupted++;
+    }
+
+    (*count)++;
+    sim->numBytes += len;
+
+    return len;
+
+}
+
+
+/**** Function VN200SimStep ****
+ *
+ * Produces the output for the next IMU sample: the IMU packet, then a GPS
+ * packet if a GPS solution falls due. Samples are 1 / imuRate seconds
+ * apart starting at 0.
+ *
+ * Arguments:
+ * 	sim    - Pointer to VN200_SIM instance
+ * 	buf    - Output bytes, at least VN200_SIM_MAX_STEP_LEN long
+ * 	bufLen - Size of buf
+ *
+ * Return value:
+ *	On success, returns the number of bytes written to buf (0 when every
+ *	packet was dropped)
+ *	On failure, returns a negative number
+ */
+int VN200SimStep(VN200_SIM *sim, unsigned char *buf, int bufLen) {
+
+    const VN200_SIM_CONFIG *config;
+    VN200_SIM_STATE gpsTruth;
+    IMU_DATA imu;
+    GPS_DATA gps;
+    uint64_t epoch;
+    double time;
+    int len = 0, rc;
+
+    if (sim == NULL || buf == NULL || bufLen < VN200_SIM_MAX_STEP_LEN) {
+        return -1;
+    }
+
+    config = &(sim->config);
+    time = (double) sim->numSteps / config->imuRate;
+
+    if (VN200SimTruth(sim, time, &(sim->truth)) != 0) {
+        return -2;
+    }
+
+    memset(&imu, 0, sizeof(imu));
+    vn200SimImu(sim, &(sim->truth), &imu);
+    if (config->format == VN200_SIM_ASCII) {
+        rc = vn200SimImuSentence(&imu, buf, bufLen);
+    } else {
+        rc = vn200SimImuPacket(&imu, buf, bufLen);
+    }
+    if (rc < 0) {
+        return -3;
+    }
+    len += vn200SimDeliver(sim, buf, rc, &(sim->numImu));
+
+    // A GPS solution goes out with the first sample at or after each epoch
+    epoch = sim->numSteps * config->gpsRate / config->imuRate;
+    if (sim->numSteps == 0 || epoch != (sim->numSteps - 1) * config->gpsRate / config->imuRate) {
+
+        time = (double) epoch / config->gpsRate;
+        VN200SimTruth(sim, time, &gpsTruth);
+
+        memset(&gps, 0, sizeof(gps));
+        vn200SimGps(sim, &gpsTruth, time, &gps);
+        if (config->format == VN200_SIM_ASCII) {
+            rc = vn200SimGpsSentence(&gps, &buf[len], bufLen - len);
+        } else {
+            rc = vn200SimGpsPacket(&gps, &buf[len], bufLen - len);
+        }
+        if (rc < 0) {
+            return -3;
+        }
+        len += vn200SimDeliver(sim, &buf[len], rc, &(sim->numGps));
+    }
+
+    sim->numSteps++;
+
+    return len;
+
+} // VN200SimStep(VN200_SIM *, unsigned char *, int)
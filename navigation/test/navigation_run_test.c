@@ -0,0 +1,97 @@
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "timing.h"
+
+#include "navigation.h"
+#include "navigation_run.h"
+
+#define IP_ADDR "127.0.0.1"
+
+// Stand-ins for the guidance, control and image processing processes
+LINK guidancePeer, controlPeer, imageprocPeer;
+static NAVIGATION_PARAMS navigation;
+
+Describe(NavigationRun);
+
+BeforeEach(NavigationRun) {
+
+    memset(&navigation, 0, sizeof(navigation));
+    ThreadMutexInit(&(navigation.lock), "Navigation params", THREAD_MUTEX_INSTRUMENT);
+    LinkInit(&(navigation.guidance_link), "guidance", LINK_ROLE_CLIENT, IP_ADDR, NAVIGATION_TCP_PORT);
+    LinkInit(&(navigation.control_link), "control", LINK_ROLE_SERVER, IP_ADDR, CONTROL_TCP_PORT);
+    LinkInit(&(navigation.imageproc_link), "imageproc", LINK_ROLE_SERVER, IP_ADDR, IMAGEPROC_TCP_PORT);
+    LinkInit(&guidancePeer, "guidance peer", LINK_ROLE_SERVER, IP_ADDR, NAVIGATION_TCP_PORT);
+    LinkInit(&controlPeer, "control peer", LINK_ROLE_CLIENT, IP_ADDR, CONTROL_TCP_PORT);
+    LinkInit(&imageprocPeer, "imageproc peer", LINK_ROLE_CLIENT, IP_ADDR, IMAGEPROC_TCP_PORT);
+
+}
+
+AfterEach(NavigationRun) {
+
+    LinkClose(&(navigation.guidance_link));
+    LinkClose(&(navigation.control_link));
+    LinkClose(&(navigation.imageproc_link));
+    ThreadMutexDestroy(&(navigation.lock));
+    LinkClose(&guidancePeer);
+    LinkClose(&controlPeer);
+    LinkClose(&imageprocPeer);
+
+}
+
+static int linksUp(void) {
+
+    return LinkIsUp(&(navigation.guidance_link)) && LinkIsUp(&(navigation.control_link)) &&
+        LinkIsUp(&(navigation.imageproc_link));
+
+}
+
+// Runs the navigation loop (and the peers) until the links are in the wanted
+// state. Returns the time taken in milliseconds, or -1 on timeout.
+static int run_until(int wantUp, int timeoutMs) {
+
+    int64_t start = TimeMonotonicNs();
+
+    do {
+        navigation_run(&navigation);
+        LinkService(&guidancePeer);
+        LinkService(&controlPeer);
+        LinkService(&imageprocPeer);
+        if (linksUp() == wantUp) {
+            return (int) ((TimeMonotonicNs() - start) / NSEC_PER_MSEC);
+        }
+        usleep(1000);
+    } while (TimeMonotonicNs() - start < timeoutMs * NSEC_PER_MSEC);
+
+    return -1;
+
+}
+
+Ensure(NavigationRun, reconnects_after_peer_restarts) {
+
+    assert_that(run_until(1, 1000), is_not_equal_to(-1));
+
+    // Guidance (a server) restarts after startup
+    LinkClose(&guidancePeer);
+    assert_that(run_until(0, 1000), is_not_equal_to(-1));
+    LinkInit(&guidancePeer, "guidance peer", LINK_ROLE_SERVER, IP_ADDR, NAVIGATION_TCP_PORT);
+    assert_that(run_until(1, 2000), is_not_equal_to(-1));
+
+    // Control (a client) restarts
+    LinkClose(&controlPeer);
+    assert_that(run_until(0, 1000), is_not_equal_to(-1));
+    LinkInit(&controlPeer, "control peer", LINK_ROLE_CLIENT, IP_ADDR, CONTROL_TCP_PORT);
+    assert_that(run_until(1, 2000), is_not_equal_to(-1));
+
+    assert_that(navigation.guidance_link.numRecoveries, is_equal_to(1));
+    assert_that(navigation.control_link.numRecoveries, is_equal_to(1));
+    assert_that(navigation.imageproc_link.numDrops, is_equal_to(0));
+
+    // Every pass took the params lock
+    assert_that(navigation.lock.numLocks, is_greater_than(0));
+    assert_that(navigation.lock.depth, is_equal_to(0));
+
+}
@@ -1,12 +1,34 @@
 
+#define _GNU_SOURCE
+
 #include <cgreen/cgreen.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <math.h>
 
+#include "debuglog.h"
+#include "timing.h"
+#include "ptydev.h"
+#include "uart.h"
+#include "vn200_cmd.h"
+#include "vn200_config.h"
+#include "vn200.h"
 #include "vn200_struct.h"
 #include "vn200_imu.h"
 #include "vn200_gps.h"
 #include "vn200_crc.h"
+#include "vn200_binary.h"
+#include "vn200_framer.h"
+#include "vn200_field.h"
+#include "vn200_scan.h"
+#include "vn200_packet.h"
+#include "vn200_clock.h"
+#include "vn200_sim.h"
+#include "vn200_decim.h"
 
 Describe(VN200);
 BeforeEach(VN200) {}
@@ -131,3 +153,1858 @@ Ensure(VN200, parse_failures) {
 
 }
 
+
+
+/**** Emulated VN200
+ *
+ * Device model for an emulated serial port (ptydev). Answers register reads
+ * and writes from a register table, counts them and write settings
+ * commands, rejects registers above 99 with $VNERR, ignores the register in ignoreReg, and streams VNIMU sentences on
+ * every tick when enabled, or binary IMU packets once binary output 1
+ * (register 75) is turned on. Replies are only intelligible when the host side
+ * is set to the sensor's current rate (register 05); otherwise noise is
+ * sent, as a real UART would see at the wrong rate.
+ *
+ ****/
+typedef struct {
+    char regs[100][48];
+    int ignoreReg;
+    int streamPerTick;
+    char line[128];
+    int lineLen;
+    unsigned char binary[VN200_BINARY_MAX_LEN];
+    int binaryLen;
+    int numReads, numWrites, numSaves;
+} VN200_MODEL;
+
+static const char imuSentence[] =
+    "$VNIMU,+01.0854,-02.0143,+02.1980,-01.157,+00.271,-09.847,"
+    "+00.001114,+00.000727,+00.002568,+21.4,+084.334*6D\r\n";
+
+static void modelInit(VN200_MODEL *model, int baud) {
+
+    memset(model, 0, sizeof(VN200_MODEL));
+    snprintf(model->regs[3], sizeof(model->regs[3]), "0100012345");
+    snprintf(model->regs[5], sizeof(model->regs[5]), "%d", baud);
+    snprintf(model->regs[7], sizeof(model->regs[7]), "40");
+    model->ignoreReg = -1;
+
+}
+
+static void modelReply(PTY_DEV *pty, const char *body) {
+
+    char out[96];
+    int len;
+
+    len = snprintf(out, sizeof(out), "$%s*%02X\r\n", body,
+            VN200CalculateChecksum((unsigned char *) body, strlen(body)));
+    PtyDevWrite(pty, (unsigned char *) out, len);
+
+}
+
+static int vn200Model(PTY_DEV *pty, const unsigned char *data, int length, void *context) {
+
+    VN200_MODEL *model = (VN200_MODEL *) context;
+    const unsigned char noise[] = {0xE6, 0x9E, 0x80, 0xF8, 0x0F, 0xC3, 0x66, 0x3C};
+    char body[96], value[48];
+    int i, reg;
+
+    // Asynchronous output
+    if (data == NULL) {
+        for (i = 0; i < model->streamPerTick; i++) {
+            if (model->binaryLen > 0 && atoi(model->regs[75]) != 0) {
+                PtyDevWrite(pty, model->binary, model->binaryLen);
+            } else {
+                PtyDevWrite(pty, (const unsigned char *) imuSentence, sizeof(imuSentence) - 1);
+            }
+        }
+        return 0;
+    }
+
+    for (i = 0; i < length; i++) {
+
+        if (data[i] != '\n') {
+            if (model->lineLen < (int) sizeof(model->line) - 1) {
+                model->line[model->lineLen++] = data[i];
+            }
+            continue;
+        }
+        model->line[model->lineLen] = '\0';
+        model->lineLen = 0;
+
+        if (UARTGetBaud(pty->master_fd) != atoi(model->regs[5])) {
+            PtyDevWrite(pty, noise, sizeof(noise));
+            continue;
+        }
+
+        if (sscanf(model->line, "$VNRRG,%d*", &reg) == 1) {
+            if (reg == model->ignoreReg) {
+                continue;
+            } else if (reg > 99) {
+                modelReply(pty, "VNERR,03");
+                continue;
+            }
+            snprintf(body, sizeof(body), "VNRRG,%02d,%s", reg, model->regs[reg]);
+            model->numReads++;
+            modelReply(pty, body);
+        } else if (sscanf(model->line, "$VNWRG,%d,%47[^*]", &reg, value) == 2) {
+            if (reg == model->ignoreReg) {
+                continue;
+            } else if (reg > 99) {
+                modelReply(pty, "VNERR,03");
+                continue;
+            }
+            snprintf(body, sizeof(body), "VNWRG,%02d,%s", reg, value);
+            snprintf(model->regs[reg], sizeof(model->regs[reg]), "%s", value);
+            model->numWrites++;
+            modelReply(pty, body);
+        } else if (strncmp(model->line, "$VNWNV*", 7) == 0) {
+            model->numSaves++;
+            modelReply(pty, "VNWNV");
+        }
+    }
+
+    return 0;
+
+}
+
+Ensure(VN200, detects_and_changes_baud) {
+
+    VN200_MODEL model;
+    PTY_DEV pty;
+    VN200_DEV dev;
+    int rc;
+
+    memset(&dev, 0, sizeof(dev));
+    modelInit(&model, 230400);
+    PtyDevInit(&pty, vn200Model, &model);
+    PtyDevStart(&pty);
+
+    dev.fd = UARTInit(pty.slavePath, 57600);
+    assert_that(dev.fd, is_greater_than(-1));
+    dev.baud = 57600;
+
+    rc = VN200DetectBaud(&dev, 50);
+    assert_that(rc, is_equal_to(230400));
+    assert_that(dev.baud, is_equal_to(230400));
+    assert_that(UARTGetBaud(dev.fd), is_equal_to(230400));
+
+    rc = VN200SetBaud(&dev, 921600, 50);
+    assert_that(rc, is_equal_to(0));
+    assert_that(atoi(model.regs[5]), is_equal_to(921600));
+    assert_that(UARTGetBaud(dev.fd), is_equal_to(921600));
+
+    // Still in agreement after the switch
+    dev.baud = 0;
+    assert_that(VN200DetectBaud(&dev, 50), is_equal_to(921600));
+
+    UARTClose(dev.fd);
+    PtyDevClose(&pty);
+
+}
+
+Ensure(VN200, streaming_throughput) {
+
+    const int numSentences = 500;
+    VN200_MODEL model;
+    PTY_DEV pty;
+    VN200_DEV dev;
+    int64_t start, elapsed;
+    int i, numFound = 0;
+
+    memset(&dev, 0, sizeof(dev));
+    modelInit(&model, 921600);
+    model.streamPerTick = 10;
+
+    // 10 sentences every 2 ms is close to what 921600 baud can carry
+    PtyDevInit(&pty, vn200Model, &model);
+    PtyDevSetPacing(&pty, 921600);
+    PtyDevSetTick(&pty, 2000);
+
+    dev.fd = UARTInit(pty.slavePath, 921600);
+    dev.baud = 921600;
+    dev.logFile.fd = open("/dev/null", O_WRONLY);
+    VN200EnableEvents(&dev, VN200_READ_VMIN);
+    PtyDevStart(&pty);
+
+    start = TimeMonotonicNs();
+    while (numFound < numSentences && TimeMonotonicNs() - start < 10 * NSEC_PER_SEC) {
+        VN200PollWait(&dev, 100);
+        for (i = 0; i < BufferLength(&(dev.inbuf)); i++) {
+            if (BufferIndex(&(dev.inbuf), i) == '$') {
+                numFound++;
+            }
+        }
+        VN200Consume(&dev, BufferLength(&(dev.inbuf)));
+    }
+    elapsed = TimeMonotonicNs() - start;
+
+    logDebug(L_INFO, "VN200 bench: %d sentences (%llu bytes) in %.1f ms, %.0f bytes/s, "
+            "%llu reads, %.1f bytes per read\n",
+            numFound, (unsigned long long) dev.reader.numBytes,
+            (double) elapsed / NSEC_PER_MSEC,
+            (double) dev.reader.numBytes * NSEC_PER_SEC / elapsed,
+            (unsigned long long) dev.reader.numChunks,
+            (double) dev.reader.numBytes / dev.reader.numChunks);
+
+    assert_that(numFound, is_greater_than(numSentences - 1));
+
+    PtyDevClose(&pty);
+    close(dev.logFile.fd);
+    UARTReaderClose(&dev.reader);
+    UARTClose(dev.fd);
+
+}
+
+Ensure(VN200, detect_fails_without_sensor) {
+
+    VN200_DEV dev;
+    int master_fd;
+
+    memset(&dev, 0, sizeof(dev));
+    master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    grantpt(master_fd);
+    unlockpt(master_fd);
+
+    dev.fd = UARTInit(ptsname(master_fd), 115200);
+    assert_that(VN200DetectBaud(&dev, 5), is_less_than(0));
+
+    UARTClose(dev.fd);
+    close(master_fd);
+
+}
+
+Ensure(VN200, byte_arrival_times_back_computed) {
+
+    VN200_DEV dev;
+    int master_fd;
+    int64_t byteNs = UARTByteTimeNs(115200);
+    int64_t firstNs, secondNs;
+
+    memset(&dev, 0, sizeof(dev));
+    master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    grantpt(master_fd);
+    unlockpt(master_fd);
+
+    dev.fd = UARTInit(ptsname(master_fd), 115200);
+    dev.baud = 115200;
+    dev.logFile.fd = open("/dev/null", O_WRONLY);
+    assert_that(VN200EnableEvents(&dev, 4), is_equal_to(0));
+
+    write(master_fd, "$VNIMU,1", 8);
+    assert_that(VN200PollWait(&dev, 200), is_equal_to(8));
+    firstNs = dev.chunks[0].timeNs;
+
+    write(master_fd, ",2*XX", 5);
+    assert_that(VN200PollWait(&dev, 200), is_equal_to(5));
+    secondNs = dev.chunks[1].timeNs;
+
+    // Last byte of each chunk at its stamp, earlier bytes one character apart
+    assert_that(VN200ByteTimeNs(&dev, 7), is_equal_to(firstNs));
+    assert_that(VN200ByteTimeNs(&dev, 0), is_equal_to(firstNs - 7 * byteNs));
+    assert_that(VN200ByteTimeNs(&dev, 8), is_equal_to(secondNs - 4 * byteNs));
+    assert_that(VN200ByteTimeNs(&dev, 13), is_less_than(0));
+
+    // Indices follow the buffer as it is consumed
+    VN200Consume(&dev, 8);
+    assert_that(VN200ByteTimeNs(&dev, 4), is_equal_to(secondNs));
+
+    close(dev.logFile.fd);
+    UARTReaderClose(&dev.reader);
+    UARTClose(dev.fd);
+    close(master_fd);
+
+}
+
+/**** Function open_emulated
+ *
+ * Starts an emulated VN200 at 115200 baud and opens it
+ *
+ ****/
+void open_emulated(VN200_DEV *dev, PTY_DEV *pty, VN200_MODEL *model) {
+
+    memset(dev, 0, sizeof(VN200_DEV));
+    modelInit(model, 115200);
+    PtyDevInit(pty, vn200Model, model);
+    PtyDevStart(pty);
+
+    VN200BaseInit(dev, pty->slavePath, 115200);
+    dev->baud = 115200;
+    dev->logFile.fd = open("/dev/null", O_WRONLY);
+
+}
+
+void close_emulated(VN200_DEV *dev, PTY_DEV *pty) {
+
+    PtyDevClose(pty);
+    close(dev->logFile.fd);
+    UARTClose(dev->fd);
+
+}
+
+Ensure(VN200, pipelined_commands_complete_by_register) {
+
+    VN200_MODEL model;
+    PTY_DEV pty;
+    VN200_DEV dev;
+    char reply[VN200_CMD_REPLY_LEN];
+    int serial, rate, async1, async2, freq;
+    int64_t start, elapsed;
+
+    open_emulated(&dev, &pty, &model);
+
+    // Each reply is delayed as if the sensor took 5 ms per command
+    PtyDevSetLatency(&pty, 5000);
+
+    start = TimeMonotonicNs();
+    serial = VN200CmdRead(&dev, 3, 200);
+    async1 = VN200CmdWrite(&dev, 6, "0", 200);
+    async2 = VN200CmdWrite(&dev, 6, "19", 200);
+    freq = VN200CmdWrite(&dev, 7, "50", 200);
+    rate = VN200CmdRead(&dev, 7, 200);
+
+    // Collected out of order, each matched to its own reply
+    assert_that(VN200CmdWait(&dev, rate, reply, sizeof(reply)), is_equal_to(0));
+    assert_that(reply, is_equal_to_string("50"));
+    assert_that(VN200CmdWait(&dev, serial, reply, sizeof(reply)), is_equal_to(0));
+    assert_that(reply, is_equal_to_string("0100012345"));
+    assert_that(VN200CmdWait(&dev, async2, reply, sizeof(reply)), is_equal_to(0));
+    assert_that(reply, is_equal_to_string("19"));
+    assert_that(VN200CmdWaitAll(&dev), is_equal_to(0));
+    elapsed = TimeMonotonicNs() - start;
+
+    logDebug(L_INFO, "VN200 bench: 5 pipelined commands in %.1f ms\n",
+            (double) elapsed / NSEC_PER_MSEC);
+
+    // Bounded by the sensor, nowhere near the old fixed sleeps
+    assert_that(elapsed, is_less_than(150 * NSEC_PER_MSEC));
+    assert_that(model.regs[6], is_equal_to_string("19"));
+    assert_that(async1, is_not_equal_to(async2));
+    assert_that(freq, is_greater_than(-1));
+
+    close_emulated(&dev, &pty);
+
+}
+
+Ensure(VN200, command_errors_and_timeouts_are_reported) {
+
+    VN200_MODEL model;
+    PTY_DEV pty;
+    VN200_DEV dev;
+    char reply[VN200_CMD_REPLY_LEN];
+    int bad, lost, good;
+    int64_t start, elapsed;
+
+    open_emulated(&dev, &pty, &model);
+    model.ignoreReg = 42;
+
+    bad = VN200CmdWrite(&dev, 120, "1", 100);
+    good = VN200CmdRead(&dev, 3, 100);
+    assert_that(VN200CmdWait(&dev, bad, NULL, 0), is_equal_to(VN200_CMD_ERR_SENSOR));
+    assert_that(VN200CmdWait(&dev, good, reply, sizeof(reply)), is_equal_to(0));
+    assert_that(reply, is_equal_to_string("0100012345"));
+
+    start = TimeMonotonicNs();
+    lost = VN200CmdRead(&dev, 42, 50);
+    good = VN200CmdRead(&dev, 5, 200);
+    assert_that(VN200CmdWait(&dev, lost, NULL, 0), is_equal_to(VN200_CMD_ERR_TIMEOUT));
+    elapsed = TimeMonotonicNs() - start;
+    assert_that(elapsed, is_greater_than(50 * NSEC_PER_MSEC - 1));
+    assert_that(elapsed, is_less_than(150 * NSEC_PER_MSEC));
+
+    assert_that(VN200CmdWait(&dev, good, reply, sizeof(reply)), is_equal_to(0));
+    assert_that(reply, is_equal_to_string("115200"));
+
+    close_emulated(&dev, &pty);
+
+}
+
+Ensure(VN200, overdue_command_expires_without_blocking) {
+
+    VN200_MODEL model;
+    PTY_DEV pty;
+    VN200_DEV dev;
+    int lost;
+    int64_t start, elapsed;
+
+    open_emulated(&dev, &pty, &model);
+    model.ignoreReg = 42;
+
+    // Event driven, so the wait reaches epoll_wait, where a negative timeout
+    // would block until data arrives
+    assert_that(VN200EnableEvents(&dev, 4), is_equal_to(0));
+
+    // Deadline well past before the device is serviced, with nothing to read
+    lost = VN200CmdRead(&dev, 42, 1);
+    usleep(20000);
+
+    start = TimeMonotonicNs();
+    assert_that(VN200CmdService(&dev, 1000), is_equal_to(0));
+    elapsed = TimeMonotonicNs() - start;
+
+    assert_that(elapsed, is_less_than(100 * NSEC_PER_MSEC));
+    assert_that(VN200CmdWait(&dev, lost, NULL, 0), is_equal_to(VN200_CMD_ERR_TIMEOUT));
+
+    close_emulated(&dev, &pty);
+
+}
+
+Ensure(VN200, replies_found_among_async_output) {
+
+    VN200_MODEL model;
+    PTY_DEV pty;
+    VN200_DEV dev;
+    char reply[VN200_CMD_REPLY_LEN];
+    int i, handle;
+
+    open_emulated(&dev, &pty, &model);
+    PtyDevStop(&pty);
+    model.streamPerTick = 3;
+    PtyDevSetTick(&pty, 1000);
+    PtyDevStart(&pty);
+
+    for (i = 0; i < 20; i++) {
+        handle = VN200CmdRead(&dev, 7, 200);
+        assert_that(VN200CmdWait(&dev, handle, reply, sizeof(reply)), is_equal_to(0));
+        assert_that(reply, is_equal_to_string("40"));
+    }
+
+    close_emulated(&dev, &pty);
+
+}
+
+
+/**** Binary packet builders
+ *
+ * Encode packets the way the sensor does, independently of the decoder
+ *
+ ****/
+static int putFloat(unsigned char *p, float value) {
+
+    uint32_t bits;
+    int i;
+
+    memcpy(&bits, &value, sizeof(bits));
+    for (i = 0; i < 4; i++) {
+        p[i] = (bits >> (8 * i)) & 0xFF;
+    }
+
+    return 4;
+
+}
+
+static int putDouble(unsigned char *p, double value) {
+
+    uint64_t bits;
+    int i;
+
+    memcpy(&bits, &value, sizeof(bits));
+    for (i = 0; i < 8; i++) {
+        p[i] = (bits >> (8 * i)) & 0xFF;
+    }
+
+    return 8;
+
+}
+
+static int finishPacket(unsigned char *p, int len) {
+
+    unsigned short crc = VN200CalculateCRC(&p[1], len - 1);
+
+    p[len++] = crc >> 8;
+    p[len++] = crc & 0xFF;
+
+    return len;
+
+}
+
+static int buildImuPacket(unsigned char *p) {
+
+    const float values[] = {
+        21.4, 84.334,                 // Temp, Pres
+        1.0854, -2.0143, 2.1980,      // Mag
+        -1.157, 0.271, -9.847,        // Accel
+        0.001114, 0.000727, 0.002568  // AngularRate
+    };
+    int i, len = 0;
+
+    p[len++] = VN200_BINARY_SYNC;
+    p[len++] = VN200_BINARY_GROUP_IMU;
+    p[len++] = VN200_BINARY_IMU_FIELDS & 0xFF;
+    p[len++] = VN200_BINARY_IMU_FIELDS >> 8;
+    for (i = 0; i < 11; i++) {
+        len += putFloat(&p[len], values[i]);
+    }
+
+    return finishPacket(p, len);
+
+}
+
+static int buildGpsPacket(unsigned char *p) {
+
+    uint64_t towNs = 570937199558000ULL;
+    int i, len = 0;
+
+    p[len++] = VN200_BINARY_SYNC;
+    p[len++] = VN200_BINARY_GROUP_GPS;
+    p[len++] = VN200_BINARY_GPS_FIELDS & 0xFF;
+    p[len++] = VN200_BINARY_GPS_FIELDS >> 8;
+    for (i = 0; i < 8; i++) {
+        p[len++] = (towNs >> (8 * i)) & 0xFF;
+    }
+    p[len++] = 2075 & 0xFF;
+    p[len++] = 2075 >> 8;
+    p[len++] = 7;  // NumSats
+    p[len++] = 3;  // Fix
+    len += putDouble(&p[len], -2006902.850);
+    len += putDouble(&p[len], -4857470.210);
+    len += putDouble(&p[len], 3604176.410);
+    len += putFloat(&p[len], 0.110);
+    len += putFloat(&p[len], -0.680);
+    len += putFloat(&p[len], 0.170);
+    len += putFloat(&p[len], 19.320);
+    len += putFloat(&p[len], 16.935);
+    len += putFloat(&p[len], 16.758);
+    len += putFloat(&p[len], 1.312);
+    len += putFloat(&p[len], 9.00e-9);
+
+    return finishPacket(p, len);
+
+}
+
+Ensure(VN200, config_values_compare_by_field) {
+
+    assert_that(VN200ConfigValuesEqual("50", "50"), is_true);
+    assert_that(VN200ConfigValuesEqual("050", "50"), is_true);
+    assert_that(VN200ConfigValuesEqual("1,2,04,0730", "1,2,4,730"), is_true);
+    assert_that(VN200ConfigValuesEqual("+1.50,-0.25", "1.5,-2.5E-01"), is_true);
+    assert_that(VN200ConfigValuesEqual("40", "50"), is_false);
+    assert_that(VN200ConfigValuesEqual("1,2", "1,2,3"), is_false);
+    assert_that(VN200ConfigValuesEqual("1,2,3", "1,2"), is_false);
+    assert_that(VN200ConfigValuesEqual("1,,3", "1,2,3"), is_false);
+    assert_that(VN200ConfigValuesEqual("", ""), is_true);
+
+}
+
+Ensure(VN200, config_writes_only_differences) {
+
+    VN200_MODEL model;
+    PTY_DEV pty;
+    VN200_DEV dev;
+    VN200_CONFIG config;
+    char binaryValue[VN200_CMD_REPLY_LEN];
+    int64_t firstNs, secondNs;
+
+    open_emulated(&dev, &pty, &model);
+    PtyDevSetLatency(&pty, 5000);
+    snprintf(model.regs[6], sizeof(model.regs[6]), "19");
+    snprintf(model.regs[75], sizeof(model.regs[75]), "0,1,04,0730");
+
+    VN200ConfigReset(&config);
+    assert_that(VN200ConfigSet(&config, 6, "19"), is_equal_to(0));
+    assert_that(VN200ConfigSet(&config, 7, "20"), is_equal_to(0));
+    assert_that(VN200BinaryOutputValue(400, VN200_BINARY_GROUP_IMU, VN200_BINARY_IMU_FIELDS,
+                binaryValue, sizeof(binaryValue)), is_equal_to(0));
+    assert_that(VN200ConfigSet(&config, 75, binaryValue), is_equal_to(0));
+    assert_that(VN200ConfigSet(&config, 7, "50"), is_equal_to(0));
+    assert_that(config.numRegs, is_equal_to(3));
+
+    // First start: two registers differ, and the result is saved
+    assert_that(VN200ConfigApply(&dev, &config, VN200_CONFIG_PERSIST), is_equal_to(2));
+    firstNs = config.elapsedNs;
+    assert_that(model.numReads, is_equal_to(3));
+    assert_that(model.numWrites, is_equal_to(2));
+    assert_that(model.numSaves, is_equal_to(1));
+    assert_that(config.saved, is_true);
+    assert_that(model.regs[7], is_equal_to_string("50"));
+    assert_that(model.regs[75], is_equal_to_string("1,2,04,0730"));
+
+    // Next start: the sensor formats the value its own way, but nothing
+    // differs, so nothing is written or saved
+    snprintf(model.regs[75], sizeof(model.regs[75]), "1,2,4,730");
+    assert_that(VN200ConfigApply(&dev, &config, VN200_CONFIG_PERSIST), is_equal_to(0));
+    secondNs = config.elapsedNs;
+    assert_that(model.numReads, is_equal_to(6));
+    assert_that(model.numWrites, is_equal_to(2));
+    assert_that(model.numSaves, is_equal_to(1));
+    assert_that(config.saved, is_false);
+
+    printf("BENCH VN200 configuration: %.1f ms writing and saving, %.1f ms when already configured\n",
+            (double) firstNs / NSEC_PER_MSEC, (double) secondNs / NSEC_PER_MSEC);
+    assert_that(secondNs, is_less_than(firstNs));
+
+    // A register the sensor rejects is a failure, the rest still apply
+    VN200ConfigSet(&config, 120, "1");
+    snprintf(model.regs[7], sizeof(model.regs[7]), "40");
+    assert_that(VN200ConfigApply(&dev, &config, 0), is_less_than(0));
+    assert_that(config.numWritten, is_equal_to(1));
+    assert_that(model.regs[7], is_equal_to_string("50"));
+
+    close_emulated(&dev, &pty);
+
+}
+
+Ensure(VN200, first_sample_recorded_once) {
+
+    VN200_DEV dev;
+    unsigned char packet[VN200_BINARY_MAX_LEN];
+    IMU_DATA imu;
+    int len;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.openNs = NSEC_PER_SEC;
+    assert_that(VN200MarkSample(&dev, 3 * NSEC_PER_SEC), is_equal_to(1));
+    assert_that(VN200MarkSample(&dev, 4 * NSEC_PER_SEC), is_equal_to(0));
+    assert_that(dev.firstSampleNs, is_equal_to(3 * NSEC_PER_SEC));
+
+    // Decoded binary samples count
+    memset(&dev, 0, sizeof(dev));
+    len = buildImuPacket(packet);
+    BufferAddArray(&(dev.inbuf), packet, len);
+    assert_that(VN200BinaryParse(&dev, &imu, NULL), is_equal_to(VN200_BINARY_HAS_IMU));
+    assert_that(dev.firstSampleNs, is_greater_than(0));
+
+}
+
+// The CRC routine from the VN200 user manual, a byte at a time
+static unsigned short manualCrc(const unsigned char *data, int length) {
+
+    unsigned short crc = 0;
+    int i;
+
+    for (i = 0; i < length; i++) {
+        crc = (unsigned char) (crc >> 8) | (crc << 8);
+        crc ^= data[i];
+        crc ^= (unsigned char) (crc & 0xff) >> 4;
+        crc ^= crc << 12;
+        crc ^= (crc & 0x00ff) << 5;
+    }
+
+    return crc;
+
+}
+
+Ensure(VN200, table_crc_matches_manual_routine) {
+
+    unsigned char data[300];
+    int i;
+
+    for (i = 0; i < (int) sizeof(data); i++) {
+        data[i] = (i * 37 + 11) ^ (i >> 3);
+    }
+
+    // Every length, so each leftover count after the four byte steps is seen
+    for (i = 0; i <= (int) sizeof(data); i++) {
+        assert_that(VN200CalculateCRC(data, i), is_equal_to(manualCrc(data, i)));
+    }
+
+}
+
+Ensure(VN200, binary_packets_decode_into_imu_and_gps) {
+
+    unsigned char packet[VN200_BINARY_MAX_LEN];
+    uint16_t fields = VN200_BINARY_IMU_FIELDS;
+    IMU_DATA imu;
+    GPS_DATA gps;
+    int len;
+
+    memset(&imu, 0, sizeof(imu));
+    memset(&gps, 0, sizeof(gps));
+
+    len = buildImuPacket(packet);
+    assert_that(len, is_equal_to(50));
+    assert_that(VN200BinaryPacketSize(VN200_BINARY_GROUP_IMU, &fields), is_equal_to(len));
+    assert_that(VN200CalculateCRC(&packet[1], len - 1), is_equal_to(0));
+    assert_that(VN200BinaryDecode(packet, len, &imu, &gps), is_equal_to(VN200_BINARY_HAS_IMU));
+
+    significant_figures_for_assert_double_are(5);
+    assert_that_double(imu.compass[0], is_equal_to_double(1.0854));
+    assert_that_double(imu.compass[2], is_equal_to_double(2.1980));
+    assert_that_double(imu.accel[1], is_equal_to_double(0.271));
+    assert_that_double(imu.accel[2], is_equal_to_double(-9.847));
+    assert_that_double(imu.gyro[0], is_equal_to_double(0.001114));
+    assert_that_double(imu.gyro[2], is_equal_to_double(0.002568));
+    assert_that_double(imu.temp, is_equal_to_double(21.4));
+    assert_that_double(imu.baro, is_equal_to_double(84.334));
+
+    len = buildGpsPacket(packet);
+    assert_that(VN200BinaryDecode(packet, len, &imu, &gps), is_equal_to(VN200_BINARY_HAS_GPS));
+
+    significant_figures_for_assert_double_are(12);
+    assert_that_double(gps.time, is_equal_to_double(570937.199558));
+    assert_that(gps.week, is_equal_to(2075));
+    assert_that(gps.GpsFix, is_equal_to(3));
+    assert_that(gps.NumSats, is_equal_to(7));
+    significant_figures_for_assert_double_are(10);
+    assert_that_double(gps.PosX, is_equal_to_double(-2006902.850));
+    assert_that_double(gps.PosZ, is_equal_to_double(3604176.410));
+    significant_figures_for_assert_double_are(4);
+    assert_that_double(gps.VelY, is_equal_to_double(-0.680));
+    assert_that_double(gps.PosAccZ, is_equal_to_double(16.758));
+    assert_that_double(gps.SpeedAcc, is_equal_to_double(1.312));
+
+    // A flipped bit anywhere is caught
+    packet[20] ^= 0x04;
+    assert_that(VN200BinaryDecode(packet, len, &imu, &gps), is_equal_to(-2));
+
+}
+
+Ensure(VN200, binary_packets_decoded_in_place_unless_they_wrap) {
+
+    VN200_DEV dev;
+    unsigned char packet[VN200_BINARY_MAX_LEN];
+    IMU_DATA first, second;
+    int len;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.inbuf.start = dev.inbuf.end = BYTE_BUFFER_LEN - 10;
+    len = buildImuPacket(packet);
+    BufferAddArray(&(dev.inbuf), packet, len);
+    BufferAddArray(&(dev.inbuf), packet, len);
+
+    // Only the packet split by the end of the ring is copied
+    assert_that(VN200BinaryParse(&dev, &first, NULL), is_equal_to(VN200_BINARY_HAS_IMU));
+    assert_that(dev.binary.numCopied, is_equal_to(len));
+    assert_that(VN200BinaryParse(&dev, &second, NULL), is_equal_to(VN200_BINARY_HAS_IMU));
+    assert_that(dev.binary.numCopied, is_equal_to(len));
+    assert_that(dev.binary.numPackets, is_equal_to(2));
+
+    assert_that(memcmp(first.gyro, second.gyro, sizeof(first.gyro)), is_equal_to(0));
+    assert_that(memcmp(first.accel, second.accel, sizeof(first.accel)), is_equal_to(0));
+
+}
+
+Ensure(VN200, binary_framing_resyncs_after_noise_and_bad_crc) {
+
+    unsigned char packet[VN200_BINARY_MAX_LEN], bad[VN200_BINARY_MAX_LEN];
+    unsigned char noise[] = {'$', 'V', 'N', 0xFA, 0xFA, 0x40, 0x13, 0x11, 0x00};
+    VN200_DEV dev;
+    IMU_DATA imu;
+    int len;
+
+    memset(&dev, 0, sizeof(dev));
+    memset(&imu, 0, sizeof(imu));
+    len = buildImuPacket(packet);
+    memcpy(bad, packet, len);
+    bad[30] ^= 0xFF;
+
+    BufferAddArray(&(dev.inbuf), noise, sizeof(noise));
+    BufferAddArray(&(dev.inbuf), bad, len);
+    BufferAddArray(&(dev.inbuf), packet, len);
+    BufferAddArray(&(dev.inbuf), packet, 10);
+
+    // Noise and the corrupted packet are passed over, the good one decoded
+    assert_that(VN200BinaryParse(&dev, &imu, NULL), is_equal_to(VN200_BINARY_HAS_IMU));
+    assert_that(dev.binary.numPackets, is_equal_to(1));
+    assert_that(dev.binary.numCrcErrors, is_equal_to(1));
+    assert_that(dev.binary.numSkipped, is_equal_to(sizeof(noise) + len));
+    significant_figures_for_assert_double_are(4);
+    assert_that_double(imu.accel[2], is_equal_to_double(-9.847));
+
+    // The partial packet waits for the rest
+    assert_that(VN200BinaryParse(&dev, &imu, NULL), is_equal_to(-1));
+    assert_that(BufferLength(&(dev.inbuf)), is_equal_to(10));
+    BufferAddArray(&(dev.inbuf), &packet[10], len - 10);
+    assert_that(VN200BinaryParse(&dev, &imu, NULL), is_equal_to(VN200_BINARY_HAS_IMU));
+    assert_that(BufferLength(&(dev.inbuf)), is_equal_to(0));
+    assert_that(dev.binary.numPackets, is_equal_to(2));
+
+}
+
+Ensure(VN200, binary_output_configured_and_streamed) {
+
+    const int numPackets = 200;
+    VN200_MODEL model;
+    PTY_DEV pty;
+    VN200_DEV dev;
+    IMU_DATA imu;
+    int handle, numFound = 0;
+    int64_t start;
+
+    open_emulated(&dev, &pty, &model);
+    model.binaryLen = buildImuPacket(model.binary);
+
+    handle = VN200BinaryConfigure(&dev, 1, 400, VN200_BINARY_GROUP_IMU, VN200_BINARY_IMU_FIELDS);
+    assert_that(VN200CmdWait(&dev, handle, NULL, 0), is_equal_to(0));
+    assert_that(model.regs[75], is_equal_to_string("1,2,04,0730"));
+
+    // Rejects what the sensor could not send
+    assert_that(VN200BinaryConfigure(&dev, 4, 400, VN200_BINARY_GROUP_IMU, 0x0001), is_less_than(0));
+    assert_that(VN200BinaryConfigure(&dev, 1, 400, VN200_BINARY_GROUP_IMU, 0x8000), is_less_than(0));
+    assert_that(VN200BinaryConfigure(&dev, 1, 400, 0x0C, 0x0001), is_less_than(0));
+
+    PtyDevStop(&pty);
+    model.streamPerTick = 4;
+    PtyDevSetTick(&pty, 1000);
+    PtyDevStart(&pty);
+
+    start = TimeMonotonicNs();
+    while (numFound < numPackets && TimeMonotonicNs() - start < 5 * NSEC_PER_SEC) {
+        VN200PollWait(&dev, 50);
+        while (VN200BinaryParse(&dev, &imu, NULL) == VN200_BINARY_HAS_IMU) {
+            numFound++;
+        }
+    }
+
+    assert_that(numFound, is_greater_than(numPackets - 1));
+    assert_that(dev.binary.numCrcErrors, is_equal_to(0));
+
+    close_emulated(&dev, &pty);
+
+}
+
+
+// Adds received bytes to the device as a read would
+static void feed(VN200_DEV *dev, const void *data, int len) {
+
+    BufferAddArray(&(dev->inbuf), (unsigned char *) data, len);
+    dev->rxOffset += len;
+
+}
+
+Ensure(VN200, framer_resumes_sentence_across_polls) {
+
+    VN200_DEV dev;
+    VN200_PACKET_VIEW view;
+    unsigned char body[VN200_FRAME_MAX_LEN + 1];
+    int i, len = sizeof(imuSentence) - 1;
+
+    memset(&dev, 0, sizeof(dev));
+    feed(&dev, "xx", 2);
+
+    // One byte per poll up to the last checksum character, each examined
+    // once
+    for (i = 0; i < len - 3; i++) {
+        feed(&dev, &imuSentence[i], 1);
+        assert_that(VN200FrameNext(&dev, &view), is_equal_to(0));
+        assert_that(dev.framer.scanned, is_equal_to(BufferLength(&(dev.inbuf))));
+    }
+
+    // Completes on the second checksum character, without the CR LF
+    feed(&dev, &imuSentence[len - 3], 1);
+    assert_that(VN200FrameNext(&dev, &view), is_equal_to(1));
+    assert_that(view.start, is_equal_to(0));
+    assert_that(view.offset, is_equal_to(2));
+    assert_that(view.end, is_equal_to(len - 2));
+    assert_that(dev.framer.numSkipped, is_equal_to(2));
+    assert_that(dev.framer.numPackets, is_equal_to(1));
+
+    assert_that(VN200FrameCopyBody(&dev, &view, body, sizeof(body)), is_equal_to(len - 6));
+    assert_that(strncmp((char *) body, "VNIMU,+01.0854", 14), is_equal_to(0));
+    assert_that(body[len - 6 - 1], is_equal_to('4'));
+
+    // The returned sentence is consumed by the next call
+    feed(&dev, "\r\n", 2);
+    assert_that(VN200FrameNext(&dev, &view), is_equal_to(0));
+    assert_that(BufferLength(&(dev.inbuf)), is_equal_to(0));
+
+}
+
+Ensure(VN200, framer_resyncs_after_garbage) {
+
+    const char stream[] =
+        "\x13\xFA garbage*4$VNIMU,1,2"                     // Cut off by the next '$'
+        "$VNRRG,03,0100012345*00\r\n"                     // Bad checksum
+        "$VNRRG,07,40\r\n"                                // Line ended without '*'
+        "$VNRRG,07,40*5G"                                 // Bad checksum character
+        "$VNRRG,07,40*5C\r\n"                             // Good
+        "$VNRRG,07,40*5c";                                // Good, lowercase
+    VN200_DEV dev;
+    VN200_PACKET_VIEW view;
+    unsigned char body[VN200_FRAME_MAX_LEN + 1];
+    int numFound = 0;
+
+    memset(&dev, 0, sizeof(dev));
+    feed(&dev, stream, sizeof(stream) - 1);
+
+    while (VN200FrameNext(&dev, &view) > 0) {
+        VN200FrameCopyBody(&dev, &view, body, sizeof(body));
+        assert_that((char *) body, is_equal_to_string("VNRRG,07,40"));
+        numFound++;
+    }
+
+    assert_that(numFound, is_equal_to(2));
+    assert_that(dev.framer.numPackets, is_equal_to(2));
+    assert_that(dev.framer.numChecksumErrors, is_equal_to(2));
+    assert_that(dev.framer.numBroken, is_equal_to(2));
+    assert_that(BufferLength(&(dev.inbuf)), is_equal_to(0));
+
+    // A runaway body is dropped instead of growing without bound
+    feed(&dev, "$", 1);
+    for (numFound = 0; numFound < VN200_FRAME_MAX_LEN + 10; numFound++) {
+        feed(&dev, "A", 1);
+    }
+    assert_that(VN200FrameNext(&dev, &view), is_equal_to(0));
+    assert_that(dev.framer.numBroken, is_equal_to(3));
+    assert_that(BufferLength(&(dev.inbuf)), is_equal_to(0));
+
+}
+
+Ensure(VN200, sentences_parsed_in_place_unless_they_wrap) {
+
+    VN200_DEV dev;
+    VN200_PACKET_VIEW view;
+    VN200_PACKET first, second;
+    unsigned char scratch[VN200_FRAME_MAX_LEN], *body;
+    int len = sizeof(imuSentence) - 1;
+
+    // The first sentence runs off the end of the ring
+    memset(&dev, 0, sizeof(dev));
+    dev.inbuf.start = dev.inbuf.end = BYTE_BUFFER_LEN - 20;
+    feed(&dev, imuSentence, len);
+    feed(&dev, imuSentence, len);
+
+    assert_that(VN200FrameNext(&dev, &view), is_equal_to(1));
+    assert_that(VN200FrameBody(&dev, &view, scratch, 10), is_null);
+    body = VN200FrameBody(&dev, &view, scratch, sizeof(scratch));
+    assert_that(body, is_equal_to(scratch));
+    assert_that(dev.framer.numCopied, is_equal_to(len - 6));
+    assert_that(VN200PacketParse(body, view.bodyLen, &first), is_equal_to(VN200_PACKET_IMU));
+
+    // The second lies in one piece and is parsed where it is
+    assert_that(VN200FrameNext(&dev, &view), is_equal_to(1));
+    body = VN200FrameBody(&dev, &view, scratch, sizeof(scratch));
+    assert_that(body, is_equal_to(&(dev.inbuf.buffer[BYTE_BUFFER_MOD(dev.inbuf.start + view.bodyStart)])));
+    assert_that(dev.framer.numCopied, is_equal_to(len - 6));
+    assert_that(VN200PacketParse(body, view.bodyLen, &second), is_equal_to(VN200_PACKET_IMU));
+
+    assert_that(memcmp(first.data.imu.accel, second.data.imu.accel, sizeof(first.data.imu.accel)),
+            is_equal_to(0));
+    assert_that_double(second.data.imu.baro, is_equal_to_double(84.334));
+
+}
+
+// Parses with VN200ParseDouble and strtod and checks they agree to the bit
+static int matchesStrtod(const char *text) {
+
+    double fast, slow;
+    int len = strlen(text);
+
+    if (VN200ParseDouble((const unsigned char *) text, len, &fast) != len) {
+        printf("Did not parse all of %s\n", text);
+        return 0;
+    }
+    slow = strtod(text, NULL);
+
+    if (memcmp(&fast, &slow, sizeof(double)) != 0) {
+        printf("%s: parsed %.17g, strtod %.17g\n", text, fast, slow);
+        return 0;
+    }
+
+    return 1;
+
+}
+
+Ensure(VN200, field_parser_matches_strtod) {
+
+    const char *formats[] = {
+        "%+08.4f", "%+07.3f", "%+010.6f", "%+.6f", "%.3f", "%+013.3f",
+        "%.2E", "%.8e", "%+.9f", "%.12g", "%.15g", "%.17g"
+    };
+    const char *edges[] = {
+        "0", "-0.000", "+1.", ".5", "2.10E-08", "9.00E-09", "1e22", "1e23",
+        "123456789012345678901234", "0.000000000000000000000000123",
+        "9007199254740993", "1.7976931348623157e308", "4.9e-324", "00000000000000000000001.5"
+    };
+    char text[VN200_FIELD_MAX_LEN];
+    double value;
+    int i, numMismatched = 0;
+
+    srand(42);
+
+    for (i = 0; i < (int) (sizeof(edges) / sizeof(edges[0])); i++) {
+        numMismatched += !matchesStrtod(edges[i]);
+    }
+
+    for (i = 0; i < 200000; i++) {
+        value = ((double) rand() / RAND_MAX - 0.5) * pow(10, rand() % 16 - 8);
+        snprintf(text, sizeof(text), formats[i % (sizeof(formats) / sizeof(formats[0]))], value);
+        numMismatched += !matchesStrtod(text);
+    }
+
+    assert_that(numMismatched, is_equal_to(0));
+
+}
+
+Ensure(VN200, field_parser_rejects_malformed) {
+
+    double values[3];
+
+    assert_that(VN200ParseDouble((const unsigned char *) "+", 1, values), is_less_than(0));
+    assert_that(VN200ParseDouble((const unsigned char *) ".", 1, values), is_less_than(0));
+    assert_that(VN200ParseDouble((const unsigned char *) ",1", 2, values), is_less_than(0));
+
+    // Stops at the length even without a terminator
+    assert_that(VN200ParseDouble((const unsigned char *) "12345", 3, values), is_equal_to(3));
+    assert_that_double(values[0], is_equal_to_double(123));
+
+    // An exponent marker without digits is not part of the number
+    assert_that(VN200ParseDouble((const unsigned char *) "2.5E", 4, values), is_equal_to(3));
+
+    assert_that(VN200ParseFields((const unsigned char *) "1,2,3", 5, values, 3), is_equal_to(3));
+    assert_that_double(values[2], is_equal_to_double(3));
+    assert_that(VN200ParseFields((const unsigned char *) "1,2", 3, values, 3), is_less_than(0));
+    assert_that(VN200ParseFields((const unsigned char *) "1,2,3,4", 7, values, 3), is_less_than(0));
+    assert_that(VN200ParseFields((const unsigned char *) "1,,3", 4, values, 3), is_less_than(0));
+    assert_that(VN200ParseFields((const unsigned char *) "1,2,3x", 6, values, 3), is_less_than(0));
+
+}
+
+// Byte at a time versions to check the kernels against
+static unsigned char naiveChecksum(const unsigned char *data, int length) {
+
+    unsigned char cksum = 0;
+    int i;
+
+    for (i = 0; i < length; i++) {
+        cksum ^= data[i];
+    }
+
+    return cksum;
+
+}
+
+static int naiveFind(const unsigned char *data, int length, const char *set) {
+
+    int i;
+
+    for (i = 0; i < length && strchr(set, data[i]) == NULL; i++);
+
+    return i;
+
+}
+
+Ensure(VN200, scan_kernels_match_byte_at_a_time) {
+
+    const VN200_SCAN_LEVEL levels[] = {
+        VN200_SCAN_SCALAR, VN200_SCAN_SSE2, VN200_SCAN_AVX2, VN200_SCAN_NEON
+    };
+    const char alphabet[] = "$*,\r\n0123456789.+-ABCVNIMU";
+    VN200_SCAN_LEVEL original = VN200ScanGetLevel();
+    static unsigned char data[512];
+    int i, j, offset, length, numLevels = 0, numMismatched = 0;
+
+    srand(7);
+
+    for (j = 0; j < (int) (sizeof(levels) / sizeof(levels[0])); j++) {
+        if (VN200ScanSetLevel(levels[j]) < 0) {
+            continue;
+        }
+        numLevels++;
+
+        for (i = 0; i < 20000; i++) {
+
+            // Sparse delimiters so long runs are searched too
+            for (offset = 0; offset < (int) sizeof(data); offset++) {
+                data[offset] = (rand() % 16 == 0) ?
+                    alphabet[rand() % 5] : alphabet[5 + rand() % (sizeof(alphabet) - 6)];
+            }
+            offset = rand() % 64;
+            length = rand() % (sizeof(data) - 64);
+
+            numMismatched += VN200ChecksumXor(&data[offset], length) !=
+                naiveChecksum(&data[offset], length);
+            numMismatched += VN200FindByte(&data[offset], length, ',') !=
+                naiveFind(&data[offset], length, ",");
+            numMismatched += VN200FindFramingByte(&data[offset], length) !=
+                naiveFind(&data[offset], length, "$*\r\n");
+        }
+
+        if (numMismatched > 0) {
+            printf("%s kernels disagree %d times\n", VN200ScanLevelName(levels[j]), numMismatched);
+        }
+    }
+
+    // Nothing to search is not an error
+    assert_that(VN200ChecksumXor(data, 0), is_equal_to(0));
+    assert_that(VN200FindByte(data, 0, '$'), is_equal_to(0));
+
+    assert_that(VN200ScanSetLevel((VN200_SCAN_LEVEL) 99), is_equal_to(-1));
+    assert_that(VN200ScanSetLevel(original), is_equal_to(0));
+
+    assert_that(numLevels, is_greater_than(0));
+    assert_that(numMismatched, is_equal_to(0));
+
+}
+
+// One body of every supported type, in VN200_PACKET_TYPE order
+static const char *packetBodies[VN200_PACKET_NUM_TYPES] = {
+    "VNIMU,+01.0854,-02.0143,+02.1980,-01.157,+00.271,-09.847,"
+        "+00.001114,+00.000727,+00.002568,+21.4,+084.334",
+    "VNGPS,342123.600000,1851,3,09,+40.11402320,-088.24282640,+00227.483,"
+        "+000.030,-000.070,+000.070,+004.290,+004.010,+009.560,+000.250,2.80E-08",
+    "VNGPE,570937.199558,2075,3,07,-2006902.850,-4857470.210,+3604176.410,"
+        "+000.110,-000.680,+000.170,+019.320,+016.935,+016.758,+001.312,9.00E-09",
+    "VNINS,342123.600000,1851,0C2A,+010.365,-000.736,+000.215,+40.11402320,"
+        "-088.24282640,+00227.483,+000.030,-000.070,+000.070,00.9,02.7,0.14",
+    "VNYMR,+006.380,+000.023,-001.953,+1.0640,-0.2531,+3.0614,+00.005,+00.344,"
+        "-09.758,-0.001222,-0.000450,-0.001218",
+    "VNQMR,-0.017386,-0.000303,+0.055490,+0.998308,+1.0661,-0.2520,+3.0581,"
+        "+00.046,+00.376,-09.798,-0.001056,-0.000547,-0.000908",
+    "VNWRG,75,2,16,01,0129",
+    "VNRRG,07,40",
+    "VNERR,12"
+};
+
+Ensure(VN200, packet_table_is_a_perfect_hash) {
+
+    const VN200_PACKET_HANDLER *handler;
+    int slot, numHandlers = 0, seen[VN200_PACKET_NUM_TYPES] = {0};
+
+    for (slot = 0; slot < VN200_PACKET_TABLE_LEN; slot++) {
+        handler = VN200PacketHandler(slot);
+        if (handler == NULL) {
+            continue;
+        }
+        numHandlers++;
+
+        // Each id sits in the slot it hashes to, and no type is missing
+        assert_that(VN200_PACKET_HASH(handler->id), is_equal_to(slot));
+        assert_that(handler->id, is_equal_to_string(VN200PacketName(handler->type)));
+        seen[handler->type]++;
+    }
+
+    assert_that(numHandlers, is_equal_to(VN200_PACKET_NUM_TYPES));
+    for (slot = 0; slot < VN200_PACKET_NUM_TYPES; slot++) {
+        assert_that(seen[slot], is_equal_to(1));
+    }
+
+}
+
+Ensure(VN200, packet_dispatch_parses_every_type) {
+
+    VN200_PACKET packet;
+    unsigned char body[VN200_FRAME_MAX_LEN];
+    int type, len;
+
+    for (type = 0; type < VN200_PACKET_NUM_TYPES; type++) {
+        len = strlen(packetBodies[type]);
+        memcpy(body, packetBodies[type], len);
+        assert_that(VN200PacketLookup(body, len), is_equal_to(type));
+        assert_that(VN200PacketParse(body, len, &packet), is_equal_to(type));
+        assert_that(packet.type, is_equal_to(type));
+    }
+
+    len = strlen(packetBodies[VN200_PACKET_INS]);
+    memcpy(body, packetBodies[VN200_PACKET_INS], len);
+    VN200PacketParse(body, len, &packet);
+    assert_that(packet.data.ins.status, is_equal_to(0x0C2A));
+    assert_that(packet.data.ins.week, is_equal_to(1851));
+    assert_that_double(packet.data.ins.Yaw, is_equal_to_double(10.365));
+    assert_that_double(packet.data.ins.VelUncertainty, is_equal_to_double(0.14));
+
+    len = strlen(packetBodies[VN200_PACKET_GPS]);
+    memcpy(body, packetBodies[VN200_PACKET_GPS], len);
+    VN200PacketParse(body, len, &packet);
+    assert_that_double(packet.data.gps.Longitude, is_equal_to_double(-88.24282640));
+    assert_that(packet.data.gps.NumSats, is_equal_to(9));
+
+    len = strlen(packetBodies[VN200_PACKET_QMR]);
+    memcpy(body, packetBodies[VN200_PACKET_QMR], len);
+    VN200PacketParse(body, len, &packet);
+    assert_that_double(packet.data.qmr.quat[3], is_equal_to_double(0.998308));
+    assert_that_double(packet.data.qmr.gyro[2], is_equal_to_double(-0.000908));
+
+    len = strlen(packetBodies[VN200_PACKET_WRG]);
+    memcpy(body, packetBodies[VN200_PACKET_WRG], len);
+    VN200PacketParse(body, len, &packet);
+    assert_that(packet.data.reg.reg, is_equal_to(75));
+    assert_that(packet.data.reg.value, is_equal_to_string("2,16,01,0129"));
+
+    len = strlen(packetBodies[VN200_PACKET_ERR]);
+    memcpy(body, packetBodies[VN200_PACKET_ERR], len);
+    VN200PacketParse(body, len, &packet);
+    assert_that(packet.data.err.code, is_equal_to(12));
+
+    // Unknown ids, ids that only share a slot, and malformed bodies
+    assert_that(VN200PacketParse((unsigned char *) "VNXYZ,1,2", 9, &packet), is_equal_to(-1));
+    assert_that(VN200PacketParse((unsigned char *) "VNMIU,1,2", 9, &packet), is_equal_to(-1));
+    assert_that(VN200PacketParse((unsigned char *) "VNIMU", 5, &packet), is_equal_to(-1));
+    assert_that(VN200PacketParse((unsigned char *) "VNIMUX1,2", 9, &packet), is_equal_to(-1));
+    assert_that(VN200PacketParse((unsigned char *) "VNIMU,1,2", 9, &packet), is_equal_to(-2));
+    assert_that(VN200PacketParse((unsigned char *) "VNINS,1,2,G,3", 13, &packet), is_equal_to(-2));
+    assert_that(VN200PacketParse((unsigned char *) "VNERR,", 6, &packet), is_equal_to(-2));
+
+}
+
+// Host time a sample with GPS time sensorNs is sent, for a host clock that
+// runs driftPpm fast and a sensor that sends each sample a fixed time late
+static int64_t trueHostNs(int64_t sensorNs, int64_t startSensorNs, double driftPpm) {
+
+    int64_t elapsedNs = sensorNs - startSensorNs;
+
+    return 5 * NSEC_PER_SEC + elapsedNs + (int64_t) (elapsedNs * driftPpm * 1e-6) + NSEC_PER_MSEC;
+
+}
+
+// Delay before a sample is seen on the host: usually a few hundred
+// microseconds, and now and then a stall of tens of milliseconds
+static int64_t arrivalDelayNs(void) {
+
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    if (rand() % 50 == 0) {
+        return 20 * NSEC_PER_MSEC + rand() % (30 * NSEC_PER_MSEC);
+    }
+
+    return (int64_t) (-300 * NSEC_PER_USEC * log(u));
+
+}
+
+Ensure(VN200, clock_model_tracks_offset_and_drift_through_delays) {
+
+    const double driftPpm = 40;
+    const int64_t startNs = VN200ClockGpsToNs(570937.2, 2075);
+    const int64_t stepNs = NSEC_PER_SEC / VN200_BINARY_GPS_RATE;
+    VN200_CLOCK clock;
+    int64_t sensorNs, truthNs, arrivalNs, error;
+    double modelErrorSum = 0, rawErrorSum = 0, worstNs = 0;
+    int i, numChecked = 0;
+
+    srand(3);
+    memset(&clock, 0, sizeof(clock));
+    VN200ClockReset(&clock);
+
+    // Two minutes of GPS solutions at 5 Hz
+    for (i = 0; i < 600; i++) {
+        sensorNs = startNs + i * stepNs;
+        truthNs = trueHostNs(sensorNs, startNs, driftPpm);
+        arrivalNs = truthNs + arrivalDelayNs();
+
+        assert_that(VN200ClockUpdate(&clock, sensorNs, arrivalNs), is_greater_than(-1));
+
+        // Judge the second minute, once the loop has settled
+        if (i >= 300) {
+            error = VN200ClockToHostNs(&clock, sensorNs) - truthNs;
+            modelErrorSum += (error < 0) ? -error : error;
+            rawErrorSum += arrivalNs - truthNs;
+            if (error > worstNs || -error > worstNs) {
+                worstNs = (error < 0) ? -error : error;
+            }
+            numChecked++;
+        }
+    }
+
+    printf("BENCH VN200 clock model: mean error %.1f us, worst %.1f us, drift %.1f ppm (true %.1f)\n",
+            modelErrorSum / numChecked / NSEC_PER_USEC, worstNs / NSEC_PER_USEC,
+            clock.drift * 1e6, driftPpm);
+    printf("BENCH VN200 raw arrival stamps: mean error %.1f us\n",
+            rawErrorSum / numChecked / NSEC_PER_USEC);
+
+    assert_that(VN200ClockIsLocked(&clock), is_true);
+    assert_that(clock.numResets, is_equal_to(0));
+    assert_that(clock.numOutliers, is_greater_than(0));
+    assert_that(worstNs, is_less_than(300 * NSEC_PER_USEC));
+    assert_that(modelErrorSum, is_less_than(rawErrorSum / 2));
+    assert_that(clock.drift * 1e6, is_greater_than(driftPpm - 5));
+    assert_that(clock.drift * 1e6, is_less_than(driftPpm + 5));
+
+    // Extrapolating ten seconds ahead stays within a millisecond
+    sensorNs = startNs + 650 * stepNs;
+    error = VN200ClockToHostNs(&clock, sensorNs) - trueHostNs(sensorNs, startNs, driftPpm);
+    assert_that(error, is_less_than(NSEC_PER_MSEC));
+    assert_that(error, is_greater_than(-NSEC_PER_MSEC));
+
+}
+
+Ensure(VN200, clock_model_starts_over_after_steps) {
+
+    const int64_t startNs = VN200ClockGpsToNs(100, 2075);
+    const int64_t stepNs = NSEC_PER_SEC / VN200_BINARY_GPS_RATE;
+    VN200_CLOCK clock;
+    int i;
+
+    memset(&clock, 0, sizeof(clock));
+    VN200ClockReset(&clock);
+
+    assert_that(VN200ClockGpsToNs(100, 0), is_less_than(0));
+    assert_that(VN200ClockGpsToNs(-1, 2075), is_less_than(0));
+    assert_that(VN200ClockGpsToNs(1.5, 1), is_equal_to(VN200_CLOCK_WEEK_SEC * NSEC_PER_SEC + 1500000000LL));
+    assert_that(VN200ClockToHostNs(&clock, startNs), is_less_than(0));
+
+    for (i = 0; i < 20; i++) {
+        VN200ClockUpdate(&clock, startNs + i * stepNs, NSEC_PER_SEC + i * stepNs);
+    }
+
+    // A repeated solution is not another observation
+    assert_that(VN200ClockUpdate(&clock, startNs + 19 * stepNs, NSEC_PER_SEC + 25 * stepNs), is_equal_to(1));
+
+    // GPS time stepping back starts over from the new observation
+    assert_that(VN200ClockUpdate(&clock, startNs, 9 * NSEC_PER_SEC), is_equal_to(0));
+    assert_that(clock.numResets, is_equal_to(1));
+    assert_that(VN200ClockIsLocked(&clock), is_false);
+    assert_that(VN200ClockToHostNs(&clock, startNs), is_equal_to(9 * NSEC_PER_SEC));
+
+    for (i = 1; i < 20; i++) {
+        VN200ClockUpdate(&clock, startNs + i * stepNs, 9 * NSEC_PER_SEC + i * stepNs);
+    }
+
+    // A lasting jump in arrival times is rejected for a while, then believed
+    for (i = 20; i < 20 + VN200_CLOCK_MAX_OUTLIERS - 1; i++) {
+        assert_that(VN200ClockUpdate(&clock, startNs + i * stepNs, 10 * NSEC_PER_SEC + i * stepNs),
+                is_equal_to(1));
+    }
+    assert_that(VN200ClockUpdate(&clock, startNs + i * stepNs, 10 * NSEC_PER_SEC + i * stepNs),
+            is_equal_to(0));
+    assert_that(clock.numResets, is_equal_to(2));
+    assert_that(VN200ClockToHostNs(&clock, startNs + i * stepNs), is_equal_to(10 * NSEC_PER_SEC + i * stepNs));
+
+}
+
+Ensure(VN200, clock_stamps_parsed_samples) {
+
+    VN200_CLOCK clock;
+    VN200_PACKET packet;
+    unsigned char body[VN200_FRAME_MAX_LEN];
+    int64_t arrivalNs = 7 * NSEC_PER_SEC;
+    int i, len;
+
+    memset(&clock, 0, sizeof(clock));
+    VN200ClockReset(&clock);
+
+    // Samples without GPS time are stamped with their arrival
+    len = strlen(packetBodies[VN200_PACKET_IMU]);
+    memcpy(body, packetBodies[VN200_PACKET_IMU], len);
+    VN200PacketParse(body, len, &packet);
+    assert_that(VN200ClockStamp(&clock, arrivalNs, &packet), is_equal_to(0));
+    assert_that_double(packet.data.imu.timestamp, is_equal_to_double(7.0));
+    assert_that(VN200ClockStamp(&clock, -1, &packet), is_less_than(0));
+
+    // GPS solutions feed the model, then are stamped from it
+    len = strlen(packetBodies[VN200_PACKET_GPE]);
+    memcpy(body, packetBodies[VN200_PACKET_GPE], len);
+    VN200PacketParse(body, len, &packet);
+    for (i = 0; i < VN200_CLOCK_MIN_UPDATES; i++) {
+        assert_that(VN200ClockStamp(&clock, arrivalNs + i * NSEC_PER_SEC / 5, &packet), is_equal_to(0));
+        packet.data.gpe.time += 0.2;
+    }
+    assert_that(VN200ClockIsLocked(&clock), is_true);
+
+    // Once locked, a late arrival does not move the stamp much
+    assert_that(VN200ClockStamp(&clock, arrivalNs + 3 * NSEC_PER_SEC / 5 + 3 * NSEC_PER_MSEC, &packet),
+            is_equal_to(0));
+    assert_that_double(packet.data.gpe.timestamp, is_greater_than_double(7.599));
+    assert_that_double(packet.data.gpe.timestamp, is_less_than_double(7.601));
+
+    // Replies have no time
+    len = strlen(packetBodies[VN200_PACKET_RRG]);
+    memcpy(body, packetBodies[VN200_PACKET_RRG], len);
+    VN200PacketParse(body, len, &packet);
+    assert_that(VN200ClockStamp(&clock, arrivalNs, &packet), is_less_than(0));
+
+}
+
+// Course maps shared with guidance, relative to the navigation directory
+#define GPX_DIR "../guidance/rust_code/src/graph/"
+
+// Simulator with no noise on a 40 m square near the test site, driven
+// clockwise at 8 m/s
+static void squareSim(VN200_SIM *sim, VN200_SIM_FORMAT format) {
+
+    const double lat = 34.6162565, lon = -112.4494117, alt = 1573.8;
+    const double dLat = 40 / 110922.0, dLon = 40 / 91694.0;
+    VN200_SIM_CONFIG config;
+
+    VN200SimDefaults(&config);
+    config.format = format;
+    config.speed = 8;
+    config.accelNoise = config.gyroNoise = config.magNoise = 0;
+    config.baroNoise = config.tempNoise = 0;
+    config.gpsPosNoise = config.gpsVelNoise = 0;
+
+    assert_that(VN200SimInit(sim, &config), is_equal_to(0));
+    VN200SimAddWaypoint(sim, lat, lon, alt);
+    VN200SimAddWaypoint(sim, lat + dLat, lon, alt);
+    VN200SimAddWaypoint(sim, lat + dLat, lon + dLon, alt);
+    VN200SimAddWaypoint(sim, lat, lon + dLon, alt);
+
+}
+
+Ensure(VN200, simulator_ascii_output_parses_back_to_truth) {
+
+    static VN200_SIM sim;
+    VN200_SIM_STATE truth;
+    VN200_DEV dev;
+    VN200_PACKET_VIEW view;
+    VN200_PACKET packet;
+    unsigned char out[VN200_SIM_MAX_STEP_LEN], body[VN200_FRAME_MAX_LEN];
+    double heading = 0, worstPos = 0, error;
+    int i, j, len, numSteps, numImu = 0, numGps = 0;
+
+    squareSim(&sim, VN200_SIM_ASCII);
+    assert_that(sim.numWaypoints, is_equal_to(4));
+    assert_that_double(sim.lapTime, is_greater_than_double(19.9));
+    assert_that_double(sim.lapTime, is_less_than_double(20.1));
+
+    memset(&dev, 0, sizeof(dev));
+    numSteps = (int) (sim.lapTime * sim.config.imuRate + 0.5);
+
+    // One lap, checked sentence by sentence
+    for (i = 0; i < numSteps; i++) {
+        len = VN200SimStep(&sim, out, sizeof(out));
+        assert_that(len, is_greater_than(0));
+        feed(&dev, out, len);
+
+        while (VN200FrameNext(&dev, &view) > 0) {
+            len = VN200FrameCopyBody(&dev, &view, body, sizeof(body));
+            switch (VN200PacketParse(body, len, &packet)) {
+                case VN200_PACKET_IMU:
+                    heading += packet.data.imu.gyro[2] / sim.config.imuRate;
+                    assert_that_double(packet.data.imu.accel[2], is_less_than_double(-VN200_SIM_GRAVITY + 0.001));
+                    assert_that_double(packet.data.imu.accel[2], is_greater_than_double(-VN200_SIM_GRAVITY - 0.001));
+                    numImu++;
+                    break;
+                case VN200_PACKET_GPE:
+                    VN200SimTruth(&sim, packet.data.gpe.time - sim.config.startTow, &truth);
+                    for (j = 0; j < 3; j++) {
+                        error = fabs((&packet.data.gpe.PosX)[j] - truth.ecef[j]);
+                        worstPos = (error > worstPos) ? error : worstPos;
+                    }
+                    numGps++;
+                    break;
+                default:
+                    assert_that(0, is_true);
+            }
+        }
+    }
+
+    assert_that(numImu, is_equal_to(numSteps));
+    // The first sample of each 5 Hz epoch carries a solution
+    assert_that(numGps, is_equal_to((numSteps + 19) / 20));
+    assert_that(sim.numImu, is_equal_to(numImu));
+    assert_that(sim.numGps, is_equal_to(numGps));
+    assert_that(dev.framer.numChecksumErrors, is_equal_to(0));
+
+    // Rounded to the millimeter in the sentence
+    assert_that_double(worstPos, is_less_than_double(0.001));
+
+    // The gyro turns the vehicle once around, clockwise
+    assert_that_double(heading, is_greater_than_double(2 * M_PI - 0.05));
+    assert_that_double(heading, is_less_than_double(2 * M_PI + 0.05));
+
+}
+
+Ensure(VN200, simulator_binary_output_with_dropouts) {
+
+    static VN200_SIM sim;
+    VN200_DEV dev;
+    IMU_DATA imu;
+    GPS_DATA gps;
+    unsigned char out[VN200_SIM_MAX_STEP_LEN];
+    uint64_t numParsed = 0;
+    int i, len, rc;
+
+    squareSim(&sim, VN200_SIM_BINARY);
+    sim.config.dropRate = 0.02;
+    sim.config.corruptRate = 0.02;
+    memset(&dev, 0, sizeof(dev));
+
+    for (i = 0; i < 3000; i++) {
+        len = VN200SimStep(&sim, out, sizeof(out));
+        assert_that(len, is_greater_than(-1));
+        feed(&dev, out, len);
+        while ((rc = VN200BinaryParse(&dev, &imu, &gps)) >= 0) {
+            assert_that(rc, is_greater_than(0));
+            numParsed++;
+        }
+    }
+
+    assert_that(sim.numDropped, is_greater_than(0));
+    assert_that(sim.numCorrupted, is_greater_than(0));
+    assert_that(sim.numImu + sim.numGps + sim.numDropped, is_equal_to(3000 + 3000 / 20));
+
+    // Every corrupted packet, and only those, fails the CRC
+    assert_that(numParsed, is_equal_to(sim.numImu + sim.numGps - sim.numCorrupted));
+    assert_that(dev.binary.numCrcErrors, is_greater_than(sim.numCorrupted - 1));
+
+}
+
+Ensure(VN200, simulator_ascii_output_with_dropouts) {
+
+    static VN200_SIM sim;
+    VN200_DEV dev;
+    VN200_PACKET_VIEW view;
+    unsigned char out[VN200_SIM_MAX_STEP_LEN];
+    int i, len;
+
+    squareSim(&sim, VN200_SIM_ASCII);
+    sim.config.dropRate = 0.02;
+    sim.config.corruptRate = 0.2;
+    memset(&dev, 0, sizeof(dev));
+
+    for (i = 0; i < 3000; i++) {
+        len = VN200SimStep(&sim, out, sizeof(out));
+        assert_that(len, is_greater_than(-1));
+        feed(&dev, out, len);
+        while (VN200FrameNext(&dev, &view) > 0);
+    }
+
+    assert_that(sim.numDropped, is_greater_than(0));
+    assert_that(sim.numCorrupted, is_greater_than(0));
+
+    // Every corrupted sentence, and only those, fails the checksum, and none
+    // is taken for a broken one
+    assert_that(dev.framer.numChecksumErrors, is_equal_to(sim.numCorrupted));
+    assert_that(dev.framer.numPackets, is_equal_to(sim.numImu + sim.numGps - sim.numCorrupted));
+    assert_that(dev.framer.numBroken, is_equal_to(0));
+
+}
+
+Ensure(VN200, simulator_follows_gpx_tracks) {
+
+    static VN200_SIM sim;
+    VN200_SIM_STATE truth;
+
+    VN200SimInit(&sim, NULL);
+    assert_that(VN200SimTruth(&sim, 0, &truth), is_less_than(0));
+    assert_that(VN200SimLoadGpx(&sim, GPX_DIR "Test Triangle.gpx", 0), is_equal_to(7));
+    assert_that(sim.numWaypoints, is_equal_to(7));
+
+    // Starts on the first point
+    assert_that(VN200SimTruth(&sim, 0, &truth), is_equal_to(0));
+    assert_that_double(truth.lla[0], is_equal_to_double(34.6162565));
+    assert_that_double(truth.lla[1], is_equal_to_double(-112.4494117));
+    assert_that_double(truth.lla[2], is_equal_to_double(1573.841));
+
+    // The waypoints instead of the track
+    VN200SimInit(&sim, NULL);
+    assert_that(VN200SimLoadGpx(&sim, GPX_DIR "Test Triangle.gpx", -1), is_equal_to(3));
+
+    assert_that(VN200SimLoadGpx(&sim, GPX_DIR "Test Triangle.gpx", 20), is_less_than(0));
+    assert_that(VN200SimLoadGpx(&sim, GPX_DIR "No Such Map.gpx", 0), is_less_than(0));
+
+}
+
+Ensure(VN200, bench_simulator_parse_times_real_time) {
+
+    static VN200_SIM sim;
+    VN200_SIM_CONFIG config;
+    VN200_DEV dev;
+    VN200_PACKET_VIEW view;
+    VN200_PACKET packet;
+    unsigned char out[VN200_SIM_MAX_STEP_LEN], body[VN200_FRAME_MAX_LEN];
+    const int seconds = 60;
+    int i, len, numParsed = 0;
+    int64_t start, elapsedNs;
+
+    // A minute of 200 Hz output around the full school map, with noise
+    VN200SimDefaults(&config);
+    config.imuRate = 200;
+    VN200SimInit(&sim, &config);
+    assert_that(VN200SimLoadGpx(&sim, GPX_DIR "Full School Map.gpx", 0), is_greater_than(1));
+
+    memset(&dev, 0, sizeof(dev));
+    start = TimeMonotonicNs();
+    for (i = 0; i < seconds * config.imuRate; i++) {
+        len = VN200SimStep(&sim, out, sizeof(out));
+        feed(&dev, out, len);
+        while (VN200FrameNext(&dev, &view) > 0) {
+            len = VN200FrameCopyBody(&dev, &view, body, sizeof(body));
+            if (VN200PacketParse(body, len, &packet) >= 0) {
+                numParsed++;
+            }
+        }
+    }
+    elapsedNs = TimeMonotonicNs() - start;
+
+    printf("BENCH VN200 simulated and parsed: %.0f times real time, %.1f MB\n",
+            (double) seconds * NSEC_PER_SEC / elapsedNs, (double) sim.numBytes / 1e6);
+
+    assert_that(numParsed, is_equal_to(sim.numImu + sim.numGps));
+    assert_that(elapsedNs, is_less_than(seconds * NSEC_PER_SEC / 10));
+
+}
+
+
+/**** IMU decimation ****/
+
+// Quaternions are w, x, y, z
+static void quatMultiply(const double *a, const double *b, double *out) {
+
+    double q[4];
+
+    q[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    q[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    q[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    q[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+    memcpy(out, q, sizeof(q));
+
+}
+
+// Turns q by a body frame rotation vector
+static void quatRotate(double *q, const double *v) {
+
+    double angle = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    double s = angle > 0 ? sin(angle / 2) / angle : 0.5;
+    double r[4] = {cos(angle / 2), s * v[0], s * v[1], s * v[2]};
+
+    quatMultiply(q, r, q);
+
+}
+
+// Adds a body frame vector, turned into the frame q is relative to
+static void quatAddTurned(const double *q, const double *v, double *out) {
+
+    double p[4] = {0, v[0], v[1], v[2]}, conj[4] = {q[0], -q[1], -q[2], -q[3]};
+
+    quatMultiply(q, p, p);
+    quatMultiply(p, conj, p);
+    out[0] += p[1];
+    out[1] += p[2];
+    out[2] += p[3];
+
+}
+
+// Angle between two attitudes, rad
+static double quatAngle(const double *a, const double *b) {
+
+    double conj[4] = {a[0], -a[1], -a[2], -a[3]}, d[4];
+
+    quatMultiply(conj, b, d);
+    return 2 * asin(fmin(1, sqrt(d[1] * d[1] + d[2] * d[2] + d[3] * d[3])));
+
+}
+
+Ensure(VN200, decimator_emits_at_the_navigation_rate) {
+
+    VN200_DECIM decim;
+    VN200_DELTA delta;
+    IMU_DATA imu;
+    const double rate = 0.5, accel = 2.0;
+    double T;
+    int i, numOut = 0;
+
+    assert_that(VN200DecimInit(&decim, 400, 30), is_less_than(0));
+    assert_that(VN200DecimInit(&decim, 400, 800), is_less_than(0));
+    assert_that(VN200DecimInit(&decim, 400, 50), is_equal_to(0));
+    assert_that(decim.ratio, is_equal_to(8));
+
+    // Steady turn while pushed along x
+    memset(&imu, 0, sizeof(imu));
+    imu.gyro[2] = rate;
+    imu.accel[0] = accel;
+    for (i = 0; i < 40; i++) {
+        imu.baro = 100 + i % 8;
+        imu.timestamp = i * 0.0025;
+        if (VN200DecimAdd(&decim, &imu, &delta) == 1) {
+            assert_that(i % 8, is_equal_to(7));
+            numOut++;
+        }
+    }
+    assert_that(numOut, is_equal_to(5));
+    assert_that(decim.numInput, is_equal_to(40));
+    assert_that(decim.numOutput, is_equal_to(5));
+
+    T = 8 * 0.0025;
+    assert_that(delta.numSamples, is_equal_to(8));
+    assert_that_double(delta.dt, is_equal_to_double(T));
+    assert_that_double(delta.timestamp, is_equal_to_double(39 * 0.0025));
+    assert_that_double(delta.baro, is_equal_to_double(103.5));
+    assert_that_double(delta.dTheta[2], is_equal_to_double(rate * T));
+
+    // In the frame at the start of the interval, the push turns with the
+    // body. The rotation is taken out to second order in the angle.
+    assert_that_double(fabs(delta.dVel[0] - accel * sin(rate * T) / rate), is_less_than_double(1e-5));
+    assert_that_double(fabs(delta.dVel[1] - accel * (1 - cos(rate * T)) / rate), is_less_than_double(1e-5));
+    assert_that_double(delta.dVel[2], is_equal_to_double(0));
+
+    // A gap starts the interval over
+    VN200DecimAdd(&decim, &imu, &delta);
+    VN200DecimReset(&decim);
+    for (i = 0; i < 7; i++) {
+        assert_that(VN200DecimAdd(&decim, &imu, &delta), is_equal_to(0));
+    }
+    assert_that(VN200DecimAdd(&decim, &imu, &delta), is_equal_to(1));
+
+}
+
+// Mean rates over each sample period, as the sensor reports them
+#define DECIM_INPUT_RATE  400
+#define DECIM_OUTPUT_RATE 50
+#define DECIM_SECONDS     10
+
+Ensure(VN200, decimator_compensates_coning) {
+
+    VN200_DECIM decim;
+    VN200_DELTA delta;
+    IMU_DATA imu;
+    const double dt = 1.0 / DECIM_INPUT_RATE, a = 0.1, w = 2 * M_PI * 5;
+    double truth[4], full[4], comp[4], naive[4], naiveAngle[3] = {0, 0, 0}, t0, t1;
+    int i, j;
+
+    VN200DecimInit(&decim, DECIM_INPUT_RATE, DECIM_OUTPUT_RATE);
+    memset(&imu, 0, sizeof(imu));
+
+    // The body axis sweeps a cone of half angle a, a common case for
+    // vibration, and a pure worst case for summing rates
+    truth[0] = cos(a / 2); truth[1] = 0; truth[2] = sin(a / 2); truth[3] = 0;
+    memcpy(full, truth, sizeof(truth));
+    memcpy(comp, truth, sizeof(truth));
+    memcpy(naive, truth, sizeof(truth));
+
+    for (i = 0; i < DECIM_SECONDS * DECIM_INPUT_RATE; i++) {
+        t0 = i * dt;
+        t1 = t0 + dt;
+        imu.gyro[0] = -2 * w * sin(a / 2) * sin(a / 2);
+        imu.gyro[1] = sin(a) * (cos(w * t1) - cos(w * t0)) / dt;
+        imu.gyro[2] = sin(a) * (sin(w * t1) - sin(w * t0)) / dt;
+
+        for (j = 0; j < 3; j++) {
+            naiveAngle[j] += imu.gyro[j] * dt;
+        }
+        quatRotate(full, (double []) {imu.gyro[0] * dt, imu.gyro[1] * dt, imu.gyro[2] * dt});
+
+        if (VN200DecimAdd(&decim, &imu, &delta) == 1) {
+            quatRotate(comp, delta.dTheta);
+            quatRotate(naive, naiveAngle);
+            memset(naiveAngle, 0, sizeof(naiveAngle));
+        }
+    }
+
+    truth[0] = cos(a / 2); truth[1] = 0;
+    truth[2] = sin(a / 2) * cos(w * DECIM_SECONDS);
+    truth[3] = sin(a / 2) * sin(w * DECIM_SECONDS);
+
+    printf("BENCH VN200 coning, %d Hz to %d Hz for %d s: attitude error %.4f deg compensated, "
+            "%.4f deg summed, %.4f deg at %d Hz\n", DECIM_INPUT_RATE, DECIM_OUTPUT_RATE, DECIM_SECONDS,
+            quatAngle(truth, comp) * 180 / M_PI, quatAngle(truth, naive) * 180 / M_PI,
+            quatAngle(truth, full) * 180 / M_PI, DECIM_INPUT_RATE);
+
+    assert_that_double(quatAngle(truth, comp), is_less_than_double(quatAngle(truth, naive) / 10));
+    assert_that_double(quatAngle(truth, comp), is_less_than_double(2 * quatAngle(truth, full) + 1e-6));
+
+}
+
+Ensure(VN200, decimator_compensates_sculling) {
+
+    VN200_DECIM decim;
+    VN200_DELTA delta;
+    IMU_DATA imu;
+    const double dt = 1.0 / DECIM_INPUT_RATE, A = 0.05, B = 1.0, w = 2 * M_PI * 5;
+    const int numFine = 64;
+    double truth[3] = {0, 0, 0}, comp[3] = {0, 0, 0}, naive[3] = {0, 0, 0};
+    double compQ[4] = {1, 0, 0, 0}, naiveQ[4] = {1, 0, 0, 0};
+    double sumAngle[3] = {0, 0, 0}, sumVel[3] = {0, 0, 0}, t0, t1, t, compError, naiveError;
+    int i, j;
+
+    VN200DecimInit(&decim, DECIM_INPUT_RATE, DECIM_OUTPUT_RATE);
+    memset(&imu, 0, sizeof(imu));
+
+    // Rolling back and forth about x, in phase with a push along y, rectifies
+    // into a steady velocity along z
+    for (i = 0; i < DECIM_SECONDS * DECIM_INPUT_RATE; i++) {
+        t0 = i * dt;
+        t1 = t0 + dt;
+        imu.gyro[0] = A * (sin(w * t1) - sin(w * t0)) / dt;
+        imu.accel[1] = B * (cos(w * t0) - cos(w * t1)) / (w * dt);
+
+        for (j = 0; j < numFine; j++) {
+            t = t0 + (j + 0.5) * dt / numFine;
+            truth[1] += cos(A * sin(w * t)) * B * sin(w * t) * dt / numFine;
+            truth[2] += sin(A * sin(w * t)) * B * sin(w * t) * dt / numFine;
+        }
+
+        for (j = 0; j < 3; j++) {
+            sumAngle[j] += imu.gyro[j] * dt;
+            sumVel[j] += imu.accel[j] * dt;
+        }
+
+        if (VN200DecimAdd(&decim, &imu, &delta) == 1) {
+            quatAddTurned(compQ, delta.dVel, comp);
+            quatRotate(compQ, delta.dTheta);
+            quatAddTurned(naiveQ, sumVel, naive);
+            quatRotate(naiveQ, sumAngle);
+            memset(sumAngle, 0, sizeof(sumAngle));
+            memset(sumVel, 0, sizeof(sumVel));
+        }
+    }
+
+    compError = sqrt(pow(comp[0] - truth[0], 2) + pow(comp[1] - truth[1], 2) + pow(comp[2] - truth[2], 2));
+    naiveError = sqrt(pow(naive[0] - truth[0], 2) + pow(naive[1] - truth[1], 2) + pow(naive[2] - truth[2], 2));
+
+    printf("BENCH VN200 sculling, %d Hz to %d Hz for %d s: velocity error %.5f m/s compensated, "
+            "%.5f m/s summed, of %.4f m/s rectified\n", DECIM_INPUT_RATE, DECIM_OUTPUT_RATE,
+            DECIM_SECONDS, compError, naiveError, truth[2]);
+
+    assert_that_double(truth[2], is_greater_than_double(0.1));
+    assert_that_double(compError, is_less_than_double(naiveError / 10));
+    assert_that_double(compError, is_less_than_double(0.01 * truth[2]));
+
+}
+
+Ensure(VN200, bench_parse_in_place_versus_copied_body) {
+
+    static VN200_SIM sim;
+    static unsigned char stream[4000000];
+    VN200_SIM_CONFIG config;
+    VN200_DEV dev;
+    VN200_PACKET_VIEW view;
+    VN200_PACKET packet;
+    unsigned char body[VN200_FRAME_MAX_LEN + 1], *inPlace;
+    const int readLen = VN200_READ_VMIN;
+    int i, len, total = 0, numCopiedParsed = 0, numInPlaceParsed = 0, pass;
+    uint64_t numCopied, numInPlace, copiedBytes, inPlaceBytes;
+    int64_t start, copiedNs = INT64_MAX, inPlaceNs = INT64_MAX, elapsedNs;
+
+    // Half a minute of 200 Hz ASCII output
+    VN200SimDefaults(&config);
+    config.imuRate = 200;
+    VN200SimInit(&sim, &config);
+    VN200SimAddWaypoint(&sim, 34.6162565, -112.4494117, 1573.8);
+    VN200SimAddWaypoint(&sim, 34.6166, -112.4494117, 1573.8);
+    VN200SimAddWaypoint(&sim, 34.6166, -112.449, 1573.8);
+    for (i = 0; i < 30 * config.imuRate; i++) {
+        len = VN200SimStep(&sim, &stream[total], sizeof(stream) - total);
+        assert_that(len, is_greater_than(0));
+        total += len;
+    }
+
+    for (pass = 0; pass < 3; pass++) {
+
+        // Body copied out, then parsed
+        memset(&dev, 0, sizeof(dev));
+        numCopiedParsed = 0;
+        start = TimeMonotonicNs();
+        for (i = 0; i < total; i += readLen) {
+            feed(&dev, &stream[i], (total - i < readLen) ? total - i : readLen);
+            while (VN200FrameNext(&dev, &view) > 0) {
+                len = VN200FrameCopyBody(&dev, &view, body, sizeof(body));
+                numCopiedParsed += (VN200PacketParse(body, len, &packet) >= 0);
+            }
+        }
+        elapsedNs = TimeMonotonicNs() - start;
+        copiedNs = (elapsedNs < copiedNs) ? elapsedNs : copiedNs;
+        numCopied = dev.framer.numPackets;
+        copiedBytes = dev.framer.numCopied;
+
+        // Parsed where it lies in the ring
+        memset(&dev, 0, sizeof(dev));
+        numInPlaceParsed = 0;
+        start = TimeMonotonicNs();
+        for (i = 0; i < total; i += readLen) {
+            feed(&dev, &stream[i], (total - i < readLen) ? total - i : readLen);
+            while (VN200FrameNext(&dev, &view) > 0) {
+                inPlace = VN200FrameBody(&dev, &view, body, sizeof(body));
+                numInPlaceParsed += (VN200PacketParse(inPlace, view.bodyLen, &packet) >= 0);
+            }
+        }
+        elapsedNs = TimeMonotonicNs() - start;
+        inPlaceNs = (elapsedNs < inPlaceNs) ? elapsedNs : inPlaceNs;
+        numInPlace = dev.framer.numPackets;
+        inPlaceBytes = dev.framer.numCopied;
+    }
+
+    printf("BENCH VN200 bytes copied per sentence: %.1f copying the body, %.2f in place "
+            "(%llu sentences, %.1f MB)\n",
+            (double) copiedBytes / numCopied, (double) inPlaceBytes / numInPlace,
+            (unsigned long long) numInPlace, (double) total / 1e6);
+    printf("BENCH VN200 frame and parse: %.1f ns per sentence copying the body, %.1f ns in place\n",
+            (double) copiedNs / numCopied, (double) inPlaceNs / numInPlace);
+
+    assert_that(numInPlaceParsed, is_equal_to(sim.numImu + sim.numGps));
+    assert_that(numCopiedParsed, is_equal_to(numInPlaceParsed));
+
+    // Only sentences that wrap are copied, a few per ring's worth of input
+    assert_that(inPlaceBytes * 20, is_less_than(copiedBytes));
+
+}
@@ -15,6 +15,9 @@
  * Revision 0.2
  * 	Last edited 2/13/2020
  *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ *
  \***************************************************************************/
 
 #ifndef __BUFFER_H
@@ -57,5 +60,7 @@ int BufferLength(BYTE_BUFFER *);
 
 int BufferCopy(BYTE_BUFFER *, unsigned char *, int, int);
 
+int BufferSegment(BYTE_BUFFER *, int, int, unsigned char **);
+
 #endif
 
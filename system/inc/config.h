@@ -56,5 +56,31 @@
 #define CONTROL_TCP_PORT        31401
 #define IMAGEPROC_TCP_PORT      31403
 
+// Multicast group for high-rate state (IMU samples, pose) that any subsystem
+// may subscribe to. Senders publish on the interface of their own address.
+#define STATE_MCAST_GROUP       "239.255.31.40"
+#define STATE_MCAST_PORT        31410
+
+// Periods of the subsystem control loops, run as periodic tasks (thread.h)
+#define CONTROL_PERIOD_US       10000
+#define NAVIGATION_PERIOD_US    5000
+#define IMAGEPROC_PERIOD_US     20000
+
+// How often the watchdog looks for stalled loops, and how many periods a
+// loop may go without checking in
+#define WATCHDOG_CHECK_PERIOD_US    1000
+#define WATCHDOG_BUDGET_PERIODS     3
+
+// Cores the subsystem loops are pinned to, ideally isolated with isolcpus=
+// and left out of IRQ affinity. Core 0 is left for housekeeping.
+#define SUBSYSTEM_RT_CPU_MASK   0x2
+
+// Cores for batch work in a thread pool (pool.h), everything but the
+// realtime cores. Cores that aren't present are ignored.
+#define POOL_CPU_MASK           (~(unsigned long) SUBSYSTEM_RT_CPU_MASK)
+
+// Stack given to realtime threads, allocated and touched up front
+#define SUBSYSTEM_RT_STACK_SIZE (256 * 1024)
+
 #endif // MR_FUSION_SYSTEM_CONFIG
 
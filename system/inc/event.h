@@ -0,0 +1,41 @@
+/****************************************************************************
+ *
+ * File:
+ *      event.h
+ *
+ * Description:
+ *      Function and type declarations and constants for event.c
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __EVENT_H
+#define __EVENT_H
+
+#include <stdint.h>
+
+typedef struct {
+
+    int fd;
+
+    // Statistics
+    uint64_t numSignals, numWakeups, numTimeouts;
+
+} EVENT;
+
+int EventInit(EVENT *event);
+
+int EventSignal(EVENT *event);
+
+int EventWait(EVENT *event, int timeoutMs);
+
+int EventFd(EVENT *event);
+
+int EventClose(EVENT *event);
+
+#endif // __EVENT_H
@@ -0,0 +1,100 @@
+/****************************************************************************
+ *
+ * File:
+ *      link.h
+ *
+ * Description:
+ *      Function and type declarations and constants for link.c
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __LINK_H
+#define __LINK_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Which end of the connection this link is
+#define LINK_ROLE_CLIENT    0
+#define LINK_ROLE_SERVER    1
+
+// Connection state
+#define LINK_STATE_DOWN         0
+#define LINK_STATE_CONNECTING   1
+#define LINK_STATE_UP           2
+
+// Reconnect backoff, doubles after every failed attempt up to the maximum
+#define LINK_BACKOFF_MIN_MS     10
+#define LINK_BACKOFF_MAX_MS     200
+
+// Give up on a connect that has not completed and start over
+#define LINK_CONNECT_TIMEOUT_MS 250
+
+// Keepalive probing for peers that vanish without closing the connection
+#define LINK_KEEPALIVE_IDLE_S   1
+#define LINK_KEEPALIVE_INTVL_S  1
+#define LINK_KEEPALIVE_COUNT    2
+#define LINK_USER_TIMEOUT_MS    1000
+
+#define LINK_NAME_LENGTH 32
+
+typedef struct {
+
+    char name[LINK_NAME_LENGTH];
+    int role, state;
+
+    // Peer address (client) or local address to listen on (server)
+    char ipAddr[16];
+    int port;
+
+    // Connected socket, and listening socket for servers (kept open)
+    int fd, listen_fd;
+
+    // Reconnect scheduling
+    int backoffMs;
+    int64_t nextAttemptNs, connectStartNs;
+
+    // Optional heartbeat timeout, link is declared dead if nothing is
+    // received for this long (0 to rely on keepalive only)
+    int rxTimeoutMs;
+    int64_t lastRxNs;
+
+    // Recovery statistics, only counted once the link has been up before
+    int wasUp;
+    int64_t downSinceNs;
+    int64_t lastRecoveryNs, maxRecoveryNs, totalRecoveryNs;
+    int numDrops, numRecoveries, numAttempts;
+
+    // Queueing delay between kernel arrival and application read
+    int64_t lastRxQueueNs, maxRxQueueNs, totalRxQueueNs;
+    int numRxStamped;
+
+} LINK;
+
+int LinkInit(LINK *link, const char *name, int role, char *ipAddr, int port);
+
+int LinkSetRxTimeout(LINK *link, int rxTimeoutMs);
+
+int LinkService(LINK *link);
+
+int LinkIsUp(LINK *link);
+
+int LinkRead(LINK *link, unsigned char *buf, int length);
+
+int LinkReadTimestamped(LINK *link, unsigned char *buf, int length, struct timespec *ts);
+
+int LinkWrite(LINK *link, unsigned char *buf, int length);
+
+int LinkDrop(LINK *link);
+
+int LinkReportStats(LINK *link);
+
+int LinkClose(LINK *link);
+
+#endif // __LINK_H
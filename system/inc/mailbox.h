@@ -0,0 +1,71 @@
+/****************************************************************************
+ *
+ * File:
+ *      mailbox.h
+ *
+ * Description:
+ *      Function and type declarations and constants for mailbox.c
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __MAILBOX_H
+#define __MAILBOX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Largest value a mailbox can carry, ex. a pose or a guidance command
+#define MAILBOX_MAX_SIZE    256
+
+#define MAILBOX_CACHE_LINE  64
+
+// Set in state when the shared slot holds a value the reader hasn't taken
+#define MAILBOX_NEW         0x4
+#define MAILBOX_INDEX_MASK  0x3
+
+typedef struct {
+    uint64_t sequence; // Publish count when the value was written
+    unsigned char data[MAILBOX_MAX_SIZE];
+} __attribute__((aligned(MAILBOX_CACHE_LINE))) MAILBOX_SLOT;
+
+// Three slots rotate between the writer, the reader, and a shared middle
+// slot. Each side only ever swaps its own slot with the middle one, so
+// neither side waits on the other and the reader never sees a torn value.
+typedef struct {
+
+    MAILBOX_SLOT slots[3];
+    size_t size;
+
+    // Index of the middle slot, plus MAILBOX_NEW
+    volatile unsigned int state __attribute__((aligned(MAILBOX_CACHE_LINE)));
+
+    // Writer side
+    unsigned int writeIndex __attribute__((aligned(MAILBOX_CACHE_LINE)));
+    uint64_t numPublished;
+
+    // Reader side
+    unsigned int readIndex __attribute__((aligned(MAILBOX_CACHE_LINE)));
+    uint64_t lastSequence;
+    uint64_t numSkipped; // Values overwritten before the reader saw them
+
+} MAILBOX;
+
+int MailboxInit(MAILBOX *mailbox, size_t size);
+
+void *MailboxWriteBuffer(MAILBOX *mailbox);
+
+int MailboxCommit(MAILBOX *mailbox);
+
+int MailboxPublish(MAILBOX *mailbox, const void *value);
+
+const void *MailboxLatest(MAILBOX *mailbox, int *isNew);
+
+int MailboxRead(MAILBOX *mailbox, void *value);
+
+#endif // __MAILBOX_H
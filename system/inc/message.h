@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ * File:
+ *      message.h
+ *
+ * Description:
+ *      Wire formats for messages passed between the guidance, navigation,
+ *      control, and imageproc subsystems, and declarations for message.c
+ *
+ *      Every message is a packed, fixed-size, little-endian struct that starts
+ *      with a MSG_HEADER. Sizes are checked at compile time, so any change to
+ *      a layout must come with a bump of that message's version.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __MESSAGE_H
+#define __MESSAGE_H
+
+#include <stdint.h>
+
+// Messages are copied straight to and from the wire in host order. Both the
+// development machines and the robot computers are little-endian.
+_Static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+        "Message layouts assume a little-endian host");
+
+#define MSG_CACHE_LINE 64
+
+// Message type identifiers
+#define MSG_TYPE_POSE           1
+#define MSG_TYPE_VELOCITY       2
+#define MSG_TYPE_WHEEL_COMMAND  3
+#define MSG_TYPE_OBSTACLE       4
+
+// Current layout version of each message type
+#define MSG_POSE_VERSION            1
+#define MSG_VELOCITY_VERSION        1
+#define MSG_WHEEL_COMMAND_VERSION   1
+#define MSG_OBSTACLE_VERSION        1
+
+// Decode errors
+#define MSG_ERR_ARGS    -1
+#define MSG_ERR_SHORT   -2
+#define MSG_ERR_TYPE    -3
+#define MSG_ERR_VERSION -4
+#define MSG_ERR_LENGTH  -5
+
+// Common header, 8 bytes
+typedef struct __attribute__((packed)) {
+    uint8_t type;       // MSG_TYPE_*
+    uint8_t version;    // Layout version for the type
+    uint16_t length;    // Total message length in bytes, header included
+    uint32_t sequence;  // Incremented by the sender for each message
+} MSG_HEADER;
+
+// Vehicle pose from navigation, fits in one cache line
+typedef struct __attribute__((packed)) {
+    MSG_HEADER header;
+    int64_t timestamp;          // CLOCK_MONOTONIC ns when the pose was valid
+    double position[3];         // Local level north, east, down (m)
+    float attitude[3];          // Roll, pitch, yaw (rad)
+    float positionSigma;        // 1-sigma horizontal position error (m)
+    float attitudeSigma;        // 1-sigma heading error (rad)
+    uint32_t status;            // Navigation solution status flags
+} MSG_POSE;
+
+// Vehicle velocity from navigation
+typedef struct __attribute__((packed)) {
+    MSG_HEADER header;
+    int64_t timestamp;          // CLOCK_MONOTONIC ns
+    float velocity[3];          // Local level north, east, down (m/s)
+    float yawRate;              // Heading rate (rad/s)
+} MSG_VELOCITY;
+
+// Wheel speed command from guidance to control
+typedef struct __attribute__((packed)) {
+    MSG_HEADER header;
+    int64_t timestamp;          // CLOCK_MONOTONIC ns the command was issued
+    float leftSpeed;            // Left wheel speed (m/s)
+    float rightSpeed;           // Right wheel speed (m/s)
+    uint32_t flags;             // Command flags (ex. emergency stop)
+    uint32_t reserved;          // Keeps the struct a multiple of 8 bytes
+} MSG_WHEEL_COMMAND;
+
+// Obstacle detected by image processing, relative to the vehicle
+typedef struct __attribute__((packed)) {
+    MSG_HEADER header;
+    int64_t timestamp;          // CLOCK_MONOTONIC ns of the source frame
+    uint32_t id;                // Track identifier
+    float position[2];          // Forward, right of the vehicle (m)
+    float radius;               // Bounding radius (m)
+    float confidence;           // Detection confidence 0-1
+    uint32_t reserved;          // Keeps the struct a multiple of 8 bytes
+} MSG_OBSTACLE;
+
+// Layouts are part of the protocol, catch accidental changes
+_Static_assert(sizeof(MSG_HEADER) == 8, "MSG_HEADER layout changed");
+_Static_assert(sizeof(MSG_POSE) == 64, "MSG_POSE layout changed");
+_Static_assert(sizeof(MSG_POSE) <= MSG_CACHE_LINE, "MSG_POSE must fit in a cache line");
+_Static_assert(sizeof(MSG_VELOCITY) == 32, "MSG_VELOCITY layout changed");
+_Static_assert(sizeof(MSG_WHEEL_COMMAND) == 32, "MSG_WHEEL_COMMAND layout changed");
+_Static_assert(sizeof(MSG_OBSTACLE) == 40, "MSG_OBSTACLE layout changed");
+
+// Largest message, for sizing receive buffers
+#define MSG_MAX_LENGTH 64
+
+// Declares an encode and a decode function for a message type. Encode fills in
+// the header type, version, and length (sequence is left to the caller).
+#define MESSAGE_CODEC_DECLARE(NAME, TYPE) \
+    int MessageEncode##NAME(TYPE *msg, unsigned char *buf, int length); \
+    int MessageDecode##NAME(const unsigned char *buf, int length, TYPE *msg);
+
+MESSAGE_CODEC_DECLARE(Pose, MSG_POSE)
+MESSAGE_CODEC_DECLARE(Velocity, MSG_VELOCITY)
+MESSAGE_CODEC_DECLARE(WheelCommand, MSG_WHEEL_COMMAND)
+MESSAGE_CODEC_DECLARE(Obstacle, MSG_OBSTACLE)
+
+int MessagePeekHeader(const unsigned char *buf, int length, MSG_HEADER *header);
+
+#endif // __MESSAGE_H
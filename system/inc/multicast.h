@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * File:
+ *      multicast.h
+ *
+ * Description:
+ *      Function and type declarations and constants for multicast.c
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Sender session in the header
+ *
+ ***************************************************************************/
+
+#ifndef __MULTICAST_H
+#define __MULTICAST_H
+
+#include <stdint.h>
+#include <netinet/in.h>
+
+// Largest payload per datagram, keeps datagrams inside a single Ethernet frame
+#define MCAST_MAX_PAYLOAD   1400
+
+// Most datagrams moved per sendmmsg/recvmmsg call
+#define MCAST_BATCH_MAX     32
+
+// Independent sequence spaces a receiver can track (stream ids 0 to max - 1)
+#define MCAST_MAX_STREAMS   16
+
+// Prepended to every datagram, 12 bytes
+typedef struct __attribute__((packed)) {
+    uint32_t sequence;  // Per-stream sequence number, incremented per datagram
+    uint32_t session;   // Chosen by the sender at startup, changes on a restart
+    uint16_t stream;    // Stream identifier (ex. IMU, pose)
+    uint16_t length;    // Payload length in bytes
+} MCAST_HEADER;
+
+#define MCAST_MAX_DATAGRAM  (sizeof(MCAST_HEADER) + MCAST_MAX_PAYLOAD)
+
+typedef struct {
+
+    int fd;
+    struct sockaddr_in group;
+
+    uint16_t stream;
+    uint32_t sequence;
+    uint32_t session;
+
+} MCAST_SENDER;
+
+// One received datagram. Data points into the receiver and is valid until
+// the next receive call.
+typedef struct {
+    uint32_t sequence;
+    uint16_t stream;
+    int length;
+    const unsigned char *data;
+} MCAST_DATAGRAM;
+
+typedef struct {
+
+    int fd;
+
+    // Next sequence number expected on each stream, and the session of the
+    // sender numbering it
+    uint32_t nextSequence[MCAST_MAX_STREAMS];
+    uint32_t session[MCAST_MAX_STREAMS];
+    int synced[MCAST_MAX_STREAMS];
+
+    // Statistics
+    uint64_t numReceived, numLost, numGaps, numStale, numMalformed;
+    uint64_t numResyncs;  // Streams restarted by a sender that restarted
+
+    // Storage for one batch of datagrams
+    unsigned char storage[MCAST_BATCH_MAX][MCAST_MAX_DATAGRAM];
+
+} MCAST_RECEIVER;
+
+int McastSenderInit(MCAST_SENDER *sender, char *groupAddr, int port, char *ifaceAddr, int stream);
+
+int McastSend(MCAST_SENDER *sender, const unsigned char *buf, int length);
+
+int McastSendBatch(MCAST_SENDER *sender, const unsigned char **bufs, const int *lengths, int count);
+
+int McastSenderClose(MCAST_SENDER *sender);
+
+int McastReceiverInit(MCAST_RECEIVER *receiver, char *groupAddr, int port, char *ifaceAddr);
+
+int McastReceiveBatch(MCAST_RECEIVER *receiver, MCAST_DATAGRAM *datagrams, int max, int timeoutMs);
+
+int McastReceiverClose(MCAST_RECEIVER *receiver);
+
+#endif // __MULTICAST_H
@@ -0,0 +1,102 @@
+/****************************************************************************
+ *
+ * File:
+ *      pool.h
+ *
+ * Description:
+ *      Function and type declarations and constants for pool.c
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __POOL_H
+#define __POOL_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+// Most worker threads in one pool
+#define POOL_MAX_WORKERS    32
+
+// Tasks each worker can hold queued. Submitting to a full deque runs the
+// task immediately in the submitting thread.
+#define POOL_DEQUE_LEN      256
+
+// Counts outstanding tasks so a thread can wait for all of them
+typedef struct {
+    volatile int pending;
+} POOL_GROUP;
+
+// Plain tasks call routine(params). Range tasks call
+// rangeRoutine(params, begin, end), splitting off halves larger than grain.
+typedef struct {
+    void (*routine)(void *params);
+    void (*rangeRoutine)(void *params, int begin, int end);
+    void *params;
+    int begin, end, grain;
+    POOL_GROUP *group;
+} POOL_TASK;
+
+// Owner pushes and pops at the bottom, other workers steal from the top.
+// Indices only grow, slots are used modulo POOL_DEQUE_LEN.
+typedef struct {
+    pthread_mutex_t lock;
+    unsigned int top, bottom;
+    POOL_TASK tasks[POOL_DEQUE_LEN];
+} POOL_DEQUE;
+
+struct POOL_STRUCT;
+
+typedef struct {
+    struct POOL_STRUCT *pool;
+    int index;
+    pthread_t thread;
+    POOL_DEQUE deque;
+
+    // Statistics
+    uint64_t numExecuted, numStolen;
+} POOL_WORKER;
+
+typedef struct POOL_STRUCT {
+
+    POOL_WORKER workers[POOL_MAX_WORKERS];
+    int numWorkers;
+    unsigned long cpuMask;
+
+    volatile int running;
+
+    // Tasks sitting in any deque, and threads asleep waiting for one
+    volatile int numQueued;
+    volatile int numSleeping;
+    pthread_mutex_t sleepLock;
+    pthread_cond_t wake;
+
+    // Round robin target for tasks submitted from outside the pool
+    volatile unsigned int nextSubmit;
+
+    // Tasks run in the submitting thread because a deque was full
+    volatile uint64_t numInline;
+
+} POOL;
+
+int PoolInit(POOL *pool, int numWorkers, unsigned long cpuMask);
+
+void PoolGroupInit(POOL_GROUP *group);
+
+int PoolSubmit(POOL *pool, POOL_GROUP *group, void (*routine)(void *), void *params);
+
+int PoolGroupWait(POOL *pool, POOL_GROUP *group);
+
+int PoolParallelFor(POOL *pool, int begin, int end, int grain,
+        void (*routine)(void *, int, int), void *params);
+
+void PoolReportStats(POOL *pool);
+
+int PoolDestroy(POOL *pool);
+
+#endif // __POOL_H
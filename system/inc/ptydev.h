@@ -0,0 +1,99 @@
+/****************************************************************************
+ *
+ * File:
+ *      ptydev.h
+ *
+ * Description:
+ *      Function and type declarations and constants for ptydev.c
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __PTYDEV_H
+#define __PTYDEV_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+#define PTYDEV_PATH_LEN     64
+#define PTYDEV_LINE_LEN     256
+
+typedef struct PTY_DEV PTY_DEV;
+
+// Device model callback. Called from the device thread with bytes the code
+// under test wrote to the serial port, or with NULL and 0 on every tick.
+// Responds with PtyDevWrite. A negative return stops the device thread.
+typedef int (*PTYDEV_HANDLER)(PTY_DEV *pty, const unsigned char *data, int length, void *context);
+
+struct PTY_DEV {
+
+    int master_fd;
+    int slave_fd; // Held open so the master never sees a hangup
+    char slavePath[PTYDEV_PATH_LEN]; // Path for the code under test to open
+
+    PTYDEV_HANDLER handler;
+    void *context;
+
+    // Emulated line conditions, set before PtyDevStart
+    int baud;            // Pace output at this rate (0 for no pacing)
+    int64_t latencyNs;   // Delay before each write reaches the line
+    double corruptRate;  // Probability of flipping a bit in each byte sent
+    unsigned int seed;   // Seed for corruption, for repeatable tests
+    int64_t tickNs;      // Period between handler ticks (0 for none)
+
+    pthread_t thread;
+    volatile int running;
+    pthread_mutex_t writeLock;
+    int64_t lineFreeNs;  // When previously written bytes finish sending
+
+    // Statistics
+    uint64_t numRx, numTx, numCorrupted, numTicks;
+
+};
+
+// One line of a scripted device: a received line starting with match is
+// answered with reply (written verbatim, including any line ending)
+typedef struct {
+    const char *match;
+    const char *reply;
+} PTYDEV_SCRIPT_ENTRY;
+
+// Context for PtyDevScriptHandler
+typedef struct {
+    const PTYDEV_SCRIPT_ENTRY *entries;
+    int numEntries;
+
+    char line[PTYDEV_LINE_LEN];
+    int lineLen;
+
+    uint64_t numMatched, numUnmatched;
+} PTYDEV_SCRIPT;
+
+int PtyDevInit(PTY_DEV *pty, PTYDEV_HANDLER handler, void *context);
+
+int PtyDevSetPacing(PTY_DEV *pty, int baud);
+
+int PtyDevSetLatency(PTY_DEV *pty, int latencyUs);
+
+int PtyDevSetCorruption(PTY_DEV *pty, double rate, unsigned int seed);
+
+int PtyDevSetTick(PTY_DEV *pty, int periodUs);
+
+int PtyDevStart(PTY_DEV *pty);
+
+int PtyDevWrite(PTY_DEV *pty, const unsigned char *buf, int length);
+
+int PtyDevStop(PTY_DEV *pty);
+
+int PtyDevClose(PTY_DEV *pty);
+
+int PtyDevScriptInit(PTYDEV_SCRIPT *script, const PTYDEV_SCRIPT_ENTRY *entries, int numEntries);
+
+int PtyDevScriptHandler(PTY_DEV *pty, const unsigned char *data, int length, void *context);
+
+#endif // __PTYDEV_H
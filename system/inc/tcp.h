@@ -16,11 +16,21 @@
  *      Last edited 03/19/2020
  *      Changed some function interfaces
  *
+ * Revision 0.3
+ *      Last edited 10/18/2026
+ *      Added persistent accept and keepalive configuration
+ *
+ * Revision 0.4
+ *      Last edited 10/18/2026
+ *      Added kernel receive timestamps
+ *
  ***************************************************************************/
 
 #ifndef __TCP_H
 #define __TCP_H
 
+#include <time.h>
+
 int TCPClientInit(void);
 
 int TCPClientTryConnect(int sock_fd, char *ipAddr, int port);
@@ -29,10 +39,18 @@ int TCPServerInit(char *ipAddr, int port);
 
 int TCPServerTryAccept(int sock_fd);
 
+int TCPServerTryAcceptKeepOpen(int sock_fd);
+
 int TCPSetNonBlocking(int sock_fd);
 
+int TCPSetKeepAlive(int sock_fd, int idleSec, int intervalSec, int count, int userTimeoutMs);
+
 int TCPRead(int sock_fd, unsigned char *buf, int length);
 
+int TCPEnableRxTimestamps(int sock_fd);
+
+int TCPReadTimestamped(int sock_fd, unsigned char *buf, int length, struct timespec *ts);
+
 int TCPWrite(int sock_fd, unsigned char *buf, int length);
 
 int TCPClose(int sock_fd);
@@ -12,16 +12,159 @@
  * Revision 0.1
  *      Last edited 04/10/2020
  *
+ * Revision 0.2
+ *      Added periodic tasks with deadline and jitter statistics
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.3
+ *      Added CPU affinity, pre-faulted stacks, and memory locking
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.4
+ *      Periodic tasks can check in with a watchdog
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.5
+ *      Added priority inheritance mutex and condition variable
+ *      Last edited 10/18/2026
+ *
  ***************************************************************************/
 
 #ifndef __THREAD_H
 #define __THREAD_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+// CPU masks have one bit per core, ex. THREAD_CPU(1) | THREAD_CPU(3)
+#define THREAD_CPU(n) (1UL << (n))
+
+// Problems reported by ThreadCheckRealtime, OR'd together
+#define THREAD_RT_NOT_ISOLATED  0x1 // Requested cores not in isolcpus
+#define THREAD_RT_NO_PRIORITY   0x2 // SCHED_FIFO threads can't be created
+#define THREAD_RT_NOT_LOCKED    0x4 // Memory is not locked
+
+// Options for ThreadMutexInit, OR'd together
+#define THREAD_MUTEX_RECURSIVE  0x1 // Owner may lock again, ex. logging from inside logging
+#define THREAD_MUTEX_INSTRUMENT 0x2 // Track hold and wait times
+
+// Mutex with priority inheritance, so a low priority owner runs at the
+// priority of the highest thread waiting on it
+typedef struct {
+
+    pthread_mutex_t mutex;
+    const char *name;
+    int options;
+
+    // Instrumentation, only updated by the owner while it holds the lock
+    int depth;
+    int64_t lockedAtNs;
+    uint64_t numLocks, numContended;
+    int64_t maxWaitNs, maxHoldNs, totalHoldNs;
+
+} THREAD_MUTEX;
+
+// Condition variable timed on CLOCK_MONOTONIC
+typedef struct {
+    pthread_cond_t cond;
+} THREAD_COND;
+
+// Histogram bins are powers of two in microseconds: bin 0 counts samples
+// under 1 us, bin i counts samples in [2^(i-1), 2^i) us, and the last bin
+// counts everything longer
+#define THREAD_HIST_BINS 24
+
+typedef struct {
+    uint64_t counts[THREAD_HIST_BINS];
+    uint64_t numSamples;
+    int64_t minNs, maxNs, totalNs;
+} THREAD_HISTOGRAM;
+
+// Snapshot of a periodic task's statistics
+typedef struct {
+    uint64_t numReleases;  // Times the routine ran
+    uint64_t numOverruns;  // Runs that finished after their deadline
+    uint64_t numSkipped;   // Releases dropped to catch up after an overrun
+    THREAD_HISTOGRAM jitter; // Release time minus scheduled release time
+    THREAD_HISTOGRAM exec;   // Routine execution time
+} PERIODIC_STATS;
+
+typedef struct {
+
+    const char *name;
+
+    // Called once per period, returning a negative number stops the task
+    int (*routine)(void *params);
+    void *params;
+
+    int64_t periodNs;
+    int64_t deadlineNs; // Relative to each release, defaults to the period
+
+    pthread_t thread;
+    volatile int running;
+
+    // Watchdog to check in with after each run, if any
+    struct WATCHDOG_STRUCT *watchdog;
+    int watchdogHandle;
+
+    // Guards stats, which may be read while the task runs
+    THREAD_MUTEX statsLock;
+    PERIODIC_STATS stats;
+
+} PERIODIC_TASK;
+
 int ThreadAttrInit(pthread_attr_t *threadAttr, int priority);
 
 int ThreadCreate(pthread_t *thread, pthread_attr_t *threadAttr, void *(*threadRoutine)(void *), void *threadParams);
 
 int ThreadTryJoin(pthread_t thread, int *threadReturn);
 
+int ThreadAttrSetAffinity(pthread_attr_t *threadAttr, unsigned long cpuMask);
+
+int ThreadAttrSetStack(pthread_attr_t *threadAttr, size_t stackSize);
+
+int ThreadAttrFreeStack(pthread_attr_t *threadAttr);
+
+int ThreadLockMemory(void);
+
+int ThreadCheckRealtime(unsigned long cpuMask);
+
+int ThreadMutexInit(THREAD_MUTEX *mutex, const char *name, int options);
+
+int ThreadMutexLock(THREAD_MUTEX *mutex);
+
+int ThreadMutexUnlock(THREAD_MUTEX *mutex);
+
+int ThreadMutexDestroy(THREAD_MUTEX *mutex);
+
+void ThreadMutexReportStats(THREAD_MUTEX *mutex);
+
+int ThreadCondInit(THREAD_COND *cond);
+
+int ThreadCondWait(THREAD_COND *cond, THREAD_MUTEX *mutex, int timeoutMs);
+
+int ThreadCondSignal(THREAD_COND *cond);
+
+int ThreadCondBroadcast(THREAD_COND *cond);
+
+int ThreadCondDestroy(THREAD_COND *cond);
+
+int ThreadPeriodicInit(PERIODIC_TASK *task, const char *name, int periodUs, int (*routine)(void *), void *params);
+
+int ThreadPeriodicSetDeadline(PERIODIC_TASK *task, int deadlineUs);
+
+int ThreadPeriodicSetWatchdog(PERIODIC_TASK *task, struct WATCHDOG_STRUCT *watchdog, int handle);
+
+int ThreadPeriodicStart(PERIODIC_TASK *task, pthread_attr_t *threadAttr);
+
+int ThreadPeriodicStop(PERIODIC_TASK *task);
+
+int ThreadPeriodicGetStats(PERIODIC_TASK *task, PERIODIC_STATS *stats);
+
+int64_t ThreadHistogramPercentile(const THREAD_HISTOGRAM *hist, double percentile);
+
+void ThreadPeriodicReportStats(PERIODIC_TASK *task);
+
 #endif // __THREAD_H
 
@@ -0,0 +1,33 @@
+/****************************************************************************
+ *
+ * File:
+ *      timing.h
+ *
+ * Description:
+ *      Function declarations and constants for timing.c
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __TIMING_H
+#define __TIMING_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define NSEC_PER_SEC    (1000000000LL)
+#define NSEC_PER_MSEC   (1000000LL)
+#define NSEC_PER_USEC   (1000LL)
+
+int64_t TimeMonotonicNs(void);
+
+int64_t TimeTimespecToNs(const struct timespec *ts);
+
+void TimeNsToTimespec(int64_t ns, struct timespec *ts);
+
+#endif // __TIMING_H
@@ -28,17 +28,55 @@
  * 	Added access() for permission checking
  * 	Last edited 5/08/2019
  *
+ * Revision 0.6
+ * 	Added all standard baud rates up to 921600 and arbitrary rates
+ * 	through termios2
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.7
+ * 	Added event-driven reader with chunk arrival timestamps
+ * 	Last edited 10/18/2026
+ *
  ***************************************************************************/
 
 #ifndef __UART_H
 #define __UART_H
 
+#include <stdint.h>
+
+// Start bit, 8 data bits, stop bit
+#define UART_BITS_PER_CHAR 10
+
+// Event-driven reader for one UART device
+typedef struct {
+
+    int fd;
+    int epoll_fd;
+    int baud;
+
+    // Statistics
+    uint64_t numBytes, numChunks, numWakeups;
+
+} UART_READER;
+
 int UARTInit(char *devName, int baud);
 
 int UARTInitReadOnly(char *devName, int baud);
 
 int UARTSetBaud(int fd, int baud);
 
+int UARTGetBaud(int fd);
+
+int UARTSetLowLatency(int fd);
+
+int UARTReaderInit(UART_READER *reader, int fd, int baud, int vmin);
+
+int UARTReaderRead(UART_READER *reader, unsigned char *buf, int length, int timeoutMs, int64_t *timeNs);
+
+int UARTReaderClose(UART_READER *reader);
+
+int64_t UARTByteTimeNs(int baud);
+
 int UARTRead(int uart_fd, unsigned char *buf, int length);
 
 int UARTWrite(int uart_fd, unsigned char *buf, int length);
@@ -0,0 +1,84 @@
+/****************************************************************************
+ *
+ * File:
+ *      watchdog.h
+ *
+ * Description:
+ *      Function and type declarations and constants for watchdog.c
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#ifndef __WATCHDOG_H
+#define __WATCHDOG_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+// Most threads one watchdog can monitor
+#define WATCHDOG_MAX_ENTRIES    16
+
+// What the watchdog does when a thread goes longer than its budget without
+// checking in
+typedef enum {
+    WATCHDOG_ACTION_LOG,     // Only log it
+    WATCHDOG_ACTION_STOP,    // Log and call the handler to bring things to a safe stop
+    WATCHDOG_ACTION_RESTART  // Log and call the handler to restart the thread,
+                             // then give it a fresh budget
+} WATCHDOG_ACTION;
+
+struct WATCHDOG_STRUCT;
+
+// Called from the watchdog thread with the index of the late entry
+typedef void (*WATCHDOG_HANDLER)(struct WATCHDOG_STRUCT *watchdog, int handle, void *params);
+
+typedef struct {
+
+    const char *name;
+    int64_t budgetNs; // Longest allowed time between check-ins
+
+    WATCHDOG_ACTION action;
+    WATCHDOG_HANDLER handler;
+    void *params;
+
+    volatile int64_t lastCheckInNs;
+    volatile int stalled; // Set by the watchdog, cleared by the next check-in
+
+    // Statistics. Misses are check-ins that came late, stalls are times the
+    // watchdog caught the thread past its budget and acted.
+    volatile uint64_t numCheckIns, numMisses, numStalls;
+    volatile int64_t worstGapNs;
+
+} WATCHDOG_ENTRY;
+
+typedef struct WATCHDOG_STRUCT {
+
+    WATCHDOG_ENTRY entries[WATCHDOG_MAX_ENTRIES];
+    volatile int numEntries;
+    pthread_mutex_t registerLock;
+
+    int64_t checkPeriodNs;
+    pthread_t thread;
+    volatile int running;
+
+} WATCHDOG;
+
+int WatchdogInit(WATCHDOG *watchdog, int checkPeriodUs);
+
+int WatchdogRegister(WATCHDOG *watchdog, const char *name, int budgetUs,
+        WATCHDOG_ACTION action, WATCHDOG_HANDLER handler, void *params);
+
+int WatchdogCheckIn(WATCHDOG *watchdog, int handle);
+
+int WatchdogStart(WATCHDOG *watchdog);
+
+int WatchdogStop(WATCHDOG *watchdog);
+
+void WatchdogReportStats(WATCHDOG *watchdog);
+
+#endif // __WATCHDOG_H
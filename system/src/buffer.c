@@ -19,6 +19,10 @@
  * 	Code that uses buffer.length may need to be modified
  * 	Last edited 2/13/2020
  *
+ * Revision 0.3
+ * 	Last edited 10/18/2026
+ * 	Contiguous segments for reading in place
+ *
  \***************************************************************************/
 
 #include <stdio.h>
@@ -287,3 +291,53 @@ int BufferCopy(BYTE_BUFFER *buf, unsigned char *dest, int start, int num) {
 
 } // BufferCopy(BYTE_BUFFER *, unsigned char *, int, int)
 
+
+
+/**** Function BufferSegment ****
+ *
+ * Finds where a run of elements lies in the circular buffer, so it can be
+ * read in place. A run that crosses the end of the storage comes in two
+ * segments: the first is returned here, and the second starts at index
+ * start plus the length returned.
+ *
+ * Arguments: 
+ * 	buf     - Pointer to BYTE_BUFFER instance to read from
+ * 	start   - Index in buf of the first element
+ * 	num     - Number of elements wanted
+ * 	segment - Set to point at the element at start
+ *
+ * Return value:
+ * 	On success returns the number of elements, up to num, that follow
+ * 	segment contiguously
+ * 	On failure returns a negative number
+ */
+int BufferSegment(BYTE_BUFFER *buf, int start, int num, unsigned char **segment) {
+
+    int index, numAvailable;
+
+    // Exit if buffer pointer invalid
+    if (buf == NULL || segment == NULL) {
+        return -1;
+    }
+
+    // No elements if inputs are out of range
+    numAvailable = BufferLength(buf) - start;
+    if (start < 0 || num < 0 || numAvailable <= 0) {
+        *segment = NULL;
+        return 0;
+    }
+    if (numAvailable < num) {
+        num = numAvailable;
+    }
+
+    // Stop at the end of the storage
+    index = BYTE_BUFFER_MOD(buf->start + start);
+    if (num > BYTE_BUFFER_LEN - index) {
+        num = BYTE_BUFFER_LEN - index;
+    }
+
+    *segment = &(buf->buffer[index]);
+
+    return num;
+
+} // BufferSegment(BYTE_BUFFER *, int, int, unsigned char **)
@@ -16,6 +16,10 @@
  *  Fixed a bug in how variadic arguments are traversed
  * 	Last edited 2/13/2020
  *
+ * Revision 0.3
+ *  Serialized output with a priority inheritance mutex
+ * 	Last edited 10/18/2026
+ *
  ***************************************************************************/
 
 #include <stdio.h>
@@ -27,14 +31,26 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <time.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 #include "config.h"
 #include "logger.h"
+#include "thread.h"
 
 #include "debuglog.h"
 
+// Serializes output from every thread. Priority inheritance keeps a low
+// priority thread in the middle of a message from holding up a realtime one,
+// and recursion lets the log file code log its own errors.
+static THREAD_MUTEX debugLock;
+static pthread_once_t debugLockOnce = PTHREAD_ONCE_INIT;
+
+static void debugLockInit(void) {
+    ThreadMutexInit(&debugLock, "debuglog", THREAD_MUTEX_RECURSIVE);
+}
+
 // The logDebug function's definition depends on DEBUG_OUT_**** set in config.h
 // 1-3 options can be defined individually or simultaneously, in which case
 // debug will be logged in more than one location
@@ -47,6 +63,9 @@ void logDebug(int debuglevel, const char *fstring, ...) {
         // Variadic arguments to pass to printf
         va_list args;
 
+        pthread_once(&debugLockOnce, debugLockInit);
+        ThreadMutexLock(&debugLock);
+
         // For each logging source, variadic arguments must be started and ended
 
 #ifdef DEBUG_OUT_SYSLOG
@@ -89,8 +108,6 @@ void logDebug(int debuglevel, const char *fstring, ...) {
         static LOG_FILE debugLog;
         static int logfileInitialized = 0;
 
-        // Should have mutex as well when eventually multithreaded, also in printf
-
         // 4K Max for a single write, maybe change in the future
         const int buflen = 4096;
         char buf[buflen];
@@ -128,6 +145,8 @@ void logDebug(int debuglevel, const char *fstring, ...) {
 
 #endif
 
+        ThreadMutexUnlock(&debugLock);
+
     } // if (debuglevel > MASK)
 
 } // logDebug(int, const char *, ...)
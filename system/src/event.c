@@ -0,0 +1,230 @@
+/****************************************************************************
+ *
+ * File:
+ *      event.c
+ *
+ * Description:
+ *      Wakeup notification between threads, built on eventfd. A consumer
+ *      sleeps in the kernel until a producer signals, and wakes within
+ *      microseconds instead of on the next tick of a polling loop. Signals
+ *      sent while nobody waits are counted and collapse into one wakeup.
+ *
+ *      The descriptor can also go into poll or epoll next to sockets and
+ *      serial ports, so one thread can wait on data and notifications
+ *      together.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Waits resume after a signal, with the time left
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#include "debuglog.h"
+#include "timing.h"
+
+#include "event.h"
+
+
+/**** Function EventInit ****
+ *
+ * Arguments:
+ *      event - Pointer to EVENT instance to initialize
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int EventInit(EVENT *event) {
+
+    if (event == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(event, 0, sizeof(EVENT));
+
+    event->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (event->fd == -1) {
+        logDebug(L_INFO, "%s: Failed to create eventfd\n", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+
+} // EventInit(EVENT *)
+
+
+/**** Function EventSignal ****
+ *
+ * Wakes the thread waiting on the event, or the next one to wait. Never
+ * blocks, safe to call from any thread.
+ *
+ * Arguments:
+ *      event - Pointer to initialized EVENT instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int EventSignal(EVENT *event) {
+
+    uint64_t one = 1;
+    int rc;
+
+    if (event == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    rc = write(event->fd, &one, sizeof(one));
+    if (rc != sizeof(one)) {
+        // Only fails once the counter saturates, so a wakeup is pending
+        // anyway
+        if (errno != EAGAIN) {
+            logDebug(L_DEBUG, "%s: Failed to signal event\n", strerror(errno));
+            return -1;
+        }
+    }
+
+    __atomic_add_fetch(&(event->numSignals), 1, __ATOMIC_RELAXED);
+
+    return 0;
+
+} // EventSignal(EVENT *)
+
+
+/**** Function EventWait ****
+ *
+ * Sleeps until the event is signaled, or returns immediately if it was
+ * signaled since the last wait
+ *
+ * Arguments:
+ *      event     - Pointer to initialized EVENT instance
+ *      timeoutMs - Longest time to wait in milliseconds, 0 to only check,
+ *                  or -1 to wait forever
+ *
+ * Return value:
+ *      Returns the number of signals since the last wait (at least 1)
+ *      Returns 0 on timeout
+ *      On failure, returns -1 and errno is set
+ */
+int EventWait(EVENT *event, int timeoutMs) {
+
+    struct pollfd pfd;
+    uint64_t count = 0;
+    int64_t deadlineNs = 0;
+    int rc, waitMs;
+
+    if (event == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (timeoutMs > 0) {
+        deadlineNs = TimeMonotonicNs() + (int64_t) timeoutMs * NSEC_PER_MSEC;
+    }
+
+    // Try without sleeping first, most waits after a burst of signals
+    // return here. Another waiter may take the count between poll and read,
+    // in which case poll again.
+    while ((rc = read(event->fd, &count, sizeof(count))) != sizeof(count)) {
+
+        if (errno != EAGAIN) {
+            logDebug(L_DEBUG, "%s: Failed to read event\n", strerror(errno));
+            return -1;
+        }
+
+        // A signal cuts the poll short, go back to it with the time left
+        pfd.fd = event->fd;
+        pfd.events = POLLIN;
+        do {
+            waitMs = timeoutMs;
+            if (timeoutMs > 0) {
+                waitMs = (int) ((deadlineNs - TimeMonotonicNs() + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC);
+                if (waitMs < 0) {
+                    waitMs = 0;
+                }
+            }
+            pfd.revents = 0;
+            rc = poll(&pfd, 1, waitMs);
+        } while (rc == -1 && errno == EINTR);
+
+        if (rc == -1) {
+            logDebug(L_DEBUG, "%s: Failed to poll event\n", strerror(errno));
+            return -1;
+        }
+        if (rc == 0) {
+            event->numTimeouts++;
+            return 0;
+        }
+    }
+
+    event->numWakeups++;
+
+    return (count > INT32_MAX) ? INT32_MAX : (int) count;
+
+} // EventWait(EVENT *, int)
+
+
+/**** Function EventFd ****
+ *
+ * Gets the descriptor to wait on with poll or epoll. It becomes readable when
+ * the event is signaled. Call EventWait(event, 0) to clear it.
+ *
+ * Arguments:
+ *      event - Pointer to initialized EVENT instance
+ *
+ * Return value:
+ *      Returns the file descriptor, or -1 if event is NULL
+ */
+int EventFd(EVENT *event) {
+
+    if (event == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    return event->fd;
+
+} // EventFd(EVENT *)
+
+
+/**** Function EventClose ****
+ *
+ * Arguments:
+ *      event - Pointer to initialized EVENT instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int EventClose(EVENT *event) {
+
+    int rc;
+
+    if (event == NULL || event->fd < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    rc = close(event->fd);
+    event->fd = -1;
+
+    return rc;
+
+} // EventClose(EVENT *)
@@ -0,0 +1,655 @@
+/****************************************************************************
+ *
+ * File:
+ *      link.c
+ *
+ * Description:
+ *      Supervises a TCP connection to another subsystem. A link notices when
+ *      its peer goes away (orderly close, reset, keepalive timeout, or an
+ *      optional heartbeat timeout) and reestablishes the connection with a
+ *      short, capped exponential backoff. Server links keep their listening
+ *      socket open so a restarted peer can connect again immediately.
+ *
+ *      LinkService must be called regularly (every control cycle is fine), it
+ *      never blocks. Time from losing a link to having it back is recorded
+ *      for every drop.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include "debuglog.h"
+#include "tcp.h"
+#include "timing.h"
+#include "utils.h"
+
+#include "link.h"
+
+
+/**** Function linkScheduleRetry ****
+ *
+ * Pushes the next connection attempt out by the current backoff, then doubles
+ * the backoff (up to LINK_BACKOFF_MAX_MS)
+ *
+ * Arguments:
+ *      link - Pointer to LINK instance
+ *      now  - Current monotonic time in nanoseconds
+ *
+ * Return value:
+ *      None
+ */
+static void linkScheduleRetry(LINK *link, int64_t now) {
+
+    link->nextAttemptNs = now + link->backoffMs * NSEC_PER_MSEC;
+    link->backoffMs = MIN(link->backoffMs * 2, LINK_BACKOFF_MAX_MS);
+
+} // linkScheduleRetry(LINK *, int64_t)
+
+
+/**** Function linkUp ****
+ *
+ * Marks a link as connected on a new socket and records recovery time
+ *
+ * Arguments:
+ *      link - Pointer to LINK instance
+ *      fd   - Newly connected socket
+ *      now  - Current monotonic time in nanoseconds
+ *
+ * Return value:
+ *      None
+ */
+static void linkUp(LINK *link, int fd, int64_t now) {
+
+    int64_t recovery;
+
+    link->fd = fd;
+    link->state = LINK_STATE_UP;
+    link->lastRxNs = now;
+    link->backoffMs = LINK_BACKOFF_MIN_MS;
+
+    // Nonblocking, and probe the peer so a silent death is noticed
+    TCPSetNonBlocking(fd);
+    TCPSetKeepAlive(fd, LINK_KEEPALIVE_IDLE_S, LINK_KEEPALIVE_INTVL_S,
+            LINK_KEEPALIVE_COUNT, LINK_USER_TIMEOUT_MS);
+
+    // Kernel arrival times, for measuring queueing delay in the process
+    TCPEnableRxTimestamps(fd);
+
+    if (link->wasUp) {
+
+        recovery = now - link->downSinceNs;
+        link->lastRecoveryNs = recovery;
+        link->totalRecoveryNs += recovery;
+        link->maxRecoveryNs = MAX(link->maxRecoveryNs, recovery);
+        link->numRecoveries++;
+
+        logDebug(L_INFO, "Link %s: Recovered after %.3f ms (%d attempts)\n",
+                link->name, (double) recovery / NSEC_PER_MSEC, link->numAttempts);
+
+    } else {
+        logDebug(L_INFO, "Link %s: Connected\n", link->name);
+    }
+
+    link->wasUp = 1;
+    link->numAttempts = 0;
+
+} // linkUp(LINK *, int, int64_t)
+
+
+/**** Function linkDown ****
+ *
+ * Closes the connected socket of a link and starts the recovery clock
+ *
+ * Arguments:
+ *      link   - Pointer to LINK instance
+ *      reason - Short description for the debug log
+ *      now    - Current monotonic time in nanoseconds
+ *
+ * Return value:
+ *      None
+ */
+static void linkDown(LINK *link, const char *reason, int64_t now) {
+
+    if (link->fd != -1) {
+        TCPClose(link->fd);
+        link->fd = -1;
+    }
+
+    if (link->state == LINK_STATE_UP) {
+        link->numDrops++;
+        link->downSinceNs = now;
+        logDebug(L_INFO, "Link %s: Lost connection (%s)\n", link->name, reason);
+    }
+
+    // First reconnect attempt happens right away
+    link->state = LINK_STATE_DOWN;
+    link->backoffMs = LINK_BACKOFF_MIN_MS;
+    link->nextAttemptNs = now;
+
+} // linkDown(LINK *, const char *, int64_t)
+
+
+/**** Function linkCheckPeer ****
+ *
+ * Checks whether the peer of a connected link is still there without
+ * consuming any data from the socket
+ *
+ * Arguments:
+ *      link - Pointer to connected LINK instance
+ *      now  - Current monotonic time in nanoseconds
+ *
+ * Return value:
+ *      Returns 1 if the peer is alive, 0 if the link was dropped
+ */
+static int linkCheckPeer(LINK *link, int64_t now) {
+
+    int rc;
+    unsigned char peek;
+
+    // A zero-length read means the peer closed, errors mean reset or timeout
+    rc = recv(link->fd, &peek, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (rc == 0) {
+        linkDown(link, "closed by peer", now);
+        return 0;
+    } else if (rc < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        linkDown(link, strerror(errno), now);
+        return 0;
+    } else if (rc > 0) {
+        link->lastRxNs = now;
+    }
+
+    // Heartbeat timeout, if the application asked for one
+    if (link->rxTimeoutMs > 0 && now - link->lastRxNs > link->rxTimeoutMs * NSEC_PER_MSEC) {
+        linkDown(link, "heartbeat timeout", now);
+        return 0;
+    }
+
+    return 1;
+
+} // linkCheckPeer(LINK *, int64_t)
+
+
+/**** Function linkServiceClient ****
+ *
+ * Advances the nonblocking connect of a client link that is down
+ *
+ * Arguments:
+ *      link - Pointer to LINK instance
+ *      now  - Current monotonic time in nanoseconds
+ *
+ * Return value:
+ *      None
+ */
+static void linkServiceClient(LINK *link, int64_t now) {
+
+    int rc;
+
+    // Waiting out the backoff
+    if (now < link->nextAttemptNs) {
+        return;
+    }
+
+    // Fresh socket for every attempt, a failed connect leaves it unusable
+    if (link->state == LINK_STATE_DOWN) {
+
+        link->fd = TCPClientInit();
+        if (link->fd == -1) {
+            linkScheduleRetry(link, now);
+            return;
+        }
+
+        // Connect must not block, the peer may be unreachable
+        TCPSetNonBlocking(link->fd);
+        link->connectStartNs = now;
+        link->state = LINK_STATE_CONNECTING;
+        link->numAttempts++;
+    }
+
+    rc = TCPClientTryConnect(link->fd, link->ipAddr, link->port);
+    if (rc == 0 || errno == EISCONN) {
+        linkUp(link, link->fd, now);
+        return;
+    }
+
+    // Still in progress, give it until the connect timeout
+    if ((errno == EINPROGRESS || errno == EALREADY) &&
+            now - link->connectStartNs < LINK_CONNECT_TIMEOUT_MS * NSEC_PER_MSEC) {
+        return;
+    }
+
+    logDebug(L_DEBUG, "Link %s: Connect attempt failed: %s\n", link->name, strerror(errno));
+
+    // Refused or timed out, start over after the backoff
+    TCPClose(link->fd);
+    link->fd = -1;
+    link->state = LINK_STATE_DOWN;
+    linkScheduleRetry(link, now);
+
+} // linkServiceClient(LINK *, int64_t)
+
+
+/**** Function linkServiceServer ****
+ *
+ * Accepts a connection for a server link, reopening the listener if needed
+ *
+ * Arguments:
+ *      link - Pointer to LINK instance
+ *      now  - Current monotonic time in nanoseconds
+ *
+ * Return value:
+ *      None
+ */
+static void linkServiceServer(LINK *link, int64_t now) {
+
+    int rc;
+
+    // Listener could not be created before, retry after the backoff
+    if (link->listen_fd == -1) {
+
+        if (now < link->nextAttemptNs) {
+            return;
+        }
+
+        link->listen_fd = TCPServerInit(link->ipAddr, link->port);
+        if (link->listen_fd < 0) {
+            link->listen_fd = -1;
+            linkScheduleRetry(link, now);
+            return;
+        }
+        TCPSetNonBlocking(link->listen_fd);
+    }
+
+    // Accepting is a cheap nonblocking call, no backoff needed
+    rc = TCPServerTryAcceptKeepOpen(link->listen_fd);
+    if (rc == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            logDebug(L_INFO, "Link %s: Accept failed: %s\n", link->name, strerror(errno));
+        }
+        return;
+    }
+
+    // A peer that restarted before its old connection timed out replaces it
+    if (link->state == LINK_STATE_UP) {
+        linkDown(link, "peer reconnected", now);
+    }
+
+    link->numAttempts++;
+    linkUp(link, rc, now);
+
+} // linkServiceServer(LINK *, int64_t)
+
+
+/**** Function LinkInit ****
+ *
+ * Initializes a supervised link. Client links connect to ipAddr:port, server
+ * links listen on ipAddr:port. No connection is made until LinkService.
+ *
+ * Arguments:
+ *      link   - Pointer to LINK instance to initialize
+ *      name   - Name used in log messages
+ *      role   - LINK_ROLE_CLIENT or LINK_ROLE_SERVER
+ *      ipAddr - String containing the IPv4 address "XXX.XXX.XXX.XXX"
+ *      port   - Integer port number
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number (server listeners that fail to
+ *        open are retried by LinkService)
+ */
+int LinkInit(LINK *link, const char *name, int role, char *ipAddr, int port) {
+
+    // Exit on error if invalid pointer
+    if (link == NULL || ipAddr == NULL) {
+        return -1;
+    }
+
+    if (role != LINK_ROLE_CLIENT && role != LINK_ROLE_SERVER) {
+        return -2;
+    }
+
+    memset(link, 0, sizeof(LINK));
+    snprintf(link->name, LINK_NAME_LENGTH, "%s", name != NULL ? name : "link");
+    snprintf(link->ipAddr, sizeof(link->ipAddr), "%s", ipAddr);
+    link->role = role;
+    link->port = port;
+    link->fd = -1;
+    link->listen_fd = -1;
+    link->state = LINK_STATE_DOWN;
+    link->backoffMs = LINK_BACKOFF_MIN_MS;
+    link->nextAttemptNs = TimeMonotonicNs();
+
+    // Servers listen from the start so clients can connect at any time
+    if (role == LINK_ROLE_SERVER) {
+
+        link->listen_fd = TCPServerInit(link->ipAddr, link->port);
+        if (link->listen_fd < 0) {
+            link->listen_fd = -1;
+            logDebug(L_INFO, "Link %s: Failed to open listener, will retry\n", link->name);
+            return -3;
+        }
+        TCPSetNonBlocking(link->listen_fd);
+    }
+
+    return 0;
+
+} // LinkInit(LINK *, const char *, int, char *, int)
+
+
+/**** Function LinkSetRxTimeout ****
+ *
+ * Sets a heartbeat timeout. If the peer sends periodic data, the link is
+ * declared dead when nothing arrives for rxTimeoutMs, which is much faster
+ * than keepalive probing.
+ *
+ * Arguments:
+ *      link        - Pointer to LINK instance
+ *      rxTimeoutMs - Receive timeout in milliseconds (0 to disable)
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int LinkSetRxTimeout(LINK *link, int rxTimeoutMs) {
+
+    if (link == NULL || rxTimeoutMs < 0) {
+        return -1;
+    }
+
+    link->rxTimeoutMs = rxTimeoutMs;
+
+    return 0;
+
+} // LinkSetRxTimeout(LINK *, int)
+
+
+/**** Function LinkService ****
+ *
+ * Checks the health of a link and advances reconnection when it is down.
+ * Never blocks.
+ *
+ * Arguments:
+ *      link - Pointer to LINK instance
+ *
+ * Return value:
+ *      On success, returns the link state (LINK_STATE_*)
+ *      On failure, returns a negative number
+ */
+int LinkService(LINK *link) {
+
+    int64_t now;
+
+    if (link == NULL) {
+        return -1;
+    }
+
+    now = TimeMonotonicNs();
+
+    if (link->state == LINK_STATE_UP) {
+        linkCheckPeer(link, now);
+    }
+
+    // Servers also look for a replacement connection while up
+    if (link->role == LINK_ROLE_SERVER) {
+        linkServiceServer(link, now);
+    } else if (link->state != LINK_STATE_UP) {
+        linkServiceClient(link, now);
+    }
+
+    return link->state;
+
+} // LinkService(LINK *)
+
+
+/**** Function LinkIsUp ****
+ *
+ * Arguments:
+ *      link - Pointer to LINK instance
+ *
+ * Return value:
+ *      Returns 1 if the link is connected, otherwise 0
+ */
+int LinkIsUp(LINK *link) {
+
+    return link != NULL && link->state == LINK_STATE_UP;
+
+} // LinkIsUp(LINK *)
+
+
+/**** Function LinkRead ****
+ *
+ * Reads from a connected link without blocking. A closed or failed connection
+ * drops the link so the next LinkService reconnects it.
+ *
+ * Arguments:
+ *      link   - Pointer to LINK instance
+ *      buf    - Buffer to store data that is read
+ *      length - Length of room left in the buffer
+ *
+ * Return value:
+ *      Returns number of characters read (may be 0)
+ *      If the link is down or was just dropped, returns a negative number
+ */
+int LinkRead(LINK *link, unsigned char *buf, int length) {
+
+    return LinkReadTimestamped(link, buf, length, NULL);
+
+} // LinkRead(LINK *, unsigned char *, int)
+
+
+/**** Function LinkReadTimestamped ****
+ *
+ * Reads from a connected link like LinkRead, and returns the kernel arrival
+ * time of the data (CLOCK_REALTIME, see TCPReadTimestamped). The delay from
+ * arrival to this read is accumulated in the link queueing statistics.
+ *
+ * Arguments:
+ *      link   - Pointer to LINK instance
+ *      buf    - Buffer to store data that is read
+ *      length - Length of room left in the buffer
+ *      ts     - Pointer to timespec to hold the arrival time, zeroed if not
+ *               available (may be NULL)
+ *
+ * Return value:
+ *      Returns number of characters read (may be 0)
+ *      If the link is down or was just dropped, returns a negative number
+ */
+int LinkReadTimestamped(LINK *link, unsigned char *buf, int length, struct timespec *ts) {
+
+    int numRead;
+    struct timespec arrival, now;
+    int64_t queueNs;
+
+    if (link == NULL || buf == NULL) {
+        return -1;
+    }
+
+    if (link->state != LINK_STATE_UP) {
+        errno = ENOTCONN;
+        return -1;
+    }
+
+    numRead = TCPReadTimestamped(link->fd, buf, length, &arrival);
+    if (numRead > 0) {
+
+        link->lastRxNs = TimeMonotonicNs();
+
+        // Socket timestamps are on the realtime clock
+        if (arrival.tv_sec != 0) {
+            clock_gettime(CLOCK_REALTIME, &now);
+            queueNs = TimeTimespecToNs(&now) - TimeTimespecToNs(&arrival);
+            link->lastRxQueueNs = queueNs;
+            link->maxRxQueueNs = MAX(link->maxRxQueueNs, queueNs);
+            link->totalRxQueueNs += queueNs;
+            link->numRxStamped++;
+        }
+
+    } else if (numRead == 0 && length > 0) {
+        linkDown(link, "closed by peer", TimeMonotonicNs());
+        return -1;
+    } else if (numRead < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        linkDown(link, strerror(errno), TimeMonotonicNs());
+    }
+
+    if (ts != NULL) {
+        *ts = arrival;
+    }
+
+    return numRead;
+
+} // LinkReadTimestamped(LINK *, unsigned char *, int, struct timespec *)
+
+
+/**** Function LinkWrite ****
+ *
+ * Writes to a connected link without blocking. A failed connection drops the
+ * link so the next LinkService reconnects it.
+ *
+ * Arguments:
+ *      link   - Pointer to LINK instance
+ *      buf    - Buffer containing data to write
+ *      length - Number of characters to write
+ *
+ * Return value:
+ *      Returns number of characters written (may be 0 if the socket is full)
+ *      If the link is down or was just dropped, returns a negative number
+ */
+int LinkWrite(LINK *link, unsigned char *buf, int length) {
+
+    int numWritten;
+
+    if (link == NULL || buf == NULL) {
+        return -1;
+    }
+
+    if (link->state != LINK_STATE_UP) {
+        errno = ENOTCONN;
+        return -1;
+    }
+
+    numWritten = TCPWrite(link->fd, buf, length);
+    if (numWritten < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        linkDown(link, strerror(errno), TimeMonotonicNs());
+    }
+
+    return numWritten;
+
+} // LinkWrite(LINK *, unsigned char *, int)
+
+
+/**** Function LinkDrop ****
+ *
+ * Forces a link down, for example after a protocol error. It is reconnected
+ * by the following calls to LinkService.
+ *
+ * Arguments:
+ *      link - Pointer to LINK instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int LinkDrop(LINK *link) {
+
+    if (link == NULL) {
+        return -1;
+    }
+
+    linkDown(link, "dropped locally", TimeMonotonicNs());
+
+    return 0;
+
+} // LinkDrop(LINK *)
+
+
+/**** Function LinkReportStats ****
+ *
+ * Logs drop and time to recovery statistics for a link
+ *
+ * Arguments:
+ *      link - Pointer to LINK instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int LinkReportStats(LINK *link) {
+
+    double meanMs = 0, meanQueueUs = 0;
+
+    if (link == NULL) {
+        return -1;
+    }
+
+    if (link->numRecoveries > 0) {
+        meanMs = (double) link->totalRecoveryNs / link->numRecoveries / NSEC_PER_MSEC;
+    }
+    if (link->numRxStamped > 0) {
+        meanQueueUs = (double) link->totalRxQueueNs / link->numRxStamped / NSEC_PER_USEC;
+    }
+
+    logDebug(L_INFO, "Link %s: %s, %d drops, %d recoveries, "
+            "recovery last %.3f ms, mean %.3f ms, max %.3f ms\n",
+            link->name, link->state == LINK_STATE_UP ? "up" : "down",
+            link->numDrops, link->numRecoveries,
+            (double) link->lastRecoveryNs / NSEC_PER_MSEC, meanMs,
+            (double) link->maxRecoveryNs / NSEC_PER_MSEC);
+    logDebug(L_INFO, "Link %s: receive queueing last %.1f us, mean %.1f us, max %.1f us\n",
+            link->name, (double) link->lastRxQueueNs / NSEC_PER_USEC, meanQueueUs,
+            (double) link->maxRxQueueNs / NSEC_PER_USEC);
+
+    return 0;
+
+} // LinkReportStats(LINK *)
+
+
+/**** Function LinkClose ****
+ *
+ * Closes all sockets belonging to a link
+ *
+ * Arguments:
+ *      link - Pointer to LINK instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int LinkClose(LINK *link) {
+
+    if (link == NULL) {
+        return -1;
+    }
+
+    if (link->fd != -1) {
+        TCPClose(link->fd);
+        link->fd = -1;
+    }
+
+    if (link->listen_fd != -1) {
+        TCPClose(link->listen_fd);
+        link->listen_fd = -1;
+    }
+
+    link->state = LINK_STATE_DOWN;
+
+    return 0;
+
+} // LinkClose(LINK *)
@@ -0,0 +1,230 @@
+/****************************************************************************
+ *
+ * File:
+ *      mailbox.c
+ *
+ * Description:
+ *      Latest-value mailbox (triple buffer) for handing state between
+ *      threads, ex. the newest pose from navigation to the control loop.
+ *      The writer publishes without ever blocking and the reader always gets
+ *      the most recent complete value without ever blocking, with no lock to
+ *      invert priority between SCHED_FIFO threads. Values the reader was too
+ *      slow to see are dropped, never queued.
+ *
+ *      One writer thread and one reader thread per mailbox.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "mailbox.h"
+
+
+/**** Function MailboxInit ****
+ *
+ * Arguments:
+ *      mailbox - Pointer to MAILBOX instance to initialize
+ *      size    - Size of the value carried, at most MAILBOX_MAX_SIZE
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int MailboxInit(MAILBOX *mailbox, size_t size) {
+
+    if (mailbox == NULL || size == 0 || size > MAILBOX_MAX_SIZE) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(mailbox, 0, sizeof(MAILBOX));
+    mailbox->size = size;
+    mailbox->writeIndex = 0;
+    mailbox->state = 1;
+    mailbox->readIndex = 2;
+
+    return 0;
+
+} // MailboxInit(MAILBOX *, size_t)
+
+
+/**** Function MailboxWriteBuffer ****
+ *
+ * Gets the writer's slot, to fill in place before MailboxCommit. Only the
+ * writer thread may call this.
+ *
+ * Arguments:
+ *      mailbox - Pointer to initialized MAILBOX instance
+ *
+ * Return value:
+ *      Returns a pointer to mailbox->size bytes owned by the writer until the
+ *        next commit, or NULL if mailbox is NULL
+ */
+void *MailboxWriteBuffer(MAILBOX *mailbox) {
+
+    if (mailbox == NULL) {
+        return NULL;
+    }
+
+    return mailbox->slots[mailbox->writeIndex].data;
+
+} // MailboxWriteBuffer(MAILBOX *)
+
+
+/**** Function MailboxCommit ****
+ *
+ * Publishes the writer's slot as the newest value and takes the old middle
+ * slot to write next. Never blocks.
+ *
+ * Arguments:
+ *      mailbox - Pointer to initialized MAILBOX instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int MailboxCommit(MAILBOX *mailbox) {
+
+    unsigned int old;
+
+    if (mailbox == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    mailbox->numPublished++;
+    mailbox->slots[mailbox->writeIndex].sequence = mailbox->numPublished;
+
+    // Release makes the slot contents visible before the swap
+    old = __atomic_exchange_n(&(mailbox->state), mailbox->writeIndex | MAILBOX_NEW,
+            __ATOMIC_ACQ_REL);
+    mailbox->writeIndex = old & MAILBOX_INDEX_MASK;
+
+    return 0;
+
+} // MailboxCommit(MAILBOX *)
+
+
+/**** Function MailboxPublish ****
+ *
+ * Copies a value in and publishes it. Only the writer thread may call this.
+ *
+ * Arguments:
+ *      mailbox - Pointer to initialized MAILBOX instance
+ *      value   - Pointer to mailbox->size bytes to publish
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int MailboxPublish(MAILBOX *mailbox, const void *value) {
+
+    if (mailbox == NULL || value == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memcpy(mailbox->slots[mailbox->writeIndex].data, value, mailbox->size);
+
+    return MailboxCommit(mailbox);
+
+} // MailboxPublish(MAILBOX *, const void *)
+
+
+/**** Function MailboxLatest ****
+ *
+ * Takes the newest published value, without copying. Only the reader thread
+ * may call this.
+ *
+ * Arguments:
+ *      mailbox - Pointer to initialized MAILBOX instance
+ *      isNew   - Set to 1 if the value was published since the last call,
+ *                0 if it is the same value as last time (may be NULL)
+ *
+ * Return value:
+ *      Returns a pointer to the value, valid until the reader's next call,
+ *        or NULL if nothing has been published yet
+ */
+const void *MailboxLatest(MAILBOX *mailbox, int *isNew) {
+
+    unsigned int old;
+    uint64_t sequence;
+    int fresh = 0;
+
+    if (mailbox == NULL) {
+        return NULL;
+    }
+
+    // Only swap when the middle slot holds something newer than ours
+    if (__atomic_load_n(&(mailbox->state), __ATOMIC_ACQUIRE) & MAILBOX_NEW) {
+
+        old = __atomic_exchange_n(&(mailbox->state), mailbox->readIndex, __ATOMIC_ACQ_REL);
+        mailbox->readIndex = old & MAILBOX_INDEX_MASK;
+
+        sequence = mailbox->slots[mailbox->readIndex].sequence;
+        if (sequence > mailbox->lastSequence + 1) {
+            mailbox->numSkipped += sequence - mailbox->lastSequence - 1;
+        }
+        mailbox->lastSequence = sequence;
+        fresh = 1;
+    }
+
+    if (isNew != NULL) {
+        *isNew = fresh;
+    }
+
+    if (mailbox->slots[mailbox->readIndex].sequence == 0) {
+        return NULL;
+    }
+
+    return mailbox->slots[mailbox->readIndex].data;
+
+} // MailboxLatest(MAILBOX *, int *)
+
+
+/**** Function MailboxRead ****
+ *
+ * Copies out the newest published value. Only the reader thread may call
+ * this.
+ *
+ * Arguments:
+ *      mailbox - Pointer to initialized MAILBOX instance
+ *      value   - Pointer to mailbox->size bytes to fill
+ *
+ * Return value:
+ *      Returns 1 if the value is new since the last read, 0 if it is the
+ *        same value as last time
+ *      Returns -1 if nothing has been published yet (value is untouched) or
+ *        on bad arguments (errno is set)
+ */
+int MailboxRead(MAILBOX *mailbox, void *value) {
+
+    const void *latest;
+    int isNew;
+
+    if (mailbox == NULL || value == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    latest = MailboxLatest(mailbox, &isNew);
+    if (latest == NULL) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    memcpy(value, latest, mailbox->size);
+
+    return isNew;
+
+} // MailboxRead(MAILBOX *, void *)
@@ -0,0 +1,121 @@
+/****************************************************************************
+ *
+ * File:
+ *      message.c
+ *
+ * Description:
+ *      Encode and decode functions for the inter-subsystem message layouts in
+ *      message.h. Messages are fixed size and already in wire order, so
+ *      encoding and decoding are a single copy plus a header check. Nothing
+ *      is parsed as text and nothing is allocated.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "message.h"
+
+
+/**** Macro MESSAGE_CODEC_DEFINE ****
+ *
+ * Generates MessageEncode<NAME> and MessageDecode<NAME> for one message type
+ *
+ * MessageEncode<NAME>:
+ *      msg    - Pointer to message to encode, header is filled in
+ *      buf    - Buffer to write the encoded message into
+ *      length - Room available in buf
+ *
+ *      On success, returns number of bytes written
+ *      On failure, returns a negative number (MSG_ERR_*)
+ *
+ * MessageDecode<NAME>:
+ *      buf    - Buffer holding an encoded message
+ *      length - Number of bytes available in buf
+ *      msg    - Pointer to message to populate
+ *
+ *      On success, returns number of bytes consumed from buf
+ *      On failure, returns a negative number (MSG_ERR_*)
+ */
+#define MESSAGE_CODEC_DEFINE(NAME, TYPE, TYPE_ID, VERSION) \
+    int MessageEncode##NAME(TYPE *msg, unsigned char *buf, int length) { \
+        if (msg == NULL || buf == NULL) { \
+            return MSG_ERR_ARGS; \
+        } \
+        if (length < (int) sizeof(TYPE)) { \
+            return MSG_ERR_SHORT; \
+        } \
+        msg->header.type = TYPE_ID; \
+        msg->header.version = VERSION; \
+        msg->header.length = sizeof(TYPE); \
+        memcpy(buf, msg, sizeof(TYPE)); \
+        return sizeof(TYPE); \
+    } \
+    int MessageDecode##NAME(const unsigned char *buf, int length, TYPE *msg) { \
+        if (msg == NULL || buf == NULL) { \
+            return MSG_ERR_ARGS; \
+        } \
+        if (length < (int) sizeof(TYPE)) { \
+            return MSG_ERR_SHORT; \
+        } \
+        memcpy(msg, buf, sizeof(TYPE)); \
+        if (msg->header.type != TYPE_ID) { \
+            return MSG_ERR_TYPE; \
+        } \
+        if (msg->header.version != VERSION) { \
+            return MSG_ERR_VERSION; \
+        } \
+        if (msg->header.length != sizeof(TYPE)) { \
+            return MSG_ERR_LENGTH; \
+        } \
+        return sizeof(TYPE); \
+    }
+
+MESSAGE_CODEC_DEFINE(Pose, MSG_POSE, MSG_TYPE_POSE, MSG_POSE_VERSION)
+MESSAGE_CODEC_DEFINE(Velocity, MSG_VELOCITY, MSG_TYPE_VELOCITY, MSG_VELOCITY_VERSION)
+MESSAGE_CODEC_DEFINE(WheelCommand, MSG_WHEEL_COMMAND, MSG_TYPE_WHEEL_COMMAND, MSG_WHEEL_COMMAND_VERSION)
+MESSAGE_CODEC_DEFINE(Obstacle, MSG_OBSTACLE, MSG_TYPE_OBSTACLE, MSG_OBSTACLE_VERSION)
+
+
+/**** Function MessagePeekHeader ****
+ *
+ * Reads the header at the start of a buffer without decoding the message, to
+ * find out which decode function to call and how many bytes it needs
+ *
+ * Arguments:
+ *      buf    - Buffer holding the start of an encoded message
+ *      length - Number of bytes available in buf
+ *      header - Pointer to header to populate
+ *
+ * Return value:
+ *      On success, returns the total length of the message
+ *      On failure, returns a negative number (MSG_ERR_*)
+ */
+int MessagePeekHeader(const unsigned char *buf, int length, MSG_HEADER *header) {
+
+    if (buf == NULL || header == NULL) {
+        return MSG_ERR_ARGS;
+    }
+
+    if (length < (int) sizeof(MSG_HEADER)) {
+        return MSG_ERR_SHORT;
+    }
+
+    memcpy(header, buf, sizeof(MSG_HEADER));
+
+    // Reject lengths that can't be a message so a stream can resynchronize
+    if (header->length < sizeof(MSG_HEADER) || header->length > MSG_MAX_LENGTH) {
+        return MSG_ERR_LENGTH;
+    }
+
+    return header->length;
+
+} // MessagePeekHeader(const unsigned char *, int, MSG_HEADER *)
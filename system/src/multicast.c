@@ -0,0 +1,446 @@
+/****************************************************************************
+ *
+ * File:
+ *      multicast.c
+ *
+ * Description:
+ *      UDP multicast transport for high-rate state that several subsystems
+ *      consume (IMU samples, pose). One send reaches every subscriber, and a
+ *      lost datagram never holds up the ones behind it. Every datagram carries
+ *      a per-stream sequence number so subscribers can count gaps and simply
+ *      continue with the newest data.
+ *
+ *      Senders and receivers move datagrams in batches with sendmmsg and
+ *      recvmmsg, one system call for up to MCAST_BATCH_MAX datagrams.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Streams resynchronized after a sender restarts
+ *
+ * Revision 0.3
+ *      Last edited 10/18/2026
+ *      Restarts told apart by the sender session, not a backward jump
+ *
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "debuglog.h"
+
+#include "multicast.h"
+
+
+/**** Function McastSenderInit ****
+ *
+ * Opens a UDP socket for publishing to a multicast group
+ *
+ * Arguments:
+ *      sender    - Pointer to MCAST_SENDER instance to initialize
+ *      groupAddr - Multicast group address "XXX.XXX.XXX.XXX"
+ *      port      - Destination port
+ *      ifaceAddr - Address of the local interface to send on (NULL for the
+ *                  system default). Use "127.0.0.1" for loopback.
+ *      stream    - Stream identifier stamped on every datagram
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int McastSenderInit(MCAST_SENDER *sender, char *groupAddr, int port, char *ifaceAddr, int stream) {
+
+    int rc, socketOption;
+    struct in_addr iface;
+    struct timespec now;
+
+    if (sender == NULL || groupAddr == NULL) {
+        return -1;
+    }
+
+    if (stream < 0 || stream >= MCAST_MAX_STREAMS) {
+        return -2;
+    }
+
+    memset(sender, 0, sizeof(MCAST_SENDER));
+    sender->stream = stream;
+
+    // Differs from one start to the next, so subscribers can tell a restart
+    // from a late datagram however few were sent before it
+    clock_gettime(CLOCK_REALTIME, &now);
+    sender->session = (uint32_t) (now.tv_sec ^ now.tv_nsec ^ ((uint32_t) getpid() << 16));
+
+    sender->group.sin_family = AF_INET;
+    sender->group.sin_port = htons(port);
+    rc = inet_pton(AF_INET, groupAddr, &(sender->group.sin_addr));
+    if (rc != 1) {
+        logDebug(L_INFO, "%s: Invalid multicast group address\n", groupAddr);
+        return -3;
+    }
+
+    sender->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sender->fd == -1) {
+        logDebug(L_INFO, "%s: Failed to create multicast socket\n", strerror(errno));
+        return -4;
+    }
+
+    // Select outgoing interface
+    if (ifaceAddr != NULL) {
+        inet_pton(AF_INET, ifaceAddr, &iface);
+        rc = setsockopt(sender->fd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface));
+        if (rc != 0) {
+            logDebug(L_INFO, "Unable to set socket option IP_MULTICAST_IF: %s\n", strerror(errno));
+        }
+    }
+
+    // Subscribers may be on this same machine
+    socketOption = 1;
+    rc = setsockopt(sender->fd, IPPROTO_IP, IP_MULTICAST_LOOP, &socketOption, sizeof(int));
+    if (rc != 0) {
+        logDebug(L_INFO, "Unable to set socket option IP_MULTICAST_LOOP: %s\n", strerror(errno));
+    }
+
+    // Stay on the robot's local network
+    socketOption = 1;
+    rc = setsockopt(sender->fd, IPPROTO_IP, IP_MULTICAST_TTL, &socketOption, sizeof(int));
+    if (rc != 0) {
+        logDebug(L_INFO, "Unable to set socket option IP_MULTICAST_TTL: %s\n", strerror(errno));
+    }
+
+    return 0;
+
+} // McastSenderInit(MCAST_SENDER *, char *, int, char *, int)
+
+
+/**** Function McastSend ****
+ *
+ * Publishes a single datagram
+ *
+ * Arguments:
+ *      sender - Pointer to initialized MCAST_SENDER instance
+ *      buf    - Payload to send
+ *      length - Payload length (at most MCAST_MAX_PAYLOAD)
+ *
+ * Return value:
+ *      On success, returns 1 (number of datagrams sent)
+ *      On failure, returns a negative number
+ */
+int McastSend(MCAST_SENDER *sender, const unsigned char *buf, int length) {
+
+    return McastSendBatch(sender, &buf, &length, 1);
+
+} // McastSend(MCAST_SENDER *, const unsigned char *, int)
+
+
+/**** Function McastSendBatch ****
+ *
+ * Publishes several datagrams with a single sendmmsg call. Each gets the next
+ * sequence number of the sender's stream.
+ *
+ * Arguments:
+ *      sender  - Pointer to initialized MCAST_SENDER instance
+ *      bufs    - Array of payload pointers
+ *      lengths - Array of payload lengths (each at most MCAST_MAX_PAYLOAD)
+ *      count   - Number of payloads (at most MCAST_BATCH_MAX)
+ *
+ * Return value:
+ *      On success, returns number of datagrams sent. Sequence numbers are
+ *        only used up by datagrams that were sent.
+ *      On failure, returns a negative number
+ */
+int McastSendBatch(MCAST_SENDER *sender, const unsigned char **bufs, const int *lengths, int count) {
+
+    MCAST_HEADER headers[MCAST_BATCH_MAX];
+    struct iovec iov[MCAST_BATCH_MAX][2];
+    struct mmsghdr msgs[MCAST_BATCH_MAX];
+    int i, numSent;
+
+    if (sender == NULL || bufs == NULL || lengths == NULL) {
+        return -1;
+    }
+
+    if (count <= 0 || count > MCAST_BATCH_MAX) {
+        return -2;
+    }
+
+    memset(msgs, 0, count * sizeof(struct mmsghdr));
+
+    for (i = 0; i < count; i++) {
+
+        if (bufs[i] == NULL || lengths[i] < 0 || lengths[i] > MCAST_MAX_PAYLOAD) {
+            return -3;
+        }
+
+        headers[i].sequence = sender->sequence + i;
+        headers[i].session = sender->session;
+        headers[i].stream = sender->stream;
+        headers[i].length = lengths[i];
+
+        // Header and payload gathered without copying into one buffer
+        iov[i][0].iov_base = &headers[i];
+        iov[i][0].iov_len = sizeof(MCAST_HEADER);
+        iov[i][1].iov_base = (void *) bufs[i];
+        iov[i][1].iov_len = lengths[i];
+
+        msgs[i].msg_hdr.msg_name = &(sender->group);
+        msgs[i].msg_hdr.msg_namelen = sizeof(sender->group);
+        msgs[i].msg_hdr.msg_iov = iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 2;
+    }
+
+    numSent = sendmmsg(sender->fd, msgs, count, MSG_DONTWAIT);
+    if (numSent < 0) {
+        logDebug(L_INFO, "%s: McastSendBatch sendmmsg() failed\n", strerror(errno));
+        return numSent;
+    }
+
+    sender->sequence += numSent;
+
+    return numSent;
+
+} // McastSendBatch(MCAST_SENDER *, const unsigned char **, const int *, int)
+
+
+/**** Function McastSenderClose ****
+ *
+ * Arguments:
+ *      sender - Pointer to MCAST_SENDER instance to close
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int McastSenderClose(MCAST_SENDER *sender) {
+
+    if (sender == NULL) {
+        return -1;
+    }
+
+    return close(sender->fd);
+
+} // McastSenderClose(MCAST_SENDER *)
+
+
+/**** Function McastReceiverInit ****
+ *
+ * Opens a UDP socket and joins a multicast group. Several receivers on the
+ * same machine may join the same group and port.
+ *
+ * Arguments:
+ *      receiver  - Pointer to MCAST_RECEIVER instance to initialize
+ *      groupAddr - Multicast group address "XXX.XXX.XXX.XXX"
+ *      port      - Port to receive on
+ *      ifaceAddr - Address of the local interface to join on (NULL for the
+ *                  system default). Use "127.0.0.1" for loopback.
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int McastReceiverInit(MCAST_RECEIVER *receiver, char *groupAddr, int port, char *ifaceAddr) {
+
+    int rc, socketOption;
+    struct sockaddr_in bindAddress;
+    struct ip_mreq membership;
+
+    if (receiver == NULL || groupAddr == NULL) {
+        return -1;
+    }
+
+    memset(receiver, 0, sizeof(MCAST_RECEIVER));
+
+    rc = inet_pton(AF_INET, groupAddr, &(membership.imr_multiaddr));
+    if (rc != 1) {
+        logDebug(L_INFO, "%s: Invalid multicast group address\n", groupAddr);
+        return -2;
+    }
+    if (ifaceAddr != NULL) {
+        inet_pton(AF_INET, ifaceAddr, &(membership.imr_interface));
+    } else {
+        membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    }
+
+    receiver->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (receiver->fd == -1) {
+        logDebug(L_INFO, "%s: Failed to create multicast socket\n", strerror(errno));
+        return -3;
+    }
+
+    // Allow every subscriber on this machine to bind the same port
+    socketOption = 1;
+    rc = setsockopt(receiver->fd, SOL_SOCKET, SO_REUSEADDR, &socketOption, sizeof(int));
+    if (rc != 0) {
+        logDebug(L_INFO, "Unable to set socket option SO_REUSEADDR: %s\n", strerror(errno));
+    }
+
+    // Bind to the group address so unrelated traffic to the port is ignored
+    memset(&bindAddress, 0, sizeof(bindAddress));
+    bindAddress.sin_family = AF_INET;
+    bindAddress.sin_port = htons(port);
+    bindAddress.sin_addr = membership.imr_multiaddr;
+    rc = bind(receiver->fd, (struct sockaddr *) &bindAddress, sizeof(bindAddress));
+    if (rc == -1) {
+        logDebug(L_INFO, "%s: Failed to bind multicast socket\n", strerror(errno));
+        close(receiver->fd);
+        return -4;
+    }
+
+    rc = setsockopt(receiver->fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership));
+    if (rc == -1) {
+        logDebug(L_INFO, "%s: Failed to join multicast group %s\n", strerror(errno), groupAddr);
+        close(receiver->fd);
+        return -5;
+    }
+
+    return 0;
+
+} // McastReceiverInit(MCAST_RECEIVER *, char *, int, char *)
+
+
+/**** Function McastReceiveBatch ****
+ *
+ * Receives up to max datagrams with a single recvmmsg call. Datagrams that
+ * skip sequence numbers are delivered and the gap is counted. Datagrams older
+ * than one already delivered on the same stream are dropped, since the
+ * subscriber has already moved past them. A datagram carrying a new sender
+ * session starts the stream over from its sequence number.
+ *
+ * Arguments:
+ *      receiver  - Pointer to initialized MCAST_RECEIVER instance
+ *      datagrams - Array to hold received datagram descriptors. Data pointers
+ *                  are valid until the next call.
+ *      max       - Size of datagrams array (at most MCAST_BATCH_MAX used)
+ *      timeoutMs - Milliseconds to wait for the first datagram (0 to return
+ *                  immediately, -1 to wait forever)
+ *
+ * Return value:
+ *      On success, returns number of datagrams delivered (may be 0)
+ *      On failure, returns a negative number
+ */
+int McastReceiveBatch(MCAST_RECEIVER *receiver, MCAST_DATAGRAM *datagrams, int max, int timeoutMs) {
+
+    struct iovec iov[MCAST_BATCH_MAX];
+    struct mmsghdr msgs[MCAST_BATCH_MAX];
+    struct pollfd fds;
+    MCAST_HEADER header;
+    int i, rc, numReceived, numDelivered = 0;
+    int32_t ahead;
+
+    if (receiver == NULL || datagrams == NULL || max <= 0) {
+        return -1;
+    }
+
+    if (max > MCAST_BATCH_MAX) {
+        max = MCAST_BATCH_MAX;
+    }
+
+    // Sleep in the kernel until something arrives
+    if (timeoutMs != 0) {
+        fds.fd = receiver->fd;
+        fds.events = POLLIN;
+        rc = poll(&fds, 1, timeoutMs);
+        if (rc <= 0) {
+            return rc;
+        }
+    }
+
+    memset(msgs, 0, max * sizeof(struct mmsghdr));
+    for (i = 0; i < max; i++) {
+        iov[i].iov_base = receiver->storage[i];
+        iov[i].iov_len = MCAST_MAX_DATAGRAM;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    numReceived = recvmmsg(receiver->fd, msgs, max, MSG_DONTWAIT, NULL);
+    if (numReceived < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        logDebug(L_INFO, "%s: McastReceiveBatch recvmmsg() failed\n", strerror(errno));
+        return numReceived;
+    }
+
+    for (i = 0; i < numReceived; i++) {
+
+        // Header must be present and agree with the datagram size
+        memcpy(&header, receiver->storage[i], sizeof(MCAST_HEADER));
+        if (msgs[i].msg_len < sizeof(MCAST_HEADER) ||
+                msgs[i].msg_len != sizeof(MCAST_HEADER) + header.length ||
+                header.stream >= MCAST_MAX_STREAMS) {
+            receiver->numMalformed++;
+            continue;
+        }
+
+        receiver->numReceived++;
+
+        // A new session means the sender started over. Otherwise compare
+        // against the expected sequence with wraparound.
+        if (receiver->synced[header.stream] && header.session != receiver->session[header.stream]) {
+            receiver->numResyncs++;
+            logDebug(L_INFO, "Multicast stream %d: sender restarted at %u, resynchronizing\n",
+                    header.stream, header.sequence);
+        } else if (receiver->synced[header.stream]) {
+            ahead = (int32_t) (header.sequence - receiver->nextSequence[header.stream]);
+            if (ahead < 0) {
+                receiver->numStale++;
+                continue;
+            } else if (ahead > 0) {
+                receiver->numLost += ahead;
+                receiver->numGaps++;
+                logDebug(L_DEBUG, "Multicast stream %d: lost %d datagrams before %u\n",
+                        header.stream, ahead, header.sequence);
+            }
+        }
+
+        receiver->synced[header.stream] = 1;
+        receiver->session[header.stream] = header.session;
+        receiver->nextSequence[header.stream] = header.sequence + 1;
+
+        datagrams[numDelivered].sequence = header.sequence;
+        datagrams[numDelivered].stream = header.stream;
+        datagrams[numDelivered].length = header.length;
+        datagrams[numDelivered].data = receiver->storage[i] + sizeof(MCAST_HEADER);
+        numDelivered++;
+    }
+
+    return numDelivered;
+
+} // McastReceiveBatch(MCAST_RECEIVER *, MCAST_DATAGRAM *, int, int)
+
+
+/**** Function McastReceiverClose ****
+ *
+ * Arguments:
+ *      receiver - Pointer to MCAST_RECEIVER instance to close
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int McastReceiverClose(MCAST_RECEIVER *receiver) {
+
+    if (receiver == NULL) {
+        return -1;
+    }
+
+    return close(receiver->fd);
+
+} // McastReceiverClose(MCAST_RECEIVER *)
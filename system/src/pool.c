@@ -0,0 +1,587 @@
+/****************************************************************************
+ *
+ * File:
+ *      pool.c
+ *
+ * Description:
+ *      Work-stealing thread pool for data-parallel batch jobs (image tiles,
+ *      parameter sweeps, log conversion). Each worker keeps its own deque of
+ *      tasks and works from the bottom of it, so related work stays on one
+ *      core. Idle workers steal from the top of other deques, which holds
+ *      the oldest and usually largest pieces of work.
+ *
+ *      Workers are ordinary (not SCHED_FIFO) threads, meant to be pinned to
+ *      cores the realtime loops don't use.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "debuglog.h"
+#include "thread.h"
+
+#include "pool.h"
+
+// Worker running in the current thread, NULL outside of any pool
+static __thread POOL_WORKER *poolSelf = NULL;
+
+
+/**** Function poolDequePush ****
+ *
+ * Adds a task to the bottom of a deque, returns -1 if full
+ */
+static int poolDequePush(POOL_DEQUE *deque, const POOL_TASK *task) {
+
+    int rc = -1;
+
+    pthread_mutex_lock(&(deque->lock));
+    if (deque->bottom - deque->top < POOL_DEQUE_LEN) {
+        deque->tasks[deque->bottom % POOL_DEQUE_LEN] = *task;
+        deque->bottom++;
+        rc = 0;
+    }
+    pthread_mutex_unlock(&(deque->lock));
+
+    return rc;
+
+} // poolDequePush(POOL_DEQUE *, const POOL_TASK *)
+
+
+/**** Function poolDequePop ****
+ *
+ * Removes the newest task from the bottom of a deque, returns -1 if empty
+ */
+static int poolDequePop(POOL_DEQUE *deque, POOL_TASK *task) {
+
+    int rc = -1;
+
+    pthread_mutex_lock(&(deque->lock));
+    if (deque->bottom != deque->top) {
+        deque->bottom--;
+        *task = deque->tasks[deque->bottom % POOL_DEQUE_LEN];
+        rc = 0;
+    }
+    pthread_mutex_unlock(&(deque->lock));
+
+    return rc;
+
+} // poolDequePop(POOL_DEQUE *, POOL_TASK *)
+
+
+/**** Function poolDequeSteal ****
+ *
+ * Removes the oldest task from the top of a deque, returns -1 if empty
+ */
+static int poolDequeSteal(POOL_DEQUE *deque, POOL_TASK *task) {
+
+    int rc = -1;
+
+    // Don't wait on a deque that is busy, just try the next one
+    if (pthread_mutex_trylock(&(deque->lock)) != 0) {
+        return -1;
+    }
+    if (deque->bottom != deque->top) {
+        *task = deque->tasks[deque->top % POOL_DEQUE_LEN];
+        deque->top++;
+        rc = 0;
+    }
+    pthread_mutex_unlock(&(deque->lock));
+
+    return rc;
+
+} // poolDequeSteal(POOL_DEQUE *, POOL_TASK *)
+
+
+/**** Function poolPush ****
+ *
+ * Queues a task on the current worker's deque, or round robin when called
+ * from outside the pool, and wakes a sleeping thread. Returns -1 if the
+ * deque is full.
+ */
+static int poolPush(POOL *pool, const POOL_TASK *task) {
+
+    POOL_WORKER *worker;
+
+    if (poolSelf != NULL && poolSelf->pool == pool) {
+        worker = poolSelf;
+    } else {
+        worker = &(pool->workers[__atomic_fetch_add(&(pool->nextSubmit), 1,
+                    __ATOMIC_RELAXED) % pool->numWorkers]);
+    }
+
+    if (poolDequePush(&(worker->deque), task) != 0) {
+        return -1;
+    }
+
+    // Sleepers register before checking numQueued, so either they see this
+    // task or this sees them
+    __atomic_add_fetch(&(pool->numQueued), 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&(pool->numSleeping), __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&(pool->sleepLock));
+        pthread_cond_signal(&(pool->wake));
+        pthread_mutex_unlock(&(pool->sleepLock));
+    }
+
+    return 0;
+
+} // poolPush(POOL *, const POOL_TASK *)
+
+
+/**** Function poolTake ****
+ *
+ * Gets a task to run, from the current worker's own deque first and
+ * otherwise stolen from another worker. Returns -1 if none are queued.
+ */
+static int poolTake(POOL *pool, POOL_TASK *task) {
+
+    POOL_WORKER *self = NULL;
+    int i, start;
+
+    if (poolSelf != NULL && poolSelf->pool == pool) {
+        self = poolSelf;
+        if (poolDequePop(&(self->deque), task) == 0) {
+            __atomic_sub_fetch(&(pool->numQueued), 1, __ATOMIC_SEQ_CST);
+            return 0;
+        }
+    }
+
+    // Start with the next worker over so thieves spread out
+    start = (self != NULL) ? self->index + 1 : 0;
+    for (i = 0; i < pool->numWorkers; i++) {
+        POOL_WORKER *victim = &(pool->workers[(start + i) % pool->numWorkers]);
+        if (victim == self) {
+            continue;
+        }
+        if (poolDequeSteal(&(victim->deque), task) == 0) {
+            __atomic_sub_fetch(&(pool->numQueued), 1, __ATOMIC_SEQ_CST);
+            if (self != NULL) {
+                self->numStolen++;
+            }
+            return 0;
+        }
+    }
+
+    return -1;
+
+} // poolTake(POOL *, POOL_TASK *)
+
+
+/**** Function poolFinish ****
+ *
+ * Marks one task of a group done, waking waiters when it was the last
+ */
+static void poolFinish(POOL *pool, POOL_GROUP *group) {
+
+    if (group == NULL) {
+        return;
+    }
+
+    if (__atomic_sub_fetch(&(group->pending), 1, __ATOMIC_SEQ_CST) == 0 &&
+            __atomic_load_n(&(pool->numSleeping), __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&(pool->sleepLock));
+        pthread_cond_broadcast(&(pool->wake));
+        pthread_mutex_unlock(&(pool->sleepLock));
+    }
+
+} // poolFinish(POOL *, POOL_GROUP *)
+
+
+/**** Function poolRun ****
+ *
+ * Runs a task. Range tasks larger than their grain first split off their
+ * upper half as a new task, repeatedly, so idle workers can steal it.
+ */
+static void poolRun(POOL *pool, POOL_TASK *task) {
+
+    POOL_TASK half;
+    int begin = task->begin, end = task->end, mid;
+
+    if (task->rangeRoutine != NULL) {
+
+        while (end - begin > task->grain) {
+            mid = begin + (end - begin) / 2;
+            half = *task;
+            half.begin = mid;
+            half.end = end;
+            if (half.group != NULL) {
+                __atomic_add_fetch(&(half.group->pending), 1, __ATOMIC_SEQ_CST);
+            }
+            if (poolPush(pool, &half) != 0) {
+                // Deque full, keep the whole range here
+                if (half.group != NULL) {
+                    __atomic_sub_fetch(&(half.group->pending), 1, __ATOMIC_SEQ_CST);
+                }
+                break;
+            }
+            end = mid;
+        }
+
+        task->rangeRoutine(task->params, begin, end);
+
+    } else {
+        task->routine(task->params);
+    }
+
+    if (poolSelf != NULL && poolSelf->pool == pool) {
+        poolSelf->numExecuted++;
+    }
+
+    poolFinish(pool, task->group);
+
+} // poolRun(POOL *, POOL_TASK *)
+
+
+/**** Function poolWorkerRoutine ****
+ *
+ * Body of each worker thread
+ */
+static void *poolWorkerRoutine(void *arg) {
+
+    POOL_WORKER *worker = (POOL_WORKER *) arg;
+    POOL *pool = worker->pool;
+    POOL_TASK task;
+
+    poolSelf = worker;
+
+    while (pool->running) {
+
+        if (poolTake(pool, &task) == 0) {
+            poolRun(pool, &task);
+            continue;
+        }
+
+        pthread_mutex_lock(&(pool->sleepLock));
+        __atomic_add_fetch(&(pool->numSleeping), 1, __ATOMIC_SEQ_CST);
+        while (pool->running && __atomic_load_n(&(pool->numQueued), __ATOMIC_SEQ_CST) <= 0) {
+            pthread_cond_wait(&(pool->wake), &(pool->sleepLock));
+        }
+        __atomic_sub_fetch(&(pool->numSleeping), 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&(pool->sleepLock));
+    }
+
+    return NULL;
+
+} // poolWorkerRoutine(void *)
+
+
+/**** Function PoolInit ****
+ *
+ * Starts a pool of worker threads
+ *
+ * Arguments:
+ *      pool       - Pointer to POOL instance to initialize
+ *      numWorkers - Number of worker threads, or 0 for one per core in
+ *                   cpuMask (or per online core if cpuMask is 0)
+ *      cpuMask    - Cores the workers may run on (see THREAD_CPU), or 0 for
+ *                   any core. Cores that don't exist are ignored.
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int PoolInit(POOL *pool, int numWorkers, unsigned long cpuMask) {
+
+    int i, rc, numCpus;
+    pthread_attr_t threadAttr;
+
+    if (pool == NULL || numWorkers < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(POOL));
+
+    // Drop cores that aren't present
+    numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (numCpus > 0 && numCpus < (int) (8 * sizeof(cpuMask))) {
+        if (cpuMask != 0 && (cpuMask & (THREAD_CPU(numCpus) - 1)) == 0) {
+            logDebug(L_INFO, "Pool: None of cores 0x%lx present, workers not pinned\n", cpuMask);
+        }
+        cpuMask &= THREAD_CPU(numCpus) - 1;
+    }
+    pool->cpuMask = cpuMask;
+
+    if (numWorkers == 0) {
+        numWorkers = (cpuMask != 0) ? __builtin_popcountl(cpuMask) : numCpus;
+    }
+    if (numWorkers < 1) {
+        numWorkers = 1;
+    }
+    if (numWorkers > POOL_MAX_WORKERS) {
+        numWorkers = POOL_MAX_WORKERS;
+    }
+
+    pthread_mutex_init(&(pool->sleepLock), NULL);
+    pthread_cond_init(&(pool->wake), NULL);
+    for (i = 0; i < POOL_MAX_WORKERS; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        pthread_mutex_init(&(pool->workers[i].deque.lock), NULL);
+    }
+
+    pthread_attr_init(&threadAttr);
+    if (cpuMask != 0) {
+        ThreadAttrSetAffinity(&threadAttr, cpuMask);
+    }
+
+    pool->running = 1;
+    for (i = 0; i < numWorkers; i++) {
+        rc = ThreadCreate(&(pool->workers[i].thread), &threadAttr,
+                poolWorkerRoutine, &(pool->workers[i]));
+        if (rc != 0) {
+            break;
+        }
+        pool->numWorkers++;
+    }
+    pthread_attr_destroy(&threadAttr);
+
+    if (pool->numWorkers < numWorkers) {
+        logDebug(L_INFO, "Pool: Started only %d of %d workers\n", pool->numWorkers, numWorkers);
+        if (pool->numWorkers == 0) {
+            PoolDestroy(pool);
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+
+    logDebug(L_DEBUG, "Pool: Started %d workers on cores 0x%lx\n", pool->numWorkers, cpuMask);
+
+    return 0;
+
+} // PoolInit(POOL *, int, unsigned long)
+
+
+/**** Function PoolGroupInit ****
+ *
+ * Arguments:
+ *      group - Pointer to POOL_GROUP instance to initialize
+ */
+void PoolGroupInit(POOL_GROUP *group) {
+
+    if (group != NULL) {
+        group->pending = 0;
+    }
+
+} // PoolGroupInit(POOL_GROUP *)
+
+
+/**** Function PoolSubmit ****
+ *
+ * Queues routine(params) to run on the pool. Tasks may submit more tasks.
+ *
+ * Arguments:
+ *      pool    - Pointer to running POOL instance
+ *      group   - Group to count the task in, or NULL
+ *      routine - Function to run
+ *      params  - Passed to routine
+ *
+ * Return value:
+ *      On success, returns 0 (if the queue was full, the task has already
+ *        run in the calling thread)
+ *      On failure, returns -1 and errno is set
+ */
+int PoolSubmit(POOL *pool, POOL_GROUP *group, void (*routine)(void *), void *params) {
+
+    POOL_TASK task;
+
+    if (pool == NULL || routine == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(&task, 0, sizeof(POOL_TASK));
+    task.routine = routine;
+    task.params = params;
+    task.group = group;
+
+    if (group != NULL) {
+        __atomic_add_fetch(&(group->pending), 1, __ATOMIC_SEQ_CST);
+    }
+
+    if (poolPush(pool, &task) != 0) {
+        __atomic_add_fetch(&(pool->numInline), 1, __ATOMIC_RELAXED);
+        poolRun(pool, &task);
+    }
+
+    return 0;
+
+} // PoolSubmit(POOL *, POOL_GROUP *, void (*)(void *), void *)
+
+
+/**** Function PoolGroupWait ****
+ *
+ * Waits for every task in a group to finish. The calling thread runs queued
+ * tasks while it waits, so waiting from inside a task never deadlocks.
+ *
+ * Arguments:
+ *      pool  - Pointer to running POOL instance
+ *      group - Group to wait on
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int PoolGroupWait(POOL *pool, POOL_GROUP *group) {
+
+    POOL_TASK task;
+
+    if (pool == NULL || group == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    while (__atomic_load_n(&(group->pending), __ATOMIC_SEQ_CST) > 0) {
+
+        if (poolTake(pool, &task) == 0) {
+            poolRun(pool, &task);
+            continue;
+        }
+
+        // Nothing to help with, sleep until a task is queued or one of ours
+        // finishes
+        pthread_mutex_lock(&(pool->sleepLock));
+        __atomic_add_fetch(&(pool->numSleeping), 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&(group->pending), __ATOMIC_SEQ_CST) > 0 &&
+                __atomic_load_n(&(pool->numQueued), __ATOMIC_SEQ_CST) <= 0) {
+            pthread_cond_wait(&(pool->wake), &(pool->sleepLock));
+        }
+        __atomic_sub_fetch(&(pool->numSleeping), 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&(pool->sleepLock));
+    }
+
+    return 0;
+
+} // PoolGroupWait(POOL *, POOL_GROUP *)
+
+
+/**** Function PoolParallelFor ****
+ *
+ * Calls routine(params, begin, end) over subranges covering [begin, end),
+ * in parallel, and returns once all of them are done. Ranges are split in
+ * half until no more than grain indices remain, so grain should be large
+ * enough that one call does meaningfully more work than a task handoff.
+ *
+ * Arguments:
+ *      pool    - Pointer to running POOL instance
+ *      begin   - First index
+ *      end     - One past the last index
+ *      grain   - Largest subrange handed to routine
+ *      routine - Function to run on each subrange
+ *      params  - Passed to routine
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int PoolParallelFor(POOL *pool, int begin, int end, int grain,
+        void (*routine)(void *, int, int), void *params) {
+
+    POOL_GROUP group;
+    POOL_TASK task;
+
+    if (pool == NULL || routine == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (end <= begin) {
+        return 0;
+    }
+
+    memset(&task, 0, sizeof(POOL_TASK));
+    task.rangeRoutine = routine;
+    task.params = params;
+    task.begin = begin;
+    task.end = end;
+    task.grain = (grain > 0) ? grain : 1;
+    task.group = &group;
+
+    // The caller takes the first piece itself
+    PoolGroupInit(&group);
+    group.pending = 1;
+    poolRun(pool, &task);
+
+    return PoolGroupWait(pool, &group);
+
+} // PoolParallelFor(POOL *, int, int, int, void (*)(void *, int, int), void *)
+
+
+/**** Function PoolReportStats ****
+ *
+ * Logs how much work each worker ran and stole
+ *
+ * Arguments:
+ *      pool - Pointer to POOL instance
+ */
+void PoolReportStats(POOL *pool) {
+
+    int i;
+
+    if (pool == NULL) {
+        return;
+    }
+
+    logDebug(L_INFO, "Pool: %d workers, %llu tasks run inline\n", pool->numWorkers,
+            (unsigned long long) pool->numInline);
+    for (i = 0; i < pool->numWorkers; i++) {
+        logDebug(L_INFO, "Pool:   worker %d ran %llu tasks, stole %llu\n", i,
+                (unsigned long long) pool->workers[i].numExecuted,
+                (unsigned long long) pool->workers[i].numStolen);
+    }
+
+} // PoolReportStats(POOL *)
+
+
+/**** Function PoolDestroy ****
+ *
+ * Stops and joins the workers. Tasks still queued are not run.
+ *
+ * Arguments:
+ *      pool - Pointer to POOL instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int PoolDestroy(POOL *pool) {
+
+    int i;
+
+    if (pool == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_mutex_lock(&(pool->sleepLock));
+    pool->running = 0;
+    pthread_cond_broadcast(&(pool->wake));
+    pthread_mutex_unlock(&(pool->sleepLock));
+
+    for (i = 0; i < pool->numWorkers; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    for (i = 0; i < POOL_MAX_WORKERS; i++) {
+        pthread_mutex_destroy(&(pool->workers[i].deque.lock));
+    }
+    pthread_mutex_destroy(&(pool->sleepLock));
+    pthread_cond_destroy(&(pool->wake));
+
+    pool->numWorkers = 0;
+
+    return 0;
+
+} // PoolDestroy(POOL *)
@@ -0,0 +1,564 @@
+/****************************************************************************
+ *
+ * File:
+ *      ptydev.c
+ *
+ * Description:
+ *      Emulated serial devices for testing without hardware. A pseudoterminal
+ *      pair stands in for the UART: the code under test opens the slave path
+ *      exactly as it would open /dev/ttyUSB0, while a device model on the
+ *      master side answers it. The model is either a callback or a script of
+ *      line-based request/reply pairs.
+ *
+ *      Output from the model can be paced to a baud rate, delayed, and
+ *      corrupted, so timing and error handling paths can be exercised.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Tick wait rounded up, running flag accessed atomically
+ *
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <termios.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "debuglog.h"
+#include "timing.h"
+#include "uart.h"
+
+#include "ptydev.h"
+
+// Largest group of paced bytes written at once, so pacing stays smooth
+#define PTYDEV_PACE_GROUP_NS NSEC_PER_MSEC
+
+// How often the device thread checks for a stop request when idle
+#define PTYDEV_IDLE_MS 20
+
+
+/**** Function ptyDevSleepUntil ****
+ *
+ * Sleeps until an absolute CLOCK_MONOTONIC time in nanoseconds
+ */
+static void ptyDevSleepUntil(int64_t timeNs) {
+
+    struct timespec ts;
+
+    TimeNsToTimespec(timeNs, &ts);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        // Interrupted by a signal, keep sleeping
+    }
+
+} // ptyDevSleepUntil(int64_t)
+
+
+/**** Function PtyDevInit ****
+ *
+ * Creates a pseudoterminal pair for an emulated device. The device does not
+ * respond until PtyDevStart is called.
+ *
+ * Arguments:
+ *      pty     - Pointer to PTY_DEV instance to initialize
+ *      handler - Device model callback (PtyDevScriptHandler for scripts)
+ *      context - Passed to the handler on each call
+ *
+ * Return value:
+ *      On success, returns 0 and pty->slavePath holds the device path
+ *      On failure, returns a negative number
+ */
+int PtyDevInit(PTY_DEV *pty, PTYDEV_HANDLER handler, void *context) {
+
+    struct termios options;
+    char *path;
+
+    if (pty == NULL || handler == NULL) {
+        return -1;
+    }
+
+    memset(pty, 0, sizeof(PTY_DEV));
+    pty->handler = handler;
+    pty->context = context;
+    pty->seed = 1;
+
+    pty->master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (pty->master_fd == -1) {
+        logDebug(L_INFO, "%s: PtyDevInit posix_openpt() failed\n", strerror(errno));
+        return -2;
+    }
+
+    if (grantpt(pty->master_fd) != 0 || unlockpt(pty->master_fd) != 0 ||
+            (path = ptsname(pty->master_fd)) == NULL) {
+        logDebug(L_INFO, "%s: PtyDevInit could not unlock slave\n", strerror(errno));
+        close(pty->master_fd);
+        return -3;
+    }
+    snprintf(pty->slavePath, PTYDEV_PATH_LEN, "%s", path);
+
+    pty->slave_fd = open(pty->slavePath, O_RDWR | O_NOCTTY);
+    if (pty->slave_fd == -1) {
+        logDebug(L_INFO, "%s: PtyDevInit could not open %s\n", strerror(errno), pty->slavePath);
+        close(pty->master_fd);
+        return -4;
+    }
+
+    // Start out as a raw line, like a serial port before configuration
+    if (tcgetattr(pty->slave_fd, &options) == 0) {
+        cfmakeraw(&options);
+        tcsetattr(pty->slave_fd, TCSANOW, &options);
+    }
+
+    pthread_mutex_init(&(pty->writeLock), NULL);
+
+    return 0;
+
+} // PtyDevInit(PTY_DEV *, PTYDEV_HANDLER, void *)
+
+
+/**** Function PtyDevSetPacing ****
+ *
+ * Arguments:
+ *      pty  - Pointer to initialized PTY_DEV instance
+ *      baud - Rate to pace output at, one 8N1 character time per byte (0 to
+ *             send as fast as possible)
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int PtyDevSetPacing(PTY_DEV *pty, int baud) {
+
+    if (pty == NULL || baud < 0) {
+        return -1;
+    }
+
+    pty->baud = baud;
+
+    return 0;
+
+} // PtyDevSetPacing(PTY_DEV *, int)
+
+
+/**** Function PtyDevSetLatency ****
+ *
+ * Arguments:
+ *      pty       - Pointer to initialized PTY_DEV instance
+ *      latencyUs - Delay before each write from the model reaches the line
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int PtyDevSetLatency(PTY_DEV *pty, int latencyUs) {
+
+    if (pty == NULL || latencyUs < 0) {
+        return -1;
+    }
+
+    pty->latencyNs = (int64_t) latencyUs * NSEC_PER_USEC;
+
+    return 0;
+
+} // PtyDevSetLatency(PTY_DEV *, int)
+
+
+/**** Function PtyDevSetCorruption ****
+ *
+ * Arguments:
+ *      pty  - Pointer to initialized PTY_DEV instance
+ *      rate - Probability (0 to 1) that each byte sent has one bit flipped
+ *      seed - Seed for the corruption generator
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int PtyDevSetCorruption(PTY_DEV *pty, double rate, unsigned int seed) {
+
+    if (pty == NULL || rate < 0 || rate > 1) {
+        return -1;
+    }
+
+    pty->corruptRate = rate;
+    pty->seed = seed;
+
+    return 0;
+
+} // PtyDevSetCorruption(PTY_DEV *, double, unsigned int)
+
+
+/**** Function PtyDevSetTick ****
+ *
+ * Makes the device thread call the handler with no data periodically, for
+ * models that produce output on their own (ex. asynchronous sensor data).
+ *
+ * Arguments:
+ *      pty      - Pointer to initialized PTY_DEV instance
+ *      periodUs - Microseconds between ticks (0 to disable)
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int PtyDevSetTick(PTY_DEV *pty, int periodUs) {
+
+    if (pty == NULL || periodUs < 0) {
+        return -1;
+    }
+
+    pty->tickNs = (int64_t) periodUs * NSEC_PER_USEC;
+
+    return 0;
+
+} // PtyDevSetTick(PTY_DEV *, int)
+
+
+/**** Function ptyDevThread ****
+ *
+ * Device thread. Hands everything written to the slave to the model, and
+ * ticks the model on its period.
+ */
+static void *ptyDevThread(void *arg) {
+
+    PTY_DEV *pty = (PTY_DEV *) arg;
+    unsigned char buf[PTYDEV_LINE_LEN];
+    struct pollfd fds;
+    int64_t nextTickNs = 0, now;
+    int timeoutMs, tickMs, numRead, rc;
+
+    fds.fd = pty->master_fd;
+    fds.events = POLLIN;
+
+    if (pty->tickNs > 0) {
+        nextTickNs = TimeMonotonicNs() + pty->tickNs;
+    }
+
+    while (__atomic_load_n(&(pty->running), __ATOMIC_SEQ_CST)) {
+
+        timeoutMs = PTYDEV_IDLE_MS;
+        if (pty->tickNs > 0) {
+            now = TimeMonotonicNs();
+            if (now >= nextTickNs) {
+                pty->numTicks++;
+                nextTickNs += pty->tickNs;
+                if (pty->handler(pty, NULL, 0, pty->context) < 0) {
+                    break;
+                }
+                continue;
+            }
+            // Rounded up, a wait rounded down to 0 would spin until the tick
+            tickMs = (int) ((nextTickNs - now + NSEC_PER_MSEC - 1) / NSEC_PER_MSEC);
+            if (tickMs < timeoutMs) {
+                timeoutMs = tickMs;
+            }
+        }
+
+        rc = poll(&fds, 1, timeoutMs);
+        if (rc <= 0 || !(fds.revents & POLLIN)) {
+            continue;
+        }
+
+        numRead = read(pty->master_fd, buf, sizeof(buf));
+        if (numRead <= 0) {
+            continue;
+        }
+
+        pty->numRx += numRead;
+        if (pty->handler(pty, buf, numRead, pty->context) < 0) {
+            break;
+        }
+    }
+
+    __atomic_store_n(&(pty->running), 0, __ATOMIC_SEQ_CST);
+
+    return NULL;
+
+} // ptyDevThread(void *)
+
+
+/**** Function PtyDevStart ****
+ *
+ * Starts the device thread. The line settings (pacing, latency, corruption,
+ * tick) must be set before this.
+ *
+ * Arguments:
+ *      pty - Pointer to initialized PTY_DEV instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int PtyDevStart(PTY_DEV *pty) {
+
+    int rc;
+
+    if (pty == NULL) {
+        return -1;
+    }
+
+    __atomic_store_n(&(pty->running), 1, __ATOMIC_SEQ_CST);
+    rc = pthread_create(&(pty->thread), NULL, ptyDevThread, pty);
+    if (rc != 0) {
+        logDebug(L_INFO, "%s: PtyDevStart could not create device thread\n", strerror(rc));
+        __atomic_store_n(&(pty->running), 0, __ATOMIC_SEQ_CST);
+        return -2;
+    }
+
+    return 0;
+
+} // PtyDevStart(PTY_DEV *)
+
+
+/**** Function PtyDevWrite ****
+ *
+ * Sends bytes from the device model to the code under test, applying the
+ * configured latency, corruption and pacing. With pacing, consecutive writes
+ * queue behind each other as they would on a real line. Safe to call from
+ * the handler or from any other thread.
+ *
+ * Arguments:
+ *      pty    - Pointer to initialized PTY_DEV instance
+ *      buf    - Bytes to send
+ *      length - Number of bytes to send
+ *
+ * Return value:
+ *      On success, returns number of bytes sent
+ *      On failure, returns a negative number
+ */
+int PtyDevWrite(PTY_DEV *pty, const unsigned char *buf, int length) {
+
+    unsigned char *out;
+    int64_t byteNs, sendNs;
+    int i, groupLen, numWritten, total = 0;
+
+    if (pty == NULL || buf == NULL || length < 0) {
+        return -1;
+    }
+
+    out = malloc(length > 0 ? length : 1);
+    if (out == NULL) {
+        return -2;
+    }
+    memcpy(out, buf, length);
+
+    pthread_mutex_lock(&(pty->writeLock));
+
+    // Flip one random bit in a fraction of the bytes
+    if (pty->corruptRate > 0) {
+        for (i = 0; i < length; i++) {
+            if ((double) rand_r(&(pty->seed)) / RAND_MAX < pty->corruptRate) {
+                out[i] ^= 1 << (rand_r(&(pty->seed)) % 8);
+                pty->numCorrupted++;
+            }
+        }
+    }
+
+    if (pty->latencyNs > 0) {
+        ptyDevSleepUntil(TimeMonotonicNs() + pty->latencyNs);
+    }
+
+    if (pty->baud > 0) {
+
+        // Each group is released when its last byte would have finished
+        byteNs = UARTByteTimeNs(pty->baud);
+        groupLen = PTYDEV_PACE_GROUP_NS / byteNs;
+        if (groupLen < 1) {
+            groupLen = 1;
+        }
+
+        sendNs = TimeMonotonicNs();
+        if (pty->lineFreeNs > sendNs) {
+            sendNs = pty->lineFreeNs;
+        }
+
+        while (total < length) {
+            if (groupLen > length - total) {
+                groupLen = length - total;
+            }
+            sendNs += groupLen * byteNs;
+            ptyDevSleepUntil(sendNs);
+
+            numWritten = write(pty->master_fd, out + total, groupLen);
+            if (numWritten <= 0) {
+                break;
+            }
+            total += numWritten;
+        }
+
+        pty->lineFreeNs = sendNs;
+
+    } else {
+
+        while (total < length) {
+            numWritten = write(pty->master_fd, out + total, length - total);
+            if (numWritten <= 0) {
+                break;
+            }
+            total += numWritten;
+        }
+    }
+
+    pty->numTx += total;
+
+    pthread_mutex_unlock(&(pty->writeLock));
+
+    free(out);
+
+    return total;
+
+} // PtyDevWrite(PTY_DEV *, const unsigned char *, int)
+
+
+/**** Function PtyDevStop ****
+ *
+ * Stops and joins the device thread
+ *
+ * Arguments:
+ *      pty - Pointer to PTY_DEV instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int PtyDevStop(PTY_DEV *pty) {
+
+    if (pty == NULL) {
+        return -1;
+    }
+
+    if (pty->thread != 0) {
+        __atomic_store_n(&(pty->running), 0, __ATOMIC_SEQ_CST);
+        pthread_join(pty->thread, NULL);
+        pty->thread = 0;
+    }
+
+    return 0;
+
+} // PtyDevStop(PTY_DEV *)
+
+
+/**** Function PtyDevClose ****
+ *
+ * Stops the device and closes the pseudoterminal. Any descriptor the code
+ * under test holds for the slave sees a hangup.
+ *
+ * Arguments:
+ *      pty - Pointer to PTY_DEV instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int PtyDevClose(PTY_DEV *pty) {
+
+    if (pty == NULL) {
+        return -1;
+    }
+
+    PtyDevStop(pty);
+
+    close(pty->slave_fd);
+    close(pty->master_fd);
+    pthread_mutex_destroy(&(pty->writeLock));
+
+    return 0;
+
+} // PtyDevClose(PTY_DEV *)
+
+
+/**** Function PtyDevScriptInit ****
+ *
+ * Arguments:
+ *      script     - Pointer to PTYDEV_SCRIPT instance to initialize
+ *      entries    - Request/reply pairs, checked in order
+ *      numEntries - Number of entries
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns a negative number
+ */
+int PtyDevScriptInit(PTYDEV_SCRIPT *script, const PTYDEV_SCRIPT_ENTRY *entries, int numEntries) {
+
+    if (script == NULL || (entries == NULL && numEntries > 0)) {
+        return -1;
+    }
+
+    memset(script, 0, sizeof(PTYDEV_SCRIPT));
+    script->entries = entries;
+    script->numEntries = numEntries;
+
+    return 0;
+
+} // PtyDevScriptInit(PTYDEV_SCRIPT *, const PTYDEV_SCRIPT_ENTRY *, int)
+
+
+/**** Function PtyDevScriptHandler ****
+ *
+ * Device model for line-based protocols. Splits received data into lines
+ * (ending in CR or LF) and answers each with the reply of the first entry
+ * whose match string it starts with. Unmatched lines are counted and ignored.
+ *
+ * Arguments:
+ *      pty     - Device the data arrived on
+ *      data    - Received bytes (NULL on a tick)
+ *      length  - Number of received bytes
+ *      context - Pointer to initialized PTYDEV_SCRIPT instance
+ *
+ * Return value:
+ *      Returns 0
+ */
+int PtyDevScriptHandler(PTY_DEV *pty, const unsigned char *data, int length, void *context) {
+
+    PTYDEV_SCRIPT *script = (PTYDEV_SCRIPT *) context;
+    const PTYDEV_SCRIPT_ENTRY *entry;
+    int i, j;
+
+    for (i = 0; i < length; i++) {
+
+        if (data[i] != '\r' && data[i] != '\n') {
+            if (script->lineLen < PTYDEV_LINE_LEN - 1) {
+                script->line[script->lineLen++] = data[i];
+            }
+            continue;
+        }
+
+        if (script->lineLen == 0) {
+            continue;
+        }
+        script->line[script->lineLen] = '\0';
+
+        for (j = 0; j < script->numEntries; j++) {
+            entry = &(script->entries[j]);
+            if (strncmp(script->line, entry->match, strlen(entry->match)) == 0) {
+                PtyDevWrite(pty, (const unsigned char *) entry->reply, strlen(entry->reply));
+                script->numMatched++;
+                break;
+            }
+        }
+
+        if (j == script->numEntries) {
+            logDebug(L_DEBUG, "Emulated device ignored line: %s\n", script->line);
+            script->numUnmatched++;
+        }
+
+        script->lineLen = 0;
+    }
+
+    return 0;
+
+} // PtyDevScriptHandler(PTY_DEV *, const unsigned char *, int, void *)
@@ -16,6 +16,15 @@
  *      Last edited 03/19/2020
  *      Changed some function interfaces
  *
+ * Revision 0.3
+ *      Last edited 10/18/2026
+ *      Added persistent accept and keepalive configuration for link
+ *      supervision
+ *
+ * Revision 0.4
+ *      Last edited 10/18/2026
+ *      Added kernel receive timestamps
+ *
  ***************************************************************************/
 
 #include <stdio.h>
@@ -26,6 +35,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -33,6 +43,7 @@
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
+#include <linux/net_tstamp.h>
 
 #include "debuglog.h"
 
@@ -254,6 +265,29 @@ int TCPServerTryAccept(int sock_fd) {
 } // TCPServerTryAccept(int)
 
 
+/**** Function TCPServerTryAcceptKeepOpen ****
+ *
+ * Attempts to accept a waiting connection on a listening socket, like
+ * TCPServerTryAccept, but leaves the listening socket open so that a peer that
+ * restarts can connect again without the server being reinitialized.
+ *
+ * Arguments: 
+ *      sock_fd - File descriptor for open and listening TCP server socket
+ *
+ * Return value:
+ *      Returns the value returned by accept(3), with errno set appropriately.
+ */
+int TCPServerTryAcceptKeepOpen(int sock_fd) {
+
+    struct sockaddr_in socketAddress;
+
+    // Accept an incoming connection, listener stays open either way
+    socklen_t sockAddressLength = sizeof(socketAddress);
+    return accept(sock_fd, (struct sockaddr*)&socketAddress, &sockAddressLength);
+
+} // TCPServerTryAcceptKeepOpen(int)
+
+
 /**** Function TCPSetNonBlocking ****
  *
  * Sets an open socket to non-blocking
@@ -276,6 +310,69 @@ int TCPSetNonBlocking(int sock_fd) {
 } // TCPSetNonBlocking(int)
 
 
+/**** Function TCPSetKeepAlive ****
+ *
+ * Enables TCP keepalive probes on a connected socket so that a peer that
+ * disappears without closing the connection (power loss, cable pulled) is
+ * detected by the kernel. Also bounds how long sent data may stay
+ * unacknowledged before the connection is dropped.
+ *
+ * Arguments: 
+ *      sock_fd       - File descriptor for open TCP socket
+ *      idleSec       - Seconds of silence before the first probe is sent
+ *      intervalSec   - Seconds between unanswered probes
+ *      count         - Number of unanswered probes before the peer is dead
+ *      userTimeoutMs - Milliseconds sent data may remain unacknowledged
+ *                      (0 to leave the system default)
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set by setsockopt
+ */
+int TCPSetKeepAlive(int sock_fd, int idleSec, int intervalSec, int count, int userTimeoutMs) {
+
+    int rc, socketOption = 1;
+
+    rc = setsockopt(sock_fd, SOL_SOCKET, SO_KEEPALIVE, &socketOption, sizeof(int));
+    if (rc != 0) {
+        logDebug(L_INFO, "Unable to set socket option SO_KEEPALIVE: %s\n", strerror(errno));
+        return rc;
+    }
+
+    rc = setsockopt(sock_fd, IPPROTO_TCP, TCP_KEEPIDLE, &idleSec, sizeof(int));
+    if (rc != 0) {
+        logDebug(L_INFO, "Unable to set socket option TCP_KEEPIDLE: %s\n", strerror(errno));
+        return rc;
+    }
+
+    rc = setsockopt(sock_fd, IPPROTO_TCP, TCP_KEEPINTVL, &intervalSec, sizeof(int));
+    if (rc != 0) {
+        logDebug(L_INFO, "Unable to set socket option TCP_KEEPINTVL: %s\n", strerror(errno));
+        return rc;
+    }
+
+    rc = setsockopt(sock_fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(int));
+    if (rc != 0) {
+        logDebug(L_INFO, "Unable to set socket option TCP_KEEPCNT: %s\n", strerror(errno));
+        return rc;
+    }
+
+    // Some systems don't have this option, keepalive still works without it
+#ifdef TCP_USER_TIMEOUT
+    if (userTimeoutMs > 0) {
+        rc = setsockopt(sock_fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &userTimeoutMs, sizeof(int));
+        if (rc != 0) {
+            logDebug(L_INFO, "Unable to set socket option TCP_USER_TIMEOUT: %s\n", strerror(errno));
+            return rc;
+        }
+    }
+#endif
+
+    return 0;
+
+} // TCPSetKeepAlive(int, int, int, int, int)
+
+
 /**** Function TCPRead ****
  *
  * Reads from an open and initialized socket file descriptor.
@@ -307,7 +404,7 @@ int TCPRead(int sock_fd, unsigned char *buf, int length) {
     // Attempt to receive a message from TCP socket at most length bytes (nonblocking)
     numRead = recv(sock_fd, buf, length, MSG_DONTWAIT);
     logDebug(L_VVDEBUG, "TCPRead: received %d chars\n", numRead);
-    if (numRead < 0) {
+    if (numRead < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
         logDebug(L_INFO, "%s: TCPRead recv() failed for TCP socket\n", strerror(errno));
     }
 
@@ -317,6 +414,130 @@ int TCPRead(int sock_fd, unsigned char *buf, int length) {
 } // TCPRead(int, unsigned char *, int)
 
 
+/**** Function TCPEnableRxTimestamps ****
+ *
+ * Asks the kernel to timestamp data as it arrives on a socket, so that
+ * TCPReadTimestamped can report when bytes actually came off the wire rather
+ * than when the application got around to reading them. Uses software
+ * SO_TIMESTAMPING where available and falls back to SO_TIMESTAMPNS.
+ *
+ * The kernel turns timestamping on asynchronously the first time any socket
+ * asks for it, so enable it at connection setup rather than just before
+ * the data of interest arrives.
+ *
+ * Arguments: 
+ *      sock_fd - File descriptor for open TCP socket
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set by setsockopt
+ */
+int TCPEnableRxTimestamps(int sock_fd) {
+
+    int rc, socketOption;
+
+    // Software receive timestamps, reported through SCM_TIMESTAMPING
+    socketOption = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+    rc = setsockopt(sock_fd, SOL_SOCKET, SO_TIMESTAMPING, &socketOption, sizeof(int));
+    if (rc == 0) {
+        return 0;
+    }
+
+    // Older kernels, reported through SCM_TIMESTAMPNS
+    socketOption = 1;
+    rc = setsockopt(sock_fd, SOL_SOCKET, SO_TIMESTAMPNS, &socketOption, sizeof(int));
+    if (rc != 0) {
+        logDebug(L_INFO, "Unable to enable socket receive timestamps: %s\n", strerror(errno));
+    }
+
+    return rc;
+
+} // TCPEnableRxTimestamps(int)
+
+
+/**** Function TCPReadTimestamped ****
+ *
+ * Reads from an open and initialized socket file descriptor like TCPRead, and
+ * also returns the kernel receive timestamp of the data. For a stream socket
+ * the timestamp is that of the most recent segment included in the read.
+ *
+ * The timestamp is on CLOCK_REALTIME (the kernel's clock for socket
+ * timestamps). Queueing delay inside the process is the CLOCK_REALTIME time
+ * at processing minus this timestamp.
+ *
+ * Arguments: 
+ *      sock_fd - File descriptor for TCP socket with timestamps enabled
+ *      buf     - Buffer to store data that is read
+ *      length  - Length of room left in the buffer
+ *      ts      - Pointer to timespec to hold the arrival time. Zeroed if the
+ *                kernel did not attach a timestamp (may be NULL)
+ *
+ * Return value:
+ *      Returns number of characters read (may be 0)
+ *      On failure, prints error message and returns a negative number 
+ */
+int TCPReadTimestamped(int sock_fd, unsigned char *buf, int length, struct timespec *ts) {
+
+    int numRead;
+    struct msghdr message;
+    struct iovec dataVector;
+    struct cmsghdr *cmsg;
+
+    // Room for either timestamp control message
+    union {
+        char buf[CMSG_SPACE(3 * sizeof(struct timespec))];
+        struct cmsghdr align;
+    } control;
+
+    // Exit on error if invalid pointer
+    if (buf == NULL) {
+        return -1;
+    }
+
+    if (ts != NULL) {
+        ts->tv_sec = 0;
+        ts->tv_nsec = 0;
+    }
+
+    dataVector.iov_base = buf;
+    dataVector.iov_len = length;
+
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &dataVector;
+    message.msg_iovlen = 1;
+    message.msg_control = control.buf;
+    message.msg_controllen = sizeof(control.buf);
+
+    // Attempt to receive at most length bytes (nonblocking)
+    numRead = recvmsg(sock_fd, &message, MSG_DONTWAIT);
+    logDebug(L_VVDEBUG, "TCPReadTimestamped: received %d chars\n", numRead);
+    if (numRead < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            logDebug(L_INFO, "%s: TCPReadTimestamped recvmsg() failed for TCP socket\n", strerror(errno));
+        }
+        return numRead;
+    }
+
+    // Find the timestamp among the control messages
+    for (cmsg = CMSG_FIRSTHDR(&message); cmsg != NULL && ts != NULL;
+            cmsg = CMSG_NXTHDR(&message, cmsg)) {
+
+        if (cmsg->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+
+        // Software timestamp is the first of the three
+        if (cmsg->cmsg_type == SCM_TIMESTAMPING || cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(ts, CMSG_DATA(cmsg), sizeof(struct timespec));
+        }
+    }
+
+    // Return number of bytes successfully read into buffer
+    return numRead;
+
+} // TCPReadTimestamped(int, unsigned char *, int, struct timespec *)
+
+
 /**** Function TCPWrite ****
  *
  * Sends to an open and initialized socket file descriptor.
@@ -12,6 +12,22 @@
  * Revision 0.1
  *      Last edited 04/10/2020
  *
+ * Revision 0.2
+ *      Added periodic tasks with deadline and jitter statistics
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.3
+ *      Added CPU affinity, pre-faulted stacks, and memory locking
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.4
+ *      Periodic tasks can check in with a watchdog
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.5
+ *      Added priority inheritance mutex and condition variable
+ *      Last edited 10/18/2026
+ *
  ***************************************************************************/
 
 #define _GNU_SOURCE
@@ -24,10 +40,15 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <limits.h>
 #include <pthread.h>
 #include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
 
 #include "debuglog.h"
+#include "timing.h"
+#include "watchdog.h"
 
 #include "thread.h"
 
@@ -116,9 +137,9 @@ int ThreadAttrInit(pthread_attr_t *threadAttr, int inversePriority) {
 
     // Other parameters being left at defaults:
     // For detach state other than default, see pthread_attr_setdetachstate
-    // For CPU affinity (AMP), see pthread_attr_setaffinity_np and CPU_SET
+    // For CPU affinity (AMP), see ThreadAttrSetAffinity
     // For CPU contention scope, see pthread_attr_setscope
-    // For stack attributes, see pthread_attr_setstack
+    // For stack attributes, see ThreadAttrSetStack
 
     // Return success
     return 0;
@@ -126,6 +147,295 @@ int ThreadAttrInit(pthread_attr_t *threadAttr, int inversePriority) {
 } // ThreadAttrInit()
 
 
+/**** Function ThreadAttrSetAffinity ****
+ *
+ * Restricts threads created with these attributes to a set of cores, so a
+ * realtime thread is never migrated mid-cycle
+ *
+ * Arguments:
+ *      threadAttr - Pointer to initialized thread attributes object
+ *      cpuMask    - Cores the thread may run on, see THREAD_CPU
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadAttrSetAffinity(pthread_attr_t *threadAttr, unsigned long cpuMask) {
+
+    int rc, cpu, numCpus;
+    cpu_set_t cpuSet;
+
+    if (threadAttr == NULL || cpuMask == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // pthread_create would fail later on cores that don't exist, so catch
+    // it here where the message is clearer
+    numCpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (numCpus > 0 && numCpus < (int) (8 * sizeof(cpuMask)) &&
+            (cpuMask >> numCpus) != 0) {
+        logDebug(L_INFO, "Affinity mask 0x%lx names cores beyond the %d present\n",
+                cpuMask, numCpus);
+        errno = EINVAL;
+        return -1;
+    }
+
+    CPU_ZERO(&cpuSet);
+    for (cpu = 0; cpu < (int) (8 * sizeof(cpuMask)); cpu++) {
+        if (cpuMask & THREAD_CPU(cpu)) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+
+    rc = pthread_attr_setaffinity_np(threadAttr, sizeof(cpu_set_t), &cpuSet);
+    if (rc != 0) {
+        logDebug(L_INFO, "%s: Failed to set thread affinity\n", strerror(rc));
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadAttrSetAffinity(pthread_attr_t *, unsigned long)
+
+
+/**** Function ThreadAttrSetStack ****
+ *
+ * Gives threads created with these attributes a stack that is allocated and
+ * touched up front, so the thread takes no page faults growing into it.
+ * The stack belongs to the attributes object: create one thread per call
+ * and release it with ThreadAttrFreeStack after that thread is joined.
+ *
+ * Arguments:
+ *      threadAttr - Pointer to initialized thread attributes object
+ *      stackSize  - Stack size in bytes, rounded up to whole pages
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadAttrSetStack(pthread_attr_t *threadAttr, size_t stackSize) {
+
+    int rc;
+    size_t pageSize;
+    void *stack;
+
+    if (threadAttr == NULL || stackSize < PTHREAD_STACK_MIN) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pageSize = sysconf(_SC_PAGESIZE);
+    stackSize = (stackSize + pageSize - 1) / pageSize * pageSize;
+
+    stack = mmap(NULL, stackSize, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED) {
+        logDebug(L_INFO, "%s: Failed to allocate thread stack\n", strerror(errno));
+        return -1;
+    }
+
+    // Write every page so it is backed now rather than on first use
+    memset(stack, 0, stackSize);
+
+    rc = pthread_attr_setstack(threadAttr, stack, stackSize);
+    if (rc != 0) {
+        logDebug(L_INFO, "%s: Failed to set thread stack\n", strerror(rc));
+        munmap(stack, stackSize);
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadAttrSetStack(pthread_attr_t *, size_t)
+
+
+/**** Function ThreadAttrFreeStack ****
+ *
+ * Releases a stack from ThreadAttrSetStack. The thread using it must have
+ * been joined.
+ *
+ * Arguments:
+ *      threadAttr - Pointer to thread attributes object given a stack
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadAttrFreeStack(pthread_attr_t *threadAttr) {
+
+    int rc;
+    void *stack;
+    size_t stackSize;
+
+    if (threadAttr == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    rc = pthread_attr_getstack(threadAttr, &stack, &stackSize);
+    if (rc != 0 || stack == NULL) {
+        errno = (rc != 0) ? rc : EINVAL;
+        return -1;
+    }
+
+    return munmap(stack, stackSize);
+
+} // ThreadAttrFreeStack(pthread_attr_t *)
+
+
+/**** Function ThreadLockMemory ****
+ *
+ * Locks all current and future pages of the process into RAM. Call once at
+ * process start, before threads and buffers are allocated.
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadLockMemory(void) {
+
+    int rc;
+
+    rc = mlockall(MCL_CURRENT | MCL_FUTURE);
+    if (rc != 0) {
+        logDebug(L_INFO, "%s: Failed to lock process memory\n", strerror(errno));
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadLockMemory()
+
+
+/**** Function threadParseCpuList ****
+ *
+ * Parses a kernel CPU list (ex. "1-3,6") into a mask
+ */
+static unsigned long threadParseCpuList(const char *list) {
+
+    unsigned long mask = 0;
+    char *end;
+    long first, last, cpu;
+
+    while (*list != '\0' && *list != '\n') {
+
+        first = strtol(list, &end, 10);
+        if (end == list) {
+            break;
+        }
+        last = first;
+        list = end;
+        if (*list == '-') {
+            list++;
+            last = strtol(list, &end, 10);
+            list = end;
+        }
+
+        for (cpu = first; cpu <= last && cpu < (long) (8 * sizeof(mask)); cpu++) {
+            mask |= THREAD_CPU(cpu);
+        }
+
+        if (*list == ',') {
+            list++;
+        }
+    }
+
+    return mask;
+
+} // threadParseCpuList(const char *)
+
+
+/**** Function threadCheckRoutine ****
+ *
+ * Does nothing, used to test whether realtime threads can be created
+ */
+static void *threadCheckRoutine(void *arg) {
+
+    return arg;
+
+} // threadCheckRoutine(void *)
+
+
+/**** Function ThreadCheckRealtime ****
+ *
+ * Reports anything about the running system that undermines realtime
+ * threads: cores that will be pinned to but are not isolated from the
+ * general scheduler, SCHED_FIFO not being granted, and memory not being
+ * locked. Each problem is logged.
+ *
+ * Arguments:
+ *      cpuMask - Cores realtime threads will be pinned to, or 0 to skip the
+ *                isolation check
+ *
+ * Return value:
+ *      Returns 0 if everything is in place, otherwise some combination of
+ *        the THREAD_RT_* flags
+ */
+int ThreadCheckRealtime(unsigned long cpuMask) {
+
+    int rc, fd, problems = 0;
+    char text[256];
+    unsigned long isolated = 0;
+    long lockedKb = 0;
+    pthread_attr_t threadAttr;
+    pthread_t thread;
+    FILE *status;
+
+    // Cores isolated with isolcpus= on the kernel command line
+    if (cpuMask != 0) {
+        fd = open("/sys/devices/system/cpu/isolated", O_RDONLY);
+        if (fd >= 0) {
+            rc = read(fd, text, sizeof(text) - 1);
+            if (rc > 0) {
+                text[rc] = '\0';
+                isolated = threadParseCpuList(text);
+            }
+            close(fd);
+        }
+        if ((cpuMask & ~isolated) != 0) {
+            logDebug(L_INFO, "Realtime cores 0x%lx are not isolated (isolated: 0x%lx)\n",
+                    cpuMask & ~isolated, isolated);
+            problems |= THREAD_RT_NOT_ISOLATED;
+        }
+    }
+
+    // Lacking privileges, creating a SCHED_FIFO thread fails with EPERM
+    rc = ThreadAttrInit(&threadAttr, 0);
+    if (rc == 0) {
+        rc = pthread_create(&thread, &threadAttr, threadCheckRoutine, NULL);
+        if (rc == 0) {
+            pthread_join(thread, NULL);
+        }
+        pthread_attr_destroy(&threadAttr);
+    }
+    if (rc != 0) {
+        logDebug(L_INFO, "Realtime priority could not be granted\n");
+        problems |= THREAD_RT_NO_PRIORITY;
+    }
+
+    // Locked memory is reported per process in /proc
+    status = fopen("/proc/self/status", "r");
+    if (status != NULL) {
+        while (fgets(text, sizeof(text), status) != NULL) {
+            if (sscanf(text, "VmLck: %ld", &lockedKb) == 1) {
+                break;
+            }
+        }
+        fclose(status);
+    }
+    if (lockedKb == 0) {
+        logDebug(L_INFO, "Process memory is not locked\n");
+        problems |= THREAD_RT_NOT_LOCKED;
+    }
+
+    return problems;
+
+} // ThreadCheckRealtime(unsigned long)
+
+
 /**** Function ThreadCreate ****
  *
  * Initializes thread attributes for realtime scheduling and priority
@@ -198,3 +508,755 @@ int ThreadTryJoin(pthread_t thread, int *threadReturn) {
 
 } // ThreadTryJoin()
 
+
+
+/**** Function ThreadMutexInit ****
+ *
+ * Initializes a mutex with priority inheritance (PTHREAD_PRIO_INHERIT). Use
+ * it for any state shared between threads of different SCHED_FIFO
+ * priorities, otherwise a middle priority thread can hold off a high
+ * priority one indefinitely by starving the low priority owner.
+ *
+ * Does not log, since the debug log itself is guarded by one of these.
+ *
+ * Arguments:
+ *      mutex   - Pointer to THREAD_MUTEX instance to initialize
+ *      name    - Name used when reporting statistics (may be NULL)
+ *      options - THREAD_MUTEX_RECURSIVE and/or THREAD_MUTEX_INSTRUMENT, or 0
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadMutexInit(THREAD_MUTEX *mutex, const char *name, int options) {
+
+    int rc;
+    pthread_mutexattr_t mutexAttr;
+
+    if (mutex == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(mutex, 0, sizeof(THREAD_MUTEX));
+    mutex->name = (name != NULL) ? name : "mutex";
+    mutex->options = options;
+
+    pthread_mutexattr_init(&mutexAttr);
+    rc = pthread_mutexattr_setprotocol(&mutexAttr, PTHREAD_PRIO_INHERIT);
+    if (rc == 0 && (options & THREAD_MUTEX_RECURSIVE)) {
+        rc = pthread_mutexattr_settype(&mutexAttr, PTHREAD_MUTEX_RECURSIVE);
+    }
+    if (rc == 0) {
+        rc = pthread_mutex_init(&(mutex->mutex), &mutexAttr);
+    }
+    pthread_mutexattr_destroy(&mutexAttr);
+
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadMutexInit(THREAD_MUTEX *, const char *, int)
+
+
+/**** Function ThreadMutexLock ****
+ *
+ * Arguments:
+ *      mutex - Pointer to initialized THREAD_MUTEX instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadMutexLock(THREAD_MUTEX *mutex) {
+
+    int rc, contended = 0;
+    int64_t startNs = 0, nowNs;
+
+    if (mutex == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (!(mutex->options & THREAD_MUTEX_INSTRUMENT)) {
+        rc = pthread_mutex_lock(&(mutex->mutex));
+        if (rc != 0) {
+            errno = rc;
+            return -1;
+        }
+        return 0;
+    }
+
+    // Try first so contention can be counted
+    startNs = TimeMonotonicNs();
+    rc = pthread_mutex_trylock(&(mutex->mutex));
+    if (rc == EBUSY) {
+        contended = 1;
+        rc = pthread_mutex_lock(&(mutex->mutex));
+    }
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    // Only the outermost lock of a recursive mutex starts a hold
+    if (mutex->depth++ == 0) {
+        nowNs = TimeMonotonicNs();
+        mutex->lockedAtNs = nowNs;
+        mutex->numLocks++;
+        mutex->numContended += contended;
+        if (nowNs - startNs > mutex->maxWaitNs) {
+            mutex->maxWaitNs = nowNs - startNs;
+        }
+    }
+
+    return 0;
+
+} // ThreadMutexLock(THREAD_MUTEX *)
+
+
+/**** Function threadMutexEndHold ****
+ *
+ * Records how long an instrumented mutex was held, called while still owned
+ */
+static void threadMutexEndHold(THREAD_MUTEX *mutex) {
+
+    int64_t holdNs = TimeMonotonicNs() - mutex->lockedAtNs;
+
+    mutex->totalHoldNs += holdNs;
+    if (holdNs > mutex->maxHoldNs) {
+        mutex->maxHoldNs = holdNs;
+    }
+
+} // threadMutexEndHold(THREAD_MUTEX *)
+
+
+/**** Function ThreadMutexUnlock ****
+ *
+ * Arguments:
+ *      mutex - Pointer to THREAD_MUTEX instance locked by this thread
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadMutexUnlock(THREAD_MUTEX *mutex) {
+
+    int rc;
+
+    if (mutex == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if ((mutex->options & THREAD_MUTEX_INSTRUMENT) && --mutex->depth == 0) {
+        threadMutexEndHold(mutex);
+    }
+
+    rc = pthread_mutex_unlock(&(mutex->mutex));
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadMutexUnlock(THREAD_MUTEX *)
+
+
+/**** Function ThreadMutexDestroy ****
+ *
+ * Arguments:
+ *      mutex - Pointer to unlocked THREAD_MUTEX instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadMutexDestroy(THREAD_MUTEX *mutex) {
+
+    int rc;
+
+    if (mutex == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    rc = pthread_mutex_destroy(&(mutex->mutex));
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadMutexDestroy(THREAD_MUTEX *)
+
+
+/**** Function ThreadMutexReportStats ****
+ *
+ * Logs contention and hold times of an instrumented mutex
+ *
+ * Arguments:
+ *      mutex - Pointer to THREAD_MUTEX instance
+ */
+void ThreadMutexReportStats(THREAD_MUTEX *mutex) {
+
+    if (mutex == NULL || !(mutex->options & THREAD_MUTEX_INSTRUMENT) ||
+            mutex->numLocks == 0) {
+        return;
+    }
+
+    logDebug(L_INFO, "%s: %llu locks, %llu contended, max wait %.3f ms, "
+            "hold mean %.3f ms max %.3f ms\n", mutex->name,
+            (unsigned long long) mutex->numLocks,
+            (unsigned long long) mutex->numContended,
+            (double) mutex->maxWaitNs / NSEC_PER_MSEC,
+            (double) mutex->totalHoldNs / mutex->numLocks / NSEC_PER_MSEC,
+            (double) mutex->maxHoldNs / NSEC_PER_MSEC);
+
+} // ThreadMutexReportStats(THREAD_MUTEX *)
+
+
+/**** Function ThreadCondInit ****
+ *
+ * Initializes a condition variable whose timeouts run on CLOCK_MONOTONIC, so
+ * wall clock steps (ex. from GPS time sync) don't stretch or cut waits
+ *
+ * Arguments:
+ *      cond - Pointer to THREAD_COND instance to initialize
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadCondInit(THREAD_COND *cond) {
+
+    int rc;
+    pthread_condattr_t condAttr;
+
+    if (cond == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_condattr_init(&condAttr);
+    rc = pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    if (rc == 0) {
+        rc = pthread_cond_init(&(cond->cond), &condAttr);
+    }
+    pthread_condattr_destroy(&condAttr);
+
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadCondInit(THREAD_COND *)
+
+
+/**** Function ThreadCondWait ****
+ *
+ * Releases the mutex and waits for a signal, then locks the mutex again.
+ * Wakeups may be spurious, so check the awaited condition in a loop.
+ *
+ * Arguments:
+ *      cond      - Pointer to initialized THREAD_COND instance
+ *      mutex     - Pointer to THREAD_MUTEX locked once by this thread
+ *      timeoutMs - Longest time to wait in milliseconds, or -1 to wait
+ *                  forever
+ *
+ * Return value:
+ *      On wakeup, returns 0
+ *      On timeout, returns -1 and errno is ETIMEDOUT
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadCondWait(THREAD_COND *cond, THREAD_MUTEX *mutex, int timeoutMs) {
+
+    int rc;
+    struct timespec deadline;
+
+    if (cond == NULL || mutex == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // The mutex is released while waiting, which ends the hold
+    if (mutex->options & THREAD_MUTEX_INSTRUMENT) {
+        threadMutexEndHold(mutex);
+    }
+
+    if (timeoutMs < 0) {
+        rc = pthread_cond_wait(&(cond->cond), &(mutex->mutex));
+    } else {
+        TimeNsToTimespec(TimeMonotonicNs() + (int64_t) timeoutMs * NSEC_PER_MSEC, &deadline);
+        rc = pthread_cond_timedwait(&(cond->cond), &(mutex->mutex), &deadline);
+    }
+
+    if (mutex->options & THREAD_MUTEX_INSTRUMENT) {
+        mutex->lockedAtNs = TimeMonotonicNs();
+        mutex->numLocks++;
+    }
+
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadCondWait(THREAD_COND *, THREAD_MUTEX *, int)
+
+
+/**** Function ThreadCondSignal ****
+ *
+ * Arguments:
+ *      cond - Pointer to initialized THREAD_COND instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadCondSignal(THREAD_COND *cond) {
+
+    int rc;
+
+    if (cond == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    rc = pthread_cond_signal(&(cond->cond));
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadCondSignal(THREAD_COND *)
+
+
+/**** Function ThreadCondBroadcast ****
+ *
+ * Arguments:
+ *      cond - Pointer to initialized THREAD_COND instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadCondBroadcast(THREAD_COND *cond) {
+
+    int rc;
+
+    if (cond == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    rc = pthread_cond_broadcast(&(cond->cond));
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadCondBroadcast(THREAD_COND *)
+
+
+/**** Function ThreadCondDestroy ****
+ *
+ * Arguments:
+ *      cond - Pointer to THREAD_COND instance with no waiters
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadCondDestroy(THREAD_COND *cond) {
+
+    int rc;
+
+    if (cond == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    rc = pthread_cond_destroy(&(cond->cond));
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadCondDestroy(THREAD_COND *)
+
+
+/**** Function threadHistogramAdd ****
+ *
+ * Adds one sample to a histogram
+ */
+static void threadHistogramAdd(THREAD_HISTOGRAM *hist, int64_t sampleNs) {
+
+    int64_t us = sampleNs / NSEC_PER_USEC;
+    int bin = 0;
+
+    // Bin is one more than the position of the highest set bit
+    while (us > 0 && bin < THREAD_HIST_BINS - 1) {
+        us >>= 1;
+        bin++;
+    }
+
+    hist->counts[bin]++;
+    if (hist->numSamples == 0 || sampleNs < hist->minNs) {
+        hist->minNs = sampleNs;
+    }
+    if (hist->numSamples == 0 || sampleNs > hist->maxNs) {
+        hist->maxNs = sampleNs;
+    }
+    hist->totalNs += sampleNs;
+    hist->numSamples++;
+
+} // threadHistogramAdd(THREAD_HISTOGRAM *, int64_t)
+
+
+/**** Function ThreadHistogramPercentile ****
+ *
+ * Estimates a percentile from a histogram, to the resolution of its bins
+ *
+ * Arguments:
+ *      hist       - Pointer to histogram
+ *      percentile - Percentile to find (0 to 100)
+ *
+ * Return value:
+ *      Returns the upper edge of the bin holding the percentile in
+ *        nanoseconds (capped at the largest sample), or 0 if empty
+ */
+int64_t ThreadHistogramPercentile(const THREAD_HISTOGRAM *hist, double percentile) {
+
+    uint64_t target, seen = 0;
+    int64_t edgeNs;
+    int bin;
+
+    if (hist == NULL || hist->numSamples == 0) {
+        return 0;
+    }
+
+    target = (uint64_t) (percentile / 100 * hist->numSamples);
+    if (target >= hist->numSamples) {
+        target = hist->numSamples - 1;
+    }
+
+    for (bin = 0; bin < THREAD_HIST_BINS - 1; bin++) {
+        seen += hist->counts[bin];
+        if (seen > target) {
+            break;
+        }
+    }
+
+    edgeNs = ((int64_t) 1 << bin) * NSEC_PER_USEC;
+    if (bin == THREAD_HIST_BINS - 1 || edgeNs > hist->maxNs) {
+        edgeNs = hist->maxNs;
+    }
+
+    return edgeNs;
+
+} // ThreadHistogramPercentile(const THREAD_HISTOGRAM *, double)
+
+
+/**** Function ThreadPeriodicInit ****
+ *
+ * Prepares a task that calls a routine at a fixed rate. Release times are
+ * absolute (period multiples from the start), so time spent in the routine
+ * or waking up late never accumulates into drift.
+ *
+ * Arguments:
+ *      task     - Pointer to PERIODIC_TASK instance to initialize
+ *      name     - Name used in log messages
+ *      periodUs - Period in microseconds
+ *      routine  - Function to call each period with params. Returning a
+ *                 negative number stops the task.
+ *      params   - Passed to routine
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadPeriodicInit(PERIODIC_TASK *task, const char *name, int periodUs, int (*routine)(void *), void *params) {
+
+    if (task == NULL || routine == NULL || periodUs <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(task, 0, sizeof(PERIODIC_TASK));
+    task->watchdogHandle = -1;
+    task->name = (name != NULL) ? name : "periodic";
+    task->routine = routine;
+    task->params = params;
+    task->periodNs = (int64_t) periodUs * NSEC_PER_USEC;
+    task->deadlineNs = task->periodNs;
+
+    ThreadMutexInit(&(task->statsLock), task->name, 0);
+
+    return 0;
+
+} // ThreadPeriodicInit(PERIODIC_TASK *, const char *, int, int (*)(void *), void *)
+
+
+/**** Function ThreadPeriodicSetDeadline ****
+ *
+ * Arguments:
+ *      task       - Pointer to initialized PERIODIC_TASK instance
+ *      deadlineUs - Time after each release by which the routine must finish
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadPeriodicSetDeadline(PERIODIC_TASK *task, int deadlineUs) {
+
+    if (task == NULL || deadlineUs <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    task->deadlineNs = (int64_t) deadlineUs * NSEC_PER_USEC;
+
+    return 0;
+
+} // ThreadPeriodicSetDeadline(PERIODIC_TASK *, int)
+
+
+/**** Function ThreadPeriodicSetWatchdog ****
+ *
+ * Has the task check in with a watchdog after each run. The watchdog entry's
+ * budget is the longest allowed time between runs, so it should allow for
+ * the period plus some jitter.
+ *
+ * Arguments:
+ *      task     - Pointer to initialized PERIODIC_TASK instance
+ *      watchdog - Pointer to initialized WATCHDOG instance
+ *      handle   - Entry registered for this task with WatchdogRegister
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadPeriodicSetWatchdog(PERIODIC_TASK *task, struct WATCHDOG_STRUCT *watchdog, int handle) {
+
+    if (task == NULL || watchdog == NULL || handle < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    task->watchdog = watchdog;
+    task->watchdogHandle = handle;
+
+    return 0;
+
+} // ThreadPeriodicSetWatchdog(PERIODIC_TASK *, struct WATCHDOG_STRUCT *, int)
+
+
+/**** Function threadPeriodicRoutine ****
+ *
+ * Body of a periodic task thread
+ */
+static void *threadPeriodicRoutine(void *arg) {
+
+    PERIODIC_TASK *task = (PERIODIC_TASK *) arg;
+    struct timespec releaseTime;
+    int64_t releaseNs, wakeNs, endNs, behindNs;
+    uint64_t numSkipped;
+    int rc;
+
+    releaseNs = TimeMonotonicNs() + task->periodNs;
+
+    while (task->running) {
+
+        // Sleep until the absolute release time
+        TimeNsToTimespec(releaseNs, &releaseTime);
+        rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &releaseTime, NULL);
+        if (rc == EINTR) {
+            continue;
+        }
+
+        wakeNs = TimeMonotonicNs();
+        rc = task->routine(task->params);
+        endNs = TimeMonotonicNs();
+
+        // Releases that already passed while the routine ran are dropped
+        // rather than run back to back
+        numSkipped = 0;
+        behindNs = endNs - (releaseNs + task->periodNs);
+        if (behindNs >= 0) {
+            numSkipped = behindNs / task->periodNs + 1;
+        }
+
+        ThreadMutexLock(&(task->statsLock));
+        task->stats.numReleases++;
+        threadHistogramAdd(&(task->stats.jitter), wakeNs - releaseNs);
+        threadHistogramAdd(&(task->stats.exec), endNs - wakeNs);
+        if (endNs > releaseNs + task->deadlineNs) {
+            task->stats.numOverruns++;
+        }
+        task->stats.numSkipped += numSkipped;
+        ThreadMutexUnlock(&(task->statsLock));
+
+        if (endNs > releaseNs + task->deadlineNs) {
+            logDebug(L_DEBUG, "%s: Missed deadline by %.3f ms\n", task->name,
+                    (double) (endNs - releaseNs - task->deadlineNs) / NSEC_PER_MSEC);
+        }
+
+        if (task->watchdog != NULL) {
+            WatchdogCheckIn(task->watchdog, task->watchdogHandle);
+        }
+
+        if (rc < 0) {
+            logDebug(L_DEBUG, "%s: Routine returned %d, stopping\n", task->name, rc);
+            break;
+        }
+
+        releaseNs += (numSkipped + 1) * task->periodNs;
+    }
+
+    task->running = 0;
+
+    return NULL;
+
+} // threadPeriodicRoutine(void *)
+
+
+/**** Function ThreadPeriodicStart ****
+ *
+ * Starts the task's thread. The first release is one period from now.
+ *
+ * Arguments:
+ *      task       - Pointer to initialized PERIODIC_TASK instance
+ *      threadAttr - Attributes for the thread (ex. from ThreadAttrInit), or
+ *                   NULL for defaults
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadPeriodicStart(PERIODIC_TASK *task, pthread_attr_t *threadAttr) {
+
+    int rc;
+
+    if (task == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    task->running = 1;
+    rc = ThreadCreate(&(task->thread), threadAttr, threadPeriodicRoutine, task);
+    if (rc != 0) {
+        task->running = 0;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadPeriodicStart(PERIODIC_TASK *, pthread_attr_t *)
+
+
+/**** Function ThreadPeriodicStop ****
+ *
+ * Stops the task after its current period and joins its thread
+ *
+ * Arguments:
+ *      task - Pointer to started PERIODIC_TASK instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadPeriodicStop(PERIODIC_TASK *task) {
+
+    int rc;
+
+    if (task == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    task->running = 0;
+    rc = pthread_join(task->thread, NULL);
+    if (rc != 0) {
+        logDebug(L_INFO, "%s: Failed to join periodic task %s\n", strerror(rc), task->name);
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // ThreadPeriodicStop(PERIODIC_TASK *)
+
+
+/**** Function ThreadPeriodicGetStats ****
+ *
+ * Copies a consistent snapshot of the task's statistics. Safe to call while
+ * the task is running.
+ *
+ * Arguments:
+ *      task  - Pointer to initialized PERIODIC_TASK instance
+ *      stats - Pointer to store the snapshot
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int ThreadPeriodicGetStats(PERIODIC_TASK *task, PERIODIC_STATS *stats) {
+
+    if (task == NULL || stats == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    ThreadMutexLock(&(task->statsLock));
+    memcpy(stats, &(task->stats), sizeof(PERIODIC_STATS));
+    ThreadMutexUnlock(&(task->statsLock));
+
+    return 0;
+
+} // ThreadPeriodicGetStats(PERIODIC_TASK *, PERIODIC_STATS *)
+
+
+/**** Function ThreadPeriodicReportStats ****
+ *
+ * Logs a summary of the task's timing
+ *
+ * Arguments:
+ *      task - Pointer to initialized PERIODIC_TASK instance
+ */
+void ThreadPeriodicReportStats(PERIODIC_TASK *task) {
+
+    PERIODIC_STATS stats;
+
+    if (ThreadPeriodicGetStats(task, &stats) != 0 || stats.numReleases == 0) {
+        return;
+    }
+
+    logDebug(L_INFO, "%s: %llu releases at %.3f ms, %llu overruns, %llu skipped\n",
+            task->name, (unsigned long long) stats.numReleases,
+            (double) task->periodNs / NSEC_PER_MSEC,
+            (unsigned long long) stats.numOverruns,
+            (unsigned long long) stats.numSkipped);
+    logDebug(L_INFO, "%s:   jitter max %.3f ms, 99%% under %.3f ms\n", task->name,
+            (double) stats.jitter.maxNs / NSEC_PER_MSEC,
+            (double) ThreadHistogramPercentile(&(stats.jitter), 99) / NSEC_PER_MSEC);
+    logDebug(L_INFO, "%s:   exec mean %.3f ms, max %.3f ms, 99%% under %.3f ms\n", task->name,
+            (double) stats.exec.totalNs / stats.exec.numSamples / NSEC_PER_MSEC,
+            (double) stats.exec.maxNs / NSEC_PER_MSEC,
+            (double) ThreadHistogramPercentile(&(stats.exec), 99) / NSEC_PER_MSEC);
+
+} // ThreadPeriodicReportStats(PERIODIC_TASK *)
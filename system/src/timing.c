@@ -0,0 +1,87 @@
+/****************************************************************************
+ *
+ * File:
+ *      timing.c
+ *
+ * Description:
+ *      Monotonic clock helpers shared by the system modules. All durations
+ *      are kept as signed 64-bit nanosecond counts so they can be subtracted
+ *      without worrying about timespec carries.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdint.h>
+#include <time.h>
+
+#include "timing.h"
+
+
+/**** Function TimeMonotonicNs ****
+ *
+ * Reads CLOCK_MONOTONIC, which never jumps when the wall clock is adjusted
+ *
+ * Arguments:
+ *      None
+ *
+ * Return value:
+ *      Returns the current monotonic time in nanoseconds
+ */
+int64_t TimeMonotonicNs(void) {
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return TimeTimespecToNs(&ts);
+
+} // TimeMonotonicNs()
+
+
+/**** Function TimeTimespecToNs ****
+ *
+ * Converts a struct timespec into a nanosecond count
+ *
+ * Arguments:
+ *      ts - Pointer to timespec to convert
+ *
+ * Return value:
+ *      Returns the time in nanoseconds (0 if ts is NULL)
+ */
+int64_t TimeTimespecToNs(const struct timespec *ts) {
+
+    if (ts == NULL) {
+        return 0;
+    }
+
+    return ((int64_t) ts->tv_sec) * NSEC_PER_SEC + ts->tv_nsec;
+
+} // TimeTimespecToNs(const struct timespec *)
+
+
+/**** Function TimeNsToTimespec ****
+ *
+ * Converts a nanosecond count into a struct timespec
+ *
+ * Arguments:
+ *      ns - Time in nanoseconds (must not be negative)
+ *      ts - Pointer to timespec to populate
+ *
+ * Return value:
+ *      None
+ */
+void TimeNsToTimespec(int64_t ns, struct timespec *ts) {
+
+    if (ts == NULL) {
+        return;
+    }
+
+    ts->tv_sec = ns / NSEC_PER_SEC;
+    ts->tv_nsec = ns % NSEC_PER_SEC;
+
+} // TimeNsToTimespec(int64_t, struct timespec *)
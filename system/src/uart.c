@@ -28,10 +28,24 @@
  * 	Added access() for permission checking
  * 	Last edited 5/08/2019
  *
+ * Revision 0.6
+ * 	Added all standard baud rates up to 921600 and arbitrary rates
+ * 	through termios2
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.7
+ * 	Added event-driven reader with chunk arrival timestamps
+ * 	Last edited 10/18/2026
+ *
+ * Revision 0.8
+ * 	Raw input with no flow control, so binary data passes unchanged
+ * 	Last edited 10/18/2026
+ *
  ***************************************************************************/
 
 #include "config.h"
 #include "debuglog.h"
+#include "timing.h"
 
 #include "uart.h"
 
@@ -47,6 +61,134 @@
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/epoll.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+
+
+// <asm/termbits.h> conflicts with <termios.h>, so the kernel's termios2 is
+// mirrored here. The TCGETS2/TCSETS2 requests from <sys/ioctl.h> refer to it
+// by this name. Layout matches the generic kernel definition (x86, ARM).
+#if defined(__linux__) && defined(TCGETS2)
+#define UART_HAVE_TERMIOS2
+#define UART_KERNEL_NCCS 19
+#define UART_BOTHER 0010000
+
+struct termios2 {
+    tcflag_t c_iflag;
+    tcflag_t c_oflag;
+    tcflag_t c_cflag;
+    tcflag_t c_lflag;
+    cc_t c_line;
+    cc_t c_cc[UART_KERNEL_NCCS];
+    speed_t c_ispeed;
+    speed_t c_ospeed;
+};
+#endif
+
+// Standard rates with their termios constants
+static const struct {
+    int baud;
+    speed_t speed;
+} uartBaudTable[] = {
+    {1200, B1200},
+    {1800, B1800},
+    {2400, B2400},
+    {4800, B4800},
+    {9600, B9600},
+    {19200, B19200},
+    {38400, B38400},
+    {57600, B57600},
+    {115200, B115200},
+    {230400, B230400},
+#ifdef B460800
+    {460800, B460800},
+#endif
+#ifdef B500000
+    {500000, B500000},
+#endif
+#ifdef B576000
+    {576000, B576000},
+#endif
+#ifdef B921600
+    {921600, B921600},
+#endif
+};
+
+#define UART_NUM_BAUDS ((int) (sizeof(uartBaudTable) / sizeof(uartBaudTable[0])))
+
+
+/**** Function uartStandardSpeed ****
+ *
+ * Looks up the termios constant for a standard baud rate
+ *
+ * Arguments: 
+ * 	baud  - Baud rate in bits per second
+ * 	speed - Pointer to store the termios speed constant
+ *
+ * Return value:
+ * 	Returns 1 if the rate is standard, 0 otherwise
+ */
+static int uartStandardSpeed(int baud, speed_t *speed) {
+
+    int i;
+
+    for (i = 0; i < UART_NUM_BAUDS; i++) {
+        if (uartBaudTable[i].baud == baud) {
+            *speed = uartBaudTable[i].speed;
+            return 1;
+        }
+    }
+
+    return 0;
+
+} // uartStandardSpeed(int, speed_t *)
+
+
+/**** Function uartSetCustomBaud ****
+ *
+ * Sets an arbitrary baud rate using the termios2 interface. Whether the
+ * hardware can actually generate the rate depends on the driver.
+ *
+ * Arguments: 
+ * 	fd   - File descriptor of open UART device
+ * 	baud - Baud rate in bits per second
+ *
+ * Return value:
+ * 	On success, returns 0
+ *	On failure, returns a negative number 
+ */
+static int uartSetCustomBaud(int fd, int baud) {
+
+#ifdef UART_HAVE_TERMIOS2
+    struct termios2 uartOptions2;
+    int rc;
+
+    rc = ioctl(fd, TCGETS2, &uartOptions2);
+    if (rc == -1) {
+        logDebug(L_INFO, "%s: UARTSetBaud TCGETS2 failed for UART device\n", strerror(errno));
+        return rc;
+    }
+
+    uartOptions2.c_cflag &= ~CBAUD;
+    uartOptions2.c_cflag |= UART_BOTHER;
+    uartOptions2.c_ispeed = baud;
+    uartOptions2.c_ospeed = baud;
+
+    rc = ioctl(fd, TCSETS2, &uartOptions2);
+    if (rc == -1) {
+        logDebug(L_INFO, "%s: UARTSetBaud TCSETS2 failed for UART device\n", strerror(errno));
+        return rc;
+    }
+
+    return 0;
+#else
+    logDebug(L_INFO, "Baud rate %d is not standard and termios2 is unavailable\n", baud);
+    return -1;
+#endif
+
+} // uartSetCustomBaud(int, int)
 
 
 /**** Function UARTInit ****
@@ -55,7 +197,7 @@
  *
  * Arguments: 
  * 	devName - String name of the file the UART device is at
- * 	baud    - Requested baud rate (for now must be either 115200 or 57600)
+ * 	baud    - Requested baud rate (see UARTSetBaud)
  *
  * Return value:
  * 	On success, returns file descriptor corresponding to UART device
@@ -86,7 +228,12 @@ int UARTInit(char *devName, int baud) {
     }
 
     // Set baud rate
-    UARTSetBaud(uart_fd, baud);
+    rc = UARTSetBaud(uart_fd, baud);
+    if (rc != 0) {
+        logDebug(L_INFO, "UARTInit could not set baud rate %d\n", baud);
+        close(uart_fd);
+        return -2;
+    }
 
     // Return file descriptor for UART
     return uart_fd;
@@ -100,7 +247,7 @@ int UARTInit(char *devName, int baud) {
  *
  * Arguments: 
  * 	devName - String name of the file the UART device is at
- * 	baud    - Requested baud rate (for now must be either 115200 or 57600)
+ * 	baud    - Requested baud rate (see UARTSetBaud)
  *
  * Return value:
  * 	On success, returns file descriptor corresponding to UART device
@@ -130,7 +277,12 @@ int UARTInitReadOnly(char *devName, int baud) {
     }
 
     // Set baud rate
-    UARTSetBaud(uart_fd, baud);
+    rc = UARTSetBaud(uart_fd, baud);
+    if (rc != 0) {
+        logDebug(L_INFO, "UARTInit could not set baud rate %d\n", baud);
+        close(uart_fd);
+        return -2;
+    }
 
     // Return file descriptor for UART
     return uart_fd;
@@ -138,10 +290,30 @@ int UARTInitReadOnly(char *devName, int baud) {
 } // UARTInitReadOnly(char *, int)
 
 
+/**** Function UARTSetBaud ****
+ *
+ * Configures an open UART device for raw 8N1 data at the requested baud rate.
+ * Standard rates up to 921600 use the termios constants, any other rate is
+ * requested from the driver through termios2.
+ *
+ * Arguments: 
+ * 	fd   - File descriptor of open UART device
+ * 	baud - Requested baud rate
+ *
+ * Return value:
+ * 	On success, returns 0
+ *	On failure, returns a negative number. The device remains open.
+ */
 int UARTSetBaud(int fd, int baud) {
 
     struct termios uartOptions;
-    int rc;
+    speed_t speed;
+    int rc, isStandard;
+
+    if (baud <= 0) {
+        logDebug(L_INFO, "Unexpected baud rate: %d\n", baud);
+        return -3;
+    }
 
     // Get existing device attributes
     rc = tcgetattr(fd, &uartOptions);
@@ -154,40 +326,30 @@ int UARTSetBaud(int fd, int baud) {
     uartOptions.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS);
     uartOptions.c_cflag |= CS8 | CREAD | CLOCAL;
 
-    // Set input options
-    uartOptions.c_iflag &= ~(ICRNL);
-    uartOptions.c_iflag |= IGNPAR | IXON | IXOFF;
+    // Set input options. Binary sensor output carries every byte value, so
+    // nothing may be translated, stripped, or taken as XON/XOFF
+    uartOptions.c_iflag &= ~(ICRNL | INLCR | IGNCR | ISTRIP | IXON | IXOFF | IXANY);
+    uartOptions.c_iflag |= IGNPAR;
 
     // Set output options
     uartOptions.c_oflag &= ~(OPOST | ONLCR);
     uartOptions.c_oflag |= OCRNL;
 
     // Set local options
-    uartOptions.c_lflag &= ~(ISIG | ICANON | ECHO | ECHOE);
+    uartOptions.c_lflag &= ~(ISIG | ICANON | ECHO | ECHOE | IEXTEN);
     uartOptions.c_lflag |= 0;
 
     // Set additional options
     uartOptions.c_cc[VTIME] = 1;
     uartOptions.c_cc[VMIN] = 0;
 
-    // Set baud rate based on input, bare minimum so far supported
-    switch(baud) {
-        case 115200:
-            uartOptions.c_cflag |= B115200;
-            cfsetispeed(&uartOptions, B115200);
-            cfsetospeed(&uartOptions, B115200);
-            break;
-        case 57600:
-            uartOptions.c_cflag |= B57600;
-            cfsetispeed(&uartOptions, B57600);
-            cfsetospeed(&uartOptions, B57600);
-            break;
-        default:
-            logDebug(L_INFO, "Unexpected baud rate: %d. Exiting\n", baud);
-            close(fd);
-            return -3;
-            break;
+    // Nonstandard rates are placed on top of a standard base setting
+    isStandard = uartStandardSpeed(baud, &speed);
+    if (!isStandard) {
+        speed = B38400;
     }
+    cfsetispeed(&uartOptions, speed);
+    cfsetospeed(&uartOptions, speed);
 
     // Push changed options to device (after flushing input and output)
     rc = tcflush(fd, TCIOFLUSH);
@@ -202,8 +364,280 @@ int UARTSetBaud(int fd, int baud) {
         return rc;
     }
 
+    if (!isStandard) {
+        rc = uartSetCustomBaud(fd, baud);
+        if (rc != 0) {
+            return -4;
+        }
+    }
+
+    logDebug(L_DEBUG, "UART baud rate set to %d\n", baud);
+
     return 0;
-}
+
+} // UARTSetBaud(int, int)
+
+
+/**** Function UARTGetBaud ****
+ *
+ * Reads back the output baud rate currently configured on a UART device
+ *
+ * Arguments: 
+ * 	fd - File descriptor of open UART device
+ *
+ * Return value:
+ * 	On success, returns the baud rate in bits per second
+ *	On failure, returns a negative number 
+ */
+int UARTGetBaud(int fd) {
+
+    struct termios uartOptions;
+    speed_t speed;
+    int i;
+
+#ifdef UART_HAVE_TERMIOS2
+    struct termios2 uartOptions2;
+
+    // Reports the exact rate for both standard and custom settings
+    if (ioctl(fd, TCGETS2, &uartOptions2) == 0) {
+        return uartOptions2.c_ospeed;
+    }
+#endif
+
+    if (tcgetattr(fd, &uartOptions) == -1) {
+        return -1;
+    }
+
+    speed = cfgetospeed(&uartOptions);
+    for (i = 0; i < UART_NUM_BAUDS; i++) {
+        if (uartBaudTable[i].speed == speed) {
+            return uartBaudTable[i].baud;
+        }
+    }
+
+    return -2;
+
+} // UARTGetBaud(int)
+
+
+/**** Function UARTSetLowLatency ****
+ *
+ * Asks the serial driver to push received bytes to the tty layer
+ * immediately rather than on its flush timer (ASYNC_LOW_LATENCY). Devices
+ * without serial driver support (USB adapters without it, pseudoterminals)
+ * are left unchanged.
+ *
+ * Arguments: 
+ * 	fd - File descriptor of open UART device
+ *
+ * Return value:
+ * 	On success, returns 0
+ *	If unsupported by the device, returns a negative number 
+ */
+int UARTSetLowLatency(int fd) {
+
+#if defined(__linux__) && defined(ASYNC_LOW_LATENCY)
+    struct serial_struct serial;
+    int rc;
+
+    rc = ioctl(fd, TIOCGSERIAL, &serial);
+    if (rc == -1) {
+        logDebug(L_DEBUG, "%s: UART device does not support low latency mode\n", strerror(errno));
+        return rc;
+    }
+
+    serial.flags |= ASYNC_LOW_LATENCY;
+
+    rc = ioctl(fd, TIOCSSERIAL, &serial);
+    if (rc == -1) {
+        logDebug(L_DEBUG, "%s: Could not set UART low latency mode\n", strerror(errno));
+        return rc;
+    }
+
+    return 0;
+#else
+    return -1;
+#endif
+
+} // UARTSetLowLatency(int)
+
+
+/**** Function UARTReaderInit ****
+ *
+ * Switches an open UART device to event-driven reading. The device is made
+ * nonblocking with VTIME disabled, and VMIN set so that a wakeup happens
+ * once about one packet's worth of bytes is waiting rather than on a
+ * 100 ms timer. Anything shorter than VMIN is still picked up when
+ * UARTReaderRead times out.
+ *
+ * Arguments: 
+ * 	reader - Pointer to UART_READER instance to initialize
+ * 	fd     - File descriptor of open and configured UART device
+ * 	baud   - Baud rate the device is configured for
+ * 	vmin   - Bytes to wait for before waking (1 to 255)
+ *
+ * Return value:
+ * 	On success, returns 0
+ *	On failure, returns a negative number 
+ */
+int UARTReaderInit(UART_READER *reader, int fd, int baud, int vmin) {
+
+    struct termios uartOptions;
+    struct epoll_event event;
+    int rc;
+
+    if (reader == NULL || baud <= 0) {
+        return -1;
+    }
+
+    if (vmin < 1) {
+        vmin = 1;
+    } else if (vmin > 255) {
+        vmin = 255;
+    }
+
+    memset(reader, 0, sizeof(UART_READER));
+    reader->fd = fd;
+    reader->baud = baud;
+
+    rc = tcgetattr(fd, &uartOptions);
+    if (rc == -1) {
+        logDebug(L_INFO, "%s: UARTReaderInit tcgetattr() failed for UART device\n", strerror(errno));
+        return -2;
+    }
+
+    uartOptions.c_cc[VMIN] = vmin;
+    uartOptions.c_cc[VTIME] = 0;
+
+    rc = tcsetattr(fd, TCSANOW, &uartOptions);
+    if (rc == -1) {
+        logDebug(L_INFO, "%s: UARTReaderInit tcsetattr() failed for UART device\n", strerror(errno));
+        return -3;
+    }
+
+    // Reads only happen after a wakeup, but must never block
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    UARTSetLowLatency(fd);
+
+    reader->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (reader->epoll_fd == -1) {
+        logDebug(L_INFO, "%s: UARTReaderInit epoll_create1() failed\n", strerror(errno));
+        return -4;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    rc = epoll_ctl(reader->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    if (rc == -1) {
+        logDebug(L_INFO, "%s: UARTReaderInit epoll_ctl() failed\n", strerror(errno));
+        close(reader->epoll_fd);
+        return -5;
+    }
+
+    return 0;
+
+} // UARTReaderInit(UART_READER *, int, int, int)
+
+
+/**** Function UARTReaderRead ****
+ *
+ * Waits until the UART has data or the timeout expires, then reads whatever
+ * is available. The chunk is stamped with CLOCK_MONOTONIC immediately after
+ * the read, which bounds the arrival time of its last byte. Earlier bytes in
+ * the chunk arrived one character time (see UARTByteTimeNs) apart before it.
+ *
+ * Arguments: 
+ * 	reader    - Pointer to initialized UART_READER instance
+ * 	buf       - Buffer to store data that is read
+ * 	length    - Length of room left in the buffer
+ * 	timeoutMs - Milliseconds to wait (0 to only read what is waiting)
+ * 	timeNs    - Pointer to store the chunk timestamp (may be NULL)
+ *
+ * Return value:
+ *	Returns number of characters read (may be 0)
+ *	On failure, returns a negative number 
+ */
+int UARTReaderRead(UART_READER *reader, unsigned char *buf, int length, int timeoutMs, int64_t *timeNs) {
+
+    struct epoll_event event;
+    int numRead;
+
+    if (reader == NULL || buf == NULL) {
+        return -1;
+    }
+
+    if (timeoutMs != 0) {
+        if (epoll_wait(reader->epoll_fd, &event, 1, timeoutMs) > 0) {
+            reader->numWakeups++;
+        }
+    }
+
+    // Read even on timeout, to collect a partial packet shorter than VMIN
+    numRead = read(reader->fd, buf, length);
+    if (numRead < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        logDebug(L_INFO, "%s: UARTReaderRead read() failed for UART device\n", strerror(errno));
+        return numRead;
+    }
+
+    if (timeNs != NULL) {
+        *timeNs = TimeMonotonicNs();
+    }
+
+    reader->numBytes += numRead;
+    if (numRead > 0) {
+        reader->numChunks++;
+    }
+
+    return numRead;
+
+} // UARTReaderRead(UART_READER *, unsigned char *, int, int, int64_t *)
+
+
+/**** Function UARTReaderClose ****
+ *
+ * Stops event-driven reading. The UART device itself stays open.
+ *
+ * Arguments: 
+ * 	reader - Pointer to UART_READER instance
+ *
+ * Return value:
+ * 	On success, returns 0
+ *	On failure, returns a negative number 
+ */
+int UARTReaderClose(UART_READER *reader) {
+
+    if (reader == NULL) {
+        return -1;
+    }
+
+    return close(reader->epoll_fd);
+
+} // UARTReaderClose(UART_READER *)
+
+
+/**** Function UARTByteTimeNs ****
+ *
+ * Arguments: 
+ * 	baud - Baud rate of the device
+ *
+ * Return value:
+ * 	Returns the time to transmit one 8N1 character (10 bits) in nanoseconds
+ */
+int64_t UARTByteTimeNs(int baud) {
+
+    if (baud <= 0) {
+        return 0;
+    }
+
+    return (int64_t) UART_BITS_PER_CHAR * NSEC_PER_SEC / baud;
+
+} // UARTByteTimeNs(int)
+
 
 /**** Function UARTRead ****
  *
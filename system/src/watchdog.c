@@ -0,0 +1,352 @@
+/****************************************************************************
+ *
+ * File:
+ *      watchdog.c
+ *
+ * Description:
+ *      Watchdog for periodic threads. Each monitored thread declares a
+ *      budget, the longest it may go between check-ins, and checks in once
+ *      per cycle. Check-ins record the gap since the previous one, so late
+ *      cycles and the worst cycle are counted. A separate high priority
+ *      thread catches threads that stop checking in altogether and takes the
+ *      configured action.
+ *
+ *      Checking in takes no locks, so it is safe from SCHED_FIFO threads.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "debuglog.h"
+#include "thread.h"
+#include "timing.h"
+
+#include "watchdog.h"
+
+
+/**** Function WatchdogInit ****
+ *
+ * Arguments:
+ *      watchdog      - Pointer to WATCHDOG instance to initialize
+ *      checkPeriodUs - How often the watchdog thread looks for stalled
+ *                      threads, should be well under the smallest budget
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int WatchdogInit(WATCHDOG *watchdog, int checkPeriodUs) {
+
+    if (watchdog == NULL || checkPeriodUs <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(watchdog, 0, sizeof(WATCHDOG));
+    watchdog->checkPeriodNs = (int64_t) checkPeriodUs * NSEC_PER_USEC;
+    pthread_mutex_init(&(watchdog->registerLock), NULL);
+
+    return 0;
+
+} // WatchdogInit(WATCHDOG *, int)
+
+
+/**** Function WatchdogRegister ****
+ *
+ * Adds a thread to monitor. Monitoring begins with its first check-in.
+ *
+ * Arguments:
+ *      watchdog - Pointer to initialized WATCHDOG instance
+ *      name     - Name used in log messages
+ *      budgetUs - Longest allowed time between check-ins
+ *      action   - What to do when the thread exceeds its budget
+ *      handler  - Called for WATCHDOG_ACTION_STOP and _RESTART (may be
+ *                 NULL for WATCHDOG_ACTION_LOG)
+ *      params   - Passed to handler
+ *
+ * Return value:
+ *      On success, returns the handle to check in with
+ *      On failure, returns -1 and errno is set
+ */
+int WatchdogRegister(WATCHDOG *watchdog, const char *name, int budgetUs,
+        WATCHDOG_ACTION action, WATCHDOG_HANDLER handler, void *params) {
+
+    WATCHDOG_ENTRY *entry;
+    int handle;
+
+    if (watchdog == NULL || budgetUs <= 0 ||
+            (action != WATCHDOG_ACTION_LOG && handler == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_mutex_lock(&(watchdog->registerLock));
+
+    handle = watchdog->numEntries;
+    if (handle >= WATCHDOG_MAX_ENTRIES) {
+        pthread_mutex_unlock(&(watchdog->registerLock));
+        logDebug(L_INFO, "Watchdog: No room to monitor %s\n", name);
+        errno = ENOSPC;
+        return -1;
+    }
+
+    entry = &(watchdog->entries[handle]);
+    memset(entry, 0, sizeof(WATCHDOG_ENTRY));
+    entry->name = (name != NULL) ? name : "thread";
+    entry->budgetNs = (int64_t) budgetUs * NSEC_PER_USEC;
+    entry->action = action;
+    entry->handler = handler;
+    entry->params = params;
+
+    // Publish the entry to the watchdog thread only once it is filled in
+    __atomic_store_n(&(watchdog->numEntries), handle + 1, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&(watchdog->registerLock));
+
+    return handle;
+
+} // WatchdogRegister(WATCHDOG *, const char *, int, WATCHDOG_ACTION, WATCHDOG_HANDLER, void *)
+
+
+/**** Function WatchdogCheckIn ****
+ *
+ * Called by a monitored thread once per cycle. Only that thread may check in
+ * for its handle.
+ *
+ * Arguments:
+ *      watchdog - Pointer to initialized WATCHDOG instance
+ *      handle   - Value returned by WatchdogRegister
+ *
+ * Return value:
+ *      Returns 1 if the check-in was later than the budget, 0 if on time
+ *      On failure, returns -1 and errno is set
+ */
+int WatchdogCheckIn(WATCHDOG *watchdog, int handle) {
+
+    WATCHDOG_ENTRY *entry;
+    int64_t nowNs, lastNs, gapNs;
+    int late = 0;
+
+    if (watchdog == NULL || handle < 0 || handle >= watchdog->numEntries) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    entry = &(watchdog->entries[handle]);
+    nowNs = TimeMonotonicNs();
+    lastNs = __atomic_exchange_n(&(entry->lastCheckInNs), nowNs, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&(entry->stalled), 0, __ATOMIC_RELEASE);
+    entry->numCheckIns++;
+
+    // First check-in only starts the clock
+    if (lastNs == 0) {
+        return 0;
+    }
+
+    gapNs = nowNs - lastNs;
+    if (gapNs > entry->worstGapNs) {
+        entry->worstGapNs = gapNs;
+    }
+    if (gapNs > entry->budgetNs) {
+        entry->numMisses++;
+        late = 1;
+    }
+
+    return late;
+
+} // WatchdogCheckIn(WATCHDOG *, int)
+
+
+/**** Function watchdogScan ****
+ *
+ * Looks for threads past their budget and acts on each one once per stall
+ */
+static void watchdogScan(WATCHDOG *watchdog) {
+
+    WATCHDOG_ENTRY *entry;
+    int64_t nowNs, lastNs;
+    int i, numEntries;
+
+    numEntries = __atomic_load_n(&(watchdog->numEntries), __ATOMIC_ACQUIRE);
+    nowNs = TimeMonotonicNs();
+
+    for (i = 0; i < numEntries; i++) {
+
+        entry = &(watchdog->entries[i]);
+        lastNs = __atomic_load_n(&(entry->lastCheckInNs), __ATOMIC_ACQUIRE);
+        if (lastNs == 0 || entry->stalled || nowNs - lastNs <= entry->budgetNs) {
+            continue;
+        }
+
+        // Skip if the thread checked in since lastNs was read
+        __atomic_store_n(&(entry->stalled), 1, __ATOMIC_RELEASE);
+        if (__atomic_load_n(&(entry->lastCheckInNs), __ATOMIC_ACQUIRE) != lastNs) {
+            __atomic_store_n(&(entry->stalled), 0, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        entry->numStalls++;
+        logDebug(L_INFO, "Watchdog: %s has not checked in for %.3f ms (budget %.3f ms, worst cycle %.3f ms)\n",
+                entry->name, (double) (nowNs - lastNs) / NSEC_PER_MSEC,
+                (double) entry->budgetNs / NSEC_PER_MSEC,
+                (double) entry->worstGapNs / NSEC_PER_MSEC);
+
+        switch (entry->action) {
+            case WATCHDOG_ACTION_STOP:
+                logDebug(L_INFO, "Watchdog: Stopping on account of %s\n", entry->name);
+                entry->handler(watchdog, i, entry->params);
+                break;
+            case WATCHDOG_ACTION_RESTART:
+                logDebug(L_INFO, "Watchdog: Restarting %s\n", entry->name);
+                entry->handler(watchdog, i, entry->params);
+                // Monitoring resumes with the restarted thread's first
+                // check-in
+                __atomic_store_n(&(entry->lastCheckInNs), 0, __ATOMIC_RELEASE);
+                __atomic_store_n(&(entry->stalled), 0, __ATOMIC_RELEASE);
+                break;
+            case WATCHDOG_ACTION_LOG:
+            default:
+                break;
+        }
+    }
+
+} // watchdogScan(WATCHDOG *)
+
+
+/**** Function watchdogRoutine ****
+ *
+ * Body of the watchdog thread
+ */
+static void *watchdogRoutine(void *arg) {
+
+    WATCHDOG *watchdog = (WATCHDOG *) arg;
+    struct timespec wakeTime;
+    int64_t wakeNs = TimeMonotonicNs();
+
+    while (watchdog->running) {
+
+        wakeNs += watchdog->checkPeriodNs;
+        TimeNsToTimespec(wakeNs, &wakeTime);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTime, NULL);
+
+        watchdogScan(watchdog);
+    }
+
+    return NULL;
+
+} // watchdogRoutine(void *)
+
+
+/**** Function WatchdogStart ****
+ *
+ * Starts the watchdog thread at the highest realtime priority, so it runs
+ * even when a monitored SCHED_FIFO thread is spinning. Falls back to normal
+ * scheduling without realtime privileges.
+ *
+ * Arguments:
+ *      watchdog - Pointer to initialized WATCHDOG instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int WatchdogStart(WATCHDOG *watchdog) {
+
+    pthread_attr_t threadAttr;
+    int rc = -1;
+
+    if (watchdog == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    watchdog->running = 1;
+
+    if (ThreadAttrInit(&threadAttr, 0) == 0) {
+        rc = pthread_create(&(watchdog->thread), &threadAttr, watchdogRoutine, watchdog);
+        pthread_attr_destroy(&threadAttr);
+    }
+    if (rc != 0) {
+        logDebug(L_INFO, "Watchdog: Running without realtime priority\n");
+        rc = ThreadCreate(&(watchdog->thread), NULL, watchdogRoutine, watchdog);
+        if (rc != 0) {
+            watchdog->running = 0;
+            return -1;
+        }
+    }
+
+    return 0;
+
+} // WatchdogStart(WATCHDOG *)
+
+
+/**** Function WatchdogStop ****
+ *
+ * Arguments:
+ *      watchdog - Pointer to started WATCHDOG instance
+ *
+ * Return value:
+ *      On success, returns 0
+ *      On failure, returns -1 and errno is set
+ */
+int WatchdogStop(WATCHDOG *watchdog) {
+
+    int rc;
+
+    if (watchdog == NULL || !watchdog->running) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    watchdog->running = 0;
+    rc = pthread_join(watchdog->thread, NULL);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    return 0;
+
+} // WatchdogStop(WATCHDOG *)
+
+
+/**** Function WatchdogReportStats ****
+ *
+ * Logs each monitored thread's worst cycle against its budget
+ *
+ * Arguments:
+ *      watchdog - Pointer to initialized WATCHDOG instance
+ */
+void WatchdogReportStats(WATCHDOG *watchdog) {
+
+    WATCHDOG_ENTRY *entry;
+    int i;
+
+    if (watchdog == NULL) {
+        return;
+    }
+
+    for (i = 0; i < watchdog->numEntries; i++) {
+        entry = &(watchdog->entries[i]);
+        logDebug(L_INFO, "Watchdog: %s: %llu check-ins, %llu late, %llu stalls, worst cycle %.3f ms of %.3f ms budget\n",
+                entry->name, (unsigned long long) entry->numCheckIns,
+                (unsigned long long) entry->numMisses,
+                (unsigned long long) entry->numStalls,
+                (double) entry->worstGapNs / NSEC_PER_MSEC,
+                (double) entry->budgetNs / NSEC_PER_MSEC);
+    }
+
+} // WatchdogReportStats(WATCHDOG *)
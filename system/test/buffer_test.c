@@ -228,6 +228,43 @@ Ensure(Buffer, add_many_and_empty_a_lot) {
     }
 }
 
+Ensure(Buffer, segments_split_at_the_wrap) {
+    BYTE_BUFFER buf;
+    BufferEmpty(&buf);
+    unsigned char data[100], *segment;
+    int i, rc;
+    for (i = 0; i < 100; i++) {
+        data[i] = (unsigned char) i;
+    }
+
+    // Start 40 elements short of the end of the storage
+    buf.start = buf.end = BYTE_BUFFER_LEN - 40;
+    BufferAddArray(&buf, data, 100);
+
+    // Within the first segment the run is read in place
+    rc = BufferSegment(&buf, 10, 20, &segment);
+    assert_that(rc, is_equal_to(20));
+    assert_that(segment, is_equal_to(&(buf.buffer[BYTE_BUFFER_LEN - 30])));
+    assert_that(segment[0], is_equal_to(10));
+
+    // Across the wrap it comes in two pieces
+    rc = BufferSegment(&buf, 30, 50, &segment);
+    assert_that(rc, is_equal_to(10));
+    assert_that(segment[9], is_equal_to(39));
+    rc = BufferSegment(&buf, 30 + rc, 40, &segment);
+    assert_that(rc, is_equal_to(40));
+    assert_that(segment, is_equal_to(&(buf.buffer[0])));
+    assert_that(segment[0], is_equal_to(40));
+
+    // Limited to what the buffer holds
+    rc = BufferSegment(&buf, 90, 50, &segment);
+    assert_that(rc, is_equal_to(10));
+    rc = BufferSegment(&buf, 100, 1, &segment);
+    assert_that(rc, is_equal_to(0));
+    rc = BufferSegment(&buf, -1, 1, &segment);
+    assert_that(rc, is_equal_to(0));
+}
+
 Ensure(Buffer, complete_wringer) {
     BYTE_BUFFER buf;
     BufferEmpty(&buf);
@@ -397,6 +434,9 @@ Ensure(Buffer, catches_invalid_accesses) {
     rc = BufferCopy(NULL, NULL, 0, 0);
     assert_that(rc, is_equal_to(-1));
 
+    rc = BufferSegment(NULL, 0, 0, NULL);
+    assert_that(rc, is_equal_to(-1));
+
     // Bounds rejection
     rc = BufferAddArray(&buf, data, BYTE_BUFFER_MAX_LEN);
     assert_that(rc, is_equal_to(BYTE_BUFFER_MAX_LEN));
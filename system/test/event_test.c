@@ -0,0 +1,238 @@
+/****************************************************************************
+ *
+ * File:
+ *      event_test.c
+ *
+ * Description:
+ *      CGreen test suite for eventfd based wakeups (event.c)
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.2
+ *      Last edited 10/18/2026
+ *      Wait interrupted by a signal, latency benchmark report-only
+ *
+ ***************************************************************************/
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+
+#include "config.h"
+
+#include "event.h"
+#include "thread.h"
+#include "timing.h"
+
+#define NUM_HANDOFFS 200
+
+static EVENT event;
+
+Describe(Event);
+
+BeforeEach(Event) {
+    EventInit(&event);
+}
+
+AfterEach(Event) {
+    EventClose(&event);
+}
+
+Ensure(Event, signals_collapse_into_one_wakeup) {
+
+    assert_that(EventWait(&event, 0), is_equal_to(0));
+    assert_that(event.numTimeouts, is_equal_to(1));
+
+    EventSignal(&event);
+    EventSignal(&event);
+    EventSignal(&event);
+    assert_that(EventWait(&event, 100), is_equal_to(3));
+    assert_that(EventWait(&event, 0), is_equal_to(0));
+    assert_that(event.numSignals, is_equal_to(3));
+    assert_that(event.numWakeups, is_equal_to(1));
+
+}
+
+Ensure(Event, wait_times_out) {
+
+    int64_t startNs = TimeMonotonicNs();
+
+    assert_that(EventWait(&event, 30), is_equal_to(0));
+    assert_that(TimeMonotonicNs() - startNs, is_greater_than(30 * NSEC_PER_MSEC - 1));
+
+}
+
+Ensure(Event, fd_works_with_poll) {
+
+    struct pollfd pfd = {EventFd(&event), POLLIN, 0};
+
+    assert_that(poll(&pfd, 1, 0), is_equal_to(0));
+    EventSignal(&event);
+    assert_that(poll(&pfd, 1, 0), is_equal_to(1));
+
+    // Waiting clears it
+    assert_that(EventWait(&event, 0), is_equal_to(1));
+    assert_that(poll(&pfd, 1, 0), is_equal_to(0));
+
+}
+
+static volatile sig_atomic_t numSignals;
+
+static void countSignal(int signum) {
+
+    numSignals++;
+
+}
+
+static void *interruptedWaiter(void *arg) {
+
+    *(int *) arg = EventWait(&event, 2000);
+
+    return NULL;
+
+}
+
+Ensure(Event, wait_resumes_after_signal) {
+
+    struct sigaction action, oldAction;
+    pthread_t thread;
+    int result = -2;
+
+    // No SA_RESTART, so the signal interrupts the wait with EINTR
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = countSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, &oldAction);
+    numSignals = 0;
+
+    pthread_create(&thread, NULL, interruptedWaiter, &result);
+    usleep(20000);
+    pthread_kill(thread, SIGUSR1);
+    usleep(20000);
+
+    // Still waiting after the signal, and woken by the event
+    assert_that(result, is_equal_to(-2));
+    EventSignal(&event);
+    pthread_join(thread, NULL);
+    sigaction(SIGUSR1, &oldAction, NULL);
+
+    assert_that(numSignals, is_equal_to(1));
+    assert_that(result, is_equal_to(1));
+    assert_that(event.numTimeouts, is_equal_to(0));
+
+}
+
+Ensure(Event, close_rejects_twice) {
+
+    EVENT other;
+
+    assert_that(EventInit(&other), is_equal_to(0));
+    assert_that(EventClose(&other), is_equal_to(0));
+    assert_that(EventClose(&other), is_equal_to(-1));
+
+}
+
+// Producer stamps the time it published, consumer measures how long it took
+// to notice, either sleeping on the event or polling a flag
+static volatile int64_t publishNs;
+static volatile int published;
+static volatile int pollPeriodUs;
+static int64_t latencyNs[NUM_HANDOFFS];
+
+static void *eventConsumer(void *arg) {
+
+    int i;
+
+    for (i = 0; i < NUM_HANDOFFS; i++) {
+        EventWait(&event, -1);
+        latencyNs[i] = TimeMonotonicNs() - publishNs;
+        __atomic_store_n(&published, 0, __ATOMIC_SEQ_CST);
+    }
+
+    return NULL;
+
+}
+
+static void *pollingConsumer(void *arg) {
+
+    int i;
+
+    for (i = 0; i < NUM_HANDOFFS; i++) {
+        while (!__atomic_load_n(&published, __ATOMIC_SEQ_CST)) {
+            usleep(pollPeriodUs);
+        }
+        latencyNs[i] = TimeMonotonicNs() - publishNs;
+        __atomic_store_n(&published, 0, __ATOMIC_SEQ_CST);
+    }
+
+    return NULL;
+
+}
+
+// Runs NUM_HANDOFFS publishes against a consumer, spaced so each one finds
+// the consumer idle, returns the mean latency and sets the max
+static int64_t measureHandoffs(void *(*consumer)(void *), int useEvent, int64_t *maxNs) {
+
+    pthread_t thread;
+    pthread_attr_t threadAttr;
+    int64_t totalNs = 0;
+    int i;
+
+    published = 0;
+    ThreadAttrInit(&threadAttr, 0);
+    pthread_create(&thread, &threadAttr, consumer, NULL);
+
+    for (i = 0; i < NUM_HANDOFFS; i++) {
+        usleep(2000);
+        publishNs = TimeMonotonicNs();
+        __atomic_store_n(&published, 1, __ATOMIC_SEQ_CST);
+        if (useEvent) {
+            EventSignal(&event);
+        }
+        while (__atomic_load_n(&published, __ATOMIC_SEQ_CST)) {
+            usleep(100);
+        }
+    }
+
+    pthread_join(thread, NULL);
+
+    *maxNs = 0;
+    for (i = 0; i < NUM_HANDOFFS; i++) {
+        totalNs += latencyNs[i];
+        if (latencyNs[i] > *maxNs) {
+            *maxNs = latencyNs[i];
+        }
+    }
+
+    return totalNs / NUM_HANDOFFS;
+
+}
+
+Ensure(Event, bench_wake_latency_versus_polling) {
+
+    int64_t eventMeanNs, eventMaxNs, pollMeanNs, pollMaxNs;
+
+    eventMeanNs = measureHandoffs(eventConsumer, 1, &eventMaxNs);
+
+    pollPeriodUs = 1000;
+    pollMeanNs = measureHandoffs(pollingConsumer, 0, &pollMaxNs);
+
+    printf("BENCH event wake latency: mean %.1f us, max %.1f us\n",
+            (double) eventMeanNs / NSEC_PER_USEC, (double) eventMaxNs / NSEC_PER_USEC);
+    printf("BENCH 1 ms polling latency: mean %.1f us, max %.1f us\n",
+            (double) pollMeanNs / NSEC_PER_USEC, (double) pollMaxNs / NSEC_PER_USEC);
+
+    // Timing is reported, not asserted, it depends on the machine
+    assert_that(eventMeanNs, is_greater_than(0));
+    assert_that(pollMeanNs, is_greater_than(0));
+
+}
@@ -0,0 +1,208 @@
+/****************************************************************************
+ *
+ * File:
+ *      linktest.c
+ *
+ * Description:
+ *      CGreen test suite for the link supervisor module (link.c)
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "timing.h"
+
+#include "link.h"
+
+#define IP_ADDR     "127.0.0.1"
+#define LINK_PORT   GUIDANCE_TCP_PORT
+
+// Upper bound on reconnection for a peer that restarts on loopback
+#define MAX_RECOVERY_MS 500
+
+LINK client, server;
+
+// Name of test context
+Describe(Link);
+
+// Execute in the context immediately before each "Ensure" test
+BeforeEach(Link) {
+}
+
+// Execute after each test
+AfterEach(Link) {
+
+    LinkClose(&client);
+    LinkClose(&server);
+
+}
+
+
+/**** Function service_until_up
+ *
+ * Services both ends of the link until they are connected or the timeout
+ * expires. Returns the time taken in milliseconds, or -1 on timeout.
+ *
+ ****/
+int service_until_up(LINK *a, LINK *b, int timeoutMs) {
+
+    int64_t start = TimeMonotonicNs();
+    int64_t elapsed;
+
+    do {
+        LinkService(a);
+        LinkService(b);
+        if (LinkIsUp(a) && LinkIsUp(b)) {
+            return (int) ((TimeMonotonicNs() - start) / NSEC_PER_MSEC);
+        }
+        usleep(1000);
+        elapsed = TimeMonotonicNs() - start;
+    } while (elapsed < timeoutMs * NSEC_PER_MSEC);
+
+    return -1;
+
+}
+
+
+/**** Start test suite ****/
+
+Ensure(Link, rejects_invalid_arguments) {
+
+    assert_that(LinkInit(NULL, "x", LINK_ROLE_CLIENT, IP_ADDR, LINK_PORT), is_less_than(0));
+    assert_that(LinkInit(&client, "x", LINK_ROLE_CLIENT, NULL, LINK_PORT), is_less_than(0));
+    assert_that(LinkInit(&client, "x", 7, IP_ADDR, LINK_PORT), is_less_than(0));
+    assert_that(LinkService(NULL), is_less_than(0));
+    assert_that(LinkIsUp(NULL), is_false);
+
+    // Make the AfterEach close harmless
+    LinkInit(&client, "client", LINK_ROLE_CLIENT, IP_ADDR, LINK_PORT);
+    LinkInit(&server, "server", LINK_ROLE_SERVER, IP_ADDR, LINK_PORT);
+
+}
+
+Ensure(Link, connects_client_and_server) {
+
+    int rc;
+
+    rc = LinkInit(&server, "server", LINK_ROLE_SERVER, IP_ADDR, LINK_PORT);
+    assert_that(rc, is_equal_to(0));
+    rc = LinkInit(&client, "client", LINK_ROLE_CLIENT, IP_ADDR, LINK_PORT);
+    assert_that(rc, is_equal_to(0));
+
+    assert_that(LinkIsUp(&client), is_false);
+    assert_that(service_until_up(&client, &server, 1000), is_not_equal_to(-1));
+
+}
+
+Ensure(Link, transfers_data) {
+
+    unsigned char outmsg[32] = "Howdy server", inmsg[32];
+    int rc, msglen = strlen((char *) outmsg), i;
+
+    LinkInit(&server, "server", LINK_ROLE_SERVER, IP_ADDR, LINK_PORT);
+    LinkInit(&client, "client", LINK_ROLE_CLIENT, IP_ADDR, LINK_PORT);
+    service_until_up(&client, &server, 1000);
+
+    rc = LinkWrite(&client, outmsg, msglen);
+    assert_that(rc, is_equal_to(msglen));
+
+    // Nothing may be there yet, wait a little
+    rc = 0;
+    for (i = 0; i < 100 && rc == 0; i++) {
+        usleep(1000);
+        rc = LinkRead(&server, inmsg, 32);
+    }
+    assert_that(rc, is_equal_to(msglen));
+    assert_that(memcmp(inmsg, outmsg, msglen), is_equal_to(0));
+
+    // Kernel arrival time was recorded for the read
+    assert_that(server.numRxStamped, is_equal_to(1));
+    assert_that(server.lastRxQueueNs, is_greater_than(0));
+
+}
+
+Ensure(Link, client_recovers_after_server_restart) {
+
+    int rc;
+
+    LinkInit(&server, "server", LINK_ROLE_SERVER, IP_ADDR, LINK_PORT);
+    LinkInit(&client, "client", LINK_ROLE_CLIENT, IP_ADDR, LINK_PORT);
+    service_until_up(&client, &server, 1000);
+
+    // Server process goes away entirely, then starts again
+    LinkClose(&server);
+    usleep(20000);
+    LinkService(&client);
+    assert_that(LinkIsUp(&client), is_false);
+
+    rc = LinkInit(&server, "server", LINK_ROLE_SERVER, IP_ADDR, LINK_PORT);
+    assert_that(rc, is_equal_to(0));
+    rc = service_until_up(&client, &server, 2000);
+    assert_that(rc, is_not_equal_to(-1));
+
+    // Recovery time is measured from the drop, including the outage above
+    assert_that(client.numDrops, is_equal_to(1));
+    assert_that(client.numRecoveries, is_equal_to(1));
+    assert_that(client.lastRecoveryNs, is_greater_than(0));
+    assert_that(client.lastRecoveryNs / NSEC_PER_MSEC, is_less_than(MAX_RECOVERY_MS));
+    LinkReportStats(&client);
+
+}
+
+Ensure(Link, server_keeps_listening_after_client_restart) {
+
+    int rc;
+
+    LinkInit(&server, "server", LINK_ROLE_SERVER, IP_ADDR, LINK_PORT);
+    LinkInit(&client, "client", LINK_ROLE_CLIENT, IP_ADDR, LINK_PORT);
+    service_until_up(&client, &server, 1000);
+
+    // Client process restarts
+    LinkClose(&client);
+    LinkInit(&client, "client", LINK_ROLE_CLIENT, IP_ADDR, LINK_PORT);
+
+    rc = service_until_up(&client, &server, 1000);
+    assert_that(rc, is_not_equal_to(-1));
+    assert_that(rc, is_less_than(MAX_RECOVERY_MS));
+    assert_that(server.numRecoveries, is_equal_to(1));
+    assert_that(server.listen_fd, is_not_equal_to(-1));
+
+}
+
+Ensure(Link, heartbeat_timeout_drops_silent_peer) {
+
+    LinkInit(&server, "server", LINK_ROLE_SERVER, IP_ADDR, LINK_PORT);
+    LinkInit(&client, "client", LINK_ROLE_CLIENT, IP_ADDR, LINK_PORT);
+    service_until_up(&client, &server, 1000);
+
+    // Peer never sends anything, so a short heartbeat timeout expires
+    LinkSetRxTimeout(&client, 20);
+    usleep(40000);
+    LinkService(&client);
+    assert_that(client.numDrops, is_equal_to(1));
+
+}
+
+Ensure(Link, write_to_down_link_fails) {
+
+    unsigned char msg[4] = "abc";
+
+    LinkInit(&client, "client", LINK_ROLE_CLIENT, IP_ADDR, LINK_PORT);
+    LinkInit(&server, "server", LINK_ROLE_SERVER, IP_ADDR, LINK_PORT);
+
+    assert_that(LinkWrite(&client, msg, 3), is_less_than(0));
+    assert_that(errno, is_equal_to(ENOTCONN));
+    assert_that(LinkRead(&client, msg, 3), is_less_than(0));
+
+}
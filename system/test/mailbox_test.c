@@ -0,0 +1,207 @@
+/****************************************************************************
+ *
+ * File:
+ *      mailbox_test.c
+ *
+ * Description:
+ *      CGreen test suite for the latest-value mailbox (mailbox.c)
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "config.h"
+
+#include "mailbox.h"
+#include "timing.h"
+
+// Stand-in for a pose, every field derived from the same counter so a torn
+// read shows up as fields that disagree
+typedef struct {
+    uint64_t count;
+    double values[12];
+} TEST_POSE;
+
+static MAILBOX mailbox;
+
+Describe(Mailbox);
+
+BeforeEach(Mailbox) {
+    MailboxInit(&mailbox, sizeof(TEST_POSE));
+}
+
+AfterEach(Mailbox) {
+}
+
+static void fillPose(TEST_POSE *pose, uint64_t count) {
+
+    int i;
+
+    pose->count = count;
+    for (i = 0; i < 12; i++) {
+        pose->values[i] = (double) count * (i + 1);
+    }
+
+}
+
+static int poseConsistent(const TEST_POSE *pose) {
+
+    int i;
+
+    for (i = 0; i < 12; i++) {
+        if (pose->values[i] != (double) pose->count * (i + 1)) {
+            return 0;
+        }
+    }
+
+    return 1;
+
+}
+
+Ensure(Mailbox, init_rejects_bad_sizes) {
+
+    MAILBOX other;
+
+    assert_that(MailboxInit(&other, 0), is_equal_to(-1));
+    assert_that(MailboxInit(&other, MAILBOX_MAX_SIZE + 1), is_equal_to(-1));
+    assert_that(MailboxInit(NULL, 8), is_equal_to(-1));
+    assert_that(MailboxInit(&other, MAILBOX_MAX_SIZE), is_equal_to(0));
+
+}
+
+Ensure(Mailbox, read_reports_new_and_repeated_values) {
+
+    TEST_POSE in, out;
+    int isNew = -1;
+
+    // Nothing published yet
+    memset(&out, 0xAA, sizeof(out));
+    assert_that(MailboxRead(&mailbox, &out), is_equal_to(-1));
+    assert_that(MailboxLatest(&mailbox, &isNew), is_null);
+    assert_that(isNew, is_equal_to(0));
+
+    fillPose(&in, 1);
+    assert_that(MailboxPublish(&mailbox, &in), is_equal_to(0));
+    assert_that(MailboxRead(&mailbox, &out), is_equal_to(1));
+    assert_that(out.count, is_equal_to(1));
+
+    // Same value again, flagged as not new
+    memset(&out, 0, sizeof(out));
+    assert_that(MailboxRead(&mailbox, &out), is_equal_to(0));
+    assert_that(out.count, is_equal_to(1));
+    assert_that(poseConsistent(&out), is_true);
+
+}
+
+Ensure(Mailbox, reader_gets_only_the_newest_value) {
+
+    TEST_POSE in, out;
+    uint64_t i;
+
+    for (i = 1; i <= 10; i++) {
+        fillPose(&in, i);
+        MailboxPublish(&mailbox, &in);
+    }
+
+    assert_that(MailboxRead(&mailbox, &out), is_equal_to(1));
+    assert_that(out.count, is_equal_to(10));
+    assert_that(mailbox.numSkipped, is_equal_to(9));
+    assert_that(MailboxRead(&mailbox, &out), is_equal_to(0));
+
+}
+
+Ensure(Mailbox, writer_can_fill_slot_in_place) {
+
+    TEST_POSE *slot;
+    const TEST_POSE *latest;
+    int isNew;
+
+    slot = (TEST_POSE *) MailboxWriteBuffer(&mailbox);
+    fillPose(slot, 7);
+    assert_that(MailboxCommit(&mailbox), is_equal_to(0));
+
+    // The writer moves on to a different slot
+    assert_that(MailboxWriteBuffer(&mailbox), is_not_equal_to(slot));
+
+    latest = (const TEST_POSE *) MailboxLatest(&mailbox, &isNew);
+    assert_that(latest, is_equal_to(slot));
+    assert_that(isNew, is_equal_to(1));
+    assert_that(latest->count, is_equal_to(7));
+
+}
+
+// Publishes as fast as it can until told to stop
+static volatile int writerRunning;
+static volatile int64_t writerNs;
+
+static void *writerRoutine(void *arg) {
+
+    TEST_POSE pose;
+    uint64_t count = 0;
+    int64_t startNs = TimeMonotonicNs();
+
+    while (writerRunning) {
+        fillPose(&pose, ++count);
+        MailboxPublish(&mailbox, &pose);
+    }
+    writerNs = TimeMonotonicNs() - startNs;
+
+    return NULL;
+
+}
+
+Ensure(Mailbox, values_never_tear_under_contention) {
+
+    pthread_t writer;
+    TEST_POSE out;
+    uint64_t lastCount = 0, numReads = 0, numNew = 0, numTorn = 0, numBackwards = 0;
+    int64_t startNs, readNs;
+    int rc;
+
+    writerRunning = 1;
+    pthread_create(&writer, NULL, writerRoutine, NULL);
+
+    startNs = TimeMonotonicNs();
+    while (TimeMonotonicNs() - startNs < 200 * NSEC_PER_MSEC) {
+        rc = MailboxRead(&mailbox, &out);
+        if (rc < 0) {
+            continue;
+        }
+        numReads++;
+        numNew += rc;
+        if (!poseConsistent(&out)) {
+            numTorn++;
+        }
+        if (out.count < lastCount || (rc == 1 && out.count == lastCount)) {
+            numBackwards++;
+        }
+        lastCount = out.count;
+    }
+    readNs = TimeMonotonicNs() - startNs;
+
+    writerRunning = 0;
+    pthread_join(writer, NULL);
+
+    assert_that(numReads, is_greater_than(0));
+    assert_that(numNew, is_greater_than(0));
+    assert_that(numTorn, is_equal_to(0));
+    assert_that(numBackwards, is_equal_to(0));
+    assert_that(mailbox.numPublished, is_greater_than(numNew - 1));
+
+    printf("BENCH mailbox %d-byte value under contention: publish %.1f ns, read %.1f ns, "
+            "%llu of %llu reads new\n", (int) sizeof(TEST_POSE),
+            (double) writerNs / mailbox.numPublished, (double) readNs / numReads,
+            (unsigned long long) numNew, (unsigned long long) numReads);
+
+}
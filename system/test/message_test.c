@@ -0,0 +1,194 @@
+/****************************************************************************
+ *
+ * File:
+ *      message_test.c
+ *
+ * Description:
+ *      CGreen test suite for the inter-subsystem message layer (message.c)
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "debuglog.h"
+#include "timing.h"
+
+#include "message.h"
+
+// Name of test context
+Describe(Message);
+
+// Execute in the context immediately before each "Ensure" test
+BeforeEach(Message) {
+}
+
+// Execute after each test
+AfterEach(Message) {
+}
+
+
+/**** Start test suite ****/
+
+Ensure(Message, pose_round_trips) {
+
+    MSG_POSE in, out;
+    unsigned char buf[MSG_MAX_LENGTH];
+    int rc;
+
+    memset(&in, 0, sizeof(in));
+    in.header.sequence = 42;
+    in.timestamp = 123456789012345LL;
+    in.position[0] = 1000.25;
+    in.position[1] = -2000.5;
+    in.position[2] = 3.125;
+    in.attitude[0] = 0.01f;
+    in.attitude[1] = -0.02f;
+    in.attitude[2] = 3.1f;
+    in.positionSigma = 0.5f;
+    in.attitudeSigma = 0.05f;
+    in.status = 0x5;
+
+    rc = MessageEncodePose(&in, buf, sizeof(buf));
+    assert_that(rc, is_equal_to(sizeof(MSG_POSE)));
+    assert_that(buf[0], is_equal_to(MSG_TYPE_POSE));
+    assert_that(buf[1], is_equal_to(MSG_POSE_VERSION));
+
+    rc = MessageDecodePose(buf, rc, &out);
+    assert_that(rc, is_equal_to(sizeof(MSG_POSE)));
+    assert_that(memcmp(&in, &out, sizeof(MSG_POSE)), is_equal_to(0));
+    assert_that(out.header.sequence, is_equal_to(42));
+
+}
+
+Ensure(Message, other_types_round_trip) {
+
+    MSG_VELOCITY vin, vout;
+    MSG_WHEEL_COMMAND win, wout;
+    MSG_OBSTACLE oin, oout;
+    unsigned char buf[MSG_MAX_LENGTH];
+    int rc;
+
+    memset(&vin, 0, sizeof(vin));
+    vin.velocity[0] = 1.5f;
+    vin.yawRate = -0.25f;
+    rc = MessageEncodeVelocity(&vin, buf, sizeof(buf));
+    assert_that(MessageDecodeVelocity(buf, rc, &vout), is_equal_to(sizeof(MSG_VELOCITY)));
+    assert_that(memcmp(&vin, &vout, sizeof(vin)), is_equal_to(0));
+
+    memset(&win, 0, sizeof(win));
+    win.leftSpeed = 0.75f;
+    win.rightSpeed = 0.8f;
+    win.flags = 1;
+    rc = MessageEncodeWheelCommand(&win, buf, sizeof(buf));
+    assert_that(MessageDecodeWheelCommand(buf, rc, &wout), is_equal_to(sizeof(MSG_WHEEL_COMMAND)));
+    assert_that(memcmp(&win, &wout, sizeof(win)), is_equal_to(0));
+
+    memset(&oin, 0, sizeof(oin));
+    oin.id = 9;
+    oin.position[0] = 4.0f;
+    oin.radius = 0.3f;
+    rc = MessageEncodeObstacle(&oin, buf, sizeof(buf));
+    assert_that(MessageDecodeObstacle(buf, rc, &oout), is_equal_to(sizeof(MSG_OBSTACLE)));
+    assert_that(memcmp(&oin, &oout, sizeof(oin)), is_equal_to(0));
+
+}
+
+Ensure(Message, wire_format_is_little_endian) {
+
+    MSG_WHEEL_COMMAND cmd;
+    unsigned char buf[MSG_MAX_LENGTH];
+
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.header.sequence = 0x01020304;
+    MessageEncodeWheelCommand(&cmd, buf, sizeof(buf));
+
+    // Length field then sequence, least significant byte first
+    assert_that(buf[2], is_equal_to(sizeof(MSG_WHEEL_COMMAND)));
+    assert_that(buf[3], is_equal_to(0));
+    assert_that(buf[4], is_equal_to(0x04));
+    assert_that(buf[7], is_equal_to(0x01));
+
+}
+
+Ensure(Message, decode_rejects_bad_input) {
+
+    MSG_POSE pose;
+    MSG_VELOCITY vel;
+    unsigned char buf[MSG_MAX_LENGTH];
+    int len;
+
+    memset(&pose, 0, sizeof(pose));
+    len = MessageEncodePose(&pose, buf, sizeof(buf));
+
+    assert_that(MessageEncodePose(&pose, buf, 10), is_equal_to(MSG_ERR_SHORT));
+    assert_that(MessageDecodePose(NULL, len, &pose), is_equal_to(MSG_ERR_ARGS));
+    assert_that(MessageDecodePose(buf, len - 1, &pose), is_equal_to(MSG_ERR_SHORT));
+
+    // Right size but wrong type
+    assert_that(MessageDecodeVelocity(buf, len, &vel), is_equal_to(MSG_ERR_TYPE));
+
+    // Older or newer layout
+    buf[1] = MSG_POSE_VERSION + 1;
+    assert_that(MessageDecodePose(buf, len, &pose), is_equal_to(MSG_ERR_VERSION));
+
+}
+
+Ensure(Message, peek_header_finds_length) {
+
+    MSG_OBSTACLE obs;
+    MSG_HEADER header;
+    unsigned char buf[MSG_MAX_LENGTH];
+
+    memset(&obs, 0, sizeof(obs));
+    MessageEncodeObstacle(&obs, buf, sizeof(buf));
+
+    assert_that(MessagePeekHeader(buf, 4, &header), is_equal_to(MSG_ERR_SHORT));
+    assert_that(MessagePeekHeader(buf, sizeof(buf), &header), is_equal_to(sizeof(MSG_OBSTACLE)));
+    assert_that(header.type, is_equal_to(MSG_TYPE_OBSTACLE));
+
+    // Garbage length is rejected
+    buf[2] = 0xFF;
+    assert_that(MessagePeekHeader(buf, sizeof(buf), &header), is_equal_to(MSG_ERR_LENGTH));
+
+}
+
+Ensure(Message, pose_throughput) {
+
+    const int numMessages = 2000000;
+    MSG_POSE in, out;
+    unsigned char buf[MSG_MAX_LENGTH];
+    int64_t start, elapsed;
+    int i, rc = 0;
+    double checksum = 0;
+
+    memset(&in, 0, sizeof(in));
+
+    start = TimeMonotonicNs();
+    for (i = 0; i < numMessages; i++) {
+        in.header.sequence = i;
+        in.position[0] = i;
+        MessageEncodePose(&in, buf, sizeof(buf));
+        rc = MessageDecodePose(buf, sizeof(buf), &out);
+        checksum += out.position[0];
+    }
+    elapsed = TimeMonotonicNs() - start;
+
+    assert_that(rc, is_equal_to(sizeof(MSG_POSE)));
+    assert_that(out.header.sequence, is_equal_to(numMessages - 1));
+
+    logDebug(L_INFO, "Message bench: %d pose encode+decode in %.3f ms, %.1f ns each (%.0f)\n",
+            numMessages, (double) elapsed / NSEC_PER_MSEC,
+            (double) elapsed / numMessages, checksum);
+
+    // Generous bound, only catches something pathological
+    assert_that(elapsed / numMessages, is_less_than(1000));
+
+}
@@ -0,0 +1,292 @@
+/****************************************************************************
+ *
+ * File:
+ *      multicast_test.c
+ *
+ * Description:
+ *      CGreen test suite for the multicast state broadcast (multicast.c).
+ *      Runs over loopback.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "debuglog.h"
+#include "timing.h"
+
+#include "multicast.h"
+
+#define IFACE_ADDR  "127.0.0.1"
+#define STREAM_ID   3
+
+MCAST_SENDER sender;
+MCAST_RECEIVER receiverA, receiverB;
+
+// Name of test context
+Describe(Multicast);
+
+// Execute in the context immediately before each "Ensure" test
+BeforeEach(Multicast) {
+
+    assert_that(McastReceiverInit(&receiverA, STATE_MCAST_GROUP, STATE_MCAST_PORT, IFACE_ADDR), is_equal_to(0));
+    assert_that(McastReceiverInit(&receiverB, STATE_MCAST_GROUP, STATE_MCAST_PORT, IFACE_ADDR), is_equal_to(0));
+    assert_that(McastSenderInit(&sender, STATE_MCAST_GROUP, STATE_MCAST_PORT, IFACE_ADDR, STREAM_ID), is_equal_to(0));
+
+}
+
+// Execute after each test
+AfterEach(Multicast) {
+
+    McastSenderClose(&sender);
+    McastReceiverClose(&receiverA);
+    McastReceiverClose(&receiverB);
+
+}
+
+
+/**** Function receive_all
+ *
+ * Receives until count datagrams have been delivered or a receive times out.
+ * Returns the number delivered; sequences are stored in the given array.
+ *
+ ****/
+int receive_all(MCAST_RECEIVER *receiver, uint32_t *sequences, int count) {
+
+    MCAST_DATAGRAM datagrams[MCAST_BATCH_MAX];
+    int i, rc, total = 0;
+
+    while (total < count) {
+        rc = McastReceiveBatch(receiver, datagrams, MCAST_BATCH_MAX, 200);
+        if (rc <= 0) {
+            break;
+        }
+        for (i = 0; i < rc && total < count; i++) {
+            sequences[total++] = datagrams[i].sequence;
+        }
+    }
+
+    return total;
+
+} // receive_all(MCAST_RECEIVER *, uint32_t *, int)
+
+
+Ensure(Multicast, batch_reaches_every_subscriber) {
+
+    const unsigned char *bufs[8];
+    int lengths[8];
+    unsigned char payloads[8][16];
+    MCAST_DATAGRAM datagrams[MCAST_BATCH_MAX];
+    int i, rc;
+
+    for (i = 0; i < 8; i++) {
+        memset(payloads[i], 'a' + i, sizeof(payloads[i]));
+        bufs[i] = payloads[i];
+        lengths[i] = i + 1;
+    }
+
+    rc = McastSendBatch(&sender, bufs, lengths, 8);
+    assert_that(rc, is_equal_to(8));
+
+    rc = McastReceiveBatch(&receiverA, datagrams, MCAST_BATCH_MAX, 200);
+    assert_that(rc, is_equal_to(8));
+    for (i = 0; i < rc; i++) {
+        assert_that(datagrams[i].stream, is_equal_to(STREAM_ID));
+        assert_that(datagrams[i].sequence, is_equal_to(i));
+        assert_that(datagrams[i].length, is_equal_to(i + 1));
+        assert_that(datagrams[i].data[0], is_equal_to('a' + i));
+    }
+
+    // The second subscriber gets its own copy of everything
+    rc = McastReceiveBatch(&receiverB, datagrams, MCAST_BATCH_MAX, 200);
+    assert_that(rc, is_equal_to(8));
+    assert_that(receiverB.numLost, is_equal_to(0));
+
+}
+
+Ensure(Multicast, gap_is_counted_and_skipped) {
+
+    unsigned char payload[4] = {1, 2, 3, 4};
+    uint32_t sequences[8];
+    int rc;
+
+    McastSend(&sender, payload, sizeof(payload));
+    McastSend(&sender, payload, sizeof(payload));
+
+    // Simulate three datagrams lost on the network
+    sender.sequence += 3;
+
+    McastSend(&sender, payload, sizeof(payload));
+    McastSend(&sender, payload, sizeof(payload));
+
+    rc = receive_all(&receiverA, sequences, 4);
+    assert_that(rc, is_equal_to(4));
+    assert_that(sequences[1], is_equal_to(1));
+    assert_that(sequences[2], is_equal_to(5));
+    assert_that(sequences[3], is_equal_to(6));
+
+    assert_that(receiverA.numReceived, is_equal_to(4));
+    assert_that(receiverA.numLost, is_equal_to(3));
+    assert_that(receiverA.numGaps, is_equal_to(1));
+
+}
+
+Ensure(Multicast, stale_datagram_is_dropped) {
+
+    unsigned char payload[4] = {0};
+    uint32_t sequences[8];
+    int rc;
+
+    sender.sequence = 10;
+    McastSend(&sender, payload, sizeof(payload));
+
+    // Reordered datagram from before the one already delivered
+    sender.sequence = 7;
+    McastSend(&sender, payload, sizeof(payload));
+
+    sender.sequence = 11;
+    McastSend(&sender, payload, sizeof(payload));
+
+    rc = receive_all(&receiverA, sequences, 3);
+    assert_that(rc, is_equal_to(2));
+    assert_that(sequences[0], is_equal_to(10));
+    assert_that(sequences[1], is_equal_to(11));
+    assert_that(receiverA.numStale, is_equal_to(1));
+    assert_that(receiverA.numLost, is_equal_to(0));
+
+}
+
+Ensure(Multicast, publisher_restart_resyncs_stream) {
+
+    unsigned char payload[4] = {0};
+    uint32_t sequences[8];
+    int rc;
+
+    // Publisher has been running a while
+    sender.sequence = 1000;
+    McastSend(&sender, payload, sizeof(payload));
+    McastSend(&sender, payload, sizeof(payload));
+
+    // It restarts and counts from zero again
+    McastSenderClose(&sender);
+    assert_that(McastSenderInit(&sender, STATE_MCAST_GROUP, STATE_MCAST_PORT, IFACE_ADDR, STREAM_ID), is_equal_to(0));
+    McastSend(&sender, payload, sizeof(payload));
+    McastSend(&sender, payload, sizeof(payload));
+    McastSend(&sender, payload, sizeof(payload));
+
+    rc = receive_all(&receiverA, sequences, 5);
+    assert_that(rc, is_equal_to(5));
+    assert_that(sequences[1], is_equal_to(1001));
+    assert_that(sequences[2], is_equal_to(0));
+    assert_that(sequences[4], is_equal_to(2));
+    assert_that(receiverA.numResyncs, is_equal_to(1));
+    assert_that(receiverA.numStale, is_equal_to(0));
+    assert_that(receiverA.numLost, is_equal_to(0));
+
+}
+
+Ensure(Multicast, publisher_restart_after_few_datagrams_resyncs_stream) {
+
+    unsigned char payload[4] = {0};
+    uint32_t sequences[8];
+    int rc;
+
+    McastSend(&sender, payload, sizeof(payload));
+    McastSend(&sender, payload, sizeof(payload));
+    McastSend(&sender, payload, sizeof(payload));
+
+    // Starting over only goes back a few sequence numbers, like a late
+    // datagram would
+    McastSenderClose(&sender);
+    assert_that(McastSenderInit(&sender, STATE_MCAST_GROUP, STATE_MCAST_PORT, IFACE_ADDR, STREAM_ID), is_equal_to(0));
+    McastSend(&sender, payload, sizeof(payload));
+    McastSend(&sender, payload, sizeof(payload));
+
+    rc = receive_all(&receiverA, sequences, 5);
+    assert_that(rc, is_equal_to(5));
+    assert_that(sequences[2], is_equal_to(2));
+    assert_that(sequences[3], is_equal_to(0));
+    assert_that(sequences[4], is_equal_to(1));
+    assert_that(receiverA.numResyncs, is_equal_to(1));
+    assert_that(receiverA.numStale, is_equal_to(0));
+
+}
+
+Ensure(Multicast, malformed_datagram_is_counted) {
+
+    unsigned char garbage[3] = {0xFF, 0xFF, 0xFF};
+    unsigned char payload[4] = {0};
+    uint32_t sequences[4];
+    int rc;
+
+    // Too short to hold a header
+    sendto(sender.fd, garbage, sizeof(garbage), 0,
+            (struct sockaddr *) &sender.group, sizeof(sender.group));
+    McastSend(&sender, payload, sizeof(payload));
+
+    rc = receive_all(&receiverA, sequences, 2);
+    assert_that(rc, is_equal_to(1));
+    assert_that(receiverA.numMalformed, is_equal_to(1));
+
+}
+
+Ensure(Multicast, oversized_payload_is_rejected) {
+
+    static unsigned char payload[MCAST_MAX_PAYLOAD + 1];
+
+    assert_that(McastSend(&sender, payload, sizeof(payload)), is_less_than(0));
+    assert_that(sender.sequence, is_equal_to(0));
+
+}
+
+Ensure(Multicast, batched_throughput) {
+
+    const int numBatches = 2000;
+    const unsigned char *bufs[MCAST_BATCH_MAX];
+    int lengths[MCAST_BATCH_MAX];
+    unsigned char payload[64];
+    MCAST_DATAGRAM datagrams[MCAST_BATCH_MAX];
+    int64_t start, elapsed;
+    int i, rc, numDelivered = 0;
+
+    memset(payload, 0x5A, sizeof(payload));
+    for (i = 0; i < MCAST_BATCH_MAX; i++) {
+        bufs[i] = payload;
+        lengths[i] = sizeof(payload);
+    }
+
+    // One subscriber only, so the other does not overflow its buffer
+    McastReceiverClose(&receiverB);
+    McastReceiverInit(&receiverB, STATE_MCAST_GROUP, STATE_MCAST_PORT + 1, IFACE_ADDR);
+
+    // Send and drain in lockstep so the socket buffer never overflows
+    start = TimeMonotonicNs();
+    for (i = 0; i < numBatches; i++) {
+        McastSendBatch(&sender, bufs, lengths, MCAST_BATCH_MAX);
+        do {
+            rc = McastReceiveBatch(&receiverA, datagrams, MCAST_BATCH_MAX, 200);
+            if (rc > 0) {
+                numDelivered += rc;
+            }
+        } while (rc > 0 && numDelivered < (i + 1) * MCAST_BATCH_MAX);
+    }
+    elapsed = TimeMonotonicNs() - start;
+
+    logDebug(L_INFO, "Multicast bench: %d datagrams in %.3f ms, %.0f ns each, %llu lost\n",
+            numDelivered, (double) elapsed / NSEC_PER_MSEC,
+            (double) elapsed / numDelivered, (unsigned long long) receiverA.numLost);
+
+    assert_that(numDelivered, is_equal_to(numBatches * MCAST_BATCH_MAX));
+    assert_that(receiverA.numLost, is_equal_to(0));
+
+}
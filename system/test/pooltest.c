@@ -0,0 +1,245 @@
+/****************************************************************************
+ *
+ * File:
+ *      pooltest.c
+ *
+ * Description:
+ *      CGreen test suite for the work-stealing thread pool (pool.c)
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+
+#include "config.h"
+
+#include "pool.h"
+#include "thread.h"
+#include "timing.h"
+
+#define NUM_ITEMS 100000
+
+static POOL pool;
+static volatile int visits[NUM_ITEMS];
+
+// Name of test context
+Describe(Pool);
+
+BeforeEach(Pool) {
+    memset((void *) visits, 0, sizeof(visits));
+}
+
+AfterEach(Pool) {
+}
+
+
+static void visitRange(void *params, int begin, int end) {
+
+    int i, *maxRange = (int *) params;
+
+    if (maxRange != NULL && end - begin > *maxRange) {
+        *maxRange = end - begin;
+    }
+    for (i = begin; i < end; i++) {
+        __atomic_add_fetch(&(visits[i]), 1, __ATOMIC_RELAXED);
+    }
+
+}
+
+static void visitOne(void *params) {
+
+    __atomic_add_fetch(&(visits[(long) params]), 1, __ATOMIC_RELAXED);
+
+}
+
+Ensure(Pool, init_rejects_bad_args) {
+
+    assert_that(PoolInit(NULL, 1, 0), is_equal_to(-1));
+    assert_that(PoolInit(&pool, -1, 0), is_equal_to(-1));
+
+}
+
+Ensure(Pool, parallel_for_visits_every_index_once) {
+
+    int i, maxRange = 0;
+
+    assert_that(PoolInit(&pool, 4, 0), is_equal_to(0));
+    assert_that(pool.numWorkers, is_equal_to(4));
+
+    assert_that(PoolParallelFor(&pool, 0, NUM_ITEMS, 1000, visitRange, NULL), is_equal_to(0));
+    for (i = 0; i < NUM_ITEMS; i++) {
+        if (visits[i] != 1) {
+            break;
+        }
+    }
+    assert_that(i, is_equal_to(NUM_ITEMS));
+
+    // Grain caps the size of each call
+    assert_that(PoolParallelFor(&pool, 0, 5000, 100, visitRange, &maxRange), is_equal_to(0));
+    assert_that(maxRange, is_less_than(101));
+    assert_that(visits[4999], is_equal_to(2));
+
+    // Empty range does nothing
+    assert_that(PoolParallelFor(&pool, 10, 10, 1, visitRange, NULL), is_equal_to(0));
+
+    PoolDestroy(&pool);
+
+}
+
+Ensure(Pool, group_waits_for_all_tasks_even_when_deques_overflow) {
+
+    POOL_GROUP group;
+    long i, numTasks = 4 * POOL_DEQUE_LEN * 2;
+
+    assert_that(PoolInit(&pool, 2, 0), is_equal_to(0));
+
+    PoolGroupInit(&group);
+    for (i = 0; i < numTasks; i++) {
+        assert_that(PoolSubmit(&pool, &group, visitOne, (void *) i), is_equal_to(0));
+    }
+    assert_that(PoolGroupWait(&pool, &group), is_equal_to(0));
+    assert_that(group.pending, is_equal_to(0));
+
+    for (i = 0; i < numTasks; i++) {
+        if (visits[i] != 1) {
+            break;
+        }
+    }
+    assert_that(i, is_equal_to(numTasks));
+
+    PoolDestroy(&pool);
+
+}
+
+// Each outer task runs its own parallel loop, waiting from inside a worker
+static void nestedTask(void *params) {
+
+    long block = (long) params;
+
+    PoolParallelFor(&pool, block * 1000, (block + 1) * 1000, 50, visitRange, NULL);
+
+}
+
+Ensure(Pool, nested_waits_inside_tasks_complete) {
+
+    POOL_GROUP group;
+    long i;
+
+    assert_that(PoolInit(&pool, 3, 0), is_equal_to(0));
+
+    PoolGroupInit(&group);
+    for (i = 0; i < 50; i++) {
+        PoolSubmit(&pool, &group, nestedTask, (void *) i);
+    }
+    assert_that(PoolGroupWait(&pool, &group), is_equal_to(0));
+
+    for (i = 0; i < 50000; i++) {
+        if (visits[i] != 1) {
+            break;
+        }
+    }
+    assert_that(i, is_equal_to(50000));
+
+    PoolDestroy(&pool);
+
+}
+
+static volatile unsigned long cpusUsed = 0;
+
+static void recordCpu(void *params) {
+
+    __atomic_or_fetch(&cpusUsed, THREAD_CPU(sched_getcpu()), __ATOMIC_RELAXED);
+
+}
+
+Ensure(Pool, workers_stay_on_configured_cores) {
+
+    POOL_GROUP group;
+    int i, numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned long lastCpu = THREAD_CPU(numCpus - 1);
+
+    // Masks are reduced to cores that exist, worker count follows the mask
+    assert_that(PoolInit(&pool, 0, lastCpu | THREAD_CPU(63)), is_equal_to(0));
+    assert_that(pool.cpuMask, is_equal_to(lastCpu));
+    assert_that(pool.numWorkers, is_equal_to(1));
+
+    cpusUsed = 0;
+    PoolGroupInit(&group);
+    for (i = 0; i < 100; i++) {
+        PoolSubmit(&pool, &group, recordCpu, NULL);
+    }
+    PoolGroupWait(&pool, &group);
+    PoolDestroy(&pool);
+
+    // Tasks the test thread helped with may have run anywhere, so only
+    // check that the worker ran some on its core
+    assert_that(cpusUsed & lastCpu, is_equal_to(lastCpu));
+
+}
+
+// Compute bound work, sized per index
+static double results[NUM_ITEMS];
+
+static void computeRange(void *params, int begin, int end) {
+
+    int i, j;
+    double x;
+
+    for (i = begin; i < end; i++) {
+        x = i;
+        for (j = 0; j < 50; j++) {
+            x = sqrt(x + j);
+        }
+        results[i] = x;
+    }
+
+}
+
+Ensure(Pool, bench_parallel_for_scaling) {
+
+    int numCpus = sysconf(_SC_NPROCESSORS_ONLN), numWorkers, rep;
+    int64_t startNs, elapsedNs, baseNs = 0;
+    const int REPS = 5;
+
+    if (numCpus > POOL_MAX_WORKERS) {
+        numCpus = POOL_MAX_WORKERS;
+    }
+
+    // 1, 2, 4, ... up to every core
+    for (numWorkers = 1; numWorkers <= numCpus;
+            numWorkers = (numWorkers < numCpus && 2 * numWorkers > numCpus) ? numCpus : 2 * numWorkers) {
+
+        assert_that(PoolInit(&pool, numWorkers, 0), is_equal_to(0));
+
+        startNs = TimeMonotonicNs();
+        for (rep = 0; rep < REPS; rep++) {
+            PoolParallelFor(&pool, 0, NUM_ITEMS, 512, computeRange, NULL);
+        }
+        elapsedNs = (TimeMonotonicNs() - startNs) / REPS;
+        if (numWorkers == 1) {
+            baseNs = elapsedNs;
+        }
+
+        printf("BENCH pool %2d workers + caller: %7.2f ms per %d items, speedup %.2f\n",
+                numWorkers, (double) elapsedNs / NSEC_PER_MSEC, NUM_ITEMS,
+                (double) baseNs / elapsedNs);
+
+        PoolDestroy(&pool);
+    }
+
+    assert_that(results[NUM_ITEMS - 1], is_greater_than(0));
+
+}
@@ -0,0 +1,230 @@
+/****************************************************************************
+ *
+ * File:
+ *      ptydevtest.c
+ *
+ * Description:
+ *      CGreen test suite for the emulated serial device module (ptydev.c)
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "timing.h"
+#include "uart.h"
+
+#include "ptydev.h"
+
+// Line protocol in the style of the Kangaroo motion controller
+static const PTYDEV_SCRIPT_ENTRY kangarooScript[] = {
+    {"1,start", ""},
+    {"1,getp", "1,P1234\r\n"},
+    {"2,getp", "2,P-56\r\n"},
+    {"3,", "E5\r\n"},
+};
+
+PTY_DEV pty;
+PTYDEV_SCRIPT script;
+int uart_fd;
+
+// Name of test context
+Describe(PtyDev);
+
+// Execute in the context immediately before each "Ensure" test
+BeforeEach(PtyDev) {
+
+    PtyDevScriptInit(&script, kangarooScript, sizeof(kangarooScript) / sizeof(kangarooScript[0]));
+    assert_that(PtyDevInit(&pty, PtyDevScriptHandler, &script), is_equal_to(0));
+    uart_fd = -1;
+
+}
+
+// Execute after each test
+AfterEach(PtyDev) {
+
+    if (uart_fd >= 0) {
+        UARTClose(uart_fd);
+    }
+    PtyDevClose(&pty);
+
+}
+
+
+/**** Function read_line
+ *
+ * Reads from the UART until a line ending arrives or the timeout expires.
+ * Returns the number of characters in the line (without the ending).
+ *
+ ****/
+int read_line(int fd, char *line, int size, int timeoutMs) {
+
+    int64_t deadline = TimeMonotonicNs() + (int64_t) timeoutMs * NSEC_PER_MSEC;
+    int len = 0, rc;
+    unsigned char c;
+
+    while (TimeMonotonicNs() < deadline && len < size - 1) {
+        rc = UARTRead(fd, &c, 1);
+        if (rc != 1) {
+            continue;
+        }
+        if (c == '\n') {
+            break;
+        }
+        if (c != '\r') {
+            line[len++] = c;
+        }
+    }
+    line[len] = '\0';
+
+    return len;
+
+} // read_line(int, char *, int, int)
+
+
+Ensure(PtyDev, scripted_device_answers_unchanged_uart_code) {
+
+    char line[64];
+
+    assert_that(PtyDevStart(&pty), is_equal_to(0));
+
+    uart_fd = UARTInit(pty.slavePath, 9600);
+    assert_that(uart_fd, is_greater_than(-1));
+
+    UARTWrite(uart_fd, (unsigned char *) "1,start\r\n", 9);
+    UARTWrite(uart_fd, (unsigned char *) "2,getp\r\n", 8);
+    read_line(uart_fd, line, sizeof(line), 500);
+    assert_that(line, is_equal_to_string("2,P-56"));
+
+    UARTWrite(uart_fd, (unsigned char *) "1,getp\r\n", 8);
+    read_line(uart_fd, line, sizeof(line), 500);
+    assert_that(line, is_equal_to_string("1,P1234"));
+
+    UARTWrite(uart_fd, (unsigned char *) "3,bogus\r\n", 9);
+    read_line(uart_fd, line, sizeof(line), 500);
+    assert_that(line, is_equal_to_string("E5"));
+
+    UARTWrite(uart_fd, (unsigned char *) "unknown\r\n", 9);
+    usleep(50000);
+    assert_that(script.numMatched, is_equal_to(4));
+    assert_that(script.numUnmatched, is_equal_to(1));
+
+}
+
+Ensure(PtyDev, output_is_paced_to_baud_rate) {
+
+    const int numBytes = 2000;
+    unsigned char out[2000], in[2000];
+    int64_t start, elapsed, expected;
+    int total = 0, rc;
+
+    memset(out, 'U', sizeof(out));
+    uart_fd = UARTInit(pty.slavePath, 115200);
+    PtyDevSetPacing(&pty, 115200);
+
+    start = TimeMonotonicNs();
+    assert_that(PtyDevWrite(&pty, out, numBytes), is_equal_to(numBytes));
+    elapsed = TimeMonotonicNs() - start;
+
+    expected = numBytes * UARTByteTimeNs(115200);
+    assert_that(elapsed, is_greater_than(expected - 1));
+    assert_that(elapsed, is_less_than(expected + 100 * NSEC_PER_MSEC));
+
+    while (total < numBytes && (rc = UARTRead(uart_fd, in + total, numBytes - total)) > 0) {
+        total += rc;
+    }
+    assert_that(total, is_equal_to(numBytes));
+
+}
+
+Ensure(PtyDev, latency_delays_replies) {
+
+    char line[64];
+    int64_t start, elapsed;
+
+    PtyDevSetLatency(&pty, 30000);
+    PtyDevStart(&pty);
+    uart_fd = UARTInit(pty.slavePath, 9600);
+
+    start = TimeMonotonicNs();
+    UARTWrite(uart_fd, (unsigned char *) "1,getp\n", 7);
+    read_line(uart_fd, line, sizeof(line), 500);
+    elapsed = TimeMonotonicNs() - start;
+
+    assert_that(line, is_equal_to_string("1,P1234"));
+    assert_that(elapsed, is_greater_than(30 * NSEC_PER_MSEC - 1));
+
+}
+
+Ensure(PtyDev, corruption_flips_one_bit_per_byte) {
+
+    unsigned char out[64], in[64];
+    int i, bits, total = 0, rc;
+    unsigned char diff;
+
+    memset(out, 0x55, sizeof(out));
+    uart_fd = UARTInit(pty.slavePath, 115200);
+    PtyDevSetCorruption(&pty, 1.0, 7);
+
+    PtyDevWrite(&pty, out, sizeof(out));
+    while (total < (int) sizeof(in) && (rc = UARTRead(uart_fd, in + total, sizeof(in) - total)) > 0) {
+        total += rc;
+    }
+    assert_that(total, is_equal_to(sizeof(in)));
+    assert_that(pty.numCorrupted, is_equal_to(sizeof(out)));
+
+    for (i = 0; i < total; i++) {
+        diff = in[i] ^ out[i];
+        for (bits = 0; diff; diff &= diff - 1) {
+            bits++;
+        }
+        assert_that(bits, is_equal_to(1));
+    }
+
+}
+
+/**** Function tick_handler
+ *
+ * Device model that sends one byte per tick
+ *
+ ****/
+int tick_handler(PTY_DEV *dev, const unsigned char *data, int length, void *context) {
+
+    if (data == NULL) {
+        PtyDevWrite(dev, (const unsigned char *) "t", 1);
+    }
+
+    return 0;
+
+} // tick_handler(PTY_DEV *, const unsigned char *, int, void *)
+
+Ensure(PtyDev, tick_drives_unsolicited_output) {
+
+    unsigned char in[64];
+    int total = 0, rc;
+
+    PtyDevClose(&pty);
+    PtyDevInit(&pty, tick_handler, NULL);
+    PtyDevSetTick(&pty, 10000);
+    uart_fd = UARTInit(pty.slavePath, 115200);
+    PtyDevStart(&pty);
+
+    usleep(105000);
+    PtyDevStop(&pty);
+
+    while ((rc = UARTRead(uart_fd, in + total, sizeof(in) - total)) > 0) {
+        total += rc;
+    }
+    assert_that(pty.numTicks, is_greater_than(7));
+    assert_that(total, is_equal_to(pty.numTicks));
+
+}
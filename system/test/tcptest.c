@@ -247,3 +247,44 @@ Ensure(TCPInterface, send_message_client_to_server) {
 
 }
 
+
+Ensure(TCPInterface, read_reports_kernel_arrival_time) {
+
+    // Use function above to set up proper connection, without assertions
+    setup_sockets(0);
+
+    unsigned char outmsg[256], inmsg[256];
+    strcpy((char *) outmsg, "Howdy server");
+    int msglen = strlen((char *) outmsg);
+    struct timespec arrival, now;
+
+    rc = TCPEnableRxTimestamps(server_fd);
+    assert_that(rc, is_equal_to(0));
+
+    // The kernel switches timestamping on asynchronously, segments that
+    // arrive right after enabling may not be stamped
+    usleep(10000);
+
+    // Send message, then let it sit in the socket for 20ms
+    rc = TCPWrite(client_fd, outmsg, msglen);
+    assert_that(rc, is_equal_to(msglen));
+    usleep(20000);
+
+    rc = TCPReadTimestamped(server_fd, inmsg, 256, &arrival);
+    clock_gettime(CLOCK_REALTIME, &now);
+    assert_that(rc, is_equal_to(msglen));
+    assert_that(memcmp(inmsg, outmsg, msglen), is_equal_to(0));
+
+    // Arrival stamp must be present and show the time spent waiting
+    assert_that(arrival.tv_sec, is_not_equal_to(0));
+    long waitedUs = (now.tv_sec - arrival.tv_sec) * 1000000L +
+        (now.tv_nsec - arrival.tv_nsec) / 1000;
+    assert_that(waitedUs, is_greater_than(15000));
+    assert_that(waitedUs, is_less_than(1000000));
+
+    // Nothing left, nonblocking read returns without a timestamp
+    rc = TCPReadTimestamped(server_fd, inmsg, 256, &arrival);
+    assert_that(rc, is_equal_to(-1));
+    assert_that(arrival.tv_sec, is_equal_to(0));
+
+}
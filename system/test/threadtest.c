@@ -12,8 +12,21 @@
  * Revision 0.1
  *      Last edited 03/19/2020
  *
+ * Revision 0.2
+ *      Added periodic task tests
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.3
+ *      Added affinity, stack, and memory locking tests
+ *      Last edited 10/18/2026
+ *
+ * Revision 0.4
+ *      Added priority inheritance mutex and condition variable tests
+ *      Last edited 10/18/2026
+ *
  ***************************************************************************/
 
+#define _GNU_SOURCE
 #include <cgreen/cgreen.h>
 #include <stdio.h>
 #include <string.h>
@@ -21,10 +34,13 @@
 #include <errno.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
 
 #include "config.h"
 
 #include "thread.h"
+#include "timing.h"
 
 int threadGlobal = 0;
 
@@ -182,3 +198,376 @@ xEnsure(Thread, join_without_create) {
 
 }
 
+
+
+// Counts calls, optionally spinning to simulate work
+typedef struct {
+    volatile int numCalls;
+    int stopAfter;     // Return -1 on this call, 0 to never stop
+    int64_t busyNs;    // Time to spend in each call
+    int slowCall;      // Call number that takes slowNs instead
+    int64_t slowNs;
+} PERIODIC_TEST;
+
+static int periodicTestRoutine(void *params) {
+
+    PERIODIC_TEST *test = (PERIODIC_TEST *) params;
+    int64_t busyNs, startNs = TimeMonotonicNs();
+
+    test->numCalls++;
+    busyNs = (test->numCalls == test->slowCall) ? test->slowNs : test->busyNs;
+    while (TimeMonotonicNs() - startNs < busyNs);
+
+    if (test->stopAfter > 0 && test->numCalls >= test->stopAfter) {
+        return -1;
+    }
+
+    return 0;
+
+}
+
+Ensure(Thread, periodic_init_rejects_bad_args) {
+
+    PERIODIC_TASK task;
+
+    assert_that(ThreadPeriodicInit(NULL, "t", 1000, periodicTestRoutine, NULL), is_equal_to(-1));
+    assert_that(ThreadPeriodicInit(&task, "t", 0, periodicTestRoutine, NULL), is_equal_to(-1));
+    assert_that(ThreadPeriodicInit(&task, "t", 1000, NULL, NULL), is_equal_to(-1));
+    assert_that(ThreadPeriodicInit(&task, "t", 1000, periodicTestRoutine, NULL), is_equal_to(0));
+    assert_that(ThreadPeriodicSetDeadline(&task, 0), is_equal_to(-1));
+
+}
+
+Ensure(Thread, periodic_task_holds_rate_without_drift) {
+
+    PERIODIC_TASK task;
+    PERIODIC_STATS stats;
+    PERIODIC_TEST test = {0};
+    pthread_attr_t threadAttr;
+    int64_t startNs, elapsedNs;
+
+    // 100 releases at 2 ms with 0.5 ms of work each. With relative sleeps
+    // the work would add up to 50 ms of drift.
+    test.stopAfter = 100;
+    test.busyNs = 500 * NSEC_PER_USEC;
+    ThreadPeriodicInit(&task, "rate", 2000, periodicTestRoutine, &test);
+
+    ThreadAttrInit(&threadAttr, 0);
+    startNs = TimeMonotonicNs();
+    assert_that(ThreadPeriodicStart(&task, &threadAttr), is_equal_to(0));
+    while (task.running) {
+        usleep(1000);
+    }
+    assert_that(ThreadPeriodicStop(&task), is_equal_to(0));
+    elapsedNs = TimeMonotonicNs() - startNs;
+
+    assert_that(test.numCalls, is_equal_to(100));
+    ThreadPeriodicGetStats(&task, &stats);
+
+    // Total time is the periods used (late wake-ups may drop a few) plus
+    // the final wake-up latency, never the sum of the work
+    assert_that(elapsedNs, is_greater_than(200 * NSEC_PER_MSEC - 1));
+    assert_that(elapsedNs, is_less_than((int64_t) (100 + stats.numSkipped) * 2 * NSEC_PER_MSEC +
+            stats.jitter.maxNs + 10 * NSEC_PER_MSEC));
+
+    assert_that(stats.numReleases, is_equal_to(100));
+    assert_that(stats.exec.numSamples, is_equal_to(100));
+    assert_that(stats.exec.minNs, is_greater_than(500 * NSEC_PER_USEC - 1));
+    assert_that(stats.jitter.minNs, is_greater_than(-1));
+    assert_that(ThreadHistogramPercentile(&(stats.exec), 50),
+            is_greater_than(stats.exec.minNs - 1));
+
+    printf("periodic: 2 ms x 100, jitter max %lld us, p99 %lld us\n",
+            (long long) (stats.jitter.maxNs / NSEC_PER_USEC),
+            (long long) (ThreadHistogramPercentile(&(stats.jitter), 99) / NSEC_PER_USEC));
+
+}
+
+Ensure(Thread, periodic_task_counts_overruns_and_skips) {
+
+    PERIODIC_TASK task;
+    PERIODIC_STATS stats;
+    PERIODIC_TEST test = {0};
+
+    // Call 5 runs for 3.5 periods, and every call misses a 0.1 ms deadline
+    test.stopAfter = 10;
+    test.busyNs = 200 * NSEC_PER_USEC;
+    test.slowCall = 5;
+    test.slowNs = 7 * NSEC_PER_MSEC;
+    ThreadPeriodicInit(&task, "overrun", 2000, periodicTestRoutine, &test);
+    ThreadPeriodicSetDeadline(&task, 100);
+
+    assert_that(ThreadPeriodicStart(&task, NULL), is_equal_to(0));
+    while (task.running) {
+        usleep(1000);
+    }
+    assert_that(ThreadPeriodicStop(&task), is_equal_to(0));
+
+    ThreadPeriodicGetStats(&task, &stats);
+    assert_that(stats.numReleases, is_equal_to(10));
+    assert_that(stats.numOverruns, is_equal_to(10));
+    assert_that(stats.numSkipped, is_greater_than(2));
+    assert_that(stats.exec.maxNs, is_greater_than(7 * NSEC_PER_MSEC - 1));
+
+}
+
+Ensure(Thread, periodic_stats_readable_while_running) {
+
+    PERIODIC_TASK task;
+    PERIODIC_STATS first, second;
+    PERIODIC_TEST test = {0};
+    int i;
+
+    ThreadPeriodicInit(&task, "live", 1000, periodicTestRoutine, &test);
+    assert_that(ThreadPeriodicStart(&task, NULL), is_equal_to(0));
+
+    usleep(20000);
+    assert_that(ThreadPeriodicGetStats(&task, &first), is_equal_to(0));
+    for (i = 0; i < 1000; i++) {
+        ThreadPeriodicGetStats(&task, &second);
+        assert_that(second.jitter.numSamples, is_equal_to(second.numReleases));
+    }
+    usleep(20000);
+    ThreadPeriodicGetStats(&task, &second);
+
+    assert_that(first.numReleases, is_greater_than(0));
+    assert_that(second.numReleases, is_greater_than(first.numReleases));
+
+    assert_that(ThreadPeriodicStop(&task), is_equal_to(0));
+    assert_that(task.running, is_equal_to(0));
+
+}
+
+
+// Reports the core the thread ran on and the bounds of its stack
+typedef struct {
+    int cpu;
+    void *stack;
+    size_t stackSize;
+} PLACEMENT_TEST;
+
+static void *reportPlacement(void *params) {
+
+    PLACEMENT_TEST *test = (PLACEMENT_TEST *) params;
+    pthread_attr_t selfAttr;
+
+    test->cpu = sched_getcpu();
+    pthread_getattr_np(pthread_self(), &selfAttr);
+    pthread_attr_getstack(&selfAttr, &(test->stack), &(test->stackSize));
+    pthread_attr_destroy(&selfAttr);
+
+    return NULL;
+
+}
+
+Ensure(Thread, affinity_pins_thread_to_core) {
+
+    PLACEMENT_TEST test = {-1, NULL, 0};
+    pthread_attr_t threadAttr;
+    pthread_t thread;
+    int numCpus = sysconf(_SC_NPROCESSORS_CONF);
+    int cpu = numCpus - 1;
+
+    assert_that(ThreadAttrInit(&threadAttr, 0), is_equal_to(0));
+    assert_that(ThreadAttrSetAffinity(&threadAttr, 0), is_equal_to(-1));
+    if (numCpus < 64) {
+        assert_that(ThreadAttrSetAffinity(&threadAttr, THREAD_CPU(numCpus)), is_equal_to(-1));
+    }
+    assert_that(ThreadAttrSetAffinity(&threadAttr, THREAD_CPU(cpu)), is_equal_to(0));
+
+    assert_that(ThreadCreate(&thread, &threadAttr, reportPlacement, &test), is_equal_to(0));
+    pthread_join(thread, NULL);
+    assert_that(test.cpu, is_equal_to(cpu));
+
+}
+
+Ensure(Thread, stack_is_prefaulted_and_used) {
+
+    PLACEMENT_TEST test = {-1, NULL, 0};
+    pthread_attr_t threadAttr;
+    pthread_t thread;
+    void *stack;
+    size_t stackSize, i, numPages, pageSize = sysconf(_SC_PAGESIZE);
+    unsigned char residency[256];
+
+    assert_that(ThreadAttrInit(&threadAttr, 0), is_equal_to(0));
+    assert_that(ThreadAttrSetStack(&threadAttr, 1024), is_equal_to(-1));
+    assert_that(ThreadAttrSetStack(&threadAttr, 256 * 1024 - 100), is_equal_to(0));
+
+    pthread_attr_getstack(&threadAttr, &stack, &stackSize);
+    assert_that(stackSize, is_equal_to(256 * 1024));
+
+    // Every page is resident before the thread touches it
+    numPages = stackSize / pageSize;
+    assert_that(numPages, is_less_than(sizeof(residency) + 1));
+    assert_that(mincore(stack, stackSize, residency), is_equal_to(0));
+    for (i = 0; i < numPages; i++) {
+        assert_that(residency[i] & 1, is_equal_to(1));
+    }
+
+    assert_that(ThreadCreate(&thread, &threadAttr, reportPlacement, &test), is_equal_to(0));
+    pthread_join(thread, NULL);
+    assert_that(test.stack, is_equal_to(stack));
+    assert_that(test.stackSize, is_equal_to(stackSize));
+
+    assert_that(ThreadAttrFreeStack(&threadAttr), is_equal_to(0));
+
+}
+
+Ensure(Thread, realtime_check_reports_memory_locking) {
+
+    int problems;
+
+    // Not locked yet, so at least that is reported
+    problems = ThreadCheckRealtime(0);
+    assert_that(problems & THREAD_RT_NOT_LOCKED, is_equal_to(THREAD_RT_NOT_LOCKED));
+    assert_that(problems & THREAD_RT_NOT_ISOLATED, is_equal_to(0));
+
+    // Locking may be refused without privileges, either way the check
+    // must agree with what happened
+    if (ThreadLockMemory() == 0) {
+        problems = ThreadCheckRealtime(0);
+        assert_that(problems & THREAD_RT_NOT_LOCKED, is_equal_to(0));
+        munlockall();
+    }
+
+    // A core that does not exist can never be isolated
+    problems = ThreadCheckRealtime(THREAD_CPU(63));
+    assert_that(problems & THREAD_RT_NOT_ISOLATED, is_equal_to(THREAD_RT_NOT_ISOLATED));
+
+}
+
+
+Ensure(Thread, mutex_instrumentation_counts_holds) {
+
+    THREAD_MUTEX mutex;
+
+    assert_that(ThreadMutexInit(&mutex, "test", THREAD_MUTEX_INSTRUMENT | THREAD_MUTEX_RECURSIVE),
+            is_equal_to(0));
+
+    // Nested locks are one hold
+    ThreadMutexLock(&mutex);
+    ThreadMutexLock(&mutex);
+    usleep(5000);
+    ThreadMutexUnlock(&mutex);
+    ThreadMutexUnlock(&mutex);
+
+    assert_that(mutex.numLocks, is_equal_to(1));
+    assert_that(mutex.numContended, is_equal_to(0));
+    assert_that(mutex.depth, is_equal_to(0));
+    assert_that(mutex.maxHoldNs, is_greater_than(5 * NSEC_PER_MSEC - 1));
+
+    assert_that(ThreadMutexDestroy(&mutex), is_equal_to(0));
+
+}
+
+Ensure(Thread, cond_wait_times_out_on_monotonic_clock) {
+
+    THREAD_MUTEX mutex;
+    THREAD_COND cond;
+    int64_t startNs;
+    int rc;
+
+    ThreadMutexInit(&mutex, "cond", 0);
+    assert_that(ThreadCondInit(&cond), is_equal_to(0));
+
+    ThreadMutexLock(&mutex);
+    startNs = TimeMonotonicNs();
+    rc = ThreadCondWait(&cond, &mutex, 20);
+    assert_that(rc, is_equal_to(-1));
+    assert_that(errno, is_equal_to(ETIMEDOUT));
+    assert_that(TimeMonotonicNs() - startNs, is_greater_than(20 * NSEC_PER_MSEC - 1));
+    ThreadMutexUnlock(&mutex);
+
+    ThreadCondDestroy(&cond);
+    ThreadMutexDestroy(&mutex);
+
+}
+
+// Classic inversion: low priority thread holds the lock, a middle priority
+// thread spins, and a high priority thread wants the lock. All on one core.
+static THREAD_MUTEX inversionLock;
+static volatile int lowHasLock;
+static volatile int64_t highWaitNs;
+
+static void spinFor(int64_t durationNs) {
+
+    int64_t startNs = TimeMonotonicNs();
+
+    while (TimeMonotonicNs() - startNs < durationNs);
+
+}
+
+static void *lowRoutine(void *arg) {
+
+    ThreadMutexLock(&inversionLock);
+    lowHasLock = 1;
+
+    // Give the test time to start the others, then do work that needs CPU
+    usleep(10000);
+    spinFor(10 * NSEC_PER_MSEC);
+
+    ThreadMutexUnlock(&inversionLock);
+
+    return NULL;
+
+}
+
+static void *highRoutine(void *arg) {
+
+    int64_t startNs;
+
+    usleep(5000);
+    startNs = TimeMonotonicNs();
+    ThreadMutexLock(&inversionLock);
+    highWaitNs = TimeMonotonicNs() - startNs;
+    ThreadMutexUnlock(&inversionLock);
+
+    return NULL;
+
+}
+
+static void *mediumRoutine(void *arg) {
+
+    spinFor(150 * NSEC_PER_MSEC);
+
+    return NULL;
+
+}
+
+Ensure(Thread, mutex_inherits_priority_of_waiter) {
+
+    pthread_attr_t lowAttr, mediumAttr, highAttr;
+    pthread_t low, medium, high;
+    unsigned long cpu = THREAD_CPU(sysconf(_SC_NPROCESSORS_ONLN) - 1);
+
+    ThreadMutexInit(&inversionLock, "inversion", 0);
+    lowHasLock = 0;
+    highWaitNs = -1;
+
+    ThreadAttrInit(&lowAttr, 30);
+    ThreadAttrInit(&mediumAttr, 20);
+    ThreadAttrInit(&highAttr, 10);
+    ThreadAttrSetAffinity(&lowAttr, cpu);
+    ThreadAttrSetAffinity(&mediumAttr, cpu);
+    ThreadAttrSetAffinity(&highAttr, cpu);
+
+    assert_that(ThreadCreate(&low, &lowAttr, lowRoutine, NULL), is_equal_to(0));
+    while (!lowHasLock) {
+        usleep(100);
+    }
+    assert_that(ThreadCreate(&high, &highAttr, highRoutine, NULL), is_equal_to(0));
+    assert_that(ThreadCreate(&medium, &mediumAttr, mediumRoutine, NULL), is_equal_to(0));
+
+    pthread_join(high, NULL);
+    pthread_join(medium, NULL);
+    pthread_join(low, NULL);
+
+    // Boosted past the spinner, low finishes its 10 ms of work and the high
+    // thread gets the lock long before the spinner's 150 ms is up
+    assert_that(highWaitNs, is_greater_than(0));
+    assert_that(highWaitNs, is_less_than(80 * NSEC_PER_MSEC));
+
+    ThreadMutexDestroy(&inversionLock);
+
+}
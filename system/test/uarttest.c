@@ -0,0 +1,161 @@
+/****************************************************************************
+ *
+ * File:
+ *      uarttest.c
+ *
+ * Description:
+ *      CGreen test suite for the UART module (uart.c). Uses a pseudoterminal
+ *      in place of a serial device.
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "timing.h"
+
+#include "uart.h"
+
+int master_fd, slave_fd;
+
+// Name of test context
+Describe(UART);
+
+// Execute in the context immediately before each "Ensure" test
+BeforeEach(UART) {
+
+    master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    assert_that(master_fd, is_greater_than(-1));
+    grantpt(master_fd);
+    unlockpt(master_fd);
+
+    slave_fd = open(ptsname(master_fd), O_RDWR | O_NOCTTY);
+    assert_that(slave_fd, is_greater_than(-1));
+
+}
+
+// Execute after each test
+AfterEach(UART) {
+
+    close(slave_fd);
+    close(master_fd);
+
+}
+
+
+Ensure(UART, sets_every_standard_rate) {
+
+    const int rates[] = {9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600};
+    int i;
+
+    for (i = 0; i < (int) (sizeof(rates) / sizeof(rates[0])); i++) {
+        assert_that(UARTSetBaud(slave_fd, rates[i]), is_equal_to(0));
+        assert_that(UARTGetBaud(slave_fd), is_equal_to(rates[i]));
+    }
+
+}
+
+Ensure(UART, sets_arbitrary_rate) {
+
+    assert_that(UARTSetBaud(slave_fd, 250000), is_equal_to(0));
+    assert_that(UARTGetBaud(slave_fd), is_equal_to(250000));
+
+    // Back to a standard rate afterwards
+    assert_that(UARTSetBaud(slave_fd, 115200), is_equal_to(0));
+    assert_that(UARTGetBaud(slave_fd), is_equal_to(115200));
+
+}
+
+Ensure(UART, bad_rate_leaves_device_open) {
+
+    unsigned char c = 'x';
+
+    assert_that(UARTSetBaud(slave_fd, 0), is_less_than(0));
+    assert_that(fcntl(slave_fd, F_GETFD), is_not_equal_to(-1));
+    assert_that(UARTWrite(slave_fd, &c, 1), is_equal_to(1));
+
+}
+
+Ensure(UART, reader_wakes_on_packet_and_stamps_chunk) {
+
+    UART_READER reader;
+    unsigned char out[8] = "ABCDEFGH", in[16];
+    int64_t before, after, timeNs;
+    int numRead;
+
+    assert_that(UARTSetBaud(slave_fd, 115200), is_equal_to(0));
+    assert_that(UARTReaderInit(&reader, slave_fd, 115200, 8), is_equal_to(0));
+
+    // Nothing waiting, returns right away
+    assert_that(UARTReaderRead(&reader, in, sizeof(in), 0, &timeNs), is_equal_to(0));
+
+    // A full packet wakes the reader well before the timeout
+    before = TimeMonotonicNs();
+    write(master_fd, out, 8);
+    numRead = UARTReaderRead(&reader, in, sizeof(in), 1000, &timeNs);
+    after = TimeMonotonicNs();
+
+    assert_that(numRead, is_equal_to(8));
+    assert_that(memcmp(in, out, 8), is_equal_to(0));
+    assert_that(after - before, is_less_than(500 * NSEC_PER_MSEC));
+    assert_that(timeNs, is_greater_than(before - 1));
+    assert_that(timeNs, is_less_than(after + 1));
+    assert_that(reader.numWakeups, is_equal_to(1));
+
+    // Less than VMIN is still collected once the wait times out
+    write(master_fd, out, 3);
+    numRead = UARTReaderRead(&reader, in, sizeof(in), 20, &timeNs);
+    assert_that(numRead, is_equal_to(3));
+    assert_that(reader.numBytes, is_equal_to(11));
+    assert_that(reader.numChunks, is_equal_to(2));
+
+    UARTReaderClose(&reader);
+
+}
+
+Ensure(UART, binary_bytes_pass_unchanged) {
+
+    unsigned char out[256], in[256];
+    int i, numRead = 0, rc;
+
+    assert_that(UARTSetBaud(slave_fd, 115200), is_equal_to(0));
+
+    // Includes XON/XOFF, CR, LF, and bytes with the high bit set
+    for (i = 0; i < 256; i++) {
+        out[i] = (unsigned char) i;
+    }
+    write(master_fd, out, sizeof(out));
+
+    while (numRead < (int) sizeof(in)) {
+        rc = read(slave_fd, &in[numRead], sizeof(in) - numRead);
+        if (rc <= 0) {
+            break;
+        }
+        numRead += rc;
+    }
+
+    assert_that(numRead, is_equal_to(256));
+    assert_that(memcmp(in, out, sizeof(out)), is_equal_to(0));
+
+}
+
+Ensure(UART, byte_time_follows_baud) {
+
+    assert_that(UARTByteTimeNs(115200), is_equal_to(86805));
+    assert_that(UARTByteTimeNs(921600), is_equal_to(10850));
+    assert_that(UARTByteTimeNs(0), is_equal_to(0));
+
+}
@@ -0,0 +1,177 @@
+/****************************************************************************
+ *
+ * File:
+ *      watchdog_test.c
+ *
+ * Description:
+ *      CGreen test suite for the thread watchdog (watchdog.c)
+ *
+ * Author:
+ *      David Stockhouse
+ *
+ * Revision 0.1
+ *      Last edited 10/18/2026
+ *
+ ***************************************************************************/
+
+#include <cgreen/cgreen.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "config.h"
+
+#include "thread.h"
+#include "timing.h"
+#include "watchdog.h"
+
+static WATCHDOG watchdog;
+
+static volatile int numHandlerCalls;
+static volatile int lastHandle;
+
+static void countingHandler(WATCHDOG *wd, int handle, void *params) {
+
+    numHandlerCalls++;
+    lastHandle = handle;
+    if (params != NULL) {
+        *(volatile int *) params = 1;
+    }
+
+}
+
+Describe(Watchdog);
+
+BeforeEach(Watchdog) {
+    numHandlerCalls = 0;
+    lastHandle = -1;
+    WatchdogInit(&watchdog, 1000);
+}
+
+AfterEach(Watchdog) {
+}
+
+Ensure(Watchdog, register_checks_arguments) {
+
+    int i;
+
+    assert_that(WatchdogRegister(&watchdog, "a", 0, WATCHDOG_ACTION_LOG, NULL, NULL), is_equal_to(-1));
+    assert_that(WatchdogRegister(&watchdog, "a", 1000, WATCHDOG_ACTION_STOP, NULL, NULL), is_equal_to(-1));
+    assert_that(WatchdogCheckIn(&watchdog, 0), is_equal_to(-1));
+
+    for (i = 0; i < WATCHDOG_MAX_ENTRIES; i++) {
+        assert_that(WatchdogRegister(&watchdog, "a", 1000, WATCHDOG_ACTION_LOG, NULL, NULL), is_equal_to(i));
+    }
+    assert_that(WatchdogRegister(&watchdog, "a", 1000, WATCHDOG_ACTION_LOG, NULL, NULL), is_equal_to(-1));
+
+}
+
+Ensure(Watchdog, check_ins_count_late_cycles_and_worst_gap) {
+
+    // Budget well clear of scheduling delays on a loaded host
+    int handle = WatchdogRegister(&watchdog, "late", 20000, WATCHDOG_ACTION_LOG, NULL, NULL);
+
+    // First check-in starts the clock
+    assert_that(WatchdogCheckIn(&watchdog, handle), is_equal_to(0));
+    usleep(1000);
+    assert_that(WatchdogCheckIn(&watchdog, handle), is_equal_to(0));
+    usleep(40000);
+    assert_that(WatchdogCheckIn(&watchdog, handle), is_equal_to(1));
+
+    assert_that(watchdog.entries[handle].numCheckIns, is_equal_to(3));
+    assert_that(watchdog.entries[handle].numMisses, is_equal_to(1));
+    assert_that(watchdog.entries[handle].worstGapNs, is_greater_than(40 * NSEC_PER_MSEC - 1));
+
+}
+
+Ensure(Watchdog, stalled_thread_triggers_stop_once) {
+
+    volatile int stopped = 0;
+    int handle = WatchdogRegister(&watchdog, "stuck", 5000,
+            WATCHDOG_ACTION_STOP, countingHandler, (void *) &stopped);
+
+    assert_that(WatchdogStart(&watchdog), is_equal_to(0));
+
+    // Not monitored before the first check-in
+    usleep(10000);
+    assert_that(numHandlerCalls, is_equal_to(0));
+
+    // Check in, then go silent well past the budget
+    WatchdogCheckIn(&watchdog, handle);
+    usleep(30000);
+    assert_that(stopped, is_equal_to(1));
+    assert_that(numHandlerCalls, is_equal_to(1));
+    assert_that(lastHandle, is_equal_to(handle));
+    assert_that(watchdog.entries[handle].numStalls, is_equal_to(1));
+
+    // Checking in again rearms it
+    WatchdogCheckIn(&watchdog, handle);
+    usleep(30000);
+    assert_that(numHandlerCalls, is_equal_to(2));
+
+    assert_that(WatchdogStop(&watchdog), is_equal_to(0));
+
+}
+
+Ensure(Watchdog, restart_waits_for_fresh_check_in) {
+
+    int handle = WatchdogRegister(&watchdog, "restart", 5000,
+            WATCHDOG_ACTION_RESTART, countingHandler, NULL);
+
+    WatchdogStart(&watchdog);
+    WatchdogCheckIn(&watchdog, handle);
+    usleep(30000);
+
+    // One restart, then quiet until the restarted thread checks in
+    assert_that(numHandlerCalls, is_equal_to(1));
+    assert_that(watchdog.entries[handle].lastCheckInNs, is_equal_to(0));
+    usleep(20000);
+    assert_that(numHandlerCalls, is_equal_to(1));
+
+    WatchdogStop(&watchdog);
+
+}
+
+// Periodic routine that hangs once for several periods
+static volatile int numRuns;
+
+static int hangOnceRoutine(void *params) {
+
+    numRuns++;
+    if (numRuns == 20) {
+        usleep(20000);
+    }
+
+    return 0;
+
+}
+
+Ensure(Watchdog, periodic_task_checks_in_each_cycle) {
+
+    PERIODIC_TASK task;
+    int handle;
+
+    numRuns = 0;
+    ThreadPeriodicInit(&task, "hang", 1000, hangOnceRoutine, NULL);
+    handle = WatchdogRegister(&watchdog, "hang", 5000, WATCHDOG_ACTION_LOG, NULL, NULL);
+    assert_that(ThreadPeriodicSetWatchdog(&task, &watchdog, handle), is_equal_to(0));
+
+    WatchdogStart(&watchdog);
+    ThreadPeriodicStart(&task, NULL);
+    usleep(80000);
+    ThreadPeriodicStop(&task);
+    WatchdogStop(&watchdog);
+
+    // Every run checked in, and the hang shows as a late cycle and a stall.
+    // Scheduling delays on a loaded host can add more of both, but each
+    // stall ends in a late check-in.
+    assert_that(watchdog.entries[handle].numCheckIns, is_equal_to(numRuns));
+    assert_that(watchdog.entries[handle].numMisses, is_greater_than(0));
+    assert_that(watchdog.entries[handle].numStalls, is_greater_than(0));
+    assert_that(watchdog.entries[handle].numStalls,
+            is_less_than(watchdog.entries[handle].numMisses + 1));
+    assert_that(watchdog.entries[handle].worstGapNs, is_greater_than(20 * NSEC_PER_MSEC - 1));
+
+}